@@ -0,0 +1,164 @@
+#include <src/cpp/LCDColumns.h>
+#include <src/cpp/VAC6Model.h>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Benchmark {
+
+using namespace pongasoft::VST::VAC6;
+
+namespace {
+
+constexpr double SILENT_THRESHOLD = 2.0e-8;
+constexpr double MIN_SAMPLE = 0.001; // -60dB
+constexpr double SOFT_CLIPPING_LEVEL = 0.50118723362; // -6dB
+constexpr double LCD_HEIGHT = 200;
+
+// a frame of the LCD (-80dB to +3dB)
+std::vector<THistorySample> randomFrame(size_t iCount)
+{
+  std::mt19937 generator{42};
+  std::uniform_real_distribution<double> db{-80.0, 3.0};
+  std::vector<THistorySample> entries{};
+  for(size_t i = 0; i < iCount; i++)
+    entries.emplace_back(toHistorySample(std::pow(10.0, db(generator) / 20.0)));
+  return entries;
+}
+
+// a frame as received by the LCD (2 channels on, -80dB to +3dB)
+std::unique_ptr<LCDData> randomLCDData()
+{
+  auto lcdData = std::make_unique<LCDData>();
+  lcdData->fNumChannels = 2;
+  for(int c = 0; c < lcdData->fNumChannels; c++)
+  {
+    auto frame = randomFrame(MAX_ARRAY_SIZE + c);
+    std::copy(frame.begin() + c, frame.end(), lcdData->fChannels[c].fSamples);
+  }
+  return lcdData;
+}
+
+// what the LCD draws for a column (the VSTGUI calls cannot be made headless => they are recorded instead)
+struct DrawnRect
+{
+  double fLeft;
+  double fTop;
+  double fRight;
+  double fBottom;
+  int fBand;
+};
+
+}
+
+// LCDColumns::compute (position and band of every column of a frame)
+static void BM_LCDColumns_compute(benchmark::State &state)
+{
+  auto const frame = randomFrame(MAX_ARRAY_SIZE);
+  LCDColumns<MAX_ARRAY_SIZE> columns{SILENT_THRESHOLD, MIN_SAMPLE, 1.0};
+
+  for(auto _ : state)
+  {
+    columns.compute(frame.data(), LCD_HEIGHT, SOFT_CLIPPING_LEVEL);
+    benchmark::DoNotOptimize(columns.getTop(0));
+  }
+  state.SetItemsProcessed(state.iterations() * MAX_ARRAY_SIZE);
+}
+BENCHMARK(BM_LCDColumns_compute);
+
+// What LCDDisplayView::draw did before LCDColumns: for every column, the max of the channels (decoded), its position
+// (toDisplayValue => log10) and its color (computeColor) followed by one line per column
+static void BM_LCDColumns_drawPerColumn(benchmark::State &state)
+{
+  auto const lcdData = randomLCDData();
+  std::vector<DrawnRect> lines{};
+  lines.reserve(MAX_ARRAY_SIZE);
+
+  for(auto _ : state)
+  {
+    lines.clear();
+    for(int i = 0; i < MAX_ARRAY_SIZE; i++)
+    {
+      TSample sample = std::max<TSample>(lcdData->computeMaxSample(i), 0);
+      if(sample >= SILENT_THRESHOLD)
+      {
+        double displayValue = sample < MIN_SAMPLE ? 1 : toDisplayValue(sample, LCD_HEIGHT);
+        double top = std::min(std::max(LCD_HEIGHT - displayValue, -0.5), LCD_HEIGHT);
+        int band = sample > HARD_CLIPPING_LEVEL ? 2 : sample > SOFT_CLIPPING_LEVEL ? 1 : 0;
+        lines.emplace_back(DrawnRect{static_cast<double>(i), top, static_cast<double>(i), LCD_HEIGHT, band});
+      }
+    }
+    benchmark::DoNotOptimize(lines.data());
+  }
+  state.SetItemsProcessed(state.iterations() * MAX_ARRAY_SIZE);
+}
+BENCHMARK(BM_LCDColumns_drawPerColumn);
+
+// What LCDDisplayView::draw does with LCDColumns (to compare with BM_LCDColumns_drawPerColumn): the max of the
+// channels for all the columns at once (LCDData::computeMaxSamples), LCDColumns::compute and one path per band built
+// from the columns of the band (LCDDisplayView::drawColumns)
+static void BM_LCDColumns_drawBands(benchmark::State &state)
+{
+  using Band = LCDColumns<MAX_ARRAY_SIZE>::Band;
+
+  auto const lcdData = randomLCDData();
+  LCDColumns<MAX_ARRAY_SIZE> columns{SILENT_THRESHOLD, MIN_SAMPLE, HARD_CLIPPING_LEVEL};
+  THistorySample samples[MAX_ARRAY_SIZE];
+  std::vector<DrawnRect> paths[Band::kNumBands]{};
+  for(auto &path : paths)
+    path.reserve(MAX_ARRAY_SIZE);
+
+  for(auto _ : state)
+  {
+    lcdData->computeMaxSamples(samples);
+    columns.compute(samples, LCD_HEIGHT, SOFT_CLIPPING_LEVEL);
+
+    for(int b = 0; b < Band::kNumBands; b++)
+    {
+      auto band = static_cast<Band>(b);
+      auto const *bandColumns = columns.getColumns(band);
+      auto &path = paths[b];
+      path.clear();
+      for(int i = 0; i < columns.getNumColumns(band); i++)
+      {
+        auto x = static_cast<double>(bandColumns[i]);
+        path.emplace_back(DrawnRect{x, columns.getTop(bandColumns[i]), x + 1, LCD_HEIGHT, b});
+      }
+      benchmark::DoNotOptimize(path.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * MAX_ARRAY_SIZE);
+}
+BENCHMARK(BM_LCDColumns_drawBands);
+
+// LCDColumns::rasterize after a scroll of range(0) columns (range(0) == MAX_ARRAY_SIZE is a full render) at 2x
+static void BM_LCDColumns_rasterize(benchmark::State &state)
+{
+  constexpr int pixelsPerColumn = 2;
+  constexpr int width = MAX_ARRAY_SIZE * pixelsPerColumn;
+  constexpr int height = static_cast<int>(LCD_HEIGHT) * pixelsPerColumn;
+
+  auto const numColumns = static_cast<int>(state.range(0));
+  auto const frame = randomFrame(MAX_ARRAY_SIZE);
+  LCDColumns<MAX_ARRAY_SIZE> columns{SILENT_THRESHOLD, MIN_SAMPLE, 1.0};
+  columns.compute(frame.data(), LCD_HEIGHT, SOFT_CLIPPING_LEVEL);
+
+  std::vector<PixelBuffer::Pixel> pixels(static_cast<size_t>(width) * height);
+  PixelBuffer buffer{reinterpret_cast<uint8_t *>(pixels.data()), width * 4, width, height};
+  PixelBuffer::Pixel const bandPixels[] = {0xff00ff00, 0xffffff00, 0xffff0000};
+
+  for(auto _ : state)
+  {
+    buffer.shiftLeft(numColumns * pixelsPerColumn);
+    columns.rasterize(buffer, MAX_ARRAY_SIZE - numColumns, pixelsPerColumn, bandPixels);
+    benchmark::DoNotOptimize(pixels.data());
+  }
+}
+BENCHMARK(BM_LCDColumns_rasterize)->Arg(1)->Arg(2)->Arg(8)->Arg(MAX_ARRAY_SIZE);
+
+}
+}
+}
@@ -0,0 +1,41 @@
+#include <src/cpp/Metrics.h>
+#include <benchmark/benchmark.h>
+
+namespace pongasoft {
+namespace VST {
+namespace Benchmark {
+
+using namespace pongasoft::VST::Common;
+
+// ProcessMetrics::recordBlock (what the metrics add to every block, the clock excluded)
+static void BM_ProcessMetrics_recordBlock(benchmark::State &state)
+{
+  ProcessMetrics metrics{};
+  metrics.reset(44100);
+
+  Steinberg::int64 timeNs = 0;
+  for(auto _ : state)
+  {
+    metrics.recordBlock(512, timeNs);
+    timeNs = (timeNs + 7919) % 20000000; // from 0 to ~170% of the budget
+  }
+}
+BENCHMARK(BM_ProcessMetrics_recordBlock);
+
+// ProcessMetrics::now followed by ProcessMetrics::recordBlock (what the metrics add to every block)
+static void BM_ProcessMetrics_measureBlock(benchmark::State &state)
+{
+  ProcessMetrics metrics{};
+  metrics.reset(44100);
+
+  for(auto _ : state)
+  {
+    auto startTime = ProcessMetrics::now();
+    metrics.recordBlock(512, ProcessMetrics::now() - startTime);
+  }
+}
+BENCHMARK(BM_ProcessMetrics_measureBlock);
+
+}
+}
+}
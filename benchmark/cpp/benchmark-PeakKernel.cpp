@@ -0,0 +1,128 @@
+#include <src/cpp/PeakKernel.h>
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Benchmark {
+
+using namespace pongasoft::VST::VAC6;
+
+namespace {
+
+template<typename SampleType>
+std::vector<SampleType> randomSamples(int iNumSamples)
+{
+  std::mt19937 generator{42};
+  std::uniform_real_distribution<SampleType> distribution{-1.0, 1.0};
+  std::vector<SampleType> samples(static_cast<size_t>(iNumSamples));
+  for(auto &sample : samples)
+    sample = distribution(generator);
+  return samples;
+}
+
+}
+
+// PeakKernel::scalarCopyAndComputeMax (reference loop) with the output copy (what the processor does when the
+// gain is applied) for 32 and 64 bits samples at various block sizes
+template<typename SampleType>
+static void BM_PeakKernel_scalarCopyAndComputeMax(benchmark::State &state)
+{
+  auto numSamples = static_cast<int>(state.range(0));
+  auto in = randomSamples<SampleType>(numSamples);
+  std::vector<SampleType> out(in.size());
+
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(PeakKernel::scalarCopyAndComputeMax<SampleType>(in.data(), out.data(), numSamples, 0.8));
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * numSamples);
+}
+BENCHMARK_TEMPLATE(BM_PeakKernel_scalarCopyAndComputeMax, Sample32)->RangeMultiplier(4)->Range(16, 8192);
+BENCHMARK_TEMPLATE(BM_PeakKernel_scalarCopyAndComputeMax, Sample64)->RangeMultiplier(4)->Range(16, 8192);
+
+// PeakKernel::copyAndComputeMax (vectorized when possible) with the output copy
+template<typename SampleType>
+static void BM_PeakKernel_copyAndComputeMax(benchmark::State &state)
+{
+  auto numSamples = static_cast<int>(state.range(0));
+  auto in = randomSamples<SampleType>(numSamples);
+  std::vector<SampleType> out(in.size());
+
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(PeakKernel::copyAndComputeMax(in.data(), out.data(), numSamples, 0.8));
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * numSamples);
+}
+BENCHMARK_TEMPLATE(BM_PeakKernel_copyAndComputeMax, Sample32)->RangeMultiplier(4)->Range(16, 8192);
+BENCHMARK_TEMPLATE(BM_PeakKernel_copyAndComputeMax, Sample64)->RangeMultiplier(4)->Range(16, 8192);
+
+// PeakKernel::scalarComputeMax (reference loop) without the output copy (pass through at unity gain)
+template<typename SampleType>
+static void BM_PeakKernel_scalarComputeMax(benchmark::State &state)
+{
+  auto numSamples = static_cast<int>(state.range(0));
+  auto in = randomSamples<SampleType>(numSamples);
+
+  for(auto _ : state)
+    benchmark::DoNotOptimize(PeakKernel::scalarComputeMax<SampleType>(in.data(), numSamples));
+
+  state.SetItemsProcessed(state.iterations() * numSamples);
+}
+BENCHMARK_TEMPLATE(BM_PeakKernel_scalarComputeMax, Sample32)->RangeMultiplier(4)->Range(16, 8192);
+BENCHMARK_TEMPLATE(BM_PeakKernel_scalarComputeMax, Sample64)->RangeMultiplier(4)->Range(16, 8192);
+
+// PeakKernel::computeMax (vectorized when possible) without the output copy
+template<typename SampleType>
+static void BM_PeakKernel_computeMax(benchmark::State &state)
+{
+  auto numSamples = static_cast<int>(state.range(0));
+  auto in = randomSamples<SampleType>(numSamples);
+
+  for(auto _ : state)
+    benchmark::DoNotOptimize(PeakKernel::computeMax(in.data(), numSamples));
+
+  state.SetItemsProcessed(state.iterations() * numSamples);
+}
+BENCHMARK_TEMPLATE(BM_PeakKernel_computeMax, Sample32)->RangeMultiplier(4)->Range(16, 8192);
+BENCHMARK_TEMPLATE(BM_PeakKernel_computeMax, Sample64)->RangeMultiplier(4)->Range(16, 8192);
+
+// PeakKernel::scalarComputeSumOfSquares (reference loop) used for the RMS of the selection
+template<typename SampleType>
+static void BM_PeakKernel_scalarComputeSumOfSquares(benchmark::State &state)
+{
+  auto numSamples = static_cast<int>(state.range(0));
+  auto in = randomSamples<SampleType>(numSamples);
+
+  for(auto _ : state)
+    benchmark::DoNotOptimize(PeakKernel::scalarComputeSumOfSquares<SampleType>(in.data(), numSamples, 0.8));
+
+  state.SetItemsProcessed(state.iterations() * numSamples);
+}
+BENCHMARK_TEMPLATE(BM_PeakKernel_scalarComputeSumOfSquares, Sample32)->RangeMultiplier(4)->Range(16, 8192);
+BENCHMARK_TEMPLATE(BM_PeakKernel_scalarComputeSumOfSquares, Sample64)->RangeMultiplier(4)->Range(16, 8192);
+
+// PeakKernel::computeSumOfSquares (vectorized when possible)
+template<typename SampleType>
+static void BM_PeakKernel_computeSumOfSquares(benchmark::State &state)
+{
+  auto numSamples = static_cast<int>(state.range(0));
+  auto in = randomSamples<SampleType>(numSamples);
+
+  for(auto _ : state)
+    benchmark::DoNotOptimize(PeakKernel::computeSumOfSquares(in.data(), numSamples, 0.8));
+
+  state.SetItemsProcessed(state.iterations() * numSamples);
+}
+BENCHMARK_TEMPLATE(BM_PeakKernel_computeSumOfSquares, Sample32)->RangeMultiplier(4)->Range(16, 8192);
+BENCHMARK_TEMPLATE(BM_PeakKernel_computeSumOfSquares, Sample64)->RangeMultiplier(4)->Range(16, 8192);
+
+}
+}
+}
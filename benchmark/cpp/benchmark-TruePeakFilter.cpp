@@ -0,0 +1,100 @@
+#include <src/cpp/TruePeakFilter.h>
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Benchmark {
+
+using namespace pongasoft::VST::VAC6;
+
+namespace {
+
+// number of samples processed per iteration by the sample peak / true peak comparison
+constexpr int NUM_SAMPLES = 32768;
+
+template<typename SampleType>
+std::vector<SampleType> randomSamples(int iNumSamples)
+{
+  std::mt19937 generator{42};
+  std::uniform_real_distribution<SampleType> distribution{-1.0, 1.0};
+  std::vector<SampleType> samples(static_cast<size_t>(iNumSamples));
+  for(auto &sample : samples)
+    sample = distribution(generator);
+  return samples;
+}
+
+// the number of samples in 5ms (the runs processed by VAC6AudioChannelProcessor::processRun)
+inline int runSize(benchmark::State const &state)
+{
+  return static_cast<int>(state.range(0) * ACCUMULATOR_BATCH_SIZE_IN_MS / 1000);
+}
+
+// reports the time per sample (the cycles per sample are this time multiplied by the frequency of the cpu)
+inline void setTimePerSample(benchmark::State &state, int iNumSamples)
+{
+  state.SetItemsProcessed(state.iterations() * iNumSamples);
+  state.counters["time_per_sample"] =
+    benchmark::Counter(static_cast<double>(state.iterations() * iNumSamples),
+                       benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+}
+
+// TruePeakFilter::process (4x oversampling) for 32 and 64 bits samples at various block sizes
+template<typename SampleType>
+static void BM_TruePeakFilter_process(benchmark::State &state)
+{
+  auto numSamples = static_cast<int>(state.range(0));
+  auto samples = randomSamples<SampleType>(numSamples);
+
+  TruePeakFilter filter{};
+  for(auto _ : state)
+    benchmark::DoNotOptimize(filter.process(samples.data(), numSamples, 0.8));
+
+  state.SetItemsProcessed(state.iterations() * numSamples);
+}
+BENCHMARK_TEMPLATE(BM_TruePeakFilter_process, Sample32)->RangeMultiplier(4)->Range(16, 8192);
+BENCHMARK_TEMPLATE(BM_TruePeakFilter_process, Sample64)->RangeMultiplier(4)->Range(16, 8192);
+
+// Sample peak: PeakKernel::computeMax over 5ms runs at 44.1kHz, 96kHz and 192kHz (baseline of the true peak)
+template<typename SampleType>
+static void BM_SamplePeak_computeMax(benchmark::State &state)
+{
+  auto const size = runSize(state);
+  auto samples = randomSamples<SampleType>(NUM_SAMPLES);
+
+  for(auto _ : state)
+  {
+    for(int i = 0; i + size <= NUM_SAMPLES; i += size)
+      benchmark::DoNotOptimize(PeakKernel::computeMax(samples.data() + i, size));
+  }
+
+  setTimePerSample(state, NUM_SAMPLES / size * size);
+}
+BENCHMARK_TEMPLATE(BM_SamplePeak_computeMax, Sample32)->Arg(44100)->Arg(96000)->Arg(192000);
+BENCHMARK_TEMPLATE(BM_SamplePeak_computeMax, Sample64)->Arg(44100)->Arg(96000)->Arg(192000);
+
+// True peak: TruePeakFilter::process over 5ms runs at 44.1kHz, 96kHz and 192kHz (to compare with the sample peak)
+template<typename SampleType>
+static void BM_TruePeak_process(benchmark::State &state)
+{
+  auto const size = runSize(state);
+  auto samples = randomSamples<SampleType>(NUM_SAMPLES);
+
+  TruePeakFilter filter{};
+  for(auto _ : state)
+  {
+    for(int i = 0; i + size <= NUM_SAMPLES; i += size)
+      benchmark::DoNotOptimize(filter.process(samples.data() + i, size, 1.0));
+  }
+
+  setTimePerSample(state, NUM_SAMPLES / size * size);
+}
+BENCHMARK_TEMPLATE(BM_TruePeak_process, Sample32)->Arg(44100)->Arg(96000)->Arg(192000);
+BENCHMARK_TEMPLATE(BM_TruePeak_process, Sample64)->Arg(44100)->Arg(96000)->Arg(192000);
+
+}
+}
+}
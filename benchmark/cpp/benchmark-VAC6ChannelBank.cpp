@@ -0,0 +1,137 @@
+#include <src/cpp/VAC6ChannelBank.h>
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Benchmark {
+
+using namespace pongasoft::VST::VAC6;
+
+namespace {
+
+constexpr int NUM_CHANNELS = 2;
+
+// the input/output bus of the processor (iNumChannels channels of iNumSamples samples)
+template<typename SampleType>
+class Bus
+{
+public:
+  Bus(int iNumSamples, int iNumChannels = NUM_CHANNELS) : fSamples(static_cast<size_t>(iNumChannels))
+  {
+    std::mt19937 generator{42};
+    std::uniform_real_distribution<SampleType> distribution{-1.0, 1.0};
+
+    for(int c = 0; c < iNumChannels; c++)
+    {
+      fSamples[c].resize(static_cast<size_t>(iNumSamples));
+      for(auto &sample : fSamples[c])
+        sample = distribution(generator);
+      fChannels[c] = fSamples[c].data();
+    }
+
+    fBusBuffers.numChannels = iNumChannels;
+    fBusBuffers.silenceFlags = 0;
+    setChannelBuffers(fBusBuffers, fChannels);
+  }
+
+  AudioBusBuffers &getBusBuffers() { return fBusBuffers; }
+
+private:
+  static void setChannelBuffers(AudioBusBuffers &oBuffers, Sample32 **iChannels) { oBuffers.channelBuffers32 = iChannels; }
+  static void setChannelBuffers(AudioBusBuffers &oBuffers, Sample64 **iChannels) { oBuffers.channelBuffers64 = iChannels; }
+
+  std::vector<std::vector<SampleType>> fSamples;
+  SampleType *fChannels[MAX_NUM_CHANNELS]{};
+  AudioBusBuffers fBusBuffers{};
+};
+
+}
+
+// VAC6ChannelBank::genericProcessChannels (what the processor does for every block in live view, with the gain
+// applied) for 32 and 64 bits samples, for block sizes 16 to 8192, sample rates 44.1kHz to 384kHz and with or without
+// true peak
+template<typename SampleType>
+static void BM_VAC6ChannelBank_processChannels(benchmark::State &state)
+{
+  auto const blockSize = static_cast<int>(state.range(0));
+  auto const sampleRate = static_cast<SampleRate>(state.range(1));
+  auto const isTruePeak = state.range(2) != 0;
+
+  SampleRateBasedClock clock{sampleRate};
+  ZoomWindow zoomWindow{MAX_ARRAY_SIZE, ZOOM_HISTORY_BUFFER_SIZE};
+  VAC6ChannelBank channelBank{clock, &zoomWindow, NUM_CHANNELS, SAMPLE_BUFFER_SIZE, HISTORY_BUFFER_SIZE, false};
+  channelBank.setIsLiveView(true);
+  channelBank.setTruePeak(isTruePeak);
+
+  Bus<SampleType> input{blockSize};
+  Bus<SampleType> output{blockSize};
+  AudioBuffers<SampleType> in(input.getBusBuffers(), blockSize);
+  AudioBuffers<SampleType> out(output.getBusBuffers(), blockSize);
+
+  BlockGain const gain{0.5, nullptr};
+
+  for(auto _ : state)
+  {
+    channelBank.genericProcessChannels<SampleType>(&zoomWindow, in, out, gain, 0, blockSize);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * blockSize * NUM_CHANNELS);
+}
+
+static void ChannelBankArguments(benchmark::internal::Benchmark *b)
+{
+  for(int64_t blockSize = 16; blockSize <= 8192; blockSize *= 4)
+    for(int64_t sampleRate : {44100, 48000, 96000, 192000, 384000})
+      for(int64_t truePeak : {0, 1})
+        b->Args({blockSize, sampleRate, truePeak});
+}
+
+BENCHMARK_TEMPLATE(BM_VAC6ChannelBank_processChannels, Sample32)->Apply(ChannelBankArguments);
+BENCHMARK_TEMPLATE(BM_VAC6ChannelBank_processChannels, Sample64)->Apply(ChannelBankArguments);
+
+// Same as BM_VAC6ChannelBank_processChannels for 1 to 16 channels (stereo, 5.1, 7.1.4, 3rd order ambisonics) at 48kHz:
+// the time per channel and sample should not depend on the number of channels (the channel processors and their
+// histories are separate objects, see VAC6ChannelBank)
+template<typename SampleType>
+static void BM_VAC6ChannelBank_processChannels_numChannels(benchmark::State &state)
+{
+  auto const blockSize = static_cast<int>(state.range(0));
+  auto const numChannels = static_cast<int>(state.range(1));
+
+  SampleRateBasedClock clock{48000};
+  ZoomWindow zoomWindow{MAX_ARRAY_SIZE, ZOOM_HISTORY_BUFFER_SIZE};
+  VAC6ChannelBank channelBank{clock, &zoomWindow, numChannels, SAMPLE_BUFFER_SIZE, HISTORY_BUFFER_SIZE, false};
+  channelBank.setIsLiveView(true);
+
+  Bus<SampleType> input{blockSize, numChannels};
+  Bus<SampleType> output{blockSize, numChannels};
+  AudioBuffers<SampleType> in(input.getBusBuffers(), blockSize);
+  AudioBuffers<SampleType> out(output.getBusBuffers(), blockSize);
+
+  BlockGain const gain{0.5, nullptr};
+
+  for(auto _ : state)
+  {
+    channelBank.genericProcessChannels<SampleType>(&zoomWindow, in, out, gain, 0, blockSize);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * blockSize * numChannels);
+}
+
+static void ChannelBankNumChannelsArguments(benchmark::internal::Benchmark *b)
+{
+  for(int64_t blockSize : {64, 512, 4096})
+    for(int64_t numChannels : {1, 2, 6, 12, 16})
+      b->Args({blockSize, numChannels});
+}
+
+BENCHMARK_TEMPLATE(BM_VAC6ChannelBank_processChannels_numChannels, Sample32)->Apply(ChannelBankNumChannelsArguments);
+BENCHMARK_TEMPLATE(BM_VAC6ChannelBank_processChannels_numChannels, Sample64)->Apply(ChannelBankNumChannelsArguments);
+
+}
+}
+}
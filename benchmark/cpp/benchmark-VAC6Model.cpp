@@ -0,0 +1,93 @@
+#include <src/cpp/VAC6Model.h>
+#include <public.sdk/source/common/memorystream.h>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+
+namespace pongasoft {
+namespace VST {
+namespace Benchmark {
+
+using namespace pongasoft::VST::VAC6;
+
+namespace {
+
+// a frame as sent by the processor (2 channels + loudness)
+std::unique_ptr<HistoryData> randomHistoryData()
+{
+  std::mt19937 generator{42};
+  std::uniform_real_distribution<double> distribution{0.0, 1.0};
+
+  auto data = std::make_unique<HistoryData>();
+  auto &lcdData = data->fLCDData;
+  lcdData.fNumChannels = 2;
+  for(int c = 0; c < lcdData.fNumChannels; c++)
+  {
+    for(auto &sample : lcdData.fChannels[c].fSamples)
+      sample = toHistorySample(distribution(generator));
+  }
+  lcdData.fLoudness.fOn = true;
+  for(auto &sample : lcdData.fLoudness.fSamples)
+    sample = toHistorySample(distribution(generator));
+
+  return data;
+}
+
+// moves the frame by iCount points (what happens between 2 frames in live view)
+void scroll(LCDData::Channel &ioChannel, int iCount, THistorySample iSample)
+{
+  std::copy(ioChannel.fSamples + iCount, ioChannel.fSamples + MAX_ARRAY_SIZE, ioChannel.fSamples);
+  std::fill(ioChannel.fSamples + MAX_ARRAY_SIZE - iCount, ioChannel.fSamples + MAX_ARRAY_SIZE, iSample);
+  ioChannel.fZoomPointCount += iCount;
+}
+
+}
+
+// HistoryDataParamSerializer round trip (RT write + GUI read) of frames which scrolled by range(0) points (delta
+// frames), range(0) == 0 being a full frame every time
+static void BM_HistoryDataParamSerializer_roundTrip(benchmark::State &state)
+{
+  auto const scrollCount = static_cast<int>(state.range(0));
+
+  auto const value = randomHistoryData();
+  auto const readValue = std::make_unique<HistoryData>();
+
+  HistoryDataParamSerializer writer{};
+  HistoryDataParamSerializer reader{};
+
+  MemoryStream stream{};
+  IBStreamer streamer{&stream, kLittleEndian};
+
+  THistorySample sample = toHistorySample(0.5);
+  int64 bytes = 0;
+
+  for(auto _ : state)
+  {
+    if(scrollCount > 0)
+    {
+      for(int c = 0; c < value->fLCDData.fNumChannels; c++)
+        scroll(value->fLCDData.fChannels[c], scrollCount, sample);
+      scroll(value->fLCDData.fLoudness, scrollCount, sample);
+    }
+    else
+    {
+      // a different number of channels forces a full frame
+      value->fLCDData.fNumChannels = value->fLCDData.fNumChannels == 2 ? 1 : 2;
+    }
+
+    stream.setSize(0);
+    stream.seek(0, IBStream::kIBSeekSet, nullptr);
+    writer.writeToStream(*value, streamer);
+    bytes += stream.getSize();
+
+    stream.seek(0, IBStream::kIBSeekSet, nullptr);
+    benchmark::DoNotOptimize(reader.readFromStream(streamer, *readValue));
+  }
+
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_HistoryDataParamSerializer_roundTrip)->Arg(0)->Arg(1)->Arg(2)->Arg(8);
+
+}
+}
+}
@@ -0,0 +1,104 @@
+#include <src/cpp/ZoomWindow.h>
+#include <src/cpp/VAC6Constants.h>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Benchmark {
+
+using namespace pongasoft::VST::Common;
+using namespace pongasoft::VST::VAC6;
+
+namespace {
+
+// random peaks (same sequence for every run)
+std::vector<THistorySample> randomEntries(size_t iCount)
+{
+  std::mt19937 generator{42};
+  std::uniform_real_distribution<double> distribution{0.0, 1.0};
+  std::vector<THistorySample> entries{};
+  entries.reserve(iCount);
+  for(size_t i = 0; i < iCount; i++)
+    entries.emplace_back(toHistorySample(distribution(generator)));
+  return entries;
+}
+
+// a full (1h) history, as the processor has after running for an hour
+TieredHistory<THistorySample> const &fullHistory()
+{
+  static auto const history = [] {
+    auto h = std::make_unique<TieredHistory<THistorySample>>(SAMPLE_BUFFER_SIZE, HISTORY_BUFFER_SIZE, HISTORY_TIER_FACTOR);
+    for(auto entry : randomEntries(HISTORY_BUFFER_SIZE))
+      h->push(entry);
+    return h;
+  }();
+  return *history;
+}
+
+}
+
+// Zoom::MaxAccumulator::accumulate (live view, one call per history entry) for zoom factors (in %) from max zoom (0)
+// to the whole history (100)
+static void BM_MaxAccumulator_accumulate(benchmark::State &state)
+{
+  ZoomWindow window{MAX_ARRAY_SIZE, ZOOM_HISTORY_BUFFER_SIZE};
+  auto accumulator = window.setZoomFactor(state.range(0) / 100.0);
+  auto const entries = randomEntries(4096);
+
+  THistorySample max{};
+  for(auto _ : state)
+  {
+    for(auto entry : entries)
+      benchmark::DoNotOptimize(accumulator.accumulate(entry, max));
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(entries.size()));
+}
+BENCHMARK(BM_MaxAccumulator_accumulate)->DenseRange(0, 100, 25);
+
+// ZoomWindow::computeZoomWindow (full window of a full history, ex: after a zoom) for zoom factors (in %) from max
+// zoom (0) to the whole history (100)
+static void BM_ZoomWindow_computeZoomWindow(benchmark::State &state)
+{
+  auto const &history = fullHistory();
+  ZoomWindow window{MAX_ARRAY_SIZE, ZOOM_HISTORY_BUFFER_SIZE};
+  window.setZoomFactor(state.range(0) / 100.0);
+  CircularBuffer<THistorySample> buffer{MAX_ARRAY_SIZE};
+  buffer.init(0);
+
+  for(auto _ : state)
+  {
+    ZoomWindow::ComputedWindow computedWindow{};
+    auto pendingPoints = window.beginZoomWindow(buffer, computedWindow, buffer);
+    window.computeZoomWindow(history, pendingPoints, MAX_ARRAY_SIZE, 0, buffer);
+    window.endZoomWindow(pendingPoints, computedWindow);
+    benchmark::DoNotOptimize(buffer.getAt(0));
+  }
+  state.SetItemsProcessed(state.iterations() * MAX_ARRAY_SIZE);
+}
+BENCHMARK(BM_ZoomWindow_computeZoomWindow)->DenseRange(0, 100, 10);
+
+// ZoomWindow::__findMaxForIndex (used when zooming around the selected point) for every point of the window
+static void BM_ZoomWindow_findMaxForIndex(benchmark::State &state)
+{
+  auto const &history = fullHistory();
+  ZoomWindow window{MAX_ARRAY_SIZE, ZOOM_HISTORY_BUFFER_SIZE};
+  window.setZoomFactor(state.range(0) / 100.0);
+
+  for(auto _ : state)
+  {
+    for(int idx = -1; idx >= -MAX_ARRAY_SIZE; idx--)
+    {
+      int maxOffset;
+      benchmark::DoNotOptimize(window.__findMaxForIndex(idx, history, maxOffset));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * MAX_ARRAY_SIZE);
+}
+BENCHMARK(BM_ZoomWindow_findMaxForIndex)->DenseRange(0, 100, 25);
+
+}
+}
+}
@@ -0,0 +1,148 @@
+#include "DiskHistory.h"
+#include <pongasoft/logging/loguru.hpp>
+#include <algorithm>
+#include <chrono>
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+/////////////////////////////////////////
+// DiskHistory::DiskHistory
+/////////////////////////////////////////
+DiskHistory::DiskHistory(int iRecordResolution) :
+  fRecordResolution{iRecordResolution},
+  fRecords{64},
+  fRequests{2},
+  fResponses{2}
+{
+  DCHECK_GT_F(iRecordResolution, 0);
+}
+
+/////////////////////////////////////////
+// DiskHistory::~DiskHistory
+/////////////////////////////////////////
+DiskHistory::~DiskHistory()
+{
+  delete fFile;
+}
+
+/////////////////////////////////////////
+// DiskHistory::process
+/////////////////////////////////////////
+void DiskHistory::process()
+{
+  Record record{};
+  while(fRecords.pop(record))
+    write(record);
+
+  while(fRequests.pop(fRequest))
+    serve(fRequest);
+}
+
+/////////////////////////////////////////
+// DiskHistory::write
+/////////////////////////////////////////
+void DiskHistory::write(Record const &iRecord)
+{
+  if(iRecord.fIndex < 0)
+    return;
+
+  if(!fFile)
+    fFile = new MemoryMappedFile(MemoryMappedFile::createTemporaryPath("VAC-6V", ".history"));
+
+  if(!fFile->isOpen())
+    return;
+
+  auto recordSize = sizeof(TierEntry);
+
+  if(static_cast<size_t>(iRecord.fIndex + 1) * recordSize > fFile->getSize())
+  {
+    auto numRecords = (iRecord.fIndex / FILE_GROWTH_IN_RECORDS + 1) * FILE_GROWTH_IN_RECORDS;
+    if(!fFile->resize(static_cast<size_t>(numRecords) * recordSize))
+      return;
+  }
+
+  reinterpret_cast<TierEntry *>(fFile->getData())[iRecord.fIndex] = iRecord.fEntry;
+  fRecordCount = std::max(fRecordCount, iRecord.fIndex + 1);
+}
+
+/////////////////////////////////////////
+// DiskHistory::serve
+/////////////////////////////////////////
+void DiskHistory::serve(Request const &iRequest)
+{
+  fResponse.fGeneration = iRequest.fGeneration;
+  fResponse.fNumPoints = iRequest.fNumPoints;
+
+  auto records = fFile && fFile->isOpen() ? reinterpret_cast<TierEntry const *>(fFile->getData()) : nullptr;
+
+  for(int i = 0; i < iRequest.fNumPoints; i++)
+  {
+    fResponse.fPositions[i] = iRequest.fPositions[i];
+
+    THistorySample max = 0;
+
+    if(records && iRequest.fTo[i] > 0)
+    {
+      // all the records overlapping the range
+      int64 from = std::max<int64>(iRequest.fFrom[i], 0) / fRecordResolution;
+      int64 to = std::min((iRequest.fTo[i] + fRecordResolution - 1) / fRecordResolution, fRecordCount);
+
+      for(int64 r = from; r < to; r++)
+        max = std::max(max, records[r].fMax);
+    }
+
+    fResponse.fMax[i] = max;
+  }
+
+  if(!fResponses.push(fResponse))
+    DLOG_F(WARNING, "DiskHistory: response dropped");
+}
+
+/////////////////////////////////////////
+// DiskHistoryThread::start
+/////////////////////////////////////////
+void DiskHistoryThread::start(std::vector<DiskHistory *> const &iHistories)
+{
+  DCHECK_F(!fRunning);
+
+  fHistories = iHistories;
+  fRunning = true;
+  fThread = std::thread(&DiskHistoryThread::run, this);
+}
+
+/////////////////////////////////////////
+// DiskHistoryThread::stop
+/////////////////////////////////////////
+void DiskHistoryThread::stop()
+{
+  if(!fThread.joinable())
+    return;
+
+  fRunning = false;
+  fThread.join();
+  fHistories.clear();
+}
+
+/////////////////////////////////////////
+// DiskHistoryThread::run
+/////////////////////////////////////////
+void DiskHistoryThread::run()
+{
+  while(fRunning)
+  {
+    for(auto history : fHistories)
+      history->process();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(DISK_HISTORY_THREAD_PERIOD_MS));
+  }
+
+  // what is left in the queues
+  for(auto history : fHistories)
+    history->process();
+}
+
+}
+}
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <pluginterfaces/vst/vsttypes.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "VAC6Constants.h"
+#include "TieredHistory.h"
+#include "SPSCQueue.h"
+#include "MemoryMappedFile.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+using namespace VST::Common;
+
+/**
+ * Disk tier of a (tiered) history: the entries of the coarsest tier of the history are appended to a memory mapped
+ * file (fixed size records) so that the history older than what is kept in memory remains available.
+ *
+ * The audio thread never touches the file: it only exchanges messages with the disk history thread (see
+ * DiskHistoryThread) through lock free SPSC queues:
+ * - the records to write (pushRecord)
+ * - the requests for the max of ranges of the history (postRequest) and their responses (pollResponse)
+ *
+ * Records are identified by their absolute index (the record i represents the full resolution entries
+ * [i * getRecordResolution(), (i + 1) * getRecordResolution()[ pushed in the history) so that a record which could
+ * not be queued simply leaves a hole (0) in the file.
+ */
+class DiskHistory
+{
+public:
+  using int64 = Steinberg::int64;
+  using TierEntry = TieredHistory<THistorySample>::TierEntry;
+
+  struct Record
+  {
+    int64 fIndex;
+    TierEntry fEntry;
+  };
+
+  /**
+   * Request for the max of the ranges [fFrom[i], fTo[i][ (absolute indices of full resolution entries) to be used for
+   * the point fPositions[i] of the LCD
+   */
+  struct Request
+  {
+    int64 fGeneration;
+    int fNumPoints;
+    int fPositions[MAX_ARRAY_SIZE];
+    int64 fFrom[MAX_ARRAY_SIZE];
+    int64 fTo[MAX_ARRAY_SIZE];
+  };
+
+  // Response to a Request (same generation, positions and number of points)
+  struct Response
+  {
+    int64 fGeneration;
+    int fNumPoints;
+    int fPositions[MAX_ARRAY_SIZE];
+    THistorySample fMax[MAX_ARRAY_SIZE];
+  };
+
+  /**
+   * @param iRecordResolution number of full resolution entries represented by a record
+   */
+  explicit DiskHistory(int iRecordResolution);
+
+  // Destructor
+  ~DiskHistory();
+
+  // getRecordResolution
+  inline int getRecordResolution() const { return fRecordResolution; }
+
+  //------------------------------------------------------------------------
+  // Audio thread (producer of records and requests, consumer of responses)
+  //------------------------------------------------------------------------
+
+  /**
+   * Queues a record to be written (if the queue is full, the record is dropped)
+   */
+  bool pushRecord(int64 iIndex, TierEntry const &iEntry) { return fRecords.push({iIndex, iEntry}); }
+
+  /**
+   * Queues a request (if the queue is full, the request is dropped)
+   */
+  bool postRequest(Request const &iRequest) { return fRequests.push(iRequest); }
+
+  /**
+   * @return true if a response was available (copied into oResponse)
+   */
+  bool pollResponse(Response &oResponse) { return fResponses.pop(oResponse); }
+
+  //------------------------------------------------------------------------
+  // Disk history thread (consumer of records and requests, producer of responses)
+  //------------------------------------------------------------------------
+
+  /**
+   * Writes the queued records and serves the queued requests
+   */
+  void process();
+
+private:
+  void write(Record const &iRecord);
+  void serve(Request const &iRequest);
+
+  // the file grows by this many records at a time (1h of 5s records)
+  static constexpr int64 FILE_GROWTH_IN_RECORDS = 720;
+
+  int const fRecordResolution;
+
+  SPSCQueue<Record> fRecords;
+  SPSCQueue<Request> fRequests;
+  SPSCQueue<Response> fResponses;
+
+  // only accessed by the disk history thread
+  MemoryMappedFile *fFile{nullptr}; // created on the first write
+  int64 fRecordCount{0}; // number of records in the file (including holes)
+  Request fRequest{};
+  Response fResponse{};
+};
+
+/**
+ * The (non realtime) thread which periodically (DISK_HISTORY_THREAD_PERIOD_MS) processes the disk histories of a
+ * plugin instance.
+ */
+class DiskHistoryThread
+{
+public:
+  // Destructor
+  ~DiskHistoryThread() { stop(); }
+
+  /**
+   * Starts the thread (which must not be running). The histories must outlive the thread (see stop).
+   */
+  void start(std::vector<DiskHistory *> const &iHistories);
+
+  /**
+   * Stops the thread (after processing what is left in the queues) and waits for it to finish
+   */
+  void stop();
+
+private:
+  void run();
+
+  std::vector<DiskHistory *> fHistories{};
+  std::thread fThread{};
+  std::atomic<bool> fRunning{false};
+};
+
+}
+}
+}
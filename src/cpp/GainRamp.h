@@ -0,0 +1,265 @@
+#pragma once
+
+#include <pluginterfaces/vst/vsttypes.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "VAC6Constants.h"
+#include "PeakKernel.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+/**
+ * The gain to apply to the samples of a block: either constant (fGains is nullptr) or one value per sample
+ */
+struct BlockGain
+{
+  double fValue; // the gain of every sample when constant
+  TSample const *fGains; // the gain of each sample of the block (nullptr when constant)
+
+  inline bool isConstant() const { return fGains == nullptr; }
+
+  // the gain of the samples starting at iOffset in the block
+  inline BlockGain offset(int iOffset) const { return fGains ? BlockGain{fValue, fGains + iOffset} : *this; }
+};
+
+/**
+ * Sample accurate gain: the target gain changes at exact sample offsets within a block (automation points) and, when
+ * the filter is on, every sample moves toward the target with a one pole filter (time constant
+ * GAIN_FILTER_TIME_CONSTANT_IN_MS) so that the result does not depend on the block size.
+ *
+ * For each block, the changes are added (addTargetValue, in increasing offset order) and then generate computes the
+ * gain of every sample. Outside of a ramp (target reached) the gain is constant which is the fast path.
+ */
+class GainRamp
+{
+public:
+  static constexpr int MAX_TARGET_CHANGES_PER_BLOCK = 64;
+
+  // under this distance to the target (-140dB), the ramp is over (the gain snaps to the target)
+  static constexpr double SNAP_DISTANCE = 1e-7;
+
+  explicit GainRamp(double iValue = 1.0, bool iFilterOn = true) :
+    fValue{iValue},
+    fTargetValue{iValue},
+    fFilterOn{iFilterOn}
+  {}
+
+  /**
+   * Computes the filter coefficient for the sample rate and allocates the gains for blocks of (at most)
+   * iMaxNumSamples samples (not realtime safe)
+   */
+  void setup(double iSampleRate, int iMaxNumSamples)
+  {
+    // each sample moves by 1 - fFactor of the distance to the target
+    fFactor = std::exp(-1000.0 / (GAIN_FILTER_TIME_CONSTANT_IN_MS * iSampleRate));
+    fGains.resize(static_cast<size_t>(std::max(iMaxNumSamples, 0)));
+  }
+
+  // getValue (gain of the last sample generated)
+  inline double getValue() const { return fValue; }
+
+  // getTargetValue
+  inline double getTargetValue() const { return fTargetValue; }
+
+  // setFilterOn (when off the gain jumps to the target)
+  inline void setFilterOn(bool iFilterOn) { fFilterOn = iFilterOn; }
+
+  // setTargetValue (from the start of the next generated block)
+  inline void setTargetValue(double iTargetValue) { addTargetValue(0, iTargetValue); }
+
+  /**
+   * The gain moves toward iTargetValue from the sample iSampleOffset of the next generated block
+   */
+  void addTargetValue(int iSampleOffset, double iTargetValue)
+  {
+    // same target => nothing changes
+    if(iTargetValue == (fNumChanges > 0 ? fChanges[fNumChanges - 1].fTargetValue : fTargetValue))
+      return;
+
+    // keeps the most recent change when there are too many (should not happen)
+    if(fNumChanges == MAX_TARGET_CHANGES_PER_BLOCK)
+      fNumChanges--;
+
+    fChanges[fNumChanges++] = {std::max(iSampleOffset, 0), iTargetValue};
+  }
+
+  /**
+   * Computes the gain of the iNumSamples samples of the block (realtime safe)
+   *
+   * @return the gain for the block which remains valid until the next call
+   */
+  BlockGain generate(int iNumSamples);
+
+  /**
+   * Fills oGains with the ramp iTarget + iDistance * iFactor^(i + 1) (i being the index of the sample)
+   */
+  static void ramp(TSample *oGains, int iNumSamples, double iTarget, double iDistance, double iFactor);
+
+  // Reference (non vectorized) implementation of ramp
+  static void scalarRamp(TSample *oGains, int iNumSamples, double iTarget, double iDistance, double iFactor);
+
+private:
+  // generates the gain of iNumSamples samples moving toward fTargetValue
+  void generateSegment(TSample *oGains, int iNumSamples);
+
+  struct TargetChange
+  {
+    int fSampleOffset;
+    double fTargetValue;
+  };
+
+  double fValue;
+  double fTargetValue;
+  bool fFilterOn;
+  double fFactor{0};
+
+  TargetChange fChanges[MAX_TARGET_CHANGES_PER_BLOCK]{};
+  int fNumChanges{0};
+
+  std::vector<TSample> fGains{};
+};
+
+///////////////////////////////////////////
+// GainRamp::generate
+///////////////////////////////////////////
+inline BlockGain GainRamp::generate(int iNumSamples)
+{
+  int numChanges = fNumChanges;
+  fNumChanges = 0;
+
+  // fast path: target reached and no change
+  if(numChanges == 0 && fValue == fTargetValue)
+    return {fValue, nullptr};
+
+  // the changes all happen at the start of the block and there is no filter => constant
+  // (also used when the block is bigger than announced by the host)
+  if((!fFilterOn && numChanges > 0 && fChanges[numChanges - 1].fSampleOffset == 0) ||
+     iNumSamples > static_cast<int>(fGains.size()))
+  {
+    if(numChanges > 0)
+      fTargetValue = fChanges[numChanges - 1].fTargetValue;
+    fValue = fTargetValue;
+    return {fValue, nullptr};
+  }
+
+  auto gains = fGains.data();
+
+  int i = 0;
+  int k = 0;
+  while(i < iNumSamples)
+  {
+    // the changes which apply from this sample
+    while(k < numChanges && fChanges[k].fSampleOffset <= i)
+      fTargetValue = fChanges[k++].fTargetValue;
+
+    // a segment stops at the next change
+    int end = k < numChanges ? std::min(fChanges[k].fSampleOffset, iNumSamples) : iNumSamples;
+
+    generateSegment(gains + i, end - i);
+
+    i = end;
+  }
+
+  // changes past the end of the block (should not happen)
+  if(k < numChanges)
+    fTargetValue = fChanges[numChanges - 1].fTargetValue;
+
+  return {fValue, gains};
+}
+
+///////////////////////////////////////////
+// GainRamp::generateSegment
+///////////////////////////////////////////
+inline void GainRamp::generateSegment(TSample *oGains, int iNumSamples)
+{
+  double distance = fValue - fTargetValue;
+
+  if(!fFilterOn || std::fabs(distance) < SNAP_DISTANCE)
+  {
+    std::fill(oGains, oGains + iNumSamples, fTargetValue);
+    fValue = fTargetValue;
+    return;
+  }
+
+  // the number of samples before the ramp is within SNAP_DISTANCE of the target
+  double rampSize = std::ceil(std::log(SNAP_DISTANCE / std::fabs(distance)) / std::log(fFactor));
+  int numRampSamples = rampSize < iNumSamples ? static_cast<int>(rampSize) : iNumSamples;
+
+  ramp(oGains, numRampSamples, fTargetValue, distance, fFactor);
+
+  if(numRampSamples < iNumSamples)
+  {
+    std::fill(oGains + numRampSamples, oGains + iNumSamples, fTargetValue);
+    fValue = fTargetValue;
+  }
+  else
+  {
+    if(numRampSamples > 0)
+      fValue = oGains[numRampSamples - 1];
+  }
+}
+
+///////////////////////////////////////////
+// GainRamp::scalarRamp
+///////////////////////////////////////////
+inline void GainRamp::scalarRamp(TSample *oGains, int iNumSamples, double iTarget, double iDistance, double iFactor)
+{
+  double power = iFactor;
+  for(int i = 0; i < iNumSamples; i++)
+  {
+    oGains[i] = iTarget + iDistance * power;
+    power *= iFactor;
+  }
+}
+
+#if VAC6_PEAK_KERNEL_SSE2
+
+///////////////////////////////////////////
+// GainRamp::ramp (SSE2)
+///////////////////////////////////////////
+/**
+ * The 2 lanes compute 2 consecutive samples (the powers of the factor move forward by 2 at each step). The powers
+ * are computed by repeated multiplications (like scalarRamp) but in a different order so the results may differ in
+ * the last bits.
+ */
+inline void GainRamp::ramp(TSample *oGains, int iNumSamples, double iTarget, double iDistance, double iFactor)
+{
+  auto const target = _mm_set1_pd(iTarget);
+  auto const distance = _mm_set1_pd(iDistance);
+  auto const step = _mm_set1_pd(iFactor * iFactor);
+
+  // _mm_set_pd takes the high lane first
+  auto powers = _mm_set_pd(iFactor * iFactor, iFactor);
+
+  int i = 0;
+  for(; i + 2 <= iNumSamples; i += 2)
+  {
+    _mm_storeu_pd(oGains + i, _mm_add_pd(target, _mm_mul_pd(distance, powers)));
+    powers = _mm_mul_pd(powers, step);
+  }
+
+  if(i < iNumSamples)
+    oGains[i] = iTarget + iDistance * _mm_cvtsd_f64(powers);
+}
+
+#else
+
+///////////////////////////////////////////
+// GainRamp::ramp (no SIMD)
+///////////////////////////////////////////
+inline void GainRamp::ramp(TSample *oGains, int iNumSamples, double iTarget, double iDistance, double iFactor)
+{
+  scalarRamp(oGains, iNumSamples, iTarget, iDistance, iFactor);
+}
+
+#endif
+
+}
+}
+}
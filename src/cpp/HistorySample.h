@@ -0,0 +1,94 @@
+#pragma once
+
+#include <pluginterfaces/vst/vsttypes.h>
+#include <algorithm>
+#include <cmath>
+
+// with the (optional) compact history, the entries of the history are stored as 16 bits dB codes (see DbCode)
+// instead of floats which halves the memory of every instance
+#ifndef VAC6_COMPACT_HISTORY
+#define VAC6_COMPACT_HISTORY 0
+#endif
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+/**
+ * 16 bits log domain code of a (positive) peak: 0 is silence (anything below MIN_DB) and the codes 1 to MAX_CODE map
+ * linearly to the dB range [MIN_DB, MAX_DB] (~0.003dB per code, far below what the LCD can show).
+ *
+ * The mapping is monotonic so that the max (and any comparison) of the codes is the code of the max: the zoom and
+ * the range max (which only compare entries) work directly on the codes and the codes only need to be decoded for
+ * display.
+ */
+struct DbCode
+{
+  using type = Steinberg::uint16;
+
+  static constexpr double MIN_DB = -144.0; // below 24 bits resolution
+  static constexpr double MAX_DB = 48.0; // max gain (+12dB) applied to a very hot (+36dB) signal
+  static constexpr int MAX_CODE = 65535;
+  static constexpr double DB_PER_CODE = (MAX_DB - MIN_DB) / (MAX_CODE - 1);
+
+  // encode
+  static inline type encode(double iSample)
+  {
+    // also handles NaN
+    if(!(iSample > 0))
+      return 0;
+
+    double db = 20.0 * std::log10(iSample);
+    if(db < MIN_DB)
+      return 0;
+
+    db = std::min(db, MAX_DB);
+
+    return static_cast<type>(1 + std::lround((db - MIN_DB) / DB_PER_CODE));
+  }
+
+  // decode
+  static inline double decode(type iCode)
+  {
+    if(iCode == 0)
+      return 0;
+
+    return std::pow(10.0, (MIN_DB + (iCode - 1) * DB_PER_CODE) / 20.0);
+  }
+};
+
+#if VAC6_COMPACT_HISTORY
+
+using THistorySample = DbCode::type;
+
+// toHistorySample (encodes a peak for the history)
+inline THistorySample toHistorySample(double iSample) { return DbCode::encode(iSample); }
+
+// fromHistorySample (decodes an entry of the history)
+inline double fromHistorySample(THistorySample iEntry) { return DbCode::decode(iEntry); }
+
+#else
+
+// the history (and zoomed buffers) only contain peaks for which float precision is enough, whatever sample size the
+// host processes (half the memory and cache footprint of Sample64)
+using THistorySample = Steinberg::Vst::Sample32;
+
+// toHistorySample
+inline THistorySample toHistorySample(double iSample) { return static_cast<THistorySample>(iSample); }
+
+// fromHistorySample
+inline double fromHistorySample(THistorySample iEntry) { return iEntry; }
+
+#endif
+
+/**
+ * Converts the entries of the history into the type used to compute their statistics (see RangeStatsIndex)
+ */
+struct HistorySampleDecoder
+{
+  inline double operator()(THistorySample iEntry) const { return fromHistorySample(iEntry); }
+};
+
+}
+}
+}
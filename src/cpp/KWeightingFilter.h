@@ -0,0 +1,242 @@
+#pragma once
+
+#include <pluginterfaces/vst/vsttypes.h>
+#include <algorithm>
+#include <cmath>
+#include "VAC6Constants.h"
+#include "PeakKernel.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+/**
+ * K-weighting pre-filter as described in ITU-R BS.1770-4 (a high shelf followed by a high pass, both biquads) with
+ * the coefficients computed for the sample rate (the standard only lists them for 48kHz).
+ *
+ * Both channels (left and right) are filtered together (one per SSE2 lane) since loudness is a measure of all the
+ * channels combined. The filter keeps its state between calls so it must be fed with consecutive samples.
+ */
+class KWeightingFilter
+{
+public:
+  static constexpr int NUM_STAGES = 2;
+
+  // Constructor
+  explicit KWeightingFilter(double iSampleRate) { setSampleRate(iSampleRate); }
+
+  // setSampleRate (computes the coefficients and resets the filter)
+  void setSampleRate(double iSampleRate);
+
+  // reset (forgets the previous samples)
+  inline void reset() { std::fill(&fState[0][0][0], &fState[0][0][0] + NUM_STAGES * 2 * 2, 0); }
+
+  /**
+   * Filters iNumSamples samples of each channel (multiplied by iGain in TSample precision, like PeakKernel) and
+   * returns the sum of the squares of the filtered samples (both channels combined)
+   *
+   * @param iLeft the left channel samples (nullptr means silence)
+   * @param iRight the right channel samples (nullptr means silence or mono)
+   */
+  template<typename SampleType>
+  TSample process(SampleType const *iLeft, SampleType const *iRight, int iNumSamples, double iGain);
+
+  // Reference (non vectorized) implementation of process
+  template<typename SampleType>
+  TSample scalarProcess(SampleType const *iLeft, SampleType const *iRight, int iNumSamples, double iGain);
+
+private:
+  // flushes the state to 0 when it decays into denormals (silence)
+  void flushDenormals();
+
+  // isReset (the state is all 0 so silence in means silence out)
+  inline bool isReset() const
+  {
+    return std::all_of(&fState[0][0][0], &fState[0][0][0] + NUM_STAGES * 2 * 2, [](double v) { return v == 0; });
+  }
+
+  struct Biquad
+  {
+    double fB0, fB1, fB2, fA1, fA2;
+  };
+
+  Biquad fStages[NUM_STAGES]{};
+
+  // [stage][z1/z2][left/right] (transposed direct form II)
+  alignas(16) double fState[NUM_STAGES][2][2]{};
+};
+
+///////////////////////////////////////////
+// KWeightingFilter::setSampleRate
+///////////////////////////////////////////
+inline void KWeightingFilter::setSampleRate(double iSampleRate)
+{
+  constexpr double PI = 3.14159265358979323846;
+
+  // stage 1: high shelf (head effects)
+  {
+    constexpr double f0 = 1681.974450955533;
+    constexpr double G = 3.999843853973347;
+    constexpr double Q = 0.7071752369554196;
+
+    double K = std::tan(PI * f0 / iSampleRate);
+    double Vh = std::pow(10.0, G / 20.0);
+    double Vb = std::pow(Vh, 0.4996667741545416);
+    double a0 = 1.0 + K / Q + K * K;
+
+    fStages[0].fB0 = (Vh + Vb * K / Q + K * K) / a0;
+    fStages[0].fB1 = 2.0 * (K * K - Vh) / a0;
+    fStages[0].fB2 = (Vh - Vb * K / Q + K * K) / a0;
+    fStages[0].fA1 = 2.0 * (K * K - 1.0) / a0;
+    fStages[0].fA2 = (1.0 - K / Q + K * K) / a0;
+  }
+
+  // stage 2: high pass (RLB weighting)
+  {
+    constexpr double f0 = 38.13547087602444;
+    constexpr double Q = 0.5003270373238773;
+
+    double K = std::tan(PI * f0 / iSampleRate);
+    double a0 = 1.0 + K / Q + K * K;
+
+    fStages[1].fB0 = 1.0;
+    fStages[1].fB1 = -2.0;
+    fStages[1].fB2 = 1.0;
+    fStages[1].fA1 = 2.0 * (K * K - 1.0) / a0;
+    fStages[1].fA2 = (1.0 - K / Q + K * K) / a0;
+  }
+
+  reset();
+}
+
+///////////////////////////////////////////
+// KWeightingFilter::flushDenormals
+///////////////////////////////////////////
+inline void KWeightingFilter::flushDenormals()
+{
+  for(auto &s: fState)
+    for(auto &z: s)
+      for(auto &v: z)
+        if(std::abs(v) < 1e-30)
+          v = 0;
+}
+
+///////////////////////////////////////////
+// KWeightingFilter::scalarProcess
+///////////////////////////////////////////
+template<typename SampleType>
+TSample KWeightingFilter::scalarProcess(SampleType const *iLeft, SampleType const *iRight, int iNumSamples, double iGain)
+{
+  TSample sumOfSquares[2] = {0, 0};
+
+  for(int i = 0; i < iNumSamples; i++)
+  {
+    TSample x[2] = {iLeft ? static_cast<TSample>(iLeft[i]) * iGain : 0,
+                    iRight ? static_cast<TSample>(iRight[i]) * iGain : 0};
+
+    for(int c = 0; c < 2; c++)
+    {
+      TSample y = x[c];
+      for(int s = 0; s < NUM_STAGES; s++)
+      {
+        auto const &b = fStages[s];
+        auto &z1 = fState[s][0][c];
+        auto &z2 = fState[s][1][c];
+        TSample in = y;
+        y = b.fB0 * in + z1;
+        z1 = (b.fB1 * in - b.fA1 * y) + z2;
+        z2 = b.fB2 * in - b.fA2 * y;
+      }
+      sumOfSquares[c] += y * y;
+    }
+  }
+
+  flushDenormals();
+
+  return sumOfSquares[0] + sumOfSquares[1];
+}
+
+#if VAC6_PEAK_KERNEL_SSE2
+
+///////////////////////////////////////////
+// KWeightingFilter::process (SSE2)
+///////////////////////////////////////////
+/**
+ * The recursion prevents vectorizing over time so the 2 channels are processed in parallel instead (lane 0 is left,
+ * lane 1 is right) with the state kept in registers for the whole block. The operations are the same (and in the
+ * same order) as the scalar implementation.
+ */
+template<typename SampleType>
+TSample KWeightingFilter::process(SampleType const *iLeft, SampleType const *iRight, int iNumSamples, double iGain)
+{
+  // silence after silence => nothing to compute
+  if(!iLeft && !iRight && isReset())
+    return 0;
+
+  __m128d b0[NUM_STAGES], b1[NUM_STAGES], b2[NUM_STAGES], a1[NUM_STAGES], a2[NUM_STAGES];
+  __m128d z1[NUM_STAGES], z2[NUM_STAGES];
+
+  for(int s = 0; s < NUM_STAGES; s++)
+  {
+    b0[s] = _mm_set1_pd(fStages[s].fB0);
+    b1[s] = _mm_set1_pd(fStages[s].fB1);
+    b2[s] = _mm_set1_pd(fStages[s].fB2);
+    a1[s] = _mm_set1_pd(fStages[s].fA1);
+    a2[s] = _mm_set1_pd(fStages[s].fA2);
+    z1[s] = _mm_load_pd(fState[s][0]);
+    z2[s] = _mm_load_pd(fState[s][1]);
+  }
+
+  auto sumOfSquares = _mm_setzero_pd();
+
+  for(int i = 0; i < iNumSamples; i++)
+  {
+    // _mm_set_pd takes the high lane first
+    auto y = _mm_set_pd(iRight ? static_cast<TSample>(iRight[i]) * iGain : 0,
+                        iLeft ? static_cast<TSample>(iLeft[i]) * iGain : 0);
+
+    for(int s = 0; s < NUM_STAGES; s++)
+    {
+      auto in = y;
+      y = _mm_add_pd(_mm_mul_pd(b0[s], in), z1[s]);
+      z1[s] = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(b1[s], in), _mm_mul_pd(a1[s], y)), z2[s]);
+      z2[s] = _mm_sub_pd(_mm_mul_pd(b2[s], in), _mm_mul_pd(a2[s], y));
+    }
+
+    sumOfSquares = _mm_add_pd(sumOfSquares, _mm_mul_pd(y, y));
+  }
+
+  for(int s = 0; s < NUM_STAGES; s++)
+  {
+    _mm_store_pd(fState[s][0], z1[s]);
+    _mm_store_pd(fState[s][1], z2[s]);
+  }
+
+  flushDenormals();
+
+  return _mm_cvtsd_f64(_mm_add_sd(sumOfSquares, _mm_unpackhi_pd(sumOfSquares, sumOfSquares)));
+}
+
+#else
+
+///////////////////////////////////////////
+// KWeightingFilter::process (no SIMD)
+///////////////////////////////////////////
+template<typename SampleType>
+TSample KWeightingFilter::process(SampleType const *iLeft, SampleType const *iRight, int iNumSamples, double iGain)
+{
+  // silence after silence => nothing to compute
+  if(!iLeft && !iRight && isReset())
+    return 0;
+
+  return scalarProcess(iLeft, iRight, iNumSamples, iGain);
+}
+
+#endif
+
+}
+}
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "VAC6Constants.h"
+#include "PixelBuffer.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+using VST::Common::PixelBuffer;
+
+/**
+ * Computes, for each column of the LCD, where the (vertical) line representing the max of the channels starts (its
+ * top, the line always ending at the bottom of the LCD) and in which band (ok, soft clipping or hard clipping) it
+ * falls so that the LCD can draw all the columns of the same band at once (one path per band instead of one line per
+ * column).
+ *
+ * The position is the same as toDisplayValue (dB scale from iMinSample at the bottom to 0dB at the top) but is
+ * computed in a tight loop without calling log10 for each column:
+ * - with the compact history the entries are linear in dB (see DbCode) so no conversion is needed at all
+ * - otherwise the dB value is computed with a fast log2 approximation (error ~0.0001dB, far below a pixel)
+ *
+ * The bands are decided without any approximation (the entries are compared to the levels directly) so that, for
+ * example, a sample at exactly 0dB is never shown as hard clipping.
+ *
+ * The columns can also be rasterized directly in memory (see rasterize) which, combined with computeShift, lets the
+ * LCD keep them in an offscreen bitmap and only draw the new ones when the graph scrolls.
+ */
+template<int NumColumns>
+class LCDColumns
+{
+public:
+  enum Band
+  {
+    kNotDrawn = -1,
+    kOk = 0,
+    kSoftClipping,
+    kHardClipping,
+    kNumBands
+  };
+
+  /**
+   * @param iSilentThreshold the columns below this level are not drawn
+   * @param iMinSample the level at the bottom of the LCD (the columns between iSilentThreshold and iMinSample are
+   *                   drawn as a single pixel)
+   * @param iHardClippingLevel the columns above this level are in the kHardClipping band
+   */
+  LCDColumns(double iSilentThreshold, double iMinSample, double iHardClippingLevel) :
+    fSilentLevel{toLevel(iSilentThreshold)},
+    fMinLevel{toLevel(iMinSample)},
+    fMinDb{20.0 * std::log10(iMinSample)},
+    fHardClippingLevel{toLevel(iHardClippingLevel)}
+  {}
+
+  /**
+   * Computes the columns (see getTop / getColumns)
+   *
+   * @param iSamples the NumColumns entries to display (as stored in the history, see THistorySample)
+   * @param iHeight the height of the LCD
+   * @param iSoftClippingLevel the columns above this level (and below the hard clipping level) are in the
+   *                           kSoftClipping band
+   */
+  void compute(THistorySample const *iSamples, double iHeight, double iSoftClippingLevel)
+  {
+    auto const softClippingLevel = toLevel(iSoftClippingLevel);
+    auto const scale = -iHeight / fMinDb;
+
+    fHeight = iHeight;
+
+    std::fill(fNumColumns, fNumColumns + kNumBands, 0);
+
+    for(int i = 0; i < NumColumns; i++)
+    {
+      auto level = toEntryLevel(iSamples[i]);
+
+      if(level < fSilentLevel)
+      {
+        fTops[i] = iHeight;
+        fBands[i] = kNotDrawn;
+        continue;
+      }
+
+      // a single pixel for min sample to silent
+      double displayValue = level < fMinLevel ? 1.0 : iHeight + levelToDb(level) * scale;
+      fTops[i] = std::min(std::max(iHeight - displayValue, -0.5), iHeight);
+
+      auto band = level > fHardClippingLevel ? kHardClipping : level > softClippingLevel ? kSoftClipping : kOk;
+      fBands[i] = band;
+      fColumns[band][fNumColumns[band]++] = i;
+    }
+  }
+
+  /**
+   * Draws the columns [iFromColumn, NumColumns) in the buffer (iPixelsPerColumn pixels wide each, the height of the
+   * buffer being the height of the LCD): the pixels of a column are set to the pixel of its band from its (rounded)
+   * top to the bottom and to 0 (transparent) above.
+   */
+  void rasterize(PixelBuffer &oBuffer,
+                 int iFromColumn,
+                 int iPixelsPerColumn,
+                 PixelBuffer::Pixel const (&iBandPixels)[kNumBands]) const
+  {
+    auto const height = oBuffer.getHeight();
+    auto const yScale = fHeight > 0 ? height / fHeight : 0;
+
+    for(int i = std::max(iFromColumn, 0); i < NumColumns; i++)
+    {
+      auto left = i * iPixelsPerColumn;
+      auto right = left + iPixelsPerColumn;
+
+      int top = height;
+      if(fBands[i] != kNotDrawn)
+      {
+        top = std::min(std::max(static_cast<int>(std::lround(fTops[i] * yScale)), 0), height);
+        oBuffer.fillRect(left, top, right, height, iBandPixels[fBands[i]]);
+      }
+      oBuffer.fillRect(left, 0, right, top, 0);
+    }
+  }
+
+  /**
+   * Compares the entries of 2 consecutive frames.
+   *
+   * @return by how many columns iPrevious must be moved to the left to be the beginning of iCurrent (0 when they are
+   *         the same), looking at no more than iMaxShift columns, -1 if none (zoom, scroll, pause...)
+   */
+  static int computeShift(THistorySample const *iPrevious, THistorySample const *iCurrent, int iMaxShift)
+  {
+    for(int shift = 0; shift <= std::min(iMaxShift, NumColumns - 1); shift++)
+    {
+      if(std::equal(iCurrent, iCurrent + NumColumns - shift, iPrevious + shift))
+        return shift;
+    }
+    return -1;
+  }
+
+  // getTop (iHeight when the column is not drawn)
+  inline double getTop(int iColumn) const { return fTops[iColumn]; }
+
+  // getBand (kNotDrawn when the column is not drawn)
+  inline Band getBand(int iColumn) const { return fBands[iColumn]; }
+
+  // getNumColumns (in the band)
+  inline int getNumColumns(Band iBand) const { return fNumColumns[iBand]; }
+
+  // getColumns (the indices of the columns of the band in increasing order)
+  inline int const *getColumns(Band iBand) const { return fColumns[iBand]; }
+
+#if VAC6_COMPACT_HISTORY
+  // the codes are linear in dB => the levels are dB values (exact)
+  using Level = double;
+
+  static inline Level toLevel(double iSample)
+  {
+    return iSample > 0 ? 20.0 * std::log10(iSample) : -std::numeric_limits<double>::infinity();
+  }
+
+  static inline Level toEntryLevel(THistorySample iEntry)
+  {
+    return iEntry == 0 ?
+           -std::numeric_limits<double>::infinity() :
+           Common::DbCode::MIN_DB + (iEntry - 1) * Common::DbCode::DB_PER_CODE;
+  }
+
+  static inline double levelToDb(Level iLevel) { return iLevel; }
+#else
+  // the levels are the entries themselves (floats)
+  using Level = THistorySample;
+
+  static inline Level toLevel(double iSample) { return static_cast<Level>(iSample); }
+
+  static inline Level toEntryLevel(THistorySample iEntry) { return iEntry; }
+
+  static inline double levelToDb(Level iLevel) { return 6.020599913279624 * fastLog2(iLevel); }
+#endif
+
+  /**
+   * Approximation of log2 for positive normal floats: exponent + log2 of the mantissa m (in [1, 2)) computed with the
+   * first 4 terms of the series ln(m) = 2 * (z + z^3/3 + z^5/5 + z^7/7 + ...) where z = (m - 1) / (m + 1) is in
+   * [0, 1/3) (max error ~2e-5, which is ~0.0001dB, and exact for powers of 2)
+   */
+  static inline float fastLog2(float iValue)
+  {
+    uint32_t bits;
+    std::memcpy(&bits, &iValue, sizeof(bits));
+    auto exponent = static_cast<float>(static_cast<int>((bits >> 23) & 0xff) - 127);
+
+    // mantissa in [1, 2)
+    bits = (bits & 0x007fffff) | 0x3f800000;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+
+    float z = (m - 1.0f) / (m + 1.0f);
+    float z2 = z * z;
+
+    // 2 / ln(2) = 2.8853900817779268
+    return exponent + 2.8853900817779268f * z * (1.0f + z2 * (1.0f / 3.0f + z2 * (1.0f / 5.0f + z2 * (1.0f / 7.0f))));
+  }
+
+private:
+  Level const fSilentLevel;
+  Level const fMinLevel;
+  double const fMinDb;
+  Level const fHardClippingLevel;
+
+  double fHeight{0};
+  double fTops[NumColumns]{};
+  Band fBands[NumColumns]{};
+  int fColumns[kNumBands][NumColumns]{};
+  int fNumColumns[kNumBands]{};
+};
+
+}
+}
+}
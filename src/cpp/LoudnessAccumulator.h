@@ -0,0 +1,146 @@
+#pragma once
+
+#include <pluginterfaces/vst/vsttypes.h>
+#include <pongasoft/logging/loguru.hpp>
+#include <algorithm>
+#include <cmath>
+#include "VAC6Constants.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+/**
+ * Accumulates the sum of the squares of the (K-weighted, see KWeightingFilter) samples in blocks of
+ * LOUDNESS_BLOCK_SIZE_IN_MS and maintains the momentary (last 4 blocks = 400ms) and short-term (last 30 blocks = 3s)
+ * loudness as defined in ITU-R BS.1770-4 / EBU R128.
+ *
+ * The sums over the windows are running sums (the completed block is added and the one leaving the window is
+ * subtracted) so that completing a block costs the same no matter the size of the window.
+ *
+ * The loudness is expressed as a sample value (loudness in LUFS = sampleToDb(value)) so that it can be stored and
+ * displayed like the peak levels. A loudness below the absolute gate (-70 LUFS) is 0 (silence).
+ */
+class LoudnessAccumulator
+{
+public:
+  static constexpr int MOMENTARY_BLOCK_COUNT = 4;
+  static constexpr int SHORT_TERM_BLOCK_COUNT = 30;
+
+  // 10^(-0.691/20) => the -0.691 offset of the loudness formula in the sample domain
+  static constexpr TSample LOUDNESS_OFFSET = 0.9235278572249818;
+
+  // 10^(-70/20) => -70 LUFS
+  static constexpr TSample ABSOLUTE_GATE = 0.00031622776601683794;
+
+  // Constructor
+  explicit LoudnessAccumulator(uint32 iBlockSize) : fBlockSize{iBlockSize} { reset(); }
+
+  // reset
+  void reset()
+  {
+    std::fill(fBlockSums, fBlockSums + SHORT_TERM_BLOCK_COUNT, 0);
+    fBlockIndex = 0;
+    fAccumulatedSum = 0;
+    fAccumulatedSamples = 0;
+    fMomentarySum = 0;
+    fShortTermSum = 0;
+    fMomentaryLoudness = 0;
+    fShortTermLoudness = 0;
+  }
+
+  /**
+   * @return how many samples can be accumulated before the current block is complete, capped to iMaxNumSamples
+   */
+  inline uint32 getRemainingSamplesInBlock(uint32 iMaxNumSamples) const
+  {
+    return std::min(fBlockSize - fAccumulatedSamples, iMaxNumSamples);
+  }
+
+  /**
+   * Accumulates a run of iNumSamples samples given the sum of their squares. The run must not cross the block
+   * boundary (see getRemainingSamplesInBlock).
+   *
+   * @return true when the block is complete (in which case the loudness values have been updated)
+   */
+  bool accumulate(TSample iSumOfSquares, uint32 iNumSamples)
+  {
+    DCHECK_F(fAccumulatedSamples + iNumSamples <= fBlockSize);
+
+    fAccumulatedSum += iSumOfSquares;
+    fAccumulatedSamples += iNumSamples;
+
+    if(fAccumulatedSamples < fBlockSize)
+      return false;
+
+    // the block leaving the momentary window is still in the short term window
+    auto momentaryIndex = (fBlockIndex + SHORT_TERM_BLOCK_COUNT - MOMENTARY_BLOCK_COUNT) % SHORT_TERM_BLOCK_COUNT;
+    fMomentarySum += fAccumulatedSum - fBlockSums[momentaryIndex];
+    fShortTermSum += fAccumulatedSum - fBlockSums[fBlockIndex];
+
+    fBlockSums[fBlockIndex] = fAccumulatedSum;
+    fBlockIndex = (fBlockIndex + 1) % SHORT_TERM_BLOCK_COUNT;
+
+    // once in a while (every 3s) the running sums are recomputed to get rid of the rounding errors
+    if(fBlockIndex == 0)
+      recomputeSums();
+
+    fMomentaryLoudness = computeLoudness(fMomentarySum, MOMENTARY_BLOCK_COUNT);
+    fShortTermLoudness = computeLoudness(fShortTermSum, SHORT_TERM_BLOCK_COUNT);
+
+    fAccumulatedSum = 0;
+    fAccumulatedSamples = 0;
+
+    return true;
+  }
+
+  // getMomentaryLoudness (as a sample value)
+  inline TSample getMomentaryLoudness() const { return fMomentaryLoudness; }
+
+  // getShortTermLoudness (as a sample value)
+  inline TSample getShortTermLoudness() const { return fShortTermLoudness; }
+
+private:
+  void recomputeSums()
+  {
+    fMomentarySum = 0;
+    fShortTermSum = 0;
+    for(int i = 0; i < SHORT_TERM_BLOCK_COUNT; i++)
+    {
+      // fBlockIndex is the oldest block
+      auto sum = fBlockSums[(fBlockIndex + i) % SHORT_TERM_BLOCK_COUNT];
+      if(i >= SHORT_TERM_BLOCK_COUNT - MOMENTARY_BLOCK_COUNT)
+        fMomentarySum += sum;
+      fShortTermSum += sum;
+    }
+  }
+
+  inline TSample computeLoudness(TSample iSum, int iBlockCount) const
+  {
+    auto meanSquare = std::max<TSample>(iSum, 0) / (static_cast<TSample>(fBlockSize) * iBlockCount);
+    auto loudness = std::sqrt(meanSquare) * LOUDNESS_OFFSET;
+    return loudness < ABSOLUTE_GATE ? 0 : loudness;
+  }
+
+private:
+  uint32 fBlockSize;
+
+  TSample fBlockSums[SHORT_TERM_BLOCK_COUNT]{};
+  int fBlockIndex{0}; // where the next completed block goes (= oldest block)
+
+  TSample fAccumulatedSum{0};
+  uint32 fAccumulatedSamples{0};
+
+  TSample fMomentarySum{0};
+  TSample fShortTermSum{0};
+
+  TSample fMomentaryLoudness{0};
+  TSample fShortTermLoudness{0};
+};
+
+}
+}
+}
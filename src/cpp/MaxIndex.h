@@ -0,0 +1,48 @@
+#pragma once
+
+#include "RangeIndex.h"
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+/**
+ * Aggregator for RangeIndex which computes the max. Note that the values are expected to be positive (which is the
+ * case for the history of max values).
+ */
+template<typename T>
+struct MaxAggregator
+{
+  using value_type = T;
+
+  inline T fromEntry(T iEntry) const { return iEntry; }
+  inline T combine(T iLeft, T iRight) const { return std::max(iLeft, iRight); }
+  inline T identity() const { return 0; }
+};
+
+/**
+ * Hierarchical max (max pyramid) maintained alongside a circular buffer so that the max over any range of the buffer
+ * can be computed in O(log n) instead of O(n) (see RangeIndex).
+ */
+template<typename T>
+class MaxIndex : public RangeIndex<T, MaxAggregator<T>>
+{
+public:
+  // Constructor
+  explicit MaxIndex(int iBufferSize) : RangeIndex<T, MaxAggregator<T>>(iBufferSize) {}
+
+  /**
+   * Computes the max of the entries in the buffer for the range [iFromOffset, iToOffset[ using the same negative
+   * offsets as CircularBuffer (-1 being the most recent entry).
+   *
+   * @return the max (or 0 when the range is empty)
+   */
+  inline T getMax(CircularBuffer<T> const &iBuffer, int iFromOffset, int iToOffset) const
+  {
+    return this->getAggregate(iBuffer, iFromOffset, iToOffset);
+  }
+};
+
+}
+}
+}
@@ -0,0 +1,215 @@
+#include "MemoryMappedFile.h"
+#include <pongasoft/logging/loguru.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+////////////////////////////////////////////////////////////
+// MemoryMappedFile::createTemporaryPath
+////////////////////////////////////////////////////////////
+std::string MemoryMappedFile::createTemporaryPath(std::string const &iPrefix, std::string const &iExtension)
+{
+  static std::atomic<int> counter{0};
+
+  std::ostringstream s;
+
+#ifdef _WIN32
+  char folder[MAX_PATH + 1];
+  auto len = GetTempPathA(MAX_PATH + 1, folder);
+  s << std::string(folder, len) << iPrefix << "-" << GetCurrentProcessId();
+#else
+  auto folder = std::getenv("TMPDIR");
+  s << (folder ? folder : "/tmp") << "/" << iPrefix << "-" << getpid();
+#endif
+
+  s << "-" << std::chrono::steady_clock::now().time_since_epoch().count() << "-" << counter++ << iExtension;
+
+  return s.str();
+}
+
+#ifdef _WIN32
+
+////////////////////////////////////////////////////////////
+// MemoryMappedFile::MemoryMappedFile (Windows)
+////////////////////////////////////////////////////////////
+MemoryMappedFile::MemoryMappedFile(std::string const &iPath)
+{
+  auto file = CreateFileA(iPath.c_str(),
+                          GENERIC_READ | GENERIC_WRITE,
+                          0,
+                          nullptr,
+                          CREATE_ALWAYS,
+                          FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE,
+                          nullptr);
+
+  if(file == INVALID_HANDLE_VALUE)
+  {
+    LOG_F(ERROR, "MemoryMappedFile: cannot create %s", iPath.c_str());
+    return;
+  }
+
+  fFile = file;
+  fIsOpen = true;
+}
+
+////////////////////////////////////////////////////////////
+// MemoryMappedFile::resize (Windows)
+////////////////////////////////////////////////////////////
+bool MemoryMappedFile::resize(size_t iSize)
+{
+  if(!fIsOpen)
+    return false;
+
+  unmap();
+
+  if(iSize > 0)
+  {
+    // the file grows (with 0s) to the size of the mapping
+    auto size = static_cast<ULONGLONG>(iSize);
+    fMapping = CreateFileMappingA(fFile, nullptr, PAGE_READWRITE,
+                                  static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFF),
+                                  nullptr);
+    if(fMapping)
+      fData = static_cast<char *>(MapViewOfFile(fMapping, FILE_MAP_ALL_ACCESS, 0, 0, iSize));
+
+    if(!fData)
+    {
+      LOG_F(ERROR, "MemoryMappedFile: cannot map %zu bytes", iSize);
+      close();
+      return false;
+    }
+  }
+
+  fSize = iSize;
+  return true;
+}
+
+////////////////////////////////////////////////////////////
+// MemoryMappedFile::unmap (Windows)
+////////////////////////////////////////////////////////////
+void MemoryMappedFile::unmap()
+{
+  if(fData)
+    UnmapViewOfFile(fData);
+  if(fMapping)
+    CloseHandle(fMapping);
+  fData = nullptr;
+  fMapping = nullptr;
+  fSize = 0;
+}
+
+////////////////////////////////////////////////////////////
+// MemoryMappedFile::close (Windows)
+////////////////////////////////////////////////////////////
+void MemoryMappedFile::close()
+{
+  unmap();
+  if(fFile)
+    CloseHandle(fFile); // FILE_FLAG_DELETE_ON_CLOSE => deletes the file
+  fFile = nullptr;
+  fIsOpen = false;
+}
+
+#else
+
+////////////////////////////////////////////////////////////
+// MemoryMappedFile::MemoryMappedFile (macOS / Linux)
+////////////////////////////////////////////////////////////
+MemoryMappedFile::MemoryMappedFile(std::string const &iPath)
+{
+  fFile = ::open(iPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+
+  if(fFile == -1)
+  {
+    LOG_F(ERROR, "MemoryMappedFile: cannot create %s", iPath.c_str());
+    return;
+  }
+
+  // the file remains accessible (through fFile) until it is closed
+  ::unlink(iPath.c_str());
+
+  fIsOpen = true;
+}
+
+////////////////////////////////////////////////////////////
+// MemoryMappedFile::resize (macOS / Linux)
+////////////////////////////////////////////////////////////
+bool MemoryMappedFile::resize(size_t iSize)
+{
+  if(!fIsOpen)
+    return false;
+
+  unmap();
+
+  if(::ftruncate(fFile, static_cast<off_t>(iSize)) != 0)
+  {
+    LOG_F(ERROR, "MemoryMappedFile: cannot resize to %zu bytes", iSize);
+    close();
+    return false;
+  }
+
+  if(iSize > 0)
+  {
+    auto data = ::mmap(nullptr, iSize, PROT_READ | PROT_WRITE, MAP_SHARED, fFile, 0);
+    if(data == MAP_FAILED)
+    {
+      LOG_F(ERROR, "MemoryMappedFile: cannot map %zu bytes", iSize);
+      close();
+      return false;
+    }
+    fData = static_cast<char *>(data);
+  }
+
+  fSize = iSize;
+  return true;
+}
+
+////////////////////////////////////////////////////////////
+// MemoryMappedFile::unmap (macOS / Linux)
+////////////////////////////////////////////////////////////
+void MemoryMappedFile::unmap()
+{
+  if(fData)
+    ::munmap(fData, fSize);
+  fData = nullptr;
+  fSize = 0;
+}
+
+////////////////////////////////////////////////////////////
+// MemoryMappedFile::close (macOS / Linux)
+////////////////////////////////////////////////////////////
+void MemoryMappedFile::close()
+{
+  unmap();
+  if(fFile != -1)
+    ::close(fFile);
+  fFile = -1;
+  fIsOpen = false;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////
+// MemoryMappedFile::~MemoryMappedFile
+////////////////////////////////////////////////////////////
+MemoryMappedFile::~MemoryMappedFile()
+{
+  close();
+}
+
+}
+}
+}
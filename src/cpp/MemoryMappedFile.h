@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+/**
+ * A (temporary) file mapped in memory which can grow. The file is created empty and deleted when the object is
+ * destroyed (on macOS/Linux it is unlinked right away so that nothing is left behind after a crash).
+ *
+ * Creating, resizing and accessing the mapping can block (IO / page faults) so this class must never be used from
+ * the audio thread.
+ */
+class MemoryMappedFile
+{
+public:
+  // Constructor (check isOpen() for errors)
+  explicit MemoryMappedFile(std::string const &iPath);
+
+  // Destructor (unmaps and deletes the file)
+  ~MemoryMappedFile();
+
+  MemoryMappedFile(MemoryMappedFile const&) = delete;
+
+  // isOpen
+  inline bool isOpen() const { return fIsOpen; }
+
+  /**
+   * Grows (or shrinks) the file and remaps it (so any pointer previously returned by getData() is invalidated).
+   * The new bytes are 0.
+   *
+   * @return false if the file could not be resized (in which case the file is closed)
+   */
+  bool resize(size_t iSize);
+
+  // getData (nullptr when the size is 0)
+  inline char *getData() const { return fData; }
+
+  // getSize
+  inline size_t getSize() const { return fSize; }
+
+  /**
+   * @return a path for a new file in the temporary folder of the system (unique for the process) with the given
+   *         prefix and extension
+   */
+  static std::string createTemporaryPath(std::string const &iPrefix, std::string const &iExtension);
+
+private:
+  void unmap();
+  void close();
+
+  bool fIsOpen{false};
+  char *fData{nullptr};
+  size_t fSize{0};
+
+#ifdef _WIN32
+  void *fFile{nullptr};
+  void *fMapping{nullptr};
+#else
+  int fFile{-1};
+#endif
+};
+
+}
+}
+}
@@ -0,0 +1,122 @@
+#include <iomanip>
+#include <sstream>
+#include "Metrics.h"
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+namespace {
+
+// formats a duration in ns with the most appropriate unit
+std::string toDurationString(double iTimeNs)
+{
+  std::ostringstream s;
+  s << std::fixed << std::setprecision(1);
+  if(iTimeNs < 1000)
+    s << iTimeNs << "ns";
+  else if(iTimeNs < 1000000)
+    s << iTimeNs / 1000 << "us";
+  else
+    s << iTimeNs / 1000000 << "ms";
+  return s.str();
+}
+
+// formats a size in bytes with the most appropriate unit
+std::string toBytesString(Steinberg::int64 iBytes)
+{
+  std::ostringstream s;
+  s << std::fixed << std::setprecision(1);
+  if(iBytes < 1024)
+    s << iBytes << "B";
+  else if(iBytes < 1024 * 1024)
+    s << iBytes / 1024.0 << "KB";
+  else
+    s << iBytes / (1024.0 * 1024.0) << "MB";
+  return s.str();
+}
+
+}
+
+//------------------------------------------------------------------------
+// MetricsSnapshot::toString
+//------------------------------------------------------------------------
+std::string MetricsSnapshot::toString() const
+{
+  std::ostringstream s;
+  s << std::fixed << std::setprecision(1);
+
+  s << "process: " << fBlockCount << " blocks, load avg " << getAverageLoad() << "% max " << fMaxLoadPermille / 10.0
+    << "% (" << toDurationString(static_cast<double>(fMaxProcessTimeNs)) << "), " << getOverrunCount() << " overruns\n";
+
+  s << "load:";
+  for(int b = 0; b < NUM_LOAD_BUCKETS; b++)
+  {
+    if(b < NUM_LOAD_BUCKETS - 1)
+      s << " <" << LOAD_BUCKET_PERCENTS[b] << "%";
+    else
+      s << " >=" << LOAD_BUCKET_PERCENTS[NUM_LOAD_BUCKETS - 2] << "%";
+    s << " " << (fBlockCount > 0 ? 100.0 * fLoadHistogram[b] / fBlockCount : 0) << "%";
+  }
+  s << "\n";
+
+  s << "zoom: " << fZoomComputeCount << " computes, avg "
+    << toDurationString(fZoomComputeCount > 0 ? static_cast<double>(fZoomComputeTimeNs) / fZoomComputeCount : 0)
+    << " max " << toDurationString(static_cast<double>(fMaxZoomComputeTimeNs)) << "\n";
+
+  s << "ui: " << fBroadcastCount << " messages (" << toBytesString(fBroadcastBytes) << "), "
+    << fSharedPublishCount << " shared updates, " << fSuppressedBroadcastCount << " suppressed\n";
+
+  s << "memory: history " << toBytesString(fHistoryBytes) << ", snapshot " << toBytesString(fSnapshotBytes);
+
+  return s.str();
+}
+
+//------------------------------------------------------------------------
+// ProcessMetrics::reset
+//------------------------------------------------------------------------
+void ProcessMetrics::reset(double iSampleRate)
+{
+  fNsPerSample = 1e9 / iSampleRate;
+
+  for(auto counter: {&fBlockCount, &fSampleCount, &fProcessTimeNs, &fBudgetNs, &fMaxProcessTimeNs, &fMaxLoadPermille,
+                     &fZoomComputeCount, &fZoomComputeTimeNs, &fMaxZoomComputeTimeNs,
+                     &fBroadcastCount, &fBroadcastBytes, &fSharedPublishCount, &fSuppressedBroadcastCount})
+    set(*counter, 0);
+
+  for(auto &counter: fLoadHistogram)
+    set(counter, 0);
+}
+
+//------------------------------------------------------------------------
+// ProcessMetrics::snapshot
+//------------------------------------------------------------------------
+void ProcessMetrics::snapshot(MetricsSnapshot &oSnapshot) const
+{
+  oSnapshot.fBlockCount = get(fBlockCount);
+  oSnapshot.fSampleCount = get(fSampleCount);
+  oSnapshot.fProcessTimeNs = get(fProcessTimeNs);
+  oSnapshot.fBudgetNs = get(fBudgetNs);
+  oSnapshot.fMaxProcessTimeNs = get(fMaxProcessTimeNs);
+  oSnapshot.fMaxLoadPermille = get(fMaxLoadPermille);
+  for(int b = 0; b < MetricsSnapshot::NUM_LOAD_BUCKETS; b++)
+    oSnapshot.fLoadHistogram[b] = get(fLoadHistogram[b]);
+
+  oSnapshot.fZoomComputeCount = get(fZoomComputeCount);
+  oSnapshot.fZoomComputeTimeNs = get(fZoomComputeTimeNs);
+  oSnapshot.fMaxZoomComputeTimeNs = get(fMaxZoomComputeTimeNs);
+
+  oSnapshot.fBroadcastCount = get(fBroadcastCount);
+  oSnapshot.fBroadcastBytes = get(fBroadcastBytes);
+  oSnapshot.fSharedPublishCount = get(fSharedPublishCount);
+  oSnapshot.fSuppressedBroadcastCount = get(fSuppressedBroadcastCount);
+
+  oSnapshot.fHistoryBytes = get(fHistoryBytes);
+  oSnapshot.fSnapshotBytes = get(fSnapshotBytes);
+
+  oSnapshot.fDumpCount = get(fDumpCount);
+}
+
+}
+}
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <pluginterfaces/vst/vsttypes.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+/**
+ * A copy of the metrics of a plugin instance (see ProcessMetrics) at a given time. It is what the editor displays
+ * (debug overlay) and what is sent to the controller when the metrics are dumped.
+ */
+struct MetricsSnapshot
+{
+  using int64 = Steinberg::int64;
+
+  // the load of a block is its process time relative to its realtime budget (its duration: numSamples / sampleRate)
+  static constexpr int NUM_LOAD_BUCKETS = 8;
+
+  // upper bound (exclusive, in percent) of the load of the blocks counted in each bucket of fLoadHistogram (the
+  // last bucket being the blocks over budget)
+  static constexpr int LOAD_BUCKET_PERCENTS[NUM_LOAD_BUCKETS - 1] = {1, 2, 5, 10, 25, 50, 100};
+
+  // process (per block)
+  int64 fBlockCount{0};
+  int64 fSampleCount{0};
+  int64 fProcessTimeNs{0};
+  int64 fBudgetNs{0}; // sum of the budgets of the blocks (fProcessTimeNs / fBudgetNs is the average load)
+  int64 fMaxProcessTimeNs{0};
+  int64 fMaxLoadPermille{0};
+  int64 fLoadHistogram[NUM_LOAD_BUCKETS]{};
+
+  // zoomed buffers (re)computation (see ZoomWindow::computeZoomWindow)
+  int64 fZoomComputeCount{0};
+  int64 fZoomComputeTimeNs{0};
+  int64 fMaxZoomComputeTimeNs{0};
+
+  // UI updates: messages (see HistoryDataParamSerializer) or shared history channel (same process) and the updates
+  // suppressed because nothing changed (see UIUpdateScheduler)
+  int64 fBroadcastCount{0};
+  int64 fBroadcastBytes{0};
+  int64 fSharedPublishCount{0};
+  int64 fSuppressedBroadcastCount{0};
+
+  // memory (in bytes) held by the histories (and their zoomed buffers) and by the paused history snapshot
+  int64 fHistoryBytes{0};
+  int64 fSnapshotBytes{0};
+
+  // number of times the metrics were dumped (see ProcessMetrics::recordDump)
+  int64 fDumpCount{0};
+
+  // getAverageLoad (in percent)
+  inline double getAverageLoad() const { return fBudgetNs > 0 ? 100.0 * fProcessTimeNs / fBudgetNs : 0; }
+
+  // getOverrunCount (blocks over budget)
+  inline int64 getOverrunCount() const { return fLoadHistogram[NUM_LOAD_BUCKETS - 1]; }
+
+  /**
+   * @return a human readable version of the metrics (one line per category)
+   */
+  std::string toString() const;
+};
+
+/**
+ * The runtime metrics of a plugin instance: lock free counters written by the audio thread (and, for the bytes sent
+ * to the UI, by the thread serializing the messages) and read by any thread (see snapshot).
+ *
+ * Every counter has a single writer so a counter is updated with a relaxed load and store instead of a read-modify-
+ * write (no lock prefix / exclusive access): recording a block costs a handful of loads and stores, 1 division and
+ * the 2 reads of the clock (see now). A snapshot reads each counter atomically but the counters are not read all at
+ * once (a snapshot taken during a block may count the block in some counters and not in others).
+ */
+class ProcessMetrics
+{
+public:
+  using int64 = Steinberg::int64;
+  using int32 = Steinberg::int32;
+
+  // now (in nanoseconds, monotonic)
+  static inline int64 now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  /**
+   * Clears the counters (the memory is set separately and the dump count never goes back) and sets the sample rate
+   * (used to compute the budget of a block). Not realtime safe: must be called while not processing (setupProcessing).
+   */
+  void reset(double iSampleRate);
+
+  // setMemory (not realtime safe: called from setupProcessing)
+  void setMemory(int64 iHistoryBytes, int64 iSnapshotBytes)
+  {
+    set(fHistoryBytes, iHistoryBytes);
+    set(fSnapshotBytes, iSnapshotBytes);
+  }
+
+  /**
+   * Audio thread: a block of iNumSamples samples was processed in iTimeNs nanoseconds
+   */
+  inline void recordBlock(int32 iNumSamples, int64 iTimeNs)
+  {
+    auto budgetNs = static_cast<int64>(iNumSamples * fNsPerSample);
+    auto loadPermille = budgetNs > 0 ? iTimeNs * 1000 / budgetNs : 0;
+
+    add(fBlockCount, 1);
+    add(fSampleCount, iNumSamples);
+    add(fProcessTimeNs, iTimeNs);
+    add(fBudgetNs, budgetNs);
+    max(fMaxProcessTimeNs, iTimeNs);
+    max(fMaxLoadPermille, loadPermille);
+
+    int bucket = 0;
+    while(bucket < MetricsSnapshot::NUM_LOAD_BUCKETS - 1 &&
+          loadPermille >= MetricsSnapshot::LOAD_BUCKET_PERCENTS[bucket] * 10)
+      bucket++;
+    add(fLoadHistogram[bucket], 1);
+  }
+
+  // recordZoomCompute (audio thread: a call to ZoomWindow::computeZoomWindow which took iTimeNs nanoseconds)
+  inline void recordZoomCompute(int64 iTimeNs)
+  {
+    add(fZoomComputeCount, 1);
+    add(fZoomComputeTimeNs, iTimeNs);
+    max(fMaxZoomComputeTimeNs, iTimeNs);
+  }
+
+  // recordBroadcast (audio thread: the history data was handed to the messaging)
+  inline void recordBroadcast() { add(fBroadcastCount, 1); }
+
+  // recordBroadcastBytes (messaging thread: iBytes bytes of history data were serialized in a message)
+  inline void recordBroadcastBytes(int64 iBytes) { add(fBroadcastBytes, iBytes); }
+
+  // recordSharedPublish (audio thread: the history data was published in the shared history channel)
+  inline void recordSharedPublish() { add(fSharedPublishCount, 1); }
+
+  // setSuppressedBroadcastCount (audio thread: the UI updates suppressed so far, see UIUpdateScheduler)
+  inline void setSuppressedBroadcastCount(int64 iCount) { set(fSuppressedBroadcastCount, iCount); }
+
+  // recordDump (audio thread: the metrics are about to be dumped)
+  inline void recordDump() { add(fDumpCount, 1); }
+
+  // snapshot (any thread)
+  void snapshot(MetricsSnapshot &oSnapshot) const;
+
+private:
+  using Counter = std::atomic<int64>;
+
+  static inline void set(Counter &oCounter, int64 iValue) { oCounter.store(iValue, std::memory_order_relaxed); }
+
+  static inline int64 get(Counter const &iCounter) { return iCounter.load(std::memory_order_relaxed); }
+
+  // add (single writer => no read-modify-write)
+  static inline void add(Counter &ioCounter, int64 iDelta) { set(ioCounter, get(ioCounter) + iDelta); }
+
+  // max (single writer)
+  static inline void max(Counter &ioCounter, int64 iValue)
+  {
+    if(iValue > get(ioCounter))
+      set(ioCounter, iValue);
+  }
+
+private:
+  double fNsPerSample{1e9 / 44100};
+
+  Counter fBlockCount{0};
+  Counter fSampleCount{0};
+  Counter fProcessTimeNs{0};
+  Counter fBudgetNs{0};
+  Counter fMaxProcessTimeNs{0};
+  Counter fMaxLoadPermille{0};
+  Counter fLoadHistogram[MetricsSnapshot::NUM_LOAD_BUCKETS]{};
+
+  Counter fZoomComputeCount{0};
+  Counter fZoomComputeTimeNs{0};
+  Counter fMaxZoomComputeTimeNs{0};
+
+  Counter fBroadcastCount{0};
+  Counter fBroadcastBytes{0};
+  Counter fSharedPublishCount{0};
+  Counter fSuppressedBroadcastCount{0};
+
+  Counter fHistoryBytes{0};
+  Counter fSnapshotBytes{0};
+
+  Counter fDumpCount{0};
+};
+
+}
+}
+}
@@ -0,0 +1,642 @@
+#pragma once
+
+#include <pluginterfaces/vst/vsttypes.h>
+#include <algorithm>
+#include "VAC6Constants.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VAC6_PEAK_KERNEL_SSE2 1
+#include <emmintrin.h>
+#else
+#define VAC6_PEAK_KERNEL_SSE2 0
+#endif
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+/**
+ * Block kernels used by the audio thread to process a whole run of samples in one pass (instead of accumulating
+ * samples one at a time).
+ *
+ * The kernels compute in the precision of the samples (32 bits samples are multiplied by the gain as floats, 4 per
+ * SSE2 register, 64 bits samples as doubles) so that the vectorized and reference implementations are bit for bit
+ * identical. The per sample gain versions compute in TSample precision since their output also feeds the filters.
+ * Note that the max of absolute values does not depend on the order in which the samples are visited which is what
+ * makes it possible to vectorize.
+ */
+namespace PeakKernel {
+
+///////////////////////////////////////////
+// PeakKernel::scalarCopyAndComputeMax
+///////////////////////////////////////////
+/**
+ * Reference (non vectorized) implementation: copies iNumSamples samples from iIn to oOut applying iGain and returns
+ * the max of the absolute values of the (gain adjusted) samples.
+ *
+ * @param iIn the input samples (nullptr means silence)
+ * @param oOut the output samples (nullptr means no output) (can be the same as iIn)
+ */
+template<typename SampleType>
+inline TSample scalarCopyAndComputeMax(SampleType const *iIn, SampleType *oOut, int iNumSamples, double iGain)
+{
+  // silence => no need to look at the samples
+  if(!iIn)
+  {
+    if(oOut)
+      std::fill(oOut, oOut + iNumSamples, 0);
+    return 0;
+  }
+
+  auto const gain = static_cast<SampleType>(iGain);
+  SampleType max = 0;
+
+  for(int i = 0; i < iNumSamples; i++)
+  {
+    SampleType sample = iIn[i] * gain;
+
+    SampleType absSample = sample < 0 ? -sample : sample;
+    if(absSample > max)
+      max = absSample;
+
+    if(oOut)
+      oOut[i] = sample;
+  }
+
+  return max;
+}
+
+///////////////////////////////////////////
+// PeakKernel::scalarCopyAndComputeMax (per sample gain)
+///////////////////////////////////////////
+/**
+ * Reference (non vectorized) implementation of the per sample gain version (see GainRamp): same as above except
+ * that the sample i is multiplied by iGains[i].
+ *
+ * @param oGained the gain adjusted samples in TSample precision (nullptr means not needed) so that the filters which
+ *                need them (TruePeakFilter, KWeightingFilter) can be fed with a gain of 1.0
+ */
+template<typename SampleType>
+inline TSample scalarCopyAndComputeMax(SampleType const *iIn,
+                                       SampleType *oOut,
+                                       int iNumSamples,
+                                       TSample const *iGains,
+                                       TSample *oGained)
+{
+  // silence => no need to look at the samples (nor the gains)
+  if(!iIn)
+  {
+    if(oOut)
+      std::fill(oOut, oOut + iNumSamples, 0);
+    if(oGained)
+      std::fill(oGained, oGained + iNumSamples, 0);
+    return 0;
+  }
+
+  TSample max = 0;
+
+  for(int i = 0; i < iNumSamples; i++)
+  {
+    TSample sample = static_cast<TSample>(iIn[i]) * iGains[i];
+
+    TSample absSample = sample < 0 ? -sample : sample;
+    if(absSample > max)
+      max = absSample;
+
+    if(oOut)
+      oOut[i] = static_cast<SampleType>(sample);
+
+    if(oGained)
+      oGained[i] = sample;
+  }
+
+  return max;
+}
+
+///////////////////////////////////////////
+// PeakKernel::scalarComputeMax
+///////////////////////////////////////////
+/**
+ * Reference (non vectorized) implementation of the read only pass (pass through at unity gain, the output being
+ * either the input itself or a bulk copy of it): same as scalarCopyAndComputeMax with no output and a gain of 1.0
+ */
+template<typename SampleType>
+inline TSample scalarComputeMax(SampleType const *iIn, int iNumSamples)
+{
+  return scalarCopyAndComputeMax<SampleType>(iIn, nullptr, iNumSamples, 1.0);
+}
+
+///////////////////////////////////////////
+// PeakKernel::scalarComputeSumOfSquares
+///////////////////////////////////////////
+/**
+ * Reference (non vectorized) implementation of the sum of the squares of the (gain adjusted) samples in TSample
+ * precision (used for the RMS of the selection, see VAC6ChannelBank). It is called right after copyAndComputeMax on
+ * the same run which is still in the cache. Unlike the max, the sum depends on the order in which the samples are
+ * added so the vectorized implementation (which keeps several partial sums) is not bit for bit identical to this
+ * one, which does not matter for displaying an RMS.
+ *
+ * @param iIn the input samples (nullptr means silence)
+ */
+template<typename SampleType>
+inline TSample scalarComputeSumOfSquares(SampleType const *iIn, int iNumSamples, double iGain)
+{
+  if(!iIn)
+    return 0;
+
+  TSample sum = 0;
+  for(int i = 0; i < iNumSamples; i++)
+  {
+    auto sample = static_cast<TSample>(iIn[i]);
+    sum += sample * sample;
+  }
+
+  return sum * iGain * iGain;
+}
+
+///////////////////////////////////////////
+// PeakKernel::scalarComputeSumOfSquares (per sample gain)
+///////////////////////////////////////////
+template<typename SampleType>
+inline TSample scalarComputeSumOfSquares(SampleType const *iIn, int iNumSamples, TSample const *iGains)
+{
+  if(!iIn)
+    return 0;
+
+  TSample sum = 0;
+  for(int i = 0; i < iNumSamples; i++)
+  {
+    TSample sample = static_cast<TSample>(iIn[i]) * iGains[i];
+    sum += sample * sample;
+  }
+
+  return sum;
+}
+
+#if VAC6_PEAK_KERNEL_SSE2
+
+///////////////////////////////////////////
+// PeakKernel::horizontalMax
+///////////////////////////////////////////
+inline TSample horizontalMax(__m128d iMax)
+{
+  return _mm_cvtsd_f64(_mm_max_pd(iMax, _mm_unpackhi_pd(iMax, iMax)));
+}
+
+///////////////////////////////////////////
+// PeakKernel::copyAndComputeMax (64 bits / SSE2)
+///////////////////////////////////////////
+/**
+ * Note that _mm_max_pd returns the second operand when either one is NaN, so putting the accumulated max second
+ * ignores NaN samples exactly like std::max(accumulatedMax, sample) does in MaxAccumulator::accumulate.
+ */
+inline TSample copyAndComputeMax(Sample64 const *iIn, Sample64 *oOut, int iNumSamples, double iGain)
+{
+  if(!iIn)
+    return scalarCopyAndComputeMax<Sample64>(iIn, oOut, iNumSamples, iGain);
+
+  auto const gain = _mm_set1_pd(iGain);
+  auto const signMask = _mm_set1_pd(-0.0);
+  auto max0 = _mm_setzero_pd();
+  auto max1 = _mm_setzero_pd();
+
+  int i = 0;
+
+  for(; i + 4 <= iNumSamples; i += 4)
+  {
+    auto s0 = _mm_mul_pd(_mm_loadu_pd(iIn + i), gain);
+    auto s1 = _mm_mul_pd(_mm_loadu_pd(iIn + i + 2), gain);
+    max0 = _mm_max_pd(_mm_andnot_pd(signMask, s0), max0);
+    max1 = _mm_max_pd(_mm_andnot_pd(signMask, s1), max1);
+    if(oOut)
+    {
+      _mm_storeu_pd(oOut + i, s0);
+      _mm_storeu_pd(oOut + i + 2, s1);
+    }
+  }
+
+  TSample max = horizontalMax(_mm_max_pd(max0, max1));
+
+  // remaining samples (less than 4)
+  TSample tailMax = scalarCopyAndComputeMax<Sample64>(iIn + i, oOut ? oOut + i : nullptr, iNumSamples - i, iGain);
+
+  return tailMax > max ? tailMax : max;
+}
+
+///////////////////////////////////////////
+// PeakKernel::horizontalMax
+///////////////////////////////////////////
+inline TSample horizontalMax(__m128 iMax)
+{
+  auto max = _mm_max_ps(iMax, _mm_movehl_ps(iMax, iMax));
+  return static_cast<TSample>(_mm_cvtss_f32(_mm_max_ss(max, _mm_shuffle_ps(max, max, 1))));
+}
+
+///////////////////////////////////////////
+// PeakKernel::copyAndComputeMax (32 bits / SSE2)
+///////////////////////////////////////////
+/**
+ * The 32 bits samples are processed natively (4 floats per register, the gain being converted to float once) which
+ * is exactly what the scalar code does.
+ */
+inline TSample copyAndComputeMax(Sample32 const *iIn, Sample32 *oOut, int iNumSamples, double iGain)
+{
+  if(!iIn)
+    return scalarCopyAndComputeMax<Sample32>(iIn, oOut, iNumSamples, iGain);
+
+  auto const gain = _mm_set1_ps(static_cast<Sample32>(iGain));
+  auto const signMask = _mm_set1_ps(-0.0f);
+  auto max0 = _mm_setzero_ps();
+  auto max1 = _mm_setzero_ps();
+
+  int i = 0;
+
+  for(; i + 8 <= iNumSamples; i += 8)
+  {
+    auto s0 = _mm_mul_ps(_mm_loadu_ps(iIn + i), gain);
+    auto s1 = _mm_mul_ps(_mm_loadu_ps(iIn + i + 4), gain);
+    max0 = _mm_max_ps(_mm_andnot_ps(signMask, s0), max0);
+    max1 = _mm_max_ps(_mm_andnot_ps(signMask, s1), max1);
+    if(oOut)
+    {
+      _mm_storeu_ps(oOut + i, s0);
+      _mm_storeu_ps(oOut + i + 4, s1);
+    }
+  }
+
+  TSample max = horizontalMax(_mm_max_ps(max0, max1));
+
+  // remaining samples (less than 8)
+  TSample tailMax = scalarCopyAndComputeMax<Sample32>(iIn + i, oOut ? oOut + i : nullptr, iNumSamples - i, iGain);
+
+  return tailMax > max ? tailMax : max;
+}
+
+///////////////////////////////////////////
+// PeakKernel::copyAndComputeMax (64 bits / SSE2 / per sample gain)
+///////////////////////////////////////////
+inline TSample copyAndComputeMax(Sample64 const *iIn,
+                                 Sample64 *oOut,
+                                 int iNumSamples,
+                                 TSample const *iGains,
+                                 TSample *oGained)
+{
+  if(!iIn)
+    return scalarCopyAndComputeMax<Sample64>(iIn, oOut, iNumSamples, iGains, oGained);
+
+  auto const signMask = _mm_set1_pd(-0.0);
+  auto max0 = _mm_setzero_pd();
+  auto max1 = _mm_setzero_pd();
+
+  int i = 0;
+
+  for(; i + 4 <= iNumSamples; i += 4)
+  {
+    auto s0 = _mm_mul_pd(_mm_loadu_pd(iIn + i), _mm_loadu_pd(iGains + i));
+    auto s1 = _mm_mul_pd(_mm_loadu_pd(iIn + i + 2), _mm_loadu_pd(iGains + i + 2));
+    max0 = _mm_max_pd(_mm_andnot_pd(signMask, s0), max0);
+    max1 = _mm_max_pd(_mm_andnot_pd(signMask, s1), max1);
+    if(oOut)
+    {
+      _mm_storeu_pd(oOut + i, s0);
+      _mm_storeu_pd(oOut + i + 2, s1);
+    }
+    if(oGained)
+    {
+      _mm_storeu_pd(oGained + i, s0);
+      _mm_storeu_pd(oGained + i + 2, s1);
+    }
+  }
+
+  TSample max = horizontalMax(_mm_max_pd(max0, max1));
+
+  // remaining samples (less than 4)
+  TSample tailMax = scalarCopyAndComputeMax<Sample64>(iIn + i,
+                                                      oOut ? oOut + i : nullptr,
+                                                      iNumSamples - i,
+                                                      iGains + i,
+                                                      oGained ? oGained + i : nullptr);
+
+  return tailMax > max ? tailMax : max;
+}
+
+///////////////////////////////////////////
+// PeakKernel::copyAndComputeMax (32 bits / SSE2 / per sample gain)
+///////////////////////////////////////////
+inline TSample copyAndComputeMax(Sample32 const *iIn,
+                                 Sample32 *oOut,
+                                 int iNumSamples,
+                                 TSample const *iGains,
+                                 TSample *oGained)
+{
+  if(!iIn)
+    return scalarCopyAndComputeMax<Sample32>(iIn, oOut, iNumSamples, iGains, oGained);
+
+  auto const signMask = _mm_set1_pd(-0.0);
+  auto max0 = _mm_setzero_pd();
+  auto max1 = _mm_setzero_pd();
+
+  int i = 0;
+
+  for(; i + 4 <= iNumSamples; i += 4)
+  {
+    auto s = _mm_loadu_ps(iIn + i);
+    auto s0 = _mm_mul_pd(_mm_cvtps_pd(s), _mm_loadu_pd(iGains + i));
+    auto s1 = _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(s, s)), _mm_loadu_pd(iGains + i + 2));
+    max0 = _mm_max_pd(_mm_andnot_pd(signMask, s0), max0);
+    max1 = _mm_max_pd(_mm_andnot_pd(signMask, s1), max1);
+    if(oOut)
+      _mm_storeu_ps(oOut + i, _mm_movelh_ps(_mm_cvtpd_ps(s0), _mm_cvtpd_ps(s1)));
+    if(oGained)
+    {
+      _mm_storeu_pd(oGained + i, s0);
+      _mm_storeu_pd(oGained + i + 2, s1);
+    }
+  }
+
+  TSample max = horizontalMax(_mm_max_pd(max0, max1));
+
+  // remaining samples (less than 4)
+  TSample tailMax = scalarCopyAndComputeMax<Sample32>(iIn + i,
+                                                      oOut ? oOut + i : nullptr,
+                                                      iNumSamples - i,
+                                                      iGains + i,
+                                                      oGained ? oGained + i : nullptr);
+
+  return tailMax > max ? tailMax : max;
+}
+
+///////////////////////////////////////////
+// PeakKernel::computeMax (64 bits / SSE2)
+///////////////////////////////////////////
+inline TSample computeMax(Sample64 const *iIn, int iNumSamples)
+{
+  if(!iIn)
+    return 0;
+
+  auto const signMask = _mm_set1_pd(-0.0);
+  auto max0 = _mm_setzero_pd();
+  auto max1 = _mm_setzero_pd();
+
+  int i = 0;
+
+  for(; i + 4 <= iNumSamples; i += 4)
+  {
+    max0 = _mm_max_pd(_mm_andnot_pd(signMask, _mm_loadu_pd(iIn + i)), max0);
+    max1 = _mm_max_pd(_mm_andnot_pd(signMask, _mm_loadu_pd(iIn + i + 2)), max1);
+  }
+
+  TSample max = horizontalMax(_mm_max_pd(max0, max1));
+
+  // remaining samples (less than 4)
+  TSample tailMax = scalarComputeMax<Sample64>(iIn + i, iNumSamples - i);
+
+  return tailMax > max ? tailMax : max;
+}
+
+///////////////////////////////////////////
+// PeakKernel::computeMax (32 bits / SSE2)
+///////////////////////////////////////////
+inline TSample computeMax(Sample32 const *iIn, int iNumSamples)
+{
+  if(!iIn)
+    return 0;
+
+  auto const signMask = _mm_set1_ps(-0.0f);
+  auto max0 = _mm_setzero_ps();
+  auto max1 = _mm_setzero_ps();
+
+  int i = 0;
+
+  for(; i + 8 <= iNumSamples; i += 8)
+  {
+    max0 = _mm_max_ps(_mm_andnot_ps(signMask, _mm_loadu_ps(iIn + i)), max0);
+    max1 = _mm_max_ps(_mm_andnot_ps(signMask, _mm_loadu_ps(iIn + i + 4)), max1);
+  }
+
+  TSample max = horizontalMax(_mm_max_ps(max0, max1));
+
+  // remaining samples (less than 8)
+  TSample tailMax = scalarComputeMax<Sample32>(iIn + i, iNumSamples - i);
+
+  return tailMax > max ? tailMax : max;
+}
+
+///////////////////////////////////////////
+// PeakKernel::horizontalSum
+///////////////////////////////////////////
+inline TSample horizontalSum(__m128d iSum)
+{
+  return _mm_cvtsd_f64(_mm_add_pd(iSum, _mm_unpackhi_pd(iSum, iSum)));
+}
+
+///////////////////////////////////////////
+// PeakKernel::computeSumOfSquares (64 bits / SSE2)
+///////////////////////////////////////////
+/**
+ * 8 partial sums (4 registers) so that the additions of consecutive samples do not depend on each other
+ */
+inline TSample computeSumOfSquares(Sample64 const *iIn, int iNumSamples, double iGain)
+{
+  if(!iIn)
+    return 0;
+
+  auto sum0 = _mm_setzero_pd();
+  auto sum1 = _mm_setzero_pd();
+  auto sum2 = _mm_setzero_pd();
+  auto sum3 = _mm_setzero_pd();
+
+  int i = 0;
+
+  for(; i + 8 <= iNumSamples; i += 8)
+  {
+    auto s0 = _mm_loadu_pd(iIn + i);
+    auto s1 = _mm_loadu_pd(iIn + i + 2);
+    auto s2 = _mm_loadu_pd(iIn + i + 4);
+    auto s3 = _mm_loadu_pd(iIn + i + 6);
+    sum0 = _mm_add_pd(sum0, _mm_mul_pd(s0, s0));
+    sum1 = _mm_add_pd(sum1, _mm_mul_pd(s1, s1));
+    sum2 = _mm_add_pd(sum2, _mm_mul_pd(s2, s2));
+    sum3 = _mm_add_pd(sum3, _mm_mul_pd(s3, s3));
+  }
+
+  TSample sum = horizontalSum(_mm_add_pd(_mm_add_pd(sum0, sum1), _mm_add_pd(sum2, sum3)));
+
+  // remaining samples (less than 8)
+  sum += scalarComputeSumOfSquares<Sample64>(iIn + i, iNumSamples - i, 1.0);
+
+  return sum * iGain * iGain;
+}
+
+///////////////////////////////////////////
+// PeakKernel::computeSumOfSquares (32 bits / SSE2)
+///////////////////////////////////////////
+/**
+ * The samples are converted to doubles (like the reference implementation) and summed in TSample precision
+ */
+inline TSample computeSumOfSquares(Sample32 const *iIn, int iNumSamples, double iGain)
+{
+  if(!iIn)
+    return 0;
+
+  auto sum0 = _mm_setzero_pd();
+  auto sum1 = _mm_setzero_pd();
+  auto sum2 = _mm_setzero_pd();
+  auto sum3 = _mm_setzero_pd();
+
+  int i = 0;
+
+  for(; i + 8 <= iNumSamples; i += 8)
+  {
+    auto s01 = _mm_loadu_ps(iIn + i);
+    auto s23 = _mm_loadu_ps(iIn + i + 4);
+    auto s0 = _mm_cvtps_pd(s01);
+    auto s1 = _mm_cvtps_pd(_mm_movehl_ps(s01, s01));
+    auto s2 = _mm_cvtps_pd(s23);
+    auto s3 = _mm_cvtps_pd(_mm_movehl_ps(s23, s23));
+    sum0 = _mm_add_pd(sum0, _mm_mul_pd(s0, s0));
+    sum1 = _mm_add_pd(sum1, _mm_mul_pd(s1, s1));
+    sum2 = _mm_add_pd(sum2, _mm_mul_pd(s2, s2));
+    sum3 = _mm_add_pd(sum3, _mm_mul_pd(s3, s3));
+  }
+
+  TSample sum = horizontalSum(_mm_add_pd(_mm_add_pd(sum0, sum1), _mm_add_pd(sum2, sum3)));
+
+  // remaining samples (less than 8)
+  sum += scalarComputeSumOfSquares<Sample32>(iIn + i, iNumSamples - i, 1.0);
+
+  return sum * iGain * iGain;
+}
+
+///////////////////////////////////////////
+// PeakKernel::computeSumOfSquares (64 bits / SSE2 / per sample gain)
+///////////////////////////////////////////
+inline TSample computeSumOfSquares(Sample64 const *iIn, int iNumSamples, TSample const *iGains)
+{
+  if(!iIn)
+    return 0;
+
+  auto sum0 = _mm_setzero_pd();
+  auto sum1 = _mm_setzero_pd();
+
+  int i = 0;
+
+  for(; i + 4 <= iNumSamples; i += 4)
+  {
+    auto s0 = _mm_mul_pd(_mm_loadu_pd(iIn + i), _mm_loadu_pd(iGains + i));
+    auto s1 = _mm_mul_pd(_mm_loadu_pd(iIn + i + 2), _mm_loadu_pd(iGains + i + 2));
+    sum0 = _mm_add_pd(sum0, _mm_mul_pd(s0, s0));
+    sum1 = _mm_add_pd(sum1, _mm_mul_pd(s1, s1));
+  }
+
+  // remaining samples (less than 4)
+  return horizontalSum(_mm_add_pd(sum0, sum1)) +
+         scalarComputeSumOfSquares<Sample64>(iIn + i, iNumSamples - i, iGains + i);
+}
+
+///////////////////////////////////////////
+// PeakKernel::computeSumOfSquares (32 bits / SSE2 / per sample gain)
+///////////////////////////////////////////
+inline TSample computeSumOfSquares(Sample32 const *iIn, int iNumSamples, TSample const *iGains)
+{
+  if(!iIn)
+    return 0;
+
+  auto sum0 = _mm_setzero_pd();
+  auto sum1 = _mm_setzero_pd();
+
+  int i = 0;
+
+  for(; i + 4 <= iNumSamples; i += 4)
+  {
+    auto s = _mm_loadu_ps(iIn + i);
+    auto s0 = _mm_mul_pd(_mm_cvtps_pd(s), _mm_loadu_pd(iGains + i));
+    auto s1 = _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(s, s)), _mm_loadu_pd(iGains + i + 2));
+    sum0 = _mm_add_pd(sum0, _mm_mul_pd(s0, s0));
+    sum1 = _mm_add_pd(sum1, _mm_mul_pd(s1, s1));
+  }
+
+  // remaining samples (less than 4)
+  return horizontalSum(_mm_add_pd(sum0, sum1)) +
+         scalarComputeSumOfSquares<Sample32>(iIn + i, iNumSamples - i, iGains + i);
+}
+
+#else
+
+///////////////////////////////////////////
+// PeakKernel::computeMax (no SIMD)
+///////////////////////////////////////////
+inline TSample computeMax(Sample64 const *iIn, int iNumSamples)
+{
+  return scalarComputeMax<Sample64>(iIn, iNumSamples);
+}
+
+inline TSample computeMax(Sample32 const *iIn, int iNumSamples)
+{
+  return scalarComputeMax<Sample32>(iIn, iNumSamples);
+}
+
+///////////////////////////////////////////
+// PeakKernel::copyAndComputeMax (no SIMD)
+///////////////////////////////////////////
+inline TSample copyAndComputeMax(Sample64 const *iIn, Sample64 *oOut, int iNumSamples, double iGain)
+{
+  return scalarCopyAndComputeMax<Sample64>(iIn, oOut, iNumSamples, iGain);
+}
+
+inline TSample copyAndComputeMax(Sample32 const *iIn, Sample32 *oOut, int iNumSamples, double iGain)
+{
+  return scalarCopyAndComputeMax<Sample32>(iIn, oOut, iNumSamples, iGain);
+}
+
+inline TSample copyAndComputeMax(Sample64 const *iIn,
+                                 Sample64 *oOut,
+                                 int iNumSamples,
+                                 TSample const *iGains,
+                                 TSample *oGained)
+{
+  return scalarCopyAndComputeMax<Sample64>(iIn, oOut, iNumSamples, iGains, oGained);
+}
+
+inline TSample copyAndComputeMax(Sample32 const *iIn,
+                                 Sample32 *oOut,
+                                 int iNumSamples,
+                                 TSample const *iGains,
+                                 TSample *oGained)
+{
+  return scalarCopyAndComputeMax<Sample32>(iIn, oOut, iNumSamples, iGains, oGained);
+}
+
+///////////////////////////////////////////
+// PeakKernel::computeSumOfSquares (no SIMD)
+///////////////////////////////////////////
+inline TSample computeSumOfSquares(Sample64 const *iIn, int iNumSamples, double iGain)
+{
+  return scalarComputeSumOfSquares<Sample64>(iIn, iNumSamples, iGain);
+}
+
+inline TSample computeSumOfSquares(Sample32 const *iIn, int iNumSamples, double iGain)
+{
+  return scalarComputeSumOfSquares<Sample32>(iIn, iNumSamples, iGain);
+}
+
+inline TSample computeSumOfSquares(Sample64 const *iIn, int iNumSamples, TSample const *iGains)
+{
+  return scalarComputeSumOfSquares<Sample64>(iIn, iNumSamples, iGains);
+}
+
+inline TSample computeSumOfSquares(Sample32 const *iIn, int iNumSamples, TSample const *iGains)
+{
+  return scalarComputeSumOfSquares<Sample32>(iIn, iNumSamples, iGains);
+}
+
+#endif
+
+}
+
+}
+}
+}
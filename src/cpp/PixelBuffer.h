@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+/**
+ * Non owning view on 32 bits pixels (for example the pixels of an offscreen bitmap) with the few operations needed
+ * to scroll its content and draw rectangles directly in memory. The pixel format does not matter: the pixels are
+ * only moved or set to values provided by the caller (0 being transparent for premultiplied formats).
+ */
+class PixelBuffer
+{
+public:
+  using Pixel = uint32_t;
+
+  // Constructor
+  PixelBuffer(uint8_t *iAddress, int iBytesPerRow, int iWidth, int iHeight) :
+    fAddress{iAddress},
+    fBytesPerRow{iBytesPerRow},
+    fWidth{iWidth},
+    fHeight{iHeight}
+  {}
+
+  inline int getWidth() const { return fWidth; }
+  inline int getHeight() const { return fHeight; }
+
+  // getRow (the iY row of pixels)
+  inline Pixel *getRow(int iY) { return reinterpret_cast<Pixel *>(fAddress + static_cast<size_t>(iY) * fBytesPerRow); }
+  inline Pixel const *getRow(int iY) const
+  {
+    return reinterpret_cast<Pixel const *>(fAddress + static_cast<size_t>(iY) * fBytesPerRow);
+  }
+
+  /**
+   * Moves every row iNumPixels pixels to the left. The iNumPixels rightmost pixels of each row are left untouched
+   * (they are expected to be drawn again by the caller).
+   */
+  void shiftLeft(int iNumPixels)
+  {
+    if(iNumPixels <= 0 || iNumPixels >= fWidth)
+      return;
+
+    auto numBytes = static_cast<size_t>(fWidth - iNumPixels) * sizeof(Pixel);
+    for(int y = 0; y < fHeight; y++)
+    {
+      auto row = getRow(y);
+      std::memmove(row, row + iNumPixels, numBytes);
+    }
+  }
+
+  /**
+   * Sets the pixels of the rectangle [iLeft, iRight) x [iTop, iBottom) (clipped to the buffer) to iPixel
+   */
+  void fillRect(int iLeft, int iTop, int iRight, int iBottom, Pixel iPixel)
+  {
+    iLeft = std::max(iLeft, 0);
+    iTop = std::max(iTop, 0);
+    iRight = std::min(iRight, fWidth);
+    iBottom = std::min(iBottom, fHeight);
+
+    for(int y = iTop; y < iBottom; y++)
+    {
+      auto row = getRow(y);
+      std::fill(row + iLeft, row + iRight, iPixel);
+    }
+  }
+
+private:
+  uint8_t *const fAddress;
+  int const fBytesPerRow;
+  int const fWidth;
+  int const fHeight;
+};
+
+}
+}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+/**
+ * Realtime safety instrumentation (see test/cpp/rtcheck): when the plugin is compiled with VAC6_RT_SAFETY_CHECK
+ * (-DVAC6_ENABLE_RT_SAFETY_CHECK=ON, Linux only), VAC6_RT_SAFETY_SCOPE marks a realtime callback for the checker
+ * library which records every allocation, lock or blocking call made while the callback is on the stack (of the
+ * same thread). The checker library is either linked (vac6_rt_safety_test) or preloaded (LD_PRELOAD) and when it is
+ * not loaded the scope does nothing. Otherwise (regular build) VAC6_RT_SAFETY_SCOPE compiles to nothing.
+ */
+#if VAC6_RT_SAFETY_CHECK
+
+// implemented by the checker library (weak => nullptr when it is not loaded)
+extern "C" void vac6_rt_safety_enter(char const *iCallback) __attribute__((weak));
+extern "C" void vac6_rt_safety_leave() __attribute__((weak));
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+/**
+ * The realtime callback iCallback (a string literal) is on the stack while this object lives (can be nested)
+ */
+class RTSafetyScope
+{
+public:
+  explicit RTSafetyScope(char const *iCallback)
+  {
+    if(vac6_rt_safety_enter)
+      vac6_rt_safety_enter(iCallback);
+  }
+
+  ~RTSafetyScope()
+  {
+    if(vac6_rt_safety_leave)
+      vac6_rt_safety_leave();
+  }
+
+  RTSafetyScope(RTSafetyScope const &) = delete;
+  RTSafetyScope &operator=(RTSafetyScope const &) = delete;
+};
+
+}
+}
+}
+
+#define VAC6_RT_SAFETY_SCOPE(iCallback) pongasoft::VST::Common::RTSafetyScope __rtSafetyScope{iCallback}
+
+#else
+
+#define VAC6_RT_SAFETY_SCOPE(iCallback) do {} while(false)
+
+#endif
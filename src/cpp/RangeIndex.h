@@ -0,0 +1,252 @@
+#pragma once
+
+#include <pluginterfaces/vst/vsttypes.h>
+#include <pongasoft/logging/loguru.hpp>
+#include <pongasoft/Utils/Collection/CircularBuffer.h>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+using namespace pongasoft::Utils::Collection;
+
+/**
+ * Hierarchical index (pyramid) maintained alongside a circular buffer (which is level 0) so that an aggregate (max,
+ * sum, etc...) over any range of the buffer can be computed in O(log n) instead of O(n).
+ *
+ * Level k (k >= 1) stores the aggregate of each (aligned) block of 2^k consecutive entries pushed in the buffer.
+ * Blocks are identified by an absolute index (number of entries pushed so far) so that alignment does not depend on
+ * where the head of the circular buffer is. Each level is updated when its block completes which happens every 2^k
+ * pushes so the amortized cost of a push is O(1).
+ *
+ * TAggregator must provide:
+ * - `value_type` the type of the aggregate
+ * - `value_type fromEntry(T iEntry) const` the aggregate of a single entry
+ * - `value_type combine(value_type const &iLeft, value_type const &iRight) const` (must be associative)
+ * - `value_type identity() const` the aggregate of an empty range
+ */
+template<typename T, typename TAggregator>
+class RangeIndex
+{
+public:
+  using int64 = Steinberg::int64;
+  using value_type = typename TAggregator::value_type;
+
+  // Constructor
+  explicit RangeIndex(int iBufferSize, TAggregator iAggregator = TAggregator{}) :
+    fBufferSize{iBufferSize},
+    fLevelCount{computeLevelCount(iBufferSize)},
+    fAggregator{std::move(iAggregator)}
+  {
+    DCHECK_GT_F(iBufferSize, 0);
+
+    int levelOffset = 0;
+    for(int k = 1; k <= fLevelCount; k++)
+    {
+      // enough blocks to cover the full buffer no matter how it is aligned
+      int levelSize = (fBufferSize >> k) + 2;
+      fLevelOffsets.emplace_back(levelOffset);
+      fLevelSizes.emplace_back(levelSize);
+      levelOffset += levelSize;
+    }
+
+    fLevels.resize(static_cast<size_t>(levelOffset));
+  }
+
+  RangeIndex(RangeIndex const&) = delete;
+
+  /**
+   * Should be called when the underlying buffer is initialized with iValue (CircularBuffer::init)
+   */
+  void init(T iValue)
+  {
+    auto blockValue = fAggregator.fromEntry(iValue);
+    for(int k = 1; k <= fLevelCount; k++)
+    {
+      blockValue = fAggregator.combine(blockValue, blockValue);
+      auto idx = static_cast<size_t>(k - 1);
+      std::fill(fLevels.begin() + fLevelOffsets[idx],
+                fLevels.begin() + fLevelOffsets[idx] + fLevelSizes[idx],
+                blockValue);
+    }
+
+    // we pretend that enough values have been pushed to fill the entire buffer and all the levels
+    fPushCount = int64{2} << fLevelCount;
+
+    // all the levels are consistent
+    fRebuildLevel = fLevelCount + 1;
+  }
+
+  /**
+   * Should be called right after each push in the underlying buffer
+   */
+  void onPush(CircularBuffer<T> const &iBuffer)
+  {
+    DCHECK_EQ_F(fBufferSize, iBuffer.getSize());
+
+    fPushCount++;
+
+    // level k completes a block every 2^k pushes
+    for(int k = 1; k <= fLevelCount; k++)
+    {
+      if((fPushCount & ((int64{1} << k) - 1)) != 0)
+        break;
+
+      computeBlock(iBuffer, k, (fPushCount >> k) - 1);
+    }
+  }
+
+  /**
+   * Recomputes every level from the underlying buffer (O(n)). Must be called when the aggregator changes in a way
+   * that changes the aggregate of the entries (for example a threshold).
+   */
+  void rebuild(CircularBuffer<T> const &iBuffer)
+  {
+    startRebuild(fAggregator);
+    continueRebuild(iBuffer, std::numeric_limits<int>::max());
+  }
+
+  /**
+   * Starts recomputing every level from the underlying buffer (see continueRebuild), replacing the aggregator with
+   * iAggregator. The aggregates are not consistent until the rebuild is complete.
+   */
+  void startRebuild(TAggregator iAggregator)
+  {
+    fAggregator = std::move(iAggregator);
+    fRebuildLevel = 1;
+    fRebuildBlock = 0;
+  }
+
+  /**
+   * Continues the rebuild (see startRebuild) for at most iMaxBlockCount blocks so that its cost can be spread over
+   * several calls. onPush can be called in between (the blocks are recomputed level by level, from the lowest one, and
+   * the blocks completed by a push are computed from the level below).
+   *
+   * @return true when the rebuild is complete
+   */
+  bool continueRebuild(CircularBuffer<T> const &iBuffer, int iMaxBlockCount)
+  {
+    DCHECK_EQ_F(fBufferSize, iBuffer.getSize());
+
+    while(fRebuildLevel <= fLevelCount)
+    {
+      auto const k = fRebuildLevel;
+
+      // only the blocks fully inside the buffer can be used by getAggregate (the range moves with the pushes)
+      int64 const blockSize = int64{1} << k;
+      int64 firstBlock = (fPushCount - fBufferSize + blockSize - 1) >> k;
+      int64 lastBlock = (fPushCount >> k) - 1;
+
+      fRebuildBlock = std::max(fRebuildBlock, firstBlock);
+      while(fRebuildBlock <= lastBlock)
+      {
+        if(iMaxBlockCount-- <= 0)
+          return false;
+
+        computeBlock(iBuffer, k, fRebuildBlock++);
+      }
+
+      fRebuildLevel++;
+      fRebuildBlock = 0;
+    }
+
+    return true;
+  }
+
+  // isRebuilding
+  inline bool isRebuilding() const { return fRebuildLevel <= fLevelCount; }
+
+  /**
+   * Computes the aggregate of the entries in the buffer for the range [iFromOffset, iToOffset[ using the same
+   * negative offsets as CircularBuffer (-1 being the most recent entry).
+   *
+   * @return the aggregate (identity when the range is empty)
+   */
+  value_type getAggregate(CircularBuffer<T> const &iBuffer, int iFromOffset, int iToOffset) const
+  {
+    DCHECK_F(iFromOffset >= -fBufferSize && iFromOffset <= iToOffset && iToOffset <= 0);
+
+    value_type res = fAggregator.identity();
+
+    int64 from = fPushCount + iFromOffset;
+    int64 const to = fPushCount + iToOffset;
+
+    while(from < to)
+    {
+      // find the biggest block starting at from and fitting in the range
+      int k = 0;
+      while(k < fLevelCount && (from & ((int64{2} << k) - 1)) == 0 && from + (int64{2} << k) <= to)
+        k++;
+
+      res = fAggregator.combine(res, getBlock(iBuffer, k, from >> k));
+
+      from += int64{1} << k;
+    }
+
+    return res;
+  }
+
+  // getBufferSize
+  inline int getBufferSize() const { return fBufferSize; }
+
+  // getAggregator
+  inline TAggregator const &getAggregator() const { return fAggregator; }
+
+  // getMemorySize (in bytes, levels only: the underlying buffer is not owned by the index)
+  inline size_t getMemorySize() const { return fLevels.size() * sizeof(value_type); }
+
+protected:
+  // the number of levels (above level 0) necessary for a buffer of size iBufferSize
+  static int computeLevelCount(int iBufferSize)
+  {
+    int levelCount = 0;
+    while((int64{2} << levelCount) <= iBufferSize)
+      levelCount++;
+    return levelCount;
+  }
+
+  // the aggregate of the block (at level 0, the block is just one entry in the buffer)
+  inline value_type getBlock(CircularBuffer<T> const &iBuffer, int iLevel, int64 iBlock) const
+  {
+    if(iLevel == 0)
+      return fAggregator.fromEntry(iBuffer.getAt(static_cast<int>(iBlock - fPushCount)));
+
+    auto idx = static_cast<size_t>(iLevel - 1);
+    return fLevels[fLevelOffsets[idx] + static_cast<int>(iBlock % fLevelSizes[idx])];
+  }
+
+  // computeBlock (from the 2 blocks of the level below)
+  inline void computeBlock(CircularBuffer<T> const &iBuffer, int iLevel, int64 iBlock)
+  {
+    auto left = getBlock(iBuffer, iLevel - 1, 2 * iBlock);
+    auto right = getBlock(iBuffer, iLevel - 1, 2 * iBlock + 1);
+    auto idx = static_cast<size_t>(iLevel - 1);
+    fLevels[fLevelOffsets[idx] + static_cast<int>(iBlock % fLevelSizes[idx])] = fAggregator.combine(left, right);
+  }
+
+protected:
+  int const fBufferSize;
+  int const fLevelCount;
+
+  TAggregator fAggregator;
+
+  // total number of entries pushed (absolute index of the next entry)
+  int64 fPushCount{int64{2} << fLevelCount};
+
+  // the block of the level being recomputed by continueRebuild (fLevelCount + 1 when there is no rebuild)
+  int fRebuildLevel{fLevelCount + 1};
+  int64 fRebuildBlock{0};
+
+  // all the levels are stored (as circular buffers) one after the other
+  std::vector<value_type> fLevels{};
+  std::vector<int> fLevelOffsets{};
+  std::vector<int> fLevelSizes{};
+};
+
+}
+}
+}
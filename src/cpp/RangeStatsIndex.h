@@ -0,0 +1,173 @@
+#pragma once
+
+#include <limits>
+#include <utility>
+#include "RangeIndex.h"
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+/**
+ * Statistics over a range of entries (the sum of the entries and the sum of their mean squares are used to compute
+ * the average peak and the RMS)
+ */
+template<typename T>
+struct RangeStats
+{
+  T fSum{0};
+  T fSumOfMeanSquares{0};
+  int fCountAboveThreshold{0};
+};
+
+/**
+ * Default conversion of an entry into the type of the sums
+ */
+template<typename T, typename S>
+struct StaticCastConverter
+{
+  inline S operator()(T iEntry) const { return static_cast<S>(iEntry); }
+};
+
+/**
+ * Aggregator for RangeIndex which computes the sum of the entries (computed with the type S which can be more precise
+ * than the type of the entries). Converter turns an entry into a value of type S (for entries which are encoded,
+ * like dB codes, the sum must be computed on the decoded values).
+ */
+template<typename T, typename S = T, typename Converter = StaticCastConverter<T, S>>
+struct RangeSumAggregator
+{
+  using value_type = S;
+
+  inline value_type fromEntry(T iEntry) const { return static_cast<S>(Converter{}(iEntry)); }
+  inline value_type combine(value_type iLeft, value_type iRight) const { return iLeft + iRight; }
+  inline value_type identity() const { return 0; }
+};
+
+/**
+ * Aggregator for RangeIndex which counts the entries strictly above a threshold (compared to the entries themselves)
+ */
+template<typename T>
+struct CountAboveThresholdAggregator
+{
+  using value_type = int;
+
+  T fThreshold{0};
+
+  inline value_type fromEntry(T iEntry) const { return iEntry > fThreshold ? 1 : 0; }
+  inline value_type combine(value_type iLeft, value_type iRight) const { return iLeft + iRight; }
+  inline value_type identity() const { return 0; }
+};
+
+/**
+ * Maintains the sum of the entries, the sum of their mean squares and the count above a threshold alongside a circular
+ * buffer of entries (the max of each batch of samples) and a companion circular buffer (same size, pushed at the same
+ * time) of their mean squares (the mean of the squares of the samples of each batch) so that they can be computed
+ * over any range of the buffers in O(log n) (see RangeIndex). Using a pyramid (instead of prefix sums) means that the
+ * sums never accumulate rounding errors no matter how many entries have been pushed.
+ *
+ * The sums do not depend on the threshold and the counts are maintained in a separate pyramid: when the threshold
+ * changes, the counts for the new threshold are computed in a second pyramid (which is O(n), but can be spread over
+ * several calls, see setThreshold) while the current one keeps being used, and the 2 are swapped once it is done.
+ */
+template<typename T, typename S = T, typename Converter = StaticCastConverter<T, S>>
+class RangeStatsIndex
+{
+public:
+  using SumIndex = RangeIndex<T, RangeSumAggregator<T, S, Converter>>;
+  using MeanSquaresSumIndex = RangeIndex<S, RangeSumAggregator<S>>;
+  using CountsIndex = RangeIndex<T, CountAboveThresholdAggregator<T>>;
+
+  // Constructor
+  RangeStatsIndex(int iBufferSize, T iThreshold) :
+    fSum{iBufferSize},
+    fMeanSquaresSum{iBufferSize},
+    fCountsA{iBufferSize, CountAboveThresholdAggregator<T>{iThreshold}},
+    fCountsB{iBufferSize, CountAboveThresholdAggregator<T>{iThreshold}}
+  {}
+
+  RangeStatsIndex(RangeStatsIndex const&) = delete;
+
+  /**
+   * Should be called when the underlying buffers are initialized with iValue and iMeanSquare (CircularBuffer::init)
+   */
+  void init(T iValue, S iMeanSquare)
+  {
+    fSum.init(iValue);
+    fMeanSquaresSum.init(iMeanSquare);
+    fCountsA.init(iValue);
+    fCountsB.init(iValue);
+  }
+
+  /**
+   * Should be called right after each push in the underlying buffers
+   */
+  void onPush(CircularBuffer<T> const &iBuffer, CircularBuffer<S> const &iMeanSquares)
+  {
+    fSum.onPush(iBuffer);
+    fMeanSquaresSum.onPush(iMeanSquares);
+    fCountsA.onPush(iBuffer);
+    fCountsB.onPush(iBuffer);
+  }
+
+  // getThreshold (the one used by getStats)
+  inline T getThreshold() const { return fCounts->getAggregator().fThreshold; }
+
+  /**
+   * Changes the threshold which requires recomputing the counts (O(n)): at most iMaxBlockCount blocks (see
+   * RangeIndex::continueRebuild) are recomputed per call and getStats keeps using the previous threshold until all of
+   * them are. The (same) threshold must then be set again (ex: once per block) to continue the change.
+   *
+   * @return true when iThreshold is the threshold used by getStats
+   */
+  bool setThreshold(CircularBuffer<T> const &iBuffer,
+                    T iThreshold,
+                    int iMaxBlockCount = std::numeric_limits<int>::max())
+  {
+    // (a change in progress to another threshold, if any, is abandoned)
+    if(iThreshold == getThreshold())
+      return true;
+
+    if(!fPendingCounts->isRebuilding() || iThreshold != fPendingCounts->getAggregator().fThreshold)
+      fPendingCounts->startRebuild(CountAboveThresholdAggregator<T>{iThreshold});
+
+    if(!fPendingCounts->continueRebuild(iBuffer, iMaxBlockCount))
+      return false;
+
+    std::swap(fCounts, fPendingCounts);
+    return true;
+  }
+
+  /**
+   * Computes the stats of the entries in the buffers for the range [iFromOffset, iToOffset[ (see
+   * RangeIndex::getAggregate)
+   */
+  inline RangeStats<S> getStats(CircularBuffer<T> const &iBuffer,
+                                CircularBuffer<S> const &iMeanSquares,
+                                int iFromOffset,
+                                int iToOffset) const
+  {
+    return {fSum.getAggregate(iBuffer, iFromOffset, iToOffset),
+            fMeanSquaresSum.getAggregate(iMeanSquares, iFromOffset, iToOffset),
+            fCounts->getAggregate(iBuffer, iFromOffset, iToOffset)};
+  }
+
+  // getMemorySize (in bytes, levels only: the underlying buffers are not owned by the index)
+  inline size_t getMemorySize() const
+  {
+    return fSum.getMemorySize() + fMeanSquaresSum.getMemorySize() + fCountsA.getMemorySize() + fCountsB.getMemorySize();
+  }
+
+private:
+  SumIndex fSum;
+  MeanSquaresSumIndex fMeanSquaresSum;
+  CountsIndex fCountsA;
+  CountsIndex fCountsB;
+
+  CountsIndex *fCounts{&fCountsA}; // used by getStats
+  CountsIndex *fPendingCounts{&fCountsB}; // being rebuilt for a new threshold (see setThreshold)
+};
+
+}
+}
+}
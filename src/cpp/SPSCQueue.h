@@ -0,0 +1,81 @@
+#pragma once
+
+#include <pongasoft/logging/loguru.hpp>
+#include <atomic>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+/**
+ * Lock free, wait free, fixed capacity queue for exactly one producer thread and one consumer thread (for example
+ * the audio thread and a background thread). All the memory is allocated in the constructor so that push and pop
+ * never allocate: an element is copied in/out of its slot.
+ */
+template<typename T>
+class SPSCQueue
+{
+public:
+  // Constructor
+  explicit SPSCQueue(int iCapacity) :
+    fSize{iCapacity + 1}, // one slot is always empty to distinguish full from empty
+    fElements(static_cast<size_t>(fSize))
+  {
+    DCHECK_GT_F(iCapacity, 0);
+  }
+
+  SPSCQueue(SPSCQueue const&) = delete;
+
+  /**
+   * Called by the producer thread only
+   *
+   * @return false if the queue is full (in which case the element is not added)
+   */
+  bool push(T const &iElement)
+  {
+    auto tail = fTail.load(std::memory_order_relaxed);
+    auto next = increment(tail);
+
+    if(next == fHead.load(std::memory_order_acquire))
+      return false;
+
+    fElements[tail] = iElement;
+    fTail.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Called by the consumer thread only
+   *
+   * @return false if the queue is empty (in which case oElement is not modified)
+   */
+  bool pop(T &oElement)
+  {
+    auto head = fHead.load(std::memory_order_relaxed);
+
+    if(head == fTail.load(std::memory_order_acquire))
+      return false;
+
+    oElement = fElements[head];
+    fHead.store(increment(head), std::memory_order_release);
+    return true;
+  }
+
+  // getCapacity
+  inline int getCapacity() const { return fSize - 1; }
+
+private:
+  inline int increment(int iIndex) const { return iIndex + 1 == fSize ? 0 : iIndex + 1; }
+
+  int const fSize;
+  std::vector<T> fElements;
+
+  // on separate cache lines since they are written by different threads
+  alignas(64) std::atomic<int> fHead{0}; // next element to pop (written by the consumer)
+  alignas(64) std::atomic<int> fTail{0}; // next slot to push to (written by the producer)
+};
+
+}
+}
+}
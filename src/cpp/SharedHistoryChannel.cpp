@@ -0,0 +1,81 @@
+#include <map>
+#include <mutex>
+#include <random>
+#include "SharedHistoryChannel.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+namespace {
+
+// the channels of this process (the processor and the controller of a plugin instance only share the id)
+std::mutex gRegistryMutex{};
+std::map<Steinberg::int64, std::weak_ptr<SharedHistoryChannel>> gRegistry{};
+Steinberg::int64 gLastId{0};
+
+}
+
+/////////////////////////////////////////
+// SharedHistoryChannel::create
+/////////////////////////////////////////
+std::shared_ptr<SharedHistoryChannel> SharedHistoryChannel::create()
+{
+  std::lock_guard<std::mutex> lock{gRegistryMutex};
+  std::shared_ptr<SharedHistoryChannel> channel{new SharedHistoryChannel(++gLastId)};
+  gRegistry[channel->getId()] = channel;
+  return channel;
+}
+
+/////////////////////////////////////////
+// SharedHistoryChannel::find
+/////////////////////////////////////////
+std::shared_ptr<SharedHistoryChannel> SharedHistoryChannel::find(int64 iProcessToken, int64 iId)
+{
+  if(iProcessToken != getProcessToken())
+    return nullptr;
+
+  std::lock_guard<std::mutex> lock{gRegistryMutex};
+  auto iter = gRegistry.find(iId);
+  return iter == gRegistry.end() ? nullptr : iter->second.lock();
+}
+
+/////////////////////////////////////////
+// SharedHistoryChannel::getProcessToken
+/////////////////////////////////////////
+SharedHistoryChannel::int64 SharedHistoryChannel::getProcessToken()
+{
+  static int64 const kProcessToken = [] {
+    std::random_device device;
+    return static_cast<int64>((static_cast<uint64_t>(device()) << 32) | device());
+  }();
+  return kProcessToken;
+}
+
+/////////////////////////////////////////
+// SharedHistoryChannel::resizeSnapshot
+/////////////////////////////////////////
+void SharedHistoryChannel::resizeSnapshot(int iNumChannels, int iEntriesPerHistory)
+{
+  std::lock_guard<std::mutex> lock{fSnapshotMutex};
+  invalidateSnapshot();
+  for(auto &snapshot : fSnapshots)
+  {
+    snapshot.fNumChannels = iNumChannels;
+    snapshot.fEntriesPerHistory = iEntriesPerHistory;
+    snapshot.fEntries.resize(static_cast<size_t>(snapshot.getNumHistories()) * iEntriesPerHistory);
+  }
+}
+
+/////////////////////////////////////////
+// SharedHistoryChannel::~SharedHistoryChannel
+/////////////////////////////////////////
+SharedHistoryChannel::~SharedHistoryChannel()
+{
+  std::lock_guard<std::mutex> lock{gRegistryMutex};
+  gRegistry.erase(fId);
+}
+
+}
+}
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <pluginterfaces/vst/vsttypes.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "TripleBuffer.h"
+#include "Metrics.h"
+#include "VAC6Model.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+using namespace VST::Common;
+
+/**
+ * Fast path for the history data (see HistoryData) when the processor and the controller live in the same process
+ * (the common case): while the editor is open, the processor writes the data in a triple buffer that the editor
+ * reads at its own frame rate, with no serialization and no host messaging. Otherwise (editor closed or controller
+ * in another process) the regular messaging is used.
+ *
+ * While paused, the channel also carries a snapshot of the (frozen) histories (see PausedHistorySnapshot) so that the
+ * editor can zoom and scroll on its own (see LocalHistoryNavigator) without involving the processor. The snapshot is
+ * double buffered: the processor always writes the one the editor is not reading.
+ *
+ * The runtime metrics of the processor (see ProcessMetrics) live in the channel as well so that the editor can display
+ * them (debug overlay) without any message.
+ *
+ * The channel is created by the processor and discovered by the controller through a message (MESSAGE_ID) sent on
+ * the connection between the 2. The message contains the id of the channel and a token identifying the process so
+ * that a controller living in another process never finds it. The channel is shared (std::shared_ptr) so that it
+ * remains valid whichever side goes away first.
+ */
+class SharedHistoryChannel
+{
+public:
+  using int64 = Steinberg::int64;
+
+  /**
+   * The max snapshot (see TieredHistory::copyMaxSnapshot) of every channel history followed by the loudness
+   * histories (momentary then short term), all of them having the same size
+   */
+  struct PausedHistorySnapshot
+  {
+    int fNumChannels{0};
+    int fEntriesPerHistory{0};
+    int64 fPushCounts[MAX_NUM_CHANNELS + 2]{};
+    std::vector<THistorySample> fEntries{};
+
+    // getNumHistories
+    inline int getNumHistories() const { return fNumChannels + 2; }
+
+    // getEntries (of a history)
+    inline THistorySample *getEntries(int iHistory) { return fEntries.data() + iHistory * fEntriesPerHistory; }
+    inline THistorySample const *getEntries(int iHistory) const { return fEntries.data() + iHistory * fEntriesPerHistory; }
+  };
+
+  static constexpr auto MESSAGE_ID = "VAC6SharedHistoryChannel";
+  static constexpr auto PROCESS_TOKEN_ATTR = "ProcessToken";
+  static constexpr auto CHANNEL_ID_ATTR = "ChannelID";
+
+  /**
+   * Creates a new channel (registered so that it can be found with find) - not realtime safe
+   */
+  static std::shared_ptr<SharedHistoryChannel> create();
+
+  /**
+   * @return the channel (nullptr if it was created in another process or does not exist anymore)
+   */
+  static std::shared_ptr<SharedHistoryChannel> find(int64 iProcessToken, int64 iId);
+
+  // getProcessToken (random token identifying this process)
+  static int64 getProcessToken();
+
+  SharedHistoryChannel(SharedHistoryChannel const&) = delete;
+
+  // Destructor (unregisters the channel)
+  ~SharedHistoryChannel();
+
+  // getId
+  inline int64 getId() const { return fId; }
+
+  //------------------------------------------------------------------------
+  // Processor (RT thread)
+  //------------------------------------------------------------------------
+
+  // isReaderAttached (when false, the regular messaging must be used)
+  inline bool isReaderAttached() const { return fIsReaderAttached.load(std::memory_order_acquire); }
+
+  // getWriteBuffer (see TripleBuffer)
+  inline HistoryData &getWriteBuffer() { return fBuffer.getWriteBuffer(); }
+
+  // publish (see TripleBuffer)
+  inline void publish() { fBuffer.publish(); }
+
+  //------------------------------------------------------------------------
+  // Editor (UI thread)
+  //------------------------------------------------------------------------
+
+  // setReaderAttached (while the editor is open)
+  inline void setReaderAttached(bool iIsReaderAttached)
+  {
+    fIsReaderAttached.store(iIsReaderAttached, std::memory_order_release);
+  }
+
+  /**
+   * @return true if the processor published new data since the last call (available in getReadBuffer())
+   */
+  inline bool update() { return fBuffer.update(); }
+
+  // getReadBuffer (see TripleBuffer)
+  inline HistoryData const &getReadBuffer() const { return fBuffer.getReadBuffer(); }
+
+  //------------------------------------------------------------------------
+  // Paused history snapshot
+  //------------------------------------------------------------------------
+
+  /**
+   * Allocates the snapshots (processor, not realtime safe: called from setupProcessing)
+   */
+  void resizeSnapshot(int iNumChannels, int iEntriesPerHistory);
+
+  // getSnapshotMemorySize (the 2 snapshots, in bytes)
+  inline size_t getSnapshotMemorySize() const
+  {
+    return (fSnapshots[0].fEntries.size() + fSnapshots[1].fEntries.size()) * sizeof(THistorySample);
+  }
+
+  /**
+   * Processor (RT thread): the histories are no longer frozen
+   */
+  inline void invalidateSnapshot()
+  {
+    // seq_cst: see beginSnapshot
+    fSnapshotId.store(0, std::memory_order_seq_cst);
+  }
+
+  /**
+   * Processor (RT thread): a new snapshot is about to be written (see getSnapshot). Invalidates the current one and
+   * selects the one the editor is not reading.
+   */
+  inline void beginSnapshot()
+  {
+    invalidateSnapshot();
+
+    // the store of the id (above) and the load of the snapshot being read (below) are ordered with the ones of
+    // readSnapshot (seq_cst): either the editor sees the invalidation or the processor sees what the editor reads
+    fWriteIndex = fReadIndex.load(std::memory_order_seq_cst) == 0 ? 1 : 0;
+  }
+
+  // getSnapshot (processor, RT thread, between beginSnapshot and publishSnapshot)
+  inline PausedHistorySnapshot &getSnapshot() { return fSnapshots[fWriteIndex]; }
+
+  // publishSnapshot (processor, RT thread: the snapshot is complete)
+  inline void publishSnapshot()
+  {
+    fPublishedIndex.store(fWriteIndex, std::memory_order_relaxed);
+    fSnapshotId.store(++fLastSnapshotId, std::memory_order_release);
+  }
+
+  // getSnapshotId (0 when no snapshot is available)
+  inline int64 getSnapshotId() const { return fSnapshotId.load(std::memory_order_acquire); }
+
+  /**
+   * Editor (UI thread): calls iReader(PausedHistorySnapshot const &) if the snapshot iSnapshotId is (still)
+   * available. The processor does not write the snapshot while iReader reads it.
+   *
+   * @return false if the snapshot is no longer available (in which case iReader is not called)
+   */
+  template<typename Reader>
+  bool readSnapshot(int64 iSnapshotId, Reader const &iReader) const
+  {
+    std::lock_guard<std::mutex> lock{fSnapshotMutex};
+
+    if(iSnapshotId == 0 || getSnapshotId() != iSnapshotId)
+      return false;
+
+    // the index published with iSnapshotId (the ids only increase so an unchanged id means an unchanged index)
+    int index = fPublishedIndex.load(std::memory_order_relaxed);
+
+    // marks the snapshot as being read then checks that it was not invalidated in the meantime (see beginSnapshot)
+    fReadIndex.store(index, std::memory_order_seq_cst);
+    bool isAvailable = fSnapshotId.load(std::memory_order_seq_cst) == iSnapshotId;
+
+    if(isAvailable)
+      iReader(fSnapshots[index]);
+
+    fReadIndex.store(-1, std::memory_order_release);
+
+    return isAvailable;
+  }
+
+  /**
+   * Editor (UI thread): the editor handles the zoom and scroll for the snapshot iSnapshotId (0 when it does not)
+   */
+  inline void setLocalNavigationSnapshotId(int64 iSnapshotId)
+  {
+    fLocalNavigationSnapshotId.store(iSnapshotId, std::memory_order_release);
+  }
+
+  /**
+   * Processor (RT thread)
+   *
+   * @return true if the editor handles the zoom and scroll of the current snapshot (in which case the processor does
+   *         not need to recompute the zoomed buffers while paused)
+   */
+  inline bool isLocalNavigation() const
+  {
+    auto snapshotId = getSnapshotId();
+    return snapshotId != 0 && fLocalNavigationSnapshotId.load(std::memory_order_acquire) == snapshotId;
+  }
+
+  //------------------------------------------------------------------------
+  // Metrics
+  //------------------------------------------------------------------------
+
+  // getMetrics (written by the processor, read by anyone, see ProcessMetrics)
+  inline ProcessMetrics &getMetrics() { return fMetrics; }
+  inline ProcessMetrics const &getMetrics() const { return fMetrics; }
+
+private:
+  explicit SharedHistoryChannel(int64 iId) : fId{iId} {}
+
+  int64 const fId;
+  std::atomic<bool> fIsReaderAttached{false};
+  TripleBuffer<HistoryData> fBuffer{};
+
+  // the processor never locks fSnapshotMutex (it only protects against a resize while the editor reads)
+  mutable std::mutex fSnapshotMutex{};
+  PausedHistorySnapshot fSnapshots[2]{};
+  std::atomic<int64> fSnapshotId{0};
+  std::atomic<int> fPublishedIndex{0}; // the snapshot fSnapshotId refers to
+  mutable std::atomic<int> fReadIndex{-1}; // the snapshot the editor is reading (-1 for none)
+  int fWriteIndex{0}; // RT thread only
+  int64 fLastSnapshotId{0}; // RT thread only
+  std::atomic<int64> fLocalNavigationSnapshotId{0};
+
+  ProcessMetrics fMetrics{};
+};
+
+}
+}
+}
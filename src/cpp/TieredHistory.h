@@ -0,0 +1,439 @@
+#pragma once
+
+#include <pluginterfaces/vst/vsttypes.h>
+#include <pongasoft/logging/loguru.hpp>
+#include <pongasoft/Utils/Collection/CircularBuffer.h>
+#include <algorithm>
+#include <vector>
+#include "MaxIndex.h"
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+using namespace pongasoft::Utils::Collection;
+
+/**
+ * Long history of (positive) entries stored at several resolutions so that its size does not grow linearly with its
+ * length:
+ *
+ * - tier 0 is the full resolution history (the most recent iFullResolutionSize entries)
+ * - tier k (k >= 1) stores the max, min and average of each (aligned) group of iTierFactor^k consecutive entries
+ *   (for example 50ms, 500ms and 5s for a full resolution of 5ms and a factor of 10). Each tier is filled
+ *   incrementally from the tier below it when a group completes and holds at most iFullResolutionSize entries.
+ *
+ * Tiers are added until the history covers iHistorySize entries (at full resolution). The whole history is then
+ * addressed with the same negative offsets as CircularBuffer (-1 being the most recent entry, -iHistorySize the
+ * oldest) and each query is answered using the most recent data available at the resolution requested.
+ */
+template<typename T>
+class TieredHistory
+{
+public:
+  using int64 = Steinberg::int64;
+
+  /**
+   * max, min and average of the entries represented by one entry of a tier (all equal for tier 0). The average is
+   * the average of the entries themselves so when they are dB codes (see DbCode) it is an average in dB.
+   */
+  struct TierEntry
+  {
+    T fMax;
+    T fMin;
+    T fAverage;
+  };
+
+  // Constructor
+  TieredHistory(int iFullResolutionSize, int iHistorySize, int iTierFactor) :
+    fHistorySize{iHistorySize},
+    fBuffer{new CircularBuffer<T>(iFullResolutionSize)},
+    fMaxIndex{new MaxIndex<T>(iFullResolutionSize)}
+  {
+    DCHECK_GT_F(iFullResolutionSize, 0);
+    DCHECK_F(iTierFactor > 1 && iTierFactor <= iFullResolutionSize);
+
+    int resolution = 1;
+    int64 coverage = iFullResolutionSize;
+    while(coverage < iHistorySize)
+    {
+      resolution *= iTierFactor;
+      int size = std::min(iFullResolutionSize, (iHistorySize + resolution - 1) / resolution);
+      fTiers.emplace_back(new Tier(resolution, iTierFactor, size));
+      coverage = int64{size} * resolution;
+    }
+
+    init(0);
+  }
+
+  TieredHistory(TieredHistory const&) = delete;
+
+  // Destructor
+  ~TieredHistory()
+  {
+    for(auto tier : fTiers)
+      delete tier;
+    delete fMaxIndex;
+    delete fBuffer;
+  }
+
+  // init (every tier is filled with iValue)
+  void init(T iValue)
+  {
+    fBuffer->init(iValue);
+    fMaxIndex->init(iValue);
+    for(auto tier : fTiers)
+      tier->init(iValue);
+    fPushCount = 0;
+  }
+
+  /**
+   * Pushes a new (full resolution) entry. The coarser tiers are updated when their group completes so that the
+   * amortized cost is O(1).
+   *
+   * @return true when the coarsest tier got a new entry (getTierEntry(getTierCount() - 1, -1))
+   */
+  bool push(T iEntry)
+  {
+    fBuffer->push(iEntry);
+    fMaxIndex->onPush(*fBuffer);
+    fPushCount++;
+
+    TierEntry entry{iEntry, iEntry, iEntry};
+    for(auto tier : fTiers)
+    {
+      if(!tier->accumulate(entry))
+        return false;
+    }
+
+    return true;
+  }
+
+  // getBuffer (the full resolution history = tier 0)
+  inline CircularBuffer<T> const &getBuffer() const { return *fBuffer; }
+
+  // getMaxIndex (maintained alongside getBuffer())
+  inline MaxIndex<T> const &getMaxIndex() const { return *fMaxIndex; }
+
+  // getPushCount (total number of entries pushed since init = absolute index of the next entry)
+  inline int64 getPushCount() const { return fPushCount; }
+
+  // getHistorySize (number of full resolution entries covered by the history)
+  inline int getHistorySize() const { return fHistorySize; }
+
+  // getTierCount (including tier 0)
+  inline int getTierCount() const { return static_cast<int>(fTiers.size()) + 1; }
+
+  // getTierResolution (number of full resolution entries represented by one entry of the tier)
+  inline int getTierResolution(int iTier) const { return iTier == 0 ? 1 : getTier(iTier)->fResolution; }
+
+  // getTierSize (number of entries stored by the tier)
+  inline int getTierSize(int iTier) const { return iTier == 0 ? fBuffer->getSize() : getTier(iTier)->fSize; }
+
+  /**
+   * @return the coarsest tier for which one entry does not represent more than iNumEntries full resolution entries
+   */
+  int findTier(int iNumEntries) const
+  {
+    int tier = 0;
+    while(tier + 1 < getTierCount() && getTierResolution(tier + 1) <= iNumEntries)
+      tier++;
+    return tier;
+  }
+
+  /**
+   * @param iOffset negative offset in the tier (-1 being the most recent complete entry of the tier)
+   */
+  TierEntry getTierEntry(int iTier, int iOffset) const
+  {
+    if(iTier == 0)
+    {
+      auto entry = fBuffer->getAt(iOffset);
+      return {entry, entry, entry};
+    }
+
+    auto tier = getTier(iTier);
+    return {tier->fMaxBuffer.getAt(iOffset), tier->fMinBuffer.getAt(iOffset), tier->fAverageBuffer.getAt(iOffset)};
+  }
+
+  /**
+   * Computes the max of the entries [iFromOffset, iToOffset[ (full resolution offsets) using tier iTier (or finer
+   * for the most recent entries which are not yet part of tier iTier, or coarser for the entries which are too old).
+   * When the range is not aligned on the entries of the tier used, the range is extended to the entries
+   * overlapping it (so the max is never smaller than the actual max). With iTier == 0 the max is exact for the
+   * entries still available at full resolution. The cost is O(log n).
+   *
+   * @return the max (or 0 when the range is empty)
+   */
+  T getMax(int iFromOffset, int iToOffset, int iTier = 0) const
+  {
+    T max = 0;
+    forEachSegment(iFromOffset, iToOffset, iTier, [this, &max] (int iTier, int iFrom, int iTo, int, int) {
+      auto tierMax = iTier == 0 ? fMaxIndex->getMax(*fBuffer, iFrom, iTo) :
+                                  getTier(iTier)->fMaxIndex.getMax(getTier(iTier)->fMaxBuffer, iFrom, iTo);
+      max = std::max(max, tierMax);
+    });
+    return max;
+  }
+
+  /**
+   * Same as getMax but also returns the (full resolution) offset of the first (oldest) entry which gives the max
+   * (oMaxOffset is left untouched when the max is 0). The entries are scanned so the cost is proportional to the
+   * number of tier entries in the range which is why iTier should be the coarsest tier possible (see findTier).
+   */
+  T findMax(int iFromOffset, int iToOffset, int iTier, int &oMaxOffset) const
+  {
+    T max = 0;
+    forEachSegment(iFromOffset, iToOffset, iTier,
+                   [this, &max, &oMaxOffset, iFromOffset, iToOffset] (int iTier, int iFrom, int iTo, int iNewestOffset, int iResolution) {
+      for(int i = iFrom; i < iTo; i++)
+      {
+        auto entry = getTierEntry(iTier, i).fMax;
+        if(entry > max)
+        {
+          max = entry;
+          // first full resolution entry of the tier entry (which may be outside the range when not aligned)
+          oMaxOffset = std::min(std::max(iNewestOffset + i * iResolution, iFromOffset), iToOffset - 1);
+        }
+      }
+    });
+    return max;
+  }
+
+  /**
+   * @return the number of entries of a max snapshot (the max entries of every tier, see copyMaxSnapshot)
+   */
+  int getMaxSnapshotSize() const
+  {
+    int res = 0;
+    for(int tier = 0; tier < getTierCount(); tier++)
+      res += getTierSize(tier);
+    return res;
+  }
+
+  /**
+   * Copies the entries [iFrom, iFrom + iCount[ of the max snapshot of the history: the max entries of every tier (tier
+   * 0 first), from the oldest to the most recent. Can be called in several steps (to bound the cost of each call)
+   * as long as the history does not change in between.
+   */
+  void copyMaxSnapshot(int iFrom, int iCount, T *oEntries) const
+  {
+    DCHECK_F(iFrom >= 0 && iCount >= 0 && iFrom + iCount <= getMaxSnapshotSize());
+
+    int tierStart = 0;
+    for(int tier = 0; tier < getTierCount() && iCount > 0; tier++)
+    {
+      int tierSize = getTierSize(tier);
+      CircularBuffer<T> const &buffer = tier == 0 ? *fBuffer : getTier(tier)->fMaxBuffer;
+      while(iCount > 0 && iFrom < tierStart + tierSize)
+      {
+        *oEntries++ = buffer.getAt(iFrom - tierStart - tierSize);
+        iFrom++;
+        iCount--;
+      }
+      tierStart += tierSize;
+    }
+  }
+
+  /**
+   * Restores the history from a max snapshot (see copyMaxSnapshot) of a history with the same sizes. Only the max
+   * is available (min and average are set to the max) which is enough for getMax and findMax to return the same
+   * results as the original history. The groups being accumulated by the original history are lost (they are only
+   * used by subsequent pushes).
+   *
+   * @param iPushCount the push count of the original history (see getPushCount)
+   */
+  void restoreMaxSnapshot(int64 iPushCount, T const *iEntries)
+  {
+    init(0);
+
+    for(int i = 0; i < fBuffer->getSize(); i++)
+    {
+      fBuffer->push(*iEntries++);
+      fMaxIndex->onPush(*fBuffer);
+    }
+
+    for(auto tier : fTiers)
+    {
+      for(int i = 0; i < tier->fSize; i++)
+      {
+        auto entry = *iEntries++;
+        tier->fMaxBuffer.push(entry);
+        tier->fMaxIndex.onPush(tier->fMaxBuffer);
+        tier->fMinBuffer.push(entry);
+        tier->fAverageBuffer.push(entry);
+      }
+    }
+
+    fPushCount = iPushCount;
+  }
+
+  // getMemorySize (in bytes, all tiers and indices included)
+  size_t getMemorySize() const
+  {
+    size_t res = sizeof(*this) + fBuffer->getSize() * sizeof(T) + fMaxIndex->getMemorySize();
+    for(auto tier : fTiers)
+      res += sizeof(*tier) + 3 * tier->fSize * sizeof(T) + tier->fMaxIndex.getMemorySize();
+    return res;
+  }
+
+private:
+  /**
+   * A coarse tier: max/min/average buffers (and the index for the max) plus the group being accumulated
+   */
+  struct Tier
+  {
+    Tier(int iResolution, int iFactor, int iSize) :
+      fResolution{iResolution},
+      fFactor{iFactor},
+      fSize{iSize},
+      fMaxBuffer(iSize),
+      fMinBuffer(iSize),
+      fAverageBuffer(iSize),
+      fMaxIndex(iSize)
+    {
+    }
+
+    void init(T iValue)
+    {
+      fMaxBuffer.init(iValue);
+      fMinBuffer.init(iValue);
+      fAverageBuffer.init(iValue);
+      fMaxIndex.init(iValue);
+      fAccumulatedCount = 0;
+    }
+
+    /**
+     * Accumulates an entry of the tier below. When the group is complete, ioEntry is replaced by the new entry of
+     * this tier (to be accumulated by the next tier) and true is returned.
+     */
+    bool accumulate(TierEntry &ioEntry)
+    {
+      if(fAccumulatedCount == 0)
+      {
+        fAccumulated = ioEntry;
+        fAverageSum = ioEntry.fAverage;
+      }
+      else
+      {
+        fAccumulated.fMax = std::max(fAccumulated.fMax, ioEntry.fMax);
+        fAccumulated.fMin = std::min(fAccumulated.fMin, ioEntry.fMin);
+        fAverageSum += ioEntry.fAverage;
+      }
+
+      if(++fAccumulatedCount < fFactor)
+        return false;
+
+      fAccumulated.fAverage = static_cast<T>(fAverageSum / fFactor);
+
+      fMaxBuffer.push(fAccumulated.fMax);
+      fMaxIndex.onPush(fMaxBuffer);
+      fMinBuffer.push(fAccumulated.fMin);
+      fAverageBuffer.push(fAccumulated.fAverage);
+
+      ioEntry = fAccumulated;
+      fAccumulatedCount = 0;
+
+      return true;
+    }
+
+    int const fResolution;
+    int const fFactor;
+    int const fSize;
+
+    CircularBuffer<T> fMaxBuffer;
+    CircularBuffer<T> fMinBuffer;
+    CircularBuffer<T> fAverageBuffer;
+    MaxIndex<T> fMaxIndex; // maintained alongside fMaxBuffer
+
+    TierEntry fAccumulated{};
+    double fAverageSum{0}; // T may be too small to hold the sum (16 bits codes for example)
+    int fAccumulatedCount{0};
+  };
+
+  inline Tier const *getTier(int iTier) const
+  {
+    DCHECK_F(iTier > 0 && iTier < getTierCount());
+    return fTiers[iTier - 1];
+  }
+
+  /**
+   * (Full resolution) offset right after the most recent complete entry of the tier (the entries pushed since
+   * then are not yet part of the tier).
+   */
+  inline int getNewestOffset(int iTier) const
+  {
+    return iTier == 0 ? 0 : -static_cast<int>(fPushCount % getTierResolution(iTier));
+  }
+
+  // (Full resolution) offset of the oldest entry of the tier
+  inline int getOldestOffset(int iTier) const
+  {
+    return getNewestOffset(iTier) - getTierSize(iTier) * getTierResolution(iTier);
+  }
+
+  /**
+   * Splits the range [iFromOffset, iToOffset[ into segments, each served by one tier, and calls
+   * iCallback(tier, tierFromOffset, tierToOffset, newestOffset, resolution) for each non empty one, from the oldest
+   * to the most recent. The tier offsets are extended to the entries overlapping the segment.
+   *
+   * - the tiers coarser than iTier serve the entries older than what the tier below them covers
+   * - iTier serves the entries from its oldest to its most recent complete entry
+   * - the tiers finer than iTier serve the most recent entries (not yet part of the tier above them)
+   */
+  template<typename Callback>
+  void forEachSegment(int iFromOffset, int iToOffset, int iTier, Callback const &iCallback) const
+  {
+    DCHECK_F(iFromOffset >= -fHistorySize && iFromOffset <= iToOffset && iToOffset <= 0);
+    DCHECK_F(iTier >= 0 && iTier < getTierCount());
+
+    auto segment = [this, iFromOffset, iToOffset, &iCallback] (int iTier, int iSegmentFrom, int iSegmentTo) {
+      int from = std::max(iFromOffset, iSegmentFrom);
+      int to = std::min(iToOffset, iSegmentTo);
+      if(from >= to)
+        return;
+
+      int newestOffset = getNewestOffset(iTier);
+      int resolution = getTierResolution(iTier);
+
+      // rounding outward (floor division of negative numbers)
+      int tierFrom = -((newestOffset - from + resolution - 1) / resolution);
+      int tierTo = -((newestOffset - to) / resolution);
+
+      tierFrom = std::max(tierFrom, -getTierSize(iTier));
+      tierTo = std::min(tierTo, 0);
+
+      if(tierFrom < tierTo)
+        iCallback(iTier, tierFrom, tierTo, newestOffset, resolution);
+    };
+
+    // coarser tiers (oldest first)
+    for(int tier = getTierCount() - 1; tier > iTier; tier--)
+    {
+      segment(tier, getOldestOffset(tier), getOldestOffset(tier - 1));
+    }
+
+    // requested tier
+    segment(iTier, getOldestOffset(iTier), getNewestOffset(iTier));
+
+    // finer tiers (most recent entries)
+    for(int tier = iTier - 1; tier >= 0; tier--)
+    {
+      segment(tier, getNewestOffset(tier + 1), getNewestOffset(tier));
+    }
+  }
+
+private:
+  int const fHistorySize;
+
+  CircularBuffer<T> *const fBuffer; // tier 0
+  MaxIndex<T> *const fMaxIndex; // maintained alongside fBuffer
+
+  std::vector<Tier *> fTiers{}; // tiers 1..n
+
+  // total number of entries pushed (modulo is used to know how far each tier is behind tier 0)
+  int64 fPushCount{0};
+};
+
+}
+}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+/**
+ * Lock free, wait free "latest value" channel for exactly one writer thread and one reader thread (for example the
+ * audio thread and the UI thread): the writer fills the write buffer and publishes it, the reader gets the most
+ * recently published buffer (the values published in between are skipped). Neither side ever waits for the other or
+ * copies more than the value being written/read since the 3 buffers are only exchanged (by index):
+ *
+ * - the write buffer (owned by the writer)
+ * - the middle buffer (the last one published, flagged when the reader did not get it yet)
+ * - the read buffer (owned by the reader)
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+  // Constructor
+  TripleBuffer() = default;
+
+  TripleBuffer(TripleBuffer const&) = delete;
+
+  /**
+   * Called by the writer thread only
+   *
+   * @return the buffer to write the next value to (its content is a previous value)
+   */
+  inline T &getWriteBuffer() { return fBuffers[fWriteIndex]; }
+
+  /**
+   * Called by the writer thread only: the write buffer becomes the latest value (the write buffer is then another
+   * one)
+   */
+  void publish()
+  {
+    auto previous = fMiddle.exchange(fWriteIndex | NEW_VALUE_FLAG, std::memory_order_acq_rel);
+    fWriteIndex = previous & INDEX_MASK;
+  }
+
+  /**
+   * Called by the reader thread only: the latest value published (if the reader did not get it yet) becomes the
+   * read buffer
+   *
+   * @return true if there was a new value (false means getReadBuffer() did not change)
+   */
+  bool update()
+  {
+    if((fMiddle.load(std::memory_order_relaxed) & NEW_VALUE_FLAG) == 0)
+      return false;
+
+    auto previous = fMiddle.exchange(fReadIndex, std::memory_order_acq_rel);
+    fReadIndex = previous & INDEX_MASK;
+    return true;
+  }
+
+  /**
+   * Called by the reader thread only
+   *
+   * @return the last value obtained with update()
+   */
+  inline T const &getReadBuffer() const { return fBuffers[fReadIndex]; }
+
+private:
+  static constexpr int INDEX_MASK = 3;
+  static constexpr int NEW_VALUE_FLAG = 4;
+
+  T fBuffers[3]{};
+
+  // on separate cache lines since they are written by different threads
+  alignas(64) int fWriteIndex{0}; // written by the writer
+  alignas(64) std::atomic<int> fMiddle{1}; // index of the middle buffer (+ NEW_VALUE_FLAG), written by both
+  alignas(64) int fReadIndex{2}; // written by the reader
+};
+
+}
+}
+}
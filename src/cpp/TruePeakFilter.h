@@ -0,0 +1,282 @@
+#pragma once
+
+#include <pluginterfaces/vst/vsttypes.h>
+#include <algorithm>
+#include <type_traits>
+#include "VAC6Constants.h"
+#include "PeakKernel.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+/**
+ * True peak (inter-sample peak) detection as described in ITU-R BS.1770-4 Annex 2: the signal is oversampled 4x with
+ * a 48 taps polyphase FIR filter (4 phases of 12 taps) and the true peak is the max of the absolute values of the
+ * oversampled signal.
+ *
+ * The filter keeps the last few samples of the previous call (state) so it must be used for one channel only and fed
+ * with consecutive samples.
+ */
+class TruePeakFilter
+{
+public:
+  static constexpr int NUM_PHASES = 4;
+  static constexpr int NUM_TAPS = 12; // per phase
+  static constexpr int HISTORY_SIZE = NUM_TAPS - 1;
+
+  // Constructor
+  TruePeakFilter() { reset(); }
+
+  // reset (forgets the previous samples)
+  inline void reset() { std::fill(fHistory, fHistory + HISTORY_SIZE, 0); }
+
+  /**
+   * Processes iNumSamples samples (multiplied by iGain in the precision of the samples, like PeakKernel) and returns
+   * the max of the absolute values of the oversampled signal. 32 bits samples are filtered as floats (4 phases per
+   * SSE2 register), 64 bits samples as doubles.
+   *
+   * @param iIn the input samples (nullptr means silence)
+   */
+  template<typename SampleType>
+  TSample process(SampleType const *iIn, int iNumSamples, double iGain);
+
+  /**
+   * Reference (non vectorized) implementation of the filter: iBuffer contains HISTORY_SIZE samples followed by
+   * iNumSamples samples and the max is computed over the iNumSamples * NUM_PHASES oversampled values (in the
+   * precision of the buffer)
+   */
+  template<typename T>
+  static TSample scalarComputeMax(T const *iBuffer, int iNumSamples);
+
+  // computeMax (vectorized when possible)
+  static TSample computeMax(Sample64 const *iBuffer, int iNumSamples);
+  static TSample computeMax(Sample32 const *iBuffer, int iNumSamples);
+
+private:
+  // samples are processed in chunks (on the stack) to avoid any allocation
+  static constexpr int CHUNK_SIZE = 64;
+
+  /**
+   * Coefficients from ITU-R BS.1770-4 (Table in Annex 2) stored tap first so that the 4 phases of a tap are
+   * contiguous (which is what the vectorized implementation needs).
+   */
+  alignas(16) static constexpr double COEFFICIENTS[NUM_TAPS][NUM_PHASES] = {
+    {  0.0017089843750, -0.0291748046875, -0.0189208984375, -0.0083007812500 },
+    {  0.0109863281250,  0.0292968750000,  0.0330810546875,  0.0148925781250 },
+    { -0.0196533203125, -0.0517578125000, -0.0582275390625, -0.0266113281250 },
+    {  0.0332031250000,  0.0891113281250,  0.1015625000000,  0.0476074218750 },
+    { -0.0594482421875, -0.1665039062500, -0.2003173828125, -0.1022949218750 },
+    {  0.1373291015625,  0.4650878906250,  0.7797851562500,  0.9721679687500 },
+    {  0.9721679687500,  0.7797851562500,  0.4650878906250,  0.1373291015625 },
+    { -0.1022949218750, -0.2003173828125, -0.1665039062500, -0.0594482421875 },
+    {  0.0476074218750,  0.1015625000000,  0.0891113281250,  0.0332031250000 },
+    { -0.0266113281250, -0.0582275390625, -0.0517578125000, -0.0196533203125 },
+    {  0.0148925781250,  0.0330810546875,  0.0292968750000,  0.0109863281250 },
+    { -0.0083007812500, -0.0189208984375, -0.0291748046875,  0.0017089843750 }
+  };
+
+  TSample fHistory[HISTORY_SIZE];
+};
+
+///////////////////////////////////////////
+// TruePeakFilter::process
+///////////////////////////////////////////
+template<typename SampleType>
+TSample TruePeakFilter::process(SampleType const *iIn, int iNumSamples, double iGain)
+{
+  // silence after silence (the history is all 0) => nothing to compute
+  if(!iIn && std::all_of(fHistory, fHistory + HISTORY_SIZE, [](TSample s) { return s == 0; }))
+    return 0;
+
+  // 32 bits samples are filtered in 32 bits precision (the gain is converted to float once, like PeakKernel)
+  using T = std::conditional_t<std::is_same<SampleType, Sample32>::value, Sample32, TSample>;
+  auto const gain = static_cast<T>(iGain);
+
+  // the history followed by the (gain adjusted) samples of the chunk
+  T buffer[HISTORY_SIZE + CHUNK_SIZE];
+  std::copy(fHistory, fHistory + HISTORY_SIZE, buffer);
+
+  TSample max = 0;
+
+  int i = 0;
+  while(i < iNumSamples)
+  {
+    int chunkSize = std::min(CHUNK_SIZE, iNumSamples - i);
+
+    T *chunk = buffer + HISTORY_SIZE;
+    for(int k = 0; k < chunkSize; k++)
+      chunk[k] = iIn ? static_cast<T>(iIn[i + k]) * gain : 0;
+
+    TSample chunkMax = computeMax(buffer, chunkSize);
+    if(chunkMax > max)
+      max = chunkMax;
+
+    // the end of the chunk becomes the history of the next one
+    std::copy(buffer + chunkSize, buffer + chunkSize + HISTORY_SIZE, buffer);
+
+    i += chunkSize;
+  }
+
+  std::copy(buffer, buffer + HISTORY_SIZE, fHistory);
+
+  return max;
+}
+
+///////////////////////////////////////////
+// TruePeakFilter::scalarComputeMax
+///////////////////////////////////////////
+template<typename T>
+TSample TruePeakFilter::scalarComputeMax(T const *iBuffer, int iNumSamples)
+{
+  T max = 0;
+
+  for(int n = 0; n < iNumSamples; n++)
+  {
+    // most recent sample is multiplied by the first tap
+    T const *x = iBuffer + n + HISTORY_SIZE;
+
+    for(int p = 0; p < NUM_PHASES; p++)
+    {
+      T sample = 0;
+      for(int j = 0; j < NUM_TAPS; j++)
+        sample += x[-j] * static_cast<T>(COEFFICIENTS[j][p]);
+
+      T absSample = sample < 0 ? -sample : sample;
+      if(absSample > max)
+        max = absSample;
+    }
+  }
+
+  return max;
+}
+
+#if VAC6_PEAK_KERNEL_SSE2
+
+///////////////////////////////////////////
+// TruePeakFilter::computeMax (64 bits / SSE2)
+///////////////////////////////////////////
+/**
+ * Consecutive output samples are computed in parallel (2 per register, one register per phase): for each tap, the
+ * input samples are loaded as is (unaligned load) and multiplied by the coefficient of the tap broadcast once per
+ * call. There is no shuffle in the inner loop and the sums are computed in the same order as the scalar
+ * implementation.
+ */
+inline TSample TruePeakFilter::computeMax(Sample64 const *iBuffer, int iNumSamples)
+{
+  __m128d coefficients[NUM_TAPS][NUM_PHASES];
+  for(int j = 0; j < NUM_TAPS; j++)
+    for(int p = 0; p < NUM_PHASES; p++)
+      coefficients[j][p] = _mm_set1_pd(COEFFICIENTS[j][p]);
+
+  auto const signMask = _mm_set1_pd(-0.0);
+  auto max = _mm_setzero_pd();
+
+  int n = 0;
+
+  for(; n + 2 <= iNumSamples; n += 2)
+  {
+    Sample64 const *x = iBuffer + n + HISTORY_SIZE;
+
+    auto phase0 = _mm_setzero_pd();
+    auto phase1 = _mm_setzero_pd();
+    auto phase2 = _mm_setzero_pd();
+    auto phase3 = _mm_setzero_pd();
+
+    for(int j = 0; j < NUM_TAPS; j++)
+    {
+      auto samples = _mm_loadu_pd(x - j);
+      phase0 = _mm_add_pd(phase0, _mm_mul_pd(samples, coefficients[j][0]));
+      phase1 = _mm_add_pd(phase1, _mm_mul_pd(samples, coefficients[j][1]));
+      phase2 = _mm_add_pd(phase2, _mm_mul_pd(samples, coefficients[j][2]));
+      phase3 = _mm_add_pd(phase3, _mm_mul_pd(samples, coefficients[j][3]));
+    }
+
+    max = _mm_max_pd(_mm_andnot_pd(signMask, phase0), max);
+    max = _mm_max_pd(_mm_andnot_pd(signMask, phase1), max);
+    max = _mm_max_pd(_mm_andnot_pd(signMask, phase2), max);
+    max = _mm_max_pd(_mm_andnot_pd(signMask, phase3), max);
+  }
+
+  TSample vectorMax = PeakKernel::horizontalMax(max);
+
+  // remaining sample (if any)
+  TSample tailMax = scalarComputeMax(iBuffer + n, iNumSamples - n);
+
+  return tailMax > vectorMax ? tailMax : vectorMax;
+}
+
+///////////////////////////////////////////
+// TruePeakFilter::computeMax (32 bits / SSE2)
+///////////////////////////////////////////
+/**
+ * Same as the 64 bits version with 4 output samples per register. The coefficients are multiples of 2^-16 so
+ * converting them to floats does not change them.
+ */
+inline TSample TruePeakFilter::computeMax(Sample32 const *iBuffer, int iNumSamples)
+{
+  __m128 coefficients[NUM_TAPS][NUM_PHASES];
+  for(int j = 0; j < NUM_TAPS; j++)
+    for(int p = 0; p < NUM_PHASES; p++)
+      coefficients[j][p] = _mm_set1_ps(static_cast<Sample32>(COEFFICIENTS[j][p]));
+
+  auto const signMask = _mm_set1_ps(-0.0f);
+  auto max = _mm_setzero_ps();
+
+  int n = 0;
+
+  for(; n + 4 <= iNumSamples; n += 4)
+  {
+    Sample32 const *x = iBuffer + n + HISTORY_SIZE;
+
+    auto phase0 = _mm_setzero_ps();
+    auto phase1 = _mm_setzero_ps();
+    auto phase2 = _mm_setzero_ps();
+    auto phase3 = _mm_setzero_ps();
+
+    for(int j = 0; j < NUM_TAPS; j++)
+    {
+      auto samples = _mm_loadu_ps(x - j);
+      phase0 = _mm_add_ps(phase0, _mm_mul_ps(samples, coefficients[j][0]));
+      phase1 = _mm_add_ps(phase1, _mm_mul_ps(samples, coefficients[j][1]));
+      phase2 = _mm_add_ps(phase2, _mm_mul_ps(samples, coefficients[j][2]));
+      phase3 = _mm_add_ps(phase3, _mm_mul_ps(samples, coefficients[j][3]));
+    }
+
+    max = _mm_max_ps(_mm_andnot_ps(signMask, phase0), max);
+    max = _mm_max_ps(_mm_andnot_ps(signMask, phase1), max);
+    max = _mm_max_ps(_mm_andnot_ps(signMask, phase2), max);
+    max = _mm_max_ps(_mm_andnot_ps(signMask, phase3), max);
+  }
+
+  TSample vectorMax = PeakKernel::horizontalMax(max);
+
+  // remaining samples (less than 4)
+  TSample tailMax = scalarComputeMax(iBuffer + n, iNumSamples - n);
+
+  return tailMax > vectorMax ? tailMax : vectorMax;
+}
+
+#else
+
+///////////////////////////////////////////
+// TruePeakFilter::computeMax (no SIMD)
+///////////////////////////////////////////
+inline TSample TruePeakFilter::computeMax(Sample64 const *iBuffer, int iNumSamples)
+{
+  return scalarComputeMax(iBuffer, iNumSamples);
+}
+
+inline TSample TruePeakFilter::computeMax(Sample32 const *iBuffer, int iNumSamples)
+{
+  return scalarComputeMax(iBuffer, iNumSamples);
+}
+
+#endif
+
+}
+}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <pluginterfaces/vst/vsttypes.h>
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+/**
+ * Decides (RT side, once per block) when to send an update to the UI: only when something visible changed since the
+ * last update and at most once every iMinIntervalInSamples (max frame rate). What is visible is tracked by a
+ * generation (provided by the caller) which must change every time something visible changes.
+ *
+ * Since RT does not know when a UI gets opened, an update is also sent every iMaxIntervalInSamples when nothing
+ * changed (0 means never).
+ *
+ * The updates that a fixed rate (one every iMinIntervalInSamples) would have sent but which were skipped because
+ * nothing changed are counted (see getSuppressedCount()).
+ */
+class UIUpdateScheduler
+{
+public:
+  using int64 = Steinberg::int64;
+  using uint32 = Steinberg::uint32;
+
+  // Constructor
+  explicit UIUpdateScheduler(uint32 iMinIntervalInSamples = 0, uint32 iMaxIntervalInSamples = 0) :
+    fMinIntervalInSamples{iMinIntervalInSamples},
+    fMaxIntervalInSamples{iMaxIntervalInSamples}
+  {}
+
+  /**
+   * Called once per block
+   *
+   * @param iNumSamples the number of samples of the block
+   * @param iGeneration the generation of what is visible
+   * @param iForce to send an update right away (whatever the generation or the max frame rate)
+   * @return true if an update must be sent
+   */
+  bool shouldUpdate(uint32 iNumSamples, int64 iGeneration, bool iForce = false)
+  {
+    fSamplesSinceUpdate += iNumSamples;
+
+    if(!iForce)
+    {
+      if(fSamplesSinceUpdate < fMinIntervalInSamples)
+        return false;
+
+      if(iGeneration == fGeneration && (fMaxIntervalInSamples == 0 || fSamplesSinceUpdate < fMaxIntervalInSamples))
+        return false;
+    }
+
+    fSuppressedCount += getPendingSuppressedCount();
+    fUpdateCount++;
+    fGeneration = iGeneration;
+    fSamplesSinceUpdate = 0;
+    return true;
+  }
+
+  // getUpdateCount (updates sent so far)
+  inline int64 getUpdateCount() const { return fUpdateCount; }
+
+  // getSuppressedCount (fixed rate updates skipped so far)
+  inline int64 getSuppressedCount() const { return fSuppressedCount + getPendingSuppressedCount(); }
+
+private:
+  // the fixed rate updates skipped since the last update (the next update stands for one of them)
+  inline int64 getPendingSuppressedCount() const
+  {
+    if(fMinIntervalInSamples == 0 || fSamplesSinceUpdate < fMinIntervalInSamples)
+      return 0;
+    return fSamplesSinceUpdate / fMinIntervalInSamples - 1;
+  }
+
+  int64 fMinIntervalInSamples;
+  int64 fMaxIntervalInSamples;
+  int64 fSamplesSinceUpdate{0};
+  int64 fGeneration{-1}; // the first call always updates
+  int64 fUpdateCount{0};
+  int64 fSuppressedCount{0};
+};
+
+}
+}
+}
@@ -14,18 +14,43 @@ using namespace VST::Common;
 /////////////////////////////////////////
 VAC6AudioChannelProcessor::VAC6AudioChannelProcessor(const SampleRateBasedClock &iClock,
                                                      ZoomWindow *iZoomWindow,
-                                                     int iMaxBufferSize) :
+                                                     int iMaxBufferSize,
+                                                     int iHistorySize,
+                                                     bool iWithDiskHistory) :
   fClock{iClock},
-  fMaxAccumulatorForBuffer(fClock.getSampleCountFor(ACCUMULATOR_BATCH_SIZE_IN_MS)),
-  fMaxBuffer{new CircularBuffer<TSample>(iMaxBufferSize)},
+  fHistory{new TieredHistory<THistorySample>(iMaxBufferSize, iHistorySize, HISTORY_TIER_FACTOR)},
+  fMeanSquares{new CircularBuffer<TSample>(iMaxBufferSize)},
+  fRangeStatsIndex{new RangeStatsIndex<THistorySample, TSample, HistorySampleDecoder>(
+    iMaxBufferSize, toHistorySample(DEFAULT_SOFT_CLIPPING_LEVEL))},
+  fSoftClippingLevel{DEFAULT_SOFT_CLIPPING_LEVEL},
   fMaxLevelSinceReset{0},
+  fHasMaxLevelSinceReset{true},
   fZoomMaxAccumulator{iZoomWindow->setZoomFactor(DEFAULT_ZOOM_FACTOR_X)},
-  fZoomMaxBuffer{new CircularBuffer<TSample>(iZoomWindow->getVisibleWindowSizeInPoints())},
+  fZoomMaxBuffer{new CircularBuffer<THistorySample>(iZoomWindow->getVisibleWindowSizeInPoints())},
+  fZoomPointCount{0},
+  fDisplayGeneration{0},
+  fZoomMaxBufferWindow{},
   fNeedToRecomputeZoomMaxBuffer{false},
-  fIsLiveView{true}
+  fPendingZoomMaxBuffer{new CircularBuffer<THistorySample>(iZoomWindow->getVisibleWindowSizeInPoints())},
+  fPendingZoomPoints{},
+  fIsComputingZoomMaxBuffer{false},
+  fPendingPushCount{0},
+  fIsLiveView{true},
+  fTruePeakFilter{},
+  fIsTruePeak{false},
+  fGainedSamples(iClock.getSampleCountFor(ACCUMULATOR_BATCH_SIZE_IN_MS), 0),
+  fDiskHistory{iWithDiskHistory ? new DiskHistory(fHistory->getTierResolution(fHistory->getTierCount() - 1)) : nullptr},
+  fZoomGeneration{0},
+  fIsWaitingForDisk{false},
+  fZoomPointsPushedSinceDiskRequest{0},
+  fDiskRequest{},
+  fDiskResponse{},
+  fMetrics{nullptr}
 {
-  fMaxBuffer->init(0);
+  fMeanSquares->init(0);
+  fRangeStatsIndex->init(0, 0);
   fZoomMaxBuffer->init(0);
+  fPendingZoomMaxBuffer->init(0);
 }
 
 /////////////////////////////////////////
@@ -33,27 +58,66 @@ VAC6AudioChannelProcessor::VAC6AudioChannelProcessor(const SampleRateBasedClock
 /////////////////////////////////////////
 VAC6AudioChannelProcessor::~VAC6AudioChannelProcessor()
 {
+  delete fPendingZoomMaxBuffer;
   delete fZoomMaxBuffer;
-  delete fMaxBuffer;
+  delete fRangeStatsIndex;
+  delete fMeanSquares;
+  delete fHistory;
+  delete fDiskHistory;
+}
+
+/////////////////////////////////////////
+// VAC6AudioChannelProcessor::getMemorySize
+/////////////////////////////////////////
+size_t VAC6AudioChannelProcessor::getMemorySize() const
+{
+  return sizeof(*this) +
+         fHistory->getMemorySize() +
+         fMeanSquares->getSize() * sizeof(TSample) +
+         fRangeStatsIndex->getMemorySize() +
+         2 * fZoomMaxBuffer->getSize() * sizeof(THistorySample);
 }
 
 /////////////////////////////////////////
 // VAC6AudioChannelProcessor::computeZoomSamples
 /////////////////////////////////////////
-void VAC6AudioChannelProcessor::computeZoomSamples(int iNumSamples, TSample *oSamples) const
+void VAC6AudioChannelProcessor::computeZoomSamples(int iNumSamples, THistorySample *oSamples) const
 {
   for(int i = 0; i < iNumSamples; i++)
     oSamples[i] = fZoomMaxBuffer->getAt(i);
 }
 
+/////////////////////////////////////////
+// VAC6AudioChannelProcessor::computeRangeStats
+/////////////////////////////////////////
+RangeStats<TSample> VAC6AudioChannelProcessor::computeRangeStats(int iFromOffset, int iToOffset) const
+{
+  return fRangeStatsIndex->getStats(fHistory->getBuffer(), *fMeanSquares, iFromOffset, iToOffset);
+}
+
 /////////////////////////////////////////
 // VAC6AudioChannelProcessor::setIsLiveView
 /////////////////////////////////////////
 void VAC6AudioChannelProcessor::setIsLiveView(bool iIsLiveView)
 {
+  // the filter is not fed while paused so its history is stale
+  if(iIsLiveView && !fIsLiveView)
+    fTruePeakFilter.reset();
+
   fIsLiveView = iIsLiveView;
 }
 
+/////////////////////////////////////////
+// VAC6AudioChannelProcessor::setTruePeak
+/////////////////////////////////////////
+void VAC6AudioChannelProcessor::setTruePeak(bool iIsTruePeak)
+{
+  if(iIsTruePeak && !fIsTruePeak)
+    fTruePeakFilter.reset();
+
+  fIsTruePeak = iIsTruePeak;
+}
+
 /////////////////////////////////////////
 // VAC6AudioChannelProcessor::setDirty
 /////////////////////////////////////////
@@ -63,9 +127,261 @@ void VAC6AudioChannelProcessor::setDirty()
 }
 
 /////////////////////////////////////////
-// VAC6AudioChannelProcessor::genericProcessChannel
+// VAC6AudioChannelProcessor::updateZoomMaxBuffer
+/////////////////////////////////////////
+void VAC6AudioChannelProcessor::updateZoomMaxBuffer(ZoomWindow const *iZoomWindow)
+{
+  if(fDiskHistory)
+    applyDiskPoints();
+
+  // a computation in progress is never restarted (under continuous zoom/scroll changes it would never complete):
+  // it completes (and gets displayed) first and the requested one starts right after
+  if(fNeedToRecomputeZoomMaxBuffer && !fIsComputingZoomMaxBuffer)
+    beginZoomMaxBufferComputation(iZoomWindow);
+
+  // the cost is bounded by ZOOM_POINTS_COMPUTED_PER_BLOCK no matter how much of the window needs to be recomputed
+  if(fIsComputingZoomMaxBuffer)
+  {
+    continueZoomMaxBufferComputation(iZoomWindow);
+
+    // completed but for a window which is no longer the current one => the next one starts before any entry gets
+    // accumulated in the (now displayed) zoomed buffer
+    if(fNeedToRecomputeZoomMaxBuffer && !fIsComputingZoomMaxBuffer)
+      beginZoomMaxBufferComputation(iZoomWindow);
+  }
+}
+
+/////////////////////////////////////////
+// VAC6AudioChannelProcessor::beginZoomMaxBufferComputation
+/////////////////////////////////////////
+void VAC6AudioChannelProcessor::beginZoomMaxBufferComputation(ZoomWindow const *iZoomWindow)
+{
+  // the points still expected from the disk history would be lost when shifting => full computation
+  if(fIsWaitingForDisk)
+    fZoomMaxBufferWindow.invalidate();
+  fIsWaitingForDisk = false;
+  fZoomGeneration++;
+
+  // starts the computation in the background buffer (fZoomMaxBuffer keeps being displayed until it completes)
+  // when scrolling (while paused) only the newly visible points get computed
+  fPendingZoomPoints = iZoomWindow->beginZoomWindow(*fZoomMaxBuffer, fZoomMaxBufferWindow, *fPendingZoomMaxBuffer);
+  fPendingPushCount = 0;
+  fIsComputingZoomMaxBuffer = true;
+  fNeedToRecomputeZoomMaxBuffer = false;
+}
+
+/////////////////////////////////////////
+// VAC6AudioChannelProcessor::pushHistoryEntry
+/////////////////////////////////////////
+void VAC6AudioChannelProcessor::pushHistoryEntry(TSample iEntry, TSample iMeanSquare)
+{
+  // everything (zoomed buffer, max level since reset) uses the stored value so that it can be found back
+  auto entry = toHistorySample(iEntry);
+
+  if(fHistory->push(entry) && fDiskHistory)
+  {
+    // a new entry in the coarsest tier => recorded on disk (the record may be dropped if the queue is full)
+    int coarsestTier = fHistory->getTierCount() - 1;
+    fDiskHistory->pushRecord(fHistory->getPushCount() / fHistory->getTierResolution(coarsestTier) - 1,
+                             fHistory->getTierEntry(coarsestTier, -1));
+  }
+
+  fMeanSquares->push(iMeanSquare);
+  fRangeStatsIndex->onPush(fHistory->getBuffer(), *fMeanSquares);
+
+  // the window fZoomMaxBuffer was computed for is relative to the (now changed) end of fHistory
+  fZoomMaxBufferWindow.invalidate();
+
+  // the max level since reset is the max of the entries (whatever the state of the zoomed buffer)
+  if(!fHasMaxLevelSinceReset || entry > fMaxLevelSinceReset)
+  {
+    fMaxLevelSinceReset = entry;
+    fHasMaxLevelSinceReset = true;
+    fDisplayGeneration++;
+  }
+
+  if(fIsComputingZoomMaxBuffer)
+  {
+    // the zoomed buffer will catch up when the computation completes
+    fPendingPushCount++;
+  }
+  else
+  {
+    // only when we get a sample in the max buffer do we accumulate in the zoomed one
+    THistorySample zoomedMax;
+    if(fZoomMaxAccumulator.accumulate(entry, zoomedMax))
+    {
+      fZoomMaxBuffer->push(zoomedMax);
+      fZoomPointCount++;
+      fDisplayGeneration++;
+      fZoomPointsPushedSinceDiskRequest++;
+    }
+  }
+}
+
+/////////////////////////////////////////
+// VAC6AudioChannelProcessor::continueZoomMaxBufferComputation
 /////////////////////////////////////////
-// => implemented in VAC6Processor.cpp (because it is generic)
+void VAC6AudioChannelProcessor::continueZoomMaxBufferComputation(ZoomWindow const *iZoomWindow)
+{
+  auto startTime = fMetrics ? ProcessMetrics::now() : 0;
+
+  iZoomWindow->computeZoomWindow(*fHistory,
+                                 fPendingZoomPoints,
+                                 ZOOM_POINTS_COMPUTED_PER_BLOCK,
+                                 fPendingPushCount,
+                                 *fPendingZoomMaxBuffer);
+
+  if(fMetrics)
+    fMetrics->recordZoomCompute(ProcessMetrics::now() - startTime);
+
+  if(!fPendingZoomPoints.isDone())
+    return;
+
+  auto zoomMaxAccumulator = iZoomWindow->endZoomWindow(fPendingZoomPoints, fZoomMaxBufferWindow);
+
+  // catching up with the entries pushed (live view) while the computation was happening
+  auto const &buffer = fHistory->getBuffer();
+  for(int i = -std::min(fPendingPushCount, buffer.getSize()); i < 0; i++)
+  {
+    THistorySample zoomedMax;
+    if(zoomMaxAccumulator.accumulate(buffer.getAt(i), zoomedMax))
+      fPendingZoomMaxBuffer->push(zoomedMax);
+  }
+
+  if(fPendingPushCount > 0)
+    fZoomMaxBufferWindow.invalidate();
+
+  std::swap(fZoomMaxBuffer, fPendingZoomMaxBuffer);
+  fZoomMaxAccumulator = zoomMaxAccumulator;
+  fIsComputingZoomMaxBuffer = false;
+  fDisplayGeneration++;
+
+  // (the points are requested for the next computation when this one is already outdated)
+  if(fDiskHistory && !fNeedToRecomputeZoomMaxBuffer)
+    requestDiskPoints(iZoomWindow);
+}
+
+/////////////////////////////////////////
+// VAC6AudioChannelProcessor::requestDiskPoints
+/////////////////////////////////////////
+void VAC6AudioChannelProcessor::requestDiskPoints(ZoomWindow const *iZoomWindow)
+{
+  int historySize = fHistory->getHistorySize();
+  auto pushCount = fHistory->getPushCount();
+
+  fDiskRequest.fGeneration = fZoomGeneration;
+  fDiskRequest.fNumPoints = 0;
+
+  // the points go from the oldest (left) to the most recent (right)
+  for(int i = 0; i < iZoomWindow->getVisibleWindowSizeInPoints(); i++)
+  {
+    int fromOffset, toOffset;
+    iZoomWindow->computeBufferRange(i, i, fromOffset, toOffset);
+
+    if(fromOffset >= -historySize)
+      break;
+
+    // only the part not covered by fHistory
+    auto n = fDiskRequest.fNumPoints++;
+    fDiskRequest.fPositions[n] = i;
+    fDiskRequest.fFrom[n] = pushCount + fromOffset;
+    fDiskRequest.fTo[n] = pushCount + std::min(toOffset, -historySize);
+  }
+
+  if(fDiskRequest.fNumPoints > 0 && fDiskHistory->postRequest(fDiskRequest))
+  {
+    fIsWaitingForDisk = true;
+    fZoomPointsPushedSinceDiskRequest = 0;
+  }
+}
+
+/////////////////////////////////////////
+// VAC6AudioChannelProcessor::applyDiskPoints
+/////////////////////////////////////////
+void VAC6AudioChannelProcessor::applyDiskPoints()
+{
+  while(fDiskHistory->pollResponse(fDiskResponse))
+  {
+    // the zoomed buffer has been (or is being) recomputed since the request
+    if(fDiskResponse.fGeneration != fZoomGeneration)
+      continue;
+
+    for(int i = 0; i < fDiskResponse.fNumPoints; i++)
+    {
+      // the points pushed (live view) since the request moved the other points to the left
+      int position = fDiskResponse.fPositions[i] - fZoomPointsPushedSinceDiskRequest;
+      if(position >= 0)
+        fZoomMaxBuffer->setAt(position, std::max(fZoomMaxBuffer->getAt(position), fDiskResponse.fMax[i]));
+    }
+
+    fDisplayGeneration++;
+
+    fIsWaitingForDisk = false;
+  }
+}
+
+/////////////////////////////////////////
+// VAC6AudioChannelProcessor::processRun
+/////////////////////////////////////////
+template<typename SampleType>
+TSample VAC6AudioChannelProcessor::processRun(SampleType const *iIn,
+                                              SampleType *oOut,
+                                              int iNumSamples,
+                                              BlockGain const &iGain,
+                                              TSample &oMeteredMax,
+                                              TSample &oSumOfSquares)
+{
+  bool isTruePeak = fIsLiveView && fIsTruePeak;
+
+  // only accumulated in live view (nothing is pushed in the history while paused)
+  oSumOfSquares = 0;
+
+  if(iGain.isConstant())
+  {
+    // pass through (the output, if any, is handled by VAC6ChannelBank) => read only pass
+    TSample runMax = !oOut && iGain.fValue == Gain::Unity ?
+                     PeakKernel::computeMax(iIn, iNumSamples) :
+                     PeakKernel::copyAndComputeMax(iIn, oOut, iNumSamples, iGain.fValue);
+
+    oMeteredMax = runMax;
+
+    if(fIsLiveView)
+      oSumOfSquares = PeakKernel::computeSumOfSquares(iIn, iNumSamples, iGain.fValue);
+
+    // the true peak is never below the sample peak (the filter does not go exactly through the samples)
+    if(isTruePeak)
+      oMeteredMax = std::max(runMax, fTruePeakFilter.process(iIn, iNumSamples, iGain.fValue));
+
+    return runMax;
+  }
+
+  // during a gain ramp the true peak filter is fed with the gain adjusted samples computed by the same pass
+  TSample *gained = nullptr;
+  if(isTruePeak && iIn)
+  {
+    DCHECK_F(iNumSamples <= static_cast<int>(fGainedSamples.size()));
+    gained = fGainedSamples.data();
+  }
+
+  TSample runMax = PeakKernel::copyAndComputeMax(iIn, oOut, iNumSamples, iGain.fGains, gained);
+
+  oMeteredMax = runMax;
+
+  if(fIsLiveView)
+    oSumOfSquares = PeakKernel::computeSumOfSquares(iIn, iNumSamples, iGain.fGains);
+
+  if(isTruePeak)
+    oMeteredMax = std::max(runMax, fTruePeakFilter.process<TSample>(gained, iNumSamples, 1.0));
+
+  return runMax;
+}
+
+// VAC6ChannelBank processes 32 and 64 bits samples
+template TSample VAC6AudioChannelProcessor::processRun<Sample32>(Sample32 const *, Sample32 *, int,
+                                                                 BlockGain const &, TSample &, TSample &);
+template TSample VAC6AudioChannelProcessor::processRun<Sample64>(Sample64 const *, Sample64 *, int,
+                                                                 BlockGain const &, TSample &, TSample &);
 
 }
 }
@@ -5,9 +5,17 @@
 #include <pongasoft/VST/AudioBuffer.h>
 #include <pongasoft/VST/SampleRateBasedClock.h>
 #include <algorithm>
+#include <vector>
 #include "VAC6Constants.h"
 #include "VAC6Model.h"
 #include "ZoomWindow.h"
+#include "RangeStatsIndex.h"
+#include "Metrics.h"
+#include "TieredHistory.h"
+#include "DiskHistory.h"
+#include "PeakKernel.h"
+#include "TruePeakFilter.h"
+#include "GainRamp.h"
 
 namespace pongasoft {
 namespace VST {
@@ -75,6 +83,45 @@ public:
     return false;
   }
 
+  /**
+   * @return how many samples can be accumulated before the current batch is complete, capped to iMaxNumSamples
+   *         (with a batch size of 0 there is no boundary so iMaxNumSamples is returned)
+   */
+  inline uint32 getRemainingSamplesInBatch(uint32 iMaxNumSamples) const
+  {
+    if(fBatchSize == 0)
+      return iMaxNumSamples;
+
+    return std::min(fBatchSize - fAccumulatedSamples, iMaxNumSamples);
+  }
+
+  /**
+   * Accumulates a run of iNumSamples samples at once given the max of their absolute values (see
+   * PeakKernel::copyAndComputeMax). The run must not cross the batch boundary (see getRemainingSamplesInBatch) and
+   * the end result is exactly the same as calling accumulate for each sample of the run.
+   */
+  bool accumulateMax(TSample iMax, uint32 iNumSamples, TSample &oMaxSample)
+  {
+    fAccumulatedMax = std::max(fAccumulatedMax, iMax);
+
+    if(fBatchSize > 0)
+    {
+      DCHECK_F(fAccumulatedSamples + iNumSamples <= fBatchSize);
+
+      fAccumulatedSamples += iNumSamples;
+
+      if(fAccumulatedSamples == fBatchSize)
+      {
+        oMaxSample = fAccumulatedMax;
+        fAccumulatedMax = 0;
+        fAccumulatedSamples = 0;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
 private:
   uint32 fBatchSize;
 
@@ -85,66 +132,239 @@ private:
 class VAC6AudioChannelProcessor
 {
 public:
-  // Constructor
-  explicit VAC6AudioChannelProcessor(const SampleRateBasedClock &iClock,
-                                     ZoomWindow *iZoomWindow,
-                                     int iMaxBufferSize);
+  /**
+   * @param iMaxBufferSize the size of the full resolution history
+   * @param iHistorySize the size of the (tiered) history (see TieredHistory)
+   * @param iWithDiskHistory whether the history older than iHistorySize is kept on disk (see DiskHistory)
+   */
+  VAC6AudioChannelProcessor(const SampleRateBasedClock &iClock,
+                            ZoomWindow *iZoomWindow,
+                            int iMaxBufferSize,
+                            int iHistorySize,
+                            bool iWithDiskHistory = false);
 
   // Destructor
   ~VAC6AudioChannelProcessor();
 
-  // getMaxBuffer
-  CircularBuffer<TSample> const &getMaxBuffer() const
+  // getHistory
+  TieredHistory<THistorySample> const &getHistory() const
   {
-    return *fMaxBuffer;
+    return *fHistory;
   };
 
+  // getDiskHistory (nullptr when there is none)
+  DiskHistory *getDiskHistory() const
+  {
+    return fDiskHistory;
+  }
+
+  // getMemorySize (in bytes, history and zoomed buffers)
+  size_t getMemorySize() const;
+
   // resetMaxLevelSinceReset
   void resetMaxLevelSinceReset()
   {
-    fMaxLevelSinceReset = -1;
+    if(fHasMaxLevelSinceReset)
+      fDisplayGeneration++;
+    fHasMaxLevelSinceReset = false;
   }
 
-  // getMaxLevelSinceReset
+  // getMaxLevelSinceReset (-1 when no entry was pushed since the reset)
   TSample getMaxLevelSinceReset() const
   {
-    return fMaxLevelSinceReset;
+    return fHasMaxLevelSinceReset ? fromHistorySample(fMaxLevelSinceReset) : -1;
+  }
+
+  // setSoftClippingLevel (used for the range stats once applied, see updateRangeStatsIndex)
+  void setSoftClippingLevel(TSample iSoftClippingLevel)
+  {
+    fSoftClippingLevel = iSoftClippingLevel;
+  }
+
+  /**
+   * Continues applying the soft clipping level to the range stats index when it changed: the index is recomputed
+   * RANGE_STATS_BLOCKS_COMPUTED_PER_BLOCK blocks at a time (the stats use the previous level until then). Must be
+   * called once per block (see VAC6ChannelBank).
+   */
+  void updateRangeStatsIndex()
+  {
+    fRangeStatsIndex->setThreshold(fHistory->getBuffer(),
+                                   toHistorySample(fSoftClippingLevel),
+                                   RANGE_STATS_BLOCKS_COMPUTED_PER_BLOCK);
+  }
+
+  /**
+   * @return the max of the entries [iFromOffset, iToOffset[ of the history (O(log n)), exact for the entries still
+   *         available at full resolution
+   */
+  TSample computeRangeMax(int iFromOffset, int iToOffset) const
+  {
+    return fromHistorySample(fHistory->getMax(ZoomWindow::clampToHistory(*fHistory, iFromOffset),
+                                              ZoomWindow::clampToHistory(*fHistory, iToOffset)));
+  }
+
+  /**
+   * @return the stats of the entries [iFromOffset, iToOffset[ of the full resolution history (O(log n)), the sum of
+   *         the mean squares being the one of the samples of the batches (see pushHistoryEntry) and the count being
+   *         for the soft clipping level applied so far (see updateRangeStatsIndex). The range must be within the full
+   *         resolution history (see getHistory().getBuffer()).
+   */
+  RangeStats<TSample> computeRangeStats(int iFromOffset, int iToOffset) const;
+
+  /**
+   * The recomputations of the zoomed buffer are recorded in iMetrics (nullptr, the default, for none)
+   */
+  void setMetrics(ProcessMetrics *iMetrics)
+  {
+    fMetrics = iMetrics;
   }
 
   /**
-   * Mark the channel processor dirty in order to recompute the max zoom buffer
+   * Mark the channel processor dirty in order to recompute the max zoom buffer (after the computation in progress,
+   * if any, completes)
    */
   void setDirty();
 
   // setIsLiveView
   void setIsLiveView(bool iIsLiveView);
 
+  /**
+   * In true peak mode, the history is fed with the max of the 4x oversampled signal (see TruePeakFilter) instead of
+   * the max of the samples
+   */
+  void setTruePeak(bool iIsTruePeak);
+
   /**
    * Copy the zoomed samples into the array provided.
    *
    * @param iNumSamples size of the provided array
    */
-  void computeZoomSamples(int iNumSamples, TSample *oSamples) const;
+  void computeZoomSamples(int iNumSamples, THistorySample *oSamples) const;
+
+  /**
+   * @return the number of points pushed in the zoomed buffer so far (the samples of 2 calls to computeZoomSamples
+   *         only differ by the points pushed in between unless the zoomed buffer was recomputed)
+   */
+  Steinberg::int64 getZoomPointCount() const
+  {
+    return fZoomPointCount;
+  }
+
+  /**
+   * @return a generation which changes every time what is displayed (zoomed samples or max level since reset)
+   *         changes (see UIUpdateScheduler)
+   */
+  Steinberg::int64 getDisplayGeneration() const
+  {
+    return fDisplayGeneration;
+  }
 
+  /**
+   * Copies (applying iGain) a run of iNumSamples samples of the channel and returns the max of their absolute values.
+   * oMeteredMax is the max to accumulate in the history: in true peak mode (and live view) it also includes the max
+   * of the 4x oversampled signal (see TruePeakFilter), which requires the runs to be consecutive (and, in live view,
+   * no longer than a batch). oSumOfSquares is the sum of the squares of the (gain adjusted) samples to accumulate
+   * for the mean square of the batch (only computed in live view, 0 otherwise).
+   *
+   * @param iIn the input samples (nullptr means silence)
+   * @param oOut the output samples (nullptr means no output)
+   * @param iGain the gain of the samples of the run (constant or ramp, see GainRamp)
+   */
   template<typename SampleType>
-  bool genericProcessChannel(ZoomWindow const *iZoomWindow,
-                             const typename AudioBuffers<SampleType>::Channel &iIn,
-                             typename AudioBuffers<SampleType>::Channel &iOut,
-                             double const &iGain);
+  TSample processRun(SampleType const *iIn,
+                     SampleType *oOut,
+                     int iNumSamples,
+                     BlockGain const &iGain,
+                     TSample &oMeteredMax,
+                     TSample &oSumOfSquares);
+
+  /**
+   * Starts/continues the recomputation of the zoomed buffer (if needed). Must be called once per block (see
+   * VAC6ChannelBank).
+   */
+  void updateZoomMaxBuffer(ZoomWindow const *iZoomWindow);
+
+  /**
+   * Pushes an entry in the history (and accumulates it in the zoomed buffer). The entry is stored as a
+   * THistorySample (float or dB code, see HistorySample.h). Called every ACCUMULATOR_BATCH_SIZE_IN_MS (in live view)
+   * with the max of the batch and the mean of the squares of its samples (see VAC6ChannelBank) which is kept (at
+   * full resolution) for the RMS of the selection.
+   */
+  void pushHistoryEntry(TSample iEntry, TSample iMeanSquare);
+
+  /**
+   * For the histories which are not computed from the samples of a channel (loudness): the entry is its own level
+   */
+  void pushHistoryEntry(TSample iEntry)
+  {
+    pushHistoryEntry(iEntry, iEntry * iEntry);
+  }
 
 private:
+  /**
+   * Starts the recomputation of the zoomed buffer for the current zoom window (in fPendingZoomMaxBuffer)
+   */
+  void beginZoomMaxBufferComputation(ZoomWindow const *iZoomWindow);
+
+  /**
+   * Computes (at most) the next ZOOM_POINTS_COMPUTED_PER_BLOCK points of the zoomed buffer and swaps it in when
+   * complete
+   */
+  void continueZoomMaxBufferComputation(ZoomWindow const *iZoomWindow);
+
+  /**
+   * Requests (from the disk history) the points of the zoomed buffer which are older than what fHistory covers
+   */
+  void requestDiskPoints(ZoomWindow const *iZoomWindow);
+
+  /**
+   * Merges the points received from the disk history into the zoomed buffer (if they are still relevant)
+   */
+  void applyDiskPoints();
+
   SampleRateBasedClock fClock;
 
-  MaxAccumulator fMaxAccumulatorForBuffer;
-  CircularBuffer<TSample> *const fMaxBuffer;
+  TieredHistory<THistorySample> *const fHistory;
+  // the mean square of the samples of each entry of fHistory->getBuffer() (not encoded)
+  CircularBuffer<TSample> *const fMeanSquares;
+  // maintained alongside fHistory->getBuffer() and fMeanSquares (the sums are computed on the decoded entries in
+  // TSample precision)
+  RangeStatsIndex<THistorySample, TSample, HistorySampleDecoder> *const fRangeStatsIndex;
+  TSample fSoftClippingLevel; // threshold requested for fRangeStatsIndex
 
-  TSample fMaxLevelSinceReset;
+  // kept as an entry of the history (only decoded when sent to the UI)
+  THistorySample fMaxLevelSinceReset;
+  bool fHasMaxLevelSinceReset;
 
   TZoom::MaxAccumulator fZoomMaxAccumulator;
-  CircularBuffer<TSample> *const fZoomMaxBuffer;
+  CircularBuffer<THistorySample> *fZoomMaxBuffer; // what is being displayed
+  Steinberg::int64 fZoomPointCount; // points pushed in fZoomMaxBuffer
+  Steinberg::int64 fDisplayGeneration; // see getDisplayGeneration()
+  ZoomWindow::ComputedWindow fZoomMaxBufferWindow; // window fZoomMaxBuffer was last computed for (while paused)
   bool fNeedToRecomputeZoomMaxBuffer;
 
+  // the recomputation of the zoomed buffer is spread over several blocks (ZOOM_POINTS_COMPUTED_PER_BLOCK points
+  // each) and happens in the background buffer which is swapped with fZoomMaxBuffer when complete
+  CircularBuffer<THistorySample> *fPendingZoomMaxBuffer;
+  ZoomWindow::PendingPoints fPendingZoomPoints;
+  bool fIsComputingZoomMaxBuffer;
+  int fPendingPushCount; // entries pushed in fHistory since the computation started
+
   bool fIsLiveView;
+
+  TruePeakFilter fTruePeakFilter;
+  bool fIsTruePeak;
+  std::vector<TSample> fGainedSamples; // the (gain ramp adjusted) samples of a run fed to fTruePeakFilter
+
+  // optional: the history older than fHistory (the audio thread only exchanges messages with it)
+  DiskHistory *const fDiskHistory;
+  Steinberg::int64 fZoomGeneration; // incremented every time the zoomed buffer is recomputed
+  bool fIsWaitingForDisk; // the zoomed buffer has points which have been requested from the disk history
+  int fZoomPointsPushedSinceDiskRequest; // the points received must be shifted by this amount
+  DiskHistory::Request fDiskRequest;
+  DiskHistory::Response fDiskResponse;
+
+  ProcessMetrics *fMetrics; // optional (see setMetrics)
 };
 
 }
@@ -23,21 +23,30 @@ enum EVAC6ParamID : Steinberg::Vst::ParamID
   kMaxLevelReset = 1010,
   kMaxLevelSinceResetMarker = 1030,
   kMaxLevelInWindowMarker = 1031,
+  kTruePeak = 1040, // max levels are true peak (4x oversampled) levels instead of sample peak levels
 
   kSoftClippingLevel = 2000,
 
   kLCDZoomFactorX = 3010,   // zoom factor on the X axis (history)
   kLCDLeftChannel = 3020,   // toggle for showing/hiding left channel
   kLCDRightChannel = 3021,  // toggle for showing/hiding right channel
+  kLCDChannelView = 3022,   // max of all the channels or a single channel
   kLCDLiveView = 3030,      // live view/pause toggle
   kLCDInputX = 3040,        // selected position on the screen when paused
+  kLCDSelectionStartX = 3041, // where the selection (range) started on the screen when paused
   kLCDHistoryOffset = 3050, // position is a percent in the history [0.0, 1.0]
+  kLCDLoudness = 3060,      // which loudness (off/momentary/short term) is displayed
 
   kGain1 = 4000,
   kGain2 = 4010,
   kGainFilter = 4020,
 
-  kHistoryData = 5000 // internal parameter used to communicate large amount of data between RT and GUI
+  kHistoryData = 5000, // internal parameter used to communicate large amount of data between RT and GUI
+  kSelectionSoftClippingLevel = 5010, // internal parameter used to send the soft clipping level to RT (selection stats)
+
+  kMetricsDump = 6000, // debug (momentary) parameter: RT sends its runtime metrics to the UI which logs them
+  kMetricsData = 6010, // internal parameter used to send the runtime metrics from RT to the UI
+  kMetricsOverlay = 6020 // internal parameter: the (hidden) debug overlay showing the runtime metrics on the LCD
 };
 
 // tags associated to custom views (not associated to params)
@@ -0,0 +1,254 @@
+#include <pongasoft/logging/loguru.hpp>
+#include "VAC6ChannelBank.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+/////////////////////////////////////////
+// VAC6ChannelBank::VAC6ChannelBank
+/////////////////////////////////////////
+VAC6ChannelBank::VAC6ChannelBank(const SampleRateBasedClock &iClock,
+                                 ZoomWindow *iZoomWindow,
+                                 int iNumChannels,
+                                 int iMaxBufferSize,
+                                 int iHistorySize,
+                                 bool iWithDiskHistory) :
+  fNumChannels{iNumChannels},
+  fChannels{},
+  fBatchSize{iClock.getSampleCountFor(ACCUMULATOR_BATCH_SIZE_IN_MS)},
+  fAccumulatedSamples{0},
+  fAccumulatedMax(static_cast<size_t>(iNumChannels), 0),
+  fAccumulatedSumOfSquares(static_cast<size_t>(iNumChannels), 0),
+  fBlockMax(static_cast<size_t>(iNumChannels), 0),
+  fIsLiveView{true}
+{
+  DCHECK_F(iNumChannels >= 1 && iNumChannels <= MAX_NUM_CHANNELS);
+  DCHECK_F(fBatchSize > 0);
+
+  for(int c = 0; c < fNumChannels; c++)
+    fChannels.emplace_back(new VAC6AudioChannelProcessor(iClock,
+                                                         iZoomWindow,
+                                                         iMaxBufferSize,
+                                                         iHistorySize,
+                                                         iWithDiskHistory));
+}
+
+/////////////////////////////////////////
+// VAC6ChannelBank::~VAC6ChannelBank
+/////////////////////////////////////////
+VAC6ChannelBank::~VAC6ChannelBank()
+{
+  for(auto channel : fChannels)
+    delete channel;
+}
+
+/////////////////////////////////////////
+// VAC6ChannelBank::getMemorySize
+/////////////////////////////////////////
+size_t VAC6ChannelBank::getMemorySize() const
+{
+  size_t res = sizeof(*this) + 3 * fNumChannels * sizeof(TSample);
+  for(auto channel : fChannels)
+    res += channel->getMemorySize();
+  return res;
+}
+
+/////////////////////////////////////////
+// VAC6ChannelBank::setDirty
+/////////////////////////////////////////
+void VAC6ChannelBank::setDirty()
+{
+  for(auto channel : fChannels)
+    channel->setDirty();
+}
+
+/////////////////////////////////////////
+// VAC6ChannelBank::setIsLiveView
+/////////////////////////////////////////
+void VAC6ChannelBank::setIsLiveView(bool iIsLiveView)
+{
+  for(auto channel : fChannels)
+    channel->setIsLiveView(iIsLiveView);
+
+  fIsLiveView = iIsLiveView;
+}
+
+/////////////////////////////////////////
+// VAC6ChannelBank::setTruePeak
+/////////////////////////////////////////
+void VAC6ChannelBank::setTruePeak(bool iIsTruePeak)
+{
+  for(auto channel : fChannels)
+    channel->setTruePeak(iIsTruePeak);
+}
+
+/////////////////////////////////////////
+// VAC6ChannelBank::setSoftClippingLevel
+/////////////////////////////////////////
+void VAC6ChannelBank::setSoftClippingLevel(TSample iSoftClippingLevel)
+{
+  for(auto channel : fChannels)
+    channel->setSoftClippingLevel(iSoftClippingLevel);
+}
+
+/////////////////////////////////////////
+// VAC6ChannelBank::setMetrics
+/////////////////////////////////////////
+void VAC6ChannelBank::setMetrics(ProcessMetrics *iMetrics)
+{
+  for(auto channel : fChannels)
+    channel->setMetrics(iMetrics);
+}
+
+/////////////////////////////////////////
+// VAC6ChannelBank::resetMaxLevelSinceReset
+/////////////////////////////////////////
+void VAC6ChannelBank::resetMaxLevelSinceReset()
+{
+  for(auto channel : fChannels)
+    channel->resetMaxLevelSinceReset();
+}
+
+/////////////////////////////////////////
+// VAC6ChannelBank::genericProcessChannels
+/////////////////////////////////////////
+template<typename SampleType>
+void VAC6ChannelBank::genericProcessChannels(ZoomWindow const *iZoomWindow,
+                                             AudioBuffers<SampleType> &iIn,
+                                             AudioBuffers<SampleType> &iOut,
+                                             BlockGain const &iGain,
+                                             int iFromSample,
+                                             int iToSample)
+{
+  DCHECK_EQ_F(iIn.getNumSamples(), iOut.getNumSamples());
+  DCHECK_F(iFromSample >= 0 && iFromSample <= iToSample && iToSample <= iIn.getNumSamples());
+
+  // the channel buffers (nullptr when there is no such input / output channel)
+  SampleType const *inPtrs[MAX_NUM_CHANNELS];
+  SampleType *outPtrs[MAX_NUM_CHANNELS];
+
+  // at unity gain (ex: bypass or used purely as a meter) the output is the input
+  bool isPassThrough = iGain.isConstant() && iGain.fValue == Gain::Unity;
+
+  // every channel is processed (so that its history keeps receiving entries) even when the host provides fewer
+  // input channels: a missing input channel is handled like a silent one
+  for(int c = 0; c < fNumChannels; c++)
+  {
+    // once per block
+    if(iFromSample == 0)
+    {
+      fChannels[c]->updateZoomMaxBuffer(iZoomWindow);
+      fChannels[c]->updateRangeStatsIndex();
+      fBlockMax[c] = 0;
+    }
+
+    SampleType const *in = nullptr;
+    auto out = c < iOut.getNumChannels() ? iOut.getAudioChannel(c).getBuffer() : nullptr;
+
+    // the host flags the channel as silent (or there is no such input channel) => the samples are never read
+    bool isSilent = true;
+    if(c < iIn.getNumChannels())
+    {
+      auto inChannel = iIn.getAudioChannel(c);
+      in = inChannel.getBuffer();
+      isSilent = inChannel.isSilent();
+    }
+
+    inPtrs[c] = isSilent ? nullptr : in;
+    outPtrs[c] = out;
+
+    if(!out || !(isSilent || isPassThrough))
+      continue;
+
+    // the output is handled here in bulk (nothing to do when the host uses the same buffer for input and output)
+    if(out != in)
+    {
+      auto numSamples = static_cast<size_t>(iToSample - iFromSample);
+      if(isSilent)
+        std::fill(out + iFromSample, out + iToSample, 0);
+      else
+        std::memcpy(out + iFromSample, in + iFromSample, numSamples * sizeof(SampleType));
+    }
+
+    // so the runs only meter the input (see VAC6AudioChannelProcessor::processRun)
+    outPtrs[c] = nullptr;
+  }
+
+  auto accumulatedMax = fAccumulatedMax.data();
+  auto accumulatedSumOfSquares = fAccumulatedSumOfSquares.data();
+  auto blockMax = fBlockMax.data();
+
+  int i = iFromSample;
+  while(i < iToSample)
+  {
+    // in live view a run stops at the end of the current batch so that its max can be pushed in the histories
+    int runSize = iToSample - i;
+    if(fIsLiveView)
+      runSize = static_cast<int>(std::min(fBatchSize - fAccumulatedSamples, static_cast<uint32>(runSize)));
+
+    auto gain = iGain.offset(i);
+
+    // one pass over all the channels for this run
+    for(int c = 0; c < fNumChannels; c++)
+    {
+      TSample meteredMax, sumOfSquares;
+      TSample runMax = fChannels[c]->processRun(inPtrs[c] ? inPtrs[c] + i : nullptr,
+                                                outPtrs[c] ? outPtrs[c] + i : nullptr,
+                                                runSize,
+                                                gain,
+                                                meteredMax,
+                                                sumOfSquares);
+      blockMax[c] = std::max(blockMax[c], runMax);
+      if(fIsLiveView)
+      {
+        accumulatedMax[c] = std::max(accumulatedMax[c], meteredMax);
+        accumulatedSumOfSquares[c] += sumOfSquares;
+      }
+    }
+
+    if(fIsLiveView)
+    {
+      fAccumulatedSamples += static_cast<uint32>(runSize);
+
+      // end of the batch => its max (and mean square) is pushed in the history of every channel
+      if(fAccumulatedSamples == fBatchSize)
+      {
+        for(int c = 0; c < fNumChannels; c++)
+        {
+          fChannels[c]->pushHistoryEntry(accumulatedMax[c], accumulatedSumOfSquares[c] / fBatchSize);
+          accumulatedMax[c] = 0;
+          accumulatedSumOfSquares[c] = 0;
+        }
+        fAccumulatedSamples = 0;
+      }
+    }
+
+    i += runSize;
+  }
+
+  // all the samples are silent if and only if the biggest one (in absolute value) is (the flags set by the call
+  // processing the end of the block cover the whole block)
+  for(int c = 0; c < fNumChannels && c < iOut.getNumChannels(); c++)
+    iOut.getAudioChannel(c).setSilenceFlag(pongasoft::VST::isSilent(blockMax[c]));
+
+  // the output channels which have no matching channel in the bank
+  for(int c = fNumChannels; c < iOut.getNumChannels(); c++)
+  {
+    auto outChannel = iOut.getAudioChannel(c);
+    auto out = outChannel.getBuffer();
+    if(out)
+      std::fill(out + iFromSample, out + iToSample, 0);
+    outChannel.setSilenceFlag(true);
+  }
+}
+
+// the processor (and the benchmarks) process 32 and 64 bits samples
+template void VAC6ChannelBank::genericProcessChannels<Sample32>(ZoomWindow const *, AudioBuffers<Sample32> &,
+                                                                AudioBuffers<Sample32> &, BlockGain const &, int, int);
+template void VAC6ChannelBank::genericProcessChannels<Sample64>(ZoomWindow const *, AudioBuffers<Sample64> &,
+                                                                AudioBuffers<Sample64> &, BlockGain const &, int, int);
+
+}
+}
+}
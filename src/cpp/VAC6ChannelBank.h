@@ -0,0 +1,113 @@
+#pragma once
+
+#include <pluginterfaces/vst/vsttypes.h>
+#include <pongasoft/VST/AudioBuffer.h>
+#include <pongasoft/VST/SampleRateBasedClock.h>
+#include <cstring>
+#include <vector>
+#include "VAC6Constants.h"
+#include "ZoomWindow.h"
+#include "VAC6AudioChannelProcessor.h"
+#include "GainRamp.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+/**
+ * The channels of the (input) bus, whatever the speaker arrangement (mono, stereo, 5.1, 7.1.4, ambisonics...).
+ *
+ * Each channel has its own history (see VAC6AudioChannelProcessor) and the channel processors are separate heap
+ * objects: only the state needed to process a block (max accumulated for the current batch, max of the block) is kept
+ * in structure of arrays form (one array per field, indexed by channel), the histories are not. The channels share the
+ * batch boundaries: a block is processed in runs (which stop at the end of the current batch) and each run is
+ * processed for all the channels in one pass. The time per channel and sample does not depend on the number of
+ * channels and is dominated by the per sample kernels (see BM_VAC6ChannelBank_processChannels_numChannels).
+ */
+class VAC6ChannelBank
+{
+public:
+  /**
+   * @param iNumChannels number of channels (1 to MAX_NUM_CHANNELS)
+   * @see VAC6AudioChannelProcessor for the other parameters
+   */
+  VAC6ChannelBank(const SampleRateBasedClock &iClock,
+                  ZoomWindow *iZoomWindow,
+                  int iNumChannels,
+                  int iMaxBufferSize,
+                  int iHistorySize,
+                  bool iWithDiskHistory = false);
+
+  // Destructor
+  ~VAC6ChannelBank();
+
+  // getNumChannels
+  inline int getNumChannels() const { return fNumChannels; }
+
+  // getChannel
+  inline VAC6AudioChannelProcessor &getChannel(int iChannel) { return *fChannels[iChannel]; }
+  inline VAC6AudioChannelProcessor const &getChannel(int iChannel) const { return *fChannels[iChannel]; }
+
+  // getMemorySize (in bytes, all the channels)
+  size_t getMemorySize() const;
+
+  /**
+   * Mark all the channels dirty in order to recompute their max zoom buffer
+   */
+  void setDirty();
+
+  // setIsLiveView
+  void setIsLiveView(bool iIsLiveView);
+
+  // setTruePeak (see VAC6AudioChannelProcessor::setTruePeak)
+  void setTruePeak(bool iIsTruePeak);
+
+  // setSoftClippingLevel (used for the range stats)
+  void setSoftClippingLevel(TSample iSoftClippingLevel);
+
+  // setMetrics (see VAC6AudioChannelProcessor::setMetrics)
+  void setMetrics(ProcessMetrics *iMetrics);
+
+  // resetMaxLevelSinceReset
+  void resetMaxLevelSinceReset();
+
+  /**
+   * Processes the samples [iFromSample, iToSample[ of a block: the input channel c is copied (applying the gain) to
+   * the output channel c (if any) and metered. The input channels beyond getNumChannels() are ignored, a missing input
+   * channel (when the host arrangement has fewer input channels) is metered as silence so that every history keeps
+   * receiving entries and the output channels beyond getNumChannels() are silent. A block can be processed in several consecutive calls (the first one starting at 0) when the
+   * state changes within the block (ex: live view/pause at the exact sample offset).
+   *
+   * @param iGain the gain of the whole block (see GainRamp)
+   * @note implemented (and instantiated for Sample32 and Sample64) in VAC6ChannelBank.cpp
+   */
+  template<typename SampleType>
+  void genericProcessChannels(ZoomWindow const *iZoomWindow,
+                              AudioBuffers<SampleType> &iIn,
+                              AudioBuffers<SampleType> &iOut,
+                              BlockGain const &iGain,
+                              int iFromSample,
+                              int iToSample);
+
+private:
+  int const fNumChannels;
+  std::vector<VAC6AudioChannelProcessor *> fChannels;
+
+  // batch (ACCUMULATOR_BATCH_SIZE_IN_MS) shared by all the channels
+  uint32 const fBatchSize;
+  uint32 fAccumulatedSamples;
+
+  // per channel state (structure of arrays)
+  std::vector<TSample> fAccumulatedMax; // max accumulated for the current batch
+  std::vector<TSample> fAccumulatedSumOfSquares; // sum of the squares of the samples of the current batch
+  std::vector<TSample> fBlockMax; // max of the (sample peak) samples of the block (=> silence flag)
+
+  bool fIsLiveView;
+};
+
+}
+}
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <pluginterfaces/vst/vsttypes.h>
+#include "HistorySample.h"
 
 namespace pongasoft {
 namespace VST {
@@ -10,23 +11,73 @@ using namespace Steinberg;
 using namespace Steinberg::Vst;
 
 using TSample = Steinberg::Vst::Sample64;
+using THistorySample = VST::Common::THistorySample; // see HistorySample.h
+using VST::Common::toHistorySample;
+using VST::Common::fromHistorySample;
 
-constexpr long UI_FRAME_RATE_MS = 40; // 40ms => 25 frames per seconds
-//constexpr long UI_FRAME_RATE_MS = 250; // 4 per seconds for dev
+// the UI is updated when what it displays changes, at most every UI_FRAME_RATE_MS (configurable at configure time with
+// -DVAC6_UI_FRAME_RATE_MS=...) and at least every UI_IDLE_FRAME_RATE_MS (see UIUpdateScheduler)
+#ifndef VAC6_UI_FRAME_RATE_MS
+#define VAC6_UI_FRAME_RATE_MS 40
+#endif
+constexpr long UI_FRAME_RATE_MS = VAC6_UI_FRAME_RATE_MS; // 40ms => 25 frames per seconds
+constexpr long UI_IDLE_FRAME_RATE_MS = 1000;
 
 constexpr int MAX_ARRAY_SIZE = 256; // size of LCD window
 constexpr int MAX_LCD_INPUT_X = MAX_ARRAY_SIZE - 1;
 constexpr double MAX_HISTORY_OFFSET = 1.0; // percentage
 
+// max number of channels of the (input) bus (16 => up to 7.1.4 surround or 3rd order ambisonics)
+constexpr int MAX_NUM_CHANNELS = 16;
+
 // the max will be accumulated for 5ms which is ~221 samples at 44100 sample rate
 constexpr int ACCUMULATOR_BATCH_SIZE_IN_MS = 5;
-constexpr int HISTORY_SIZE_IN_SECONDS = 30; // how long is the history in seconds
+constexpr int HISTORY_SIZE_IN_SECONDS = 3600; // how long is the history in seconds (1h)
+constexpr int FULL_RESOLUTION_HISTORY_SIZE_IN_SECONDS = 30; // how much of the history is kept at full resolution
 // the buffer size is independent of the sample rate since one sample in the buffer is always made of
 // enough samples to fit ACCUMULATOR_BATCH_SIZE_IN_MS
-constexpr int SAMPLE_BUFFER_SIZE = HISTORY_SIZE_IN_SECONDS * 1000 / ACCUMULATOR_BATCH_SIZE_IN_MS; // 6000 samples
+constexpr int SAMPLE_BUFFER_SIZE = FULL_RESOLUTION_HISTORY_SIZE_IN_SECONDS * 1000 / ACCUMULATOR_BATCH_SIZE_IN_MS; // 6000 samples
+// the rest of the history is stored in coarser tiers (each one 10x coarser: 50ms, 500ms, 5s) with at most
+// SAMPLE_BUFFER_SIZE entries per tier (see TieredHistory) => the memory does not grow linearly with the history
+constexpr int HISTORY_TIER_FACTOR = 10;
+constexpr int HISTORY_BUFFER_SIZE = HISTORY_SIZE_IN_SECONDS * 1000 / ACCUMULATOR_BATCH_SIZE_IN_MS; // 720000 samples
+
+// with the (optional) disk history, the history which is older than HISTORY_SIZE_IN_SECONDS remains available
+// (at the resolution of the coarsest tier) in a memory mapped file (see DiskHistory) => the LCD can zoom out to
+// DISK_HISTORY_SIZE_IN_SECONDS
+#ifndef VAC6_DISK_HISTORY
+#define VAC6_DISK_HISTORY 0
+#endif
+constexpr int DISK_HISTORY_SIZE_IN_SECONDS = 24 * 3600; // 1 day
+constexpr int ZOOM_HISTORY_SIZE_IN_SECONDS = VAC6_DISK_HISTORY ? DISK_HISTORY_SIZE_IN_SECONDS : HISTORY_SIZE_IN_SECONDS;
+constexpr int ZOOM_HISTORY_BUFFER_SIZE = ZOOM_HISTORY_SIZE_IN_SECONDS * 1000 / ACCUMULATOR_BATCH_SIZE_IN_MS;
+// how often the disk history thread writes the records / serves the requests
+constexpr int DISK_HISTORY_THREAD_PERIOD_MS = 20;
+
+// the loudness (see LoudnessAccumulator) is computed in blocks of 100ms (BS.1770-4)
+constexpr int LOUDNESS_BLOCK_SIZE_IN_MS = 100;
+
+// how many points of the LCD window (when it needs to be recomputed) are computed in one block by the audio thread
+// so that the cost of a block does not depend on zoom/scroll activity (the full window takes 4 blocks)
+constexpr int ZOOM_POINTS_COMPUTED_PER_BLOCK = 64;
+
+// how many blocks of the range stats index (see RangeStatsIndex::setThreshold) are recomputed in one block by the audio
+// thread when the soft clipping level changes (the full resolution history takes 6 blocks)
+constexpr int RANGE_STATS_BLOCKS_COMPUTED_PER_BLOCK = 1024;
+
+// while paused, the (frozen) histories are copied for the editor (when in the same process, see SharedHistoryChannel)
+// which then zooms/scrolls on its own: at most PAUSED_SNAPSHOT_ENTRIES_PER_BLOCK entries are copied per block (a
+// stereo snapshot takes ~10 blocks). Not available with the disk history (the editor would not have the disk points).
+constexpr int PAUSED_SNAPSHOT_ENTRIES_PER_BLOCK = 8192;
+constexpr bool PAUSED_SNAPSHOT_ENABLED = !VAC6_DISK_HISTORY;
+
+// time constant of the one pole filter smoothing the gain changes (see GainRamp): every sample (whatever the block
+// size) moves the gain by ~1/4410 of the distance to the target at 44100 sample rate
+constexpr double GAIN_FILTER_TIME_CONSTANT_IN_MS = 100;
 
 // keeping track of the version of the state being saved so that it can be upgraded more easily later
-constexpr uint16 PROCESSOR_STATE_VERSION = 1;
+// (version 2: exponential zoom level, see VAC6Parameters::handleRTStateUpgrade)
+constexpr uint16 PROCESSOR_STATE_VERSION = 2;
 constexpr uint16 CONTROLLER_STATE_VERSION = 1;
 
 /**
@@ -0,0 +1,75 @@
+#include "VAC6LoudnessProcessor.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+/////////////////////////////////////////
+// VAC6LoudnessProcessor::VAC6LoudnessProcessor
+/////////////////////////////////////////
+VAC6LoudnessProcessor::VAC6LoudnessProcessor(const SampleRateBasedClock &iClock,
+                                             ZoomWindow *iZoomWindow,
+                                             int iMaxBufferSize,
+                                             int iHistorySize,
+                                             bool iWithDiskHistory) :
+  fClock{iClock},
+  fKWeightingFilter{fClock.getSampleRate()},
+  fGainedLeft(fClock.getSampleCountFor(ACCUMULATOR_BATCH_SIZE_IN_MS), 0),
+  fGainedRight(fClock.getSampleCountFor(ACCUMULATOR_BATCH_SIZE_IN_MS), 0),
+  fLoudnessAccumulator{fClock.getSampleCountFor(LOUDNESS_BLOCK_SIZE_IN_MS)},
+  fMomentaryAccumulator{fClock.getSampleCountFor(ACCUMULATOR_BATCH_SIZE_IN_MS)},
+  fShortTermAccumulator{fClock.getSampleCountFor(ACCUMULATOR_BATCH_SIZE_IN_MS)},
+  fMomentaryHistory{new VAC6AudioChannelProcessor(iClock, iZoomWindow, iMaxBufferSize, iHistorySize, iWithDiskHistory)},
+  fShortTermHistory{new VAC6AudioChannelProcessor(iClock, iZoomWindow, iMaxBufferSize, iHistorySize, iWithDiskHistory)},
+  fIsLiveView{true}
+{
+}
+
+/////////////////////////////////////////
+// VAC6LoudnessProcessor::~VAC6LoudnessProcessor
+/////////////////////////////////////////
+VAC6LoudnessProcessor::~VAC6LoudnessProcessor()
+{
+  delete fShortTermHistory;
+  delete fMomentaryHistory;
+}
+
+/////////////////////////////////////////
+// VAC6LoudnessProcessor::setDirty
+/////////////////////////////////////////
+void VAC6LoudnessProcessor::setDirty()
+{
+  fMomentaryHistory->setDirty();
+  fShortTermHistory->setDirty();
+}
+
+/////////////////////////////////////////
+// VAC6LoudnessProcessor::setIsLiveView
+/////////////////////////////////////////
+void VAC6LoudnessProcessor::setIsLiveView(bool iIsLiveView)
+{
+  fIsLiveView = iIsLiveView;
+  fMomentaryHistory->setIsLiveView(iIsLiveView);
+  fShortTermHistory->setIsLiveView(iIsLiveView);
+}
+
+/////////////////////////////////////////
+// VAC6LoudnessProcessor::setMetrics
+/////////////////////////////////////////
+void VAC6LoudnessProcessor::setMetrics(ProcessMetrics *iMetrics)
+{
+  fMomentaryHistory->setMetrics(iMetrics);
+  fShortTermHistory->setMetrics(iMetrics);
+}
+
+/////////////////////////////////////////
+// VAC6LoudnessProcessor::genericProcessLoudness
+/////////////////////////////////////////
+// => implemented in VAC6Processor.cpp (because it is generic)
+
+}
+}
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <pluginterfaces/vst/vsttypes.h>
+#include <pongasoft/VST/AudioBuffer.h>
+#include <pongasoft/VST/SampleRateBasedClock.h>
+#include <vector>
+#include "VAC6Constants.h"
+#include "VAC6Model.h"
+#include "ZoomWindow.h"
+#include "KWeightingFilter.h"
+#include "LoudnessAccumulator.h"
+#include "VAC6AudioChannelProcessor.h"
+#include "GainRamp.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+/**
+ * Computes the (momentary and short term) loudness of the (front) left and right channels combined (the first 2
+ * channels of the bus) and records it in histories parallel to the peak histories of the channels (one entry every
+ * ACCUMULATOR_BATCH_SIZE_IN_MS, zoomed by the same ZoomWindow) so that they can be displayed on the same LCD
+ * timeline.
+ */
+class VAC6LoudnessProcessor
+{
+public:
+  // Constructor (see VAC6AudioChannelProcessor for the sizes)
+  VAC6LoudnessProcessor(const SampleRateBasedClock &iClock,
+                        ZoomWindow *iZoomWindow,
+                        int iMaxBufferSize,
+                        int iHistorySize,
+                        bool iWithDiskHistory = false);
+
+  // Destructor
+  ~VAC6LoudnessProcessor();
+
+  /**
+   * @param iLoudness LCD_LOUDNESS_MOMENTARY or LCD_LOUDNESS_SHORT_TERM
+   * @return the history for the loudness
+   */
+  VAC6AudioChannelProcessor const &getHistory(int iLoudness) const
+  {
+    return iLoudness == LCD_LOUDNESS_SHORT_TERM ? *fShortTermHistory : *fMomentaryHistory;
+  }
+
+  // getMemorySize (in bytes, both histories)
+  size_t getMemorySize() const
+  {
+    return sizeof(*this) + fMomentaryHistory->getMemorySize() + fShortTermHistory->getMemorySize();
+  }
+
+  /**
+   * Mark the histories dirty in order to recompute their max zoom buffer
+   */
+  void setDirty();
+
+  // setIsLiveView
+  void setIsLiveView(bool iIsLiveView);
+
+  // setMetrics (see VAC6AudioChannelProcessor::setMetrics)
+  void setMetrics(ProcessMetrics *iMetrics);
+
+  /**
+   * Processes the samples [iFromSample, iToSample[ of a block (see VAC6ChannelBank::genericProcessChannels)
+   *
+   * @param iGain the gain of the whole block (see GainRamp)
+   */
+  template<typename SampleType>
+  void genericProcessLoudness(ZoomWindow const *iZoomWindow,
+                              AudioBuffers<SampleType> &iIn,
+                              BlockGain const &iGain,
+                              int iFromSample,
+                              int iToSample);
+
+private:
+  SampleRateBasedClock fClock;
+
+  KWeightingFilter fKWeightingFilter;
+  // the (gain ramp adjusted) samples of a run fed to fKWeightingFilter
+  std::vector<TSample> fGainedLeft;
+  std::vector<TSample> fGainedRight;
+  LoudnessAccumulator fLoudnessAccumulator;
+
+  // the loudness is pushed in the histories at the same rate as the peaks
+  MaxAccumulator fMomentaryAccumulator;
+  MaxAccumulator fShortTermAccumulator;
+
+  // the loudness histories are handled like channels (history, zoom...) except they are fed directly
+  VAC6AudioChannelProcessor *const fMomentaryHistory;
+  VAC6AudioChannelProcessor *const fShortTermHistory;
+
+  bool fIsLiveView;
+};
+
+}
+}
+}
@@ -1,4 +1,5 @@
 #include <pongasoft/VST/AudioUtils.h>
+#include <cmath>
 #include "VAC6Model.h"
 
 namespace pongasoft {
@@ -14,16 +15,19 @@ MaxLevel LCDData::Channel::computeInWindowMaxLevel() const
 
   if(fOn)
   {
+    // the max is computed on the entries (only the result is decoded)
+    THistorySample max = 0;
     auto ptr = &fSamples[0];
     for(int i = 0; i < MAX_ARRAY_SIZE; i++)
     {
-      TSample sample = *ptr++;
-      if(sample > res.fValue)
+      THistorySample sample = *ptr++;
+      if(res.fIndex == -1 || sample > max)
       {
-        res.fValue = sample;
+        max = sample;
         res.fIndex = i;
       }
     }
+    res.fValue = fromHistorySample(max);
   }
   return res;
 }
@@ -35,13 +39,15 @@ MaxLevel LCDData::Channel::computeSinceResetMaxLevel() const
 {
   MaxLevel oSinceReset = {fMaxLevelSinceReset, -1};
 
-  if(fOn)
+  if(fOn && !oSinceReset.isUndefined())
   {
+    // fMaxLevelSinceReset is a decoded entry => encoding it gives back the entry
+    auto maxLevelSinceReset = toHistorySample(fMaxLevelSinceReset);
     auto ptr = &fSamples[MAX_ARRAY_SIZE - 1];
     for(int i = MAX_ARRAY_SIZE - 1; i >= 0; i--)
     {
-      TSample sample = *ptr--;
-      if(sample == fMaxLevelSinceReset)
+      THistorySample sample = *ptr--;
+      if(sample == maxLevelSinceReset)
       {
         oSinceReset.fIndex = i;
         return oSinceReset;
@@ -52,6 +58,45 @@ MaxLevel LCDData::Channel::computeSinceResetMaxLevel() const
   return oSinceReset;
 }
 
+//------------------------------------------------------------------------
+// LCDData::computeMaxSample
+//------------------------------------------------------------------------
+TSample LCDData::computeMaxSample(int iIndex) const
+{
+  THistorySample max = 0;
+  bool isOn = false;
+
+  for(int c = 0; c < fNumChannels; c++)
+  {
+    if(fChannels[c].fOn)
+    {
+      max = std::max(max, fChannels[c].fSamples[iIndex]);
+      isOn = true;
+    }
+  }
+
+  return isOn ? fromHistorySample(max) : -1;
+}
+
+//------------------------------------------------------------------------
+// LCDData::computeMaxSamples
+//------------------------------------------------------------------------
+void LCDData::computeMaxSamples(THistorySample *oSamples) const
+{
+  std::fill(oSamples, oSamples + MAX_ARRAY_SIZE, 0);
+
+  // one channel at a time (contiguous memory)
+  for(int c = 0; c < fNumChannels; c++)
+  {
+    if(fChannels[c].fOn)
+    {
+      auto const *samples = fChannels[c].fSamples;
+      for(int i = 0; i < MAX_ARRAY_SIZE; i++)
+        oSamples[i] = std::max(oSamples[i], samples[i]);
+    }
+  }
+}
+
 //------------------------------------------------------------------------
 // MaxLevel::computeMaxLevel
 //------------------------------------------------------------------------
@@ -117,16 +162,27 @@ std::string toDbString(TSample iSample, int iPrecision)
   return s.str();
 }
 
+//------------------------------------------------------------------------
+// LCDZoomFactorXParamConverter::upgradeFromVersion1
+//------------------------------------------------------------------------
+double LCDZoomFactorXParamConverter::upgradeFromVersion1(double iValue)
+{
+  auto maxZoomFactorV1 = static_cast<double>(SAMPLE_BUFFER_SIZE) / MAX_ARRAY_SIZE;
+  auto maxZoomFactor = static_cast<double>(ZOOM_HISTORY_BUFFER_SIZE) / MAX_ARRAY_SIZE;
+  auto zoomFactor = maxZoomFactorV1 + Utils::clamp(iValue, 0.0, 1.0) * (1.0 - maxZoomFactorV1);
+  return 1.0 - std::log(zoomFactor) / std::log(maxZoomFactor);
+}
+
 //------------------------------------------------------------------------
 // LCDZoomFactorXParamConverter::toString
 //------------------------------------------------------------------------
 std::string LCDZoomFactorXParamConverter::toString(const LCDZoomFactorXParamConverter::ParamType &iValue,
                                                    int32 iPrecision) const
 {
-  auto zoomInSeconds =
-    Utils::mapValueDP(iValue,
-                      0.0, 1.0,
-                      static_cast<double>(HISTORY_SIZE_IN_SECONDS), ACCUMULATOR_BATCH_SIZE_IN_MS * MAX_ARRAY_SIZE / 1000.0);
+  // same (exponential) mapping as ZoomWindow::setZoomFactor
+  auto minZoomInSeconds = ACCUMULATOR_BATCH_SIZE_IN_MS * MAX_ARRAY_SIZE / 1000.0;
+  auto maxZoomFactor = ZOOM_HISTORY_SIZE_IN_SECONDS / minZoomInSeconds;
+  auto zoomInSeconds = minZoomInSeconds * std::pow(maxZoomFactor, 1.0 - iValue);
 
   std::ostringstream s;
   s.precision(iPrecision);
@@ -135,6 +191,39 @@ std::string LCDZoomFactorXParamConverter::toString(const LCDZoomFactorXParamConv
   return s.str();
 }
 
+//------------------------------------------------------------------------
+// LCDLoudnessParamConverter::toString
+//------------------------------------------------------------------------
+std::string LCDLoudnessParamConverter::toString(const LCDLoudnessParamConverter::ParamType &iValue,
+                                                int32 /* iPrecision */) const
+{
+  switch(iValue)
+  {
+    case LCD_LOUDNESS_MOMENTARY:
+      return "Momentary";
+
+    case LCD_LOUDNESS_SHORT_TERM:
+      return "Short Term";
+
+    default:
+      return "Off";
+  }
+}
+
+//------------------------------------------------------------------------
+// LCDChannelViewParamConverter::toString
+//------------------------------------------------------------------------
+std::string LCDChannelViewParamConverter::toString(const LCDChannelViewParamConverter::ParamType &iValue,
+                                                   int32 /* iPrecision */) const
+{
+  if(iValue == LCD_CHANNEL_VIEW_ALL)
+    return "All (max)";
+
+  std::ostringstream s;
+  s << "Channel " << iValue;
+  return s.str();
+}
+
 //------------------------------------------------------------------------
 // HistoryData::getMaxLevelForSelection
 //------------------------------------------------------------------------
@@ -146,10 +235,7 @@ MaxLevel HistoryData::getMaxLevelForSelection(int iLCDInputX) const
 
   MaxLevel res{-1, Utils::clampE(iLCDInputX, 0, MAX_LCD_INPUT_X)};
 
-  TSample leftSample = fLCDData.fLeftChannel.fOn ? fLCDData.fLeftChannel.fSamples[res.fIndex] : -1;
-  TSample rightSample = fLCDData.fRightChannel.fOn ? fLCDData.fRightChannel.fSamples[res.fIndex] : -1;
-
-  res.fValue = std::max(leftSample, rightSample);
+  res.fValue = fLCDData.computeMaxSample(res.fIndex);
 
   return res;
 }
@@ -159,25 +245,164 @@ MaxLevel HistoryData::getMaxLevelForSelection(int iLCDInputX) const
 //------------------------------------------------------------------------
 void HistoryData::computeMaxLevels()
 {
-  fMaxLevelInWindow = MaxLevel::computeMaxLevel(fLCDData.fLeftChannel.computeInWindowMaxLevel(),
-                                                fLCDData.fRightChannel.computeInWindowMaxLevel());
-  fMaxLevelSinceReset = MaxLevel::computeMaxLevel(fLCDData.fLeftChannel.computeSinceResetMaxLevel(),
-                                                  fLCDData.fRightChannel.computeSinceResetMaxLevel());
+  fMaxLevelInWindow = MaxLevel{};
+  fMaxLevelSinceReset = MaxLevel{};
+
+  for(int c = 0; c < fLCDData.fNumChannels; c++)
+  {
+    auto const &channel = fLCDData.fChannels[c];
+    fMaxLevelInWindow = MaxLevel::computeMaxLevel(fMaxLevelInWindow, channel.computeInWindowMaxLevel());
+    fMaxLevelSinceReset = MaxLevel::computeMaxLevel(fMaxLevelSinceReset, channel.computeSinceResetMaxLevel());
+  }
 }
 
 //------------------------------------------------------------------------
-// HistoryData::readFromStream
+// HistoryDataParamSerializer::readFromStream
 //------------------------------------------------------------------------
 tresult HistoryDataParamSerializer::readFromStream(IBStreamer &iStreamer, HistoryData &oValue) const
 {
+  int32 version;
+  uint32 frameId;
+  uint32 previousFrameId;
+  int32 numChannels;
+
+  if(!iStreamer.readInt32(version) || version != WIRE_FORMAT_VERSION)
+    return kResultFalse;
+
+  if(!iStreamer.readInt32u(frameId) || !iStreamer.readInt32u(previousFrameId) || !iStreamer.readInt32(numChannels))
+    return kResultFalse;
+
+  if(numChannels < 0 || numChannels > MAX_NUM_CHANNELS)
+    return kResultFalse;
+
+  // a delta frame for a frame which was not read => wait for the next full frame (expected when a frame is missed,
+  // not an error: the value is left unchanged)
+  if(previousFrameId != 0 && previousFrameId != fReadFrameId)
+    return kResultOk;
+
+  // fReadFrame is only valid once the frame is completely read
+  fReadFrameId = 0;
+
+  tresult res = kResultOk;
+  fReadFrame.fNumChannels = numChannels;
+  for(int c = 0; c < numChannels; c++)
+    res |= LCDDataChannelParamSerializer::readFromStream(iStreamer, fReadFrame.fChannels[c]);
+  res |= LCDDataChannelParamSerializer::readFromStream(iStreamer, fReadFrame.fLoudness);
+
+  if(res == kResultOk)
   {
-    tresult res = LCDDataParamSerializer::readFromStream(iStreamer, oValue.fLCDData);
-    if(res == kResultOk)
-    {
-      oValue.computeMaxLevels();
-    }
-    return res;
+    fReadFrameId = frameId;
+    oValue.fLCDData = fReadFrame;
+    res |= SelectionStatsParamSerializer::readFromStream(iStreamer, oValue.fSelectionStats);
+    oValue.computeMaxLevels();
   }
+
+  return res;
+}
+
+//------------------------------------------------------------------------
+// HistoryDataParamSerializer::writeToStream
+//------------------------------------------------------------------------
+tresult HistoryDataParamSerializer::writeToStream(const HistoryData &iValue, IBStreamer &oStreamer) const
+{
+  auto const &lcdData = iValue.fLCDData;
+
+  auto now = fClock();
+
+  bool isFullFrame = fWrittenFrameId == 0 ||
+                     now - fFullFrameTime >= FULL_FRAME_INTERVAL_NS ||
+                     lcdData.fNumChannels != fWrittenFrame.fNumChannels;
+
+  // 0 is reserved (no frame)
+  uint32 frameId = fWrittenFrameId + 1;
+  if(frameId == 0)
+    frameId = 1;
+
+  auto startPosition = oStreamer.tell();
+
+  oStreamer.writeInt32(WIRE_FORMAT_VERSION);
+  oStreamer.writeInt32u(frameId);
+  oStreamer.writeInt32u(isFullFrame ? 0 : fWrittenFrameId);
+  oStreamer.writeInt32(lcdData.fNumChannels);
+
+  auto appendedCount = [isFullFrame](LCDData::Channel const &iPrevious, LCDData::Channel const &iChannel) {
+    return isFullFrame ? MAX_ARRAY_SIZE : LCDDataChannelParamSerializer::computeAppendedCount(iPrevious, iChannel);
+  };
+
+  tresult res = kResultOk;
+  for(int c = 0; c < lcdData.fNumChannels; c++)
+  {
+    auto const &channel = lcdData.fChannels[c];
+    res |= LCDDataChannelParamSerializer::writeToStream(channel,
+                                                        appendedCount(fWrittenFrame.fChannels[c], channel),
+                                                        oStreamer);
+  }
+  res |= LCDDataChannelParamSerializer::writeToStream(lcdData.fLoudness,
+                                                      appendedCount(fWrittenFrame.fLoudness, lcdData.fLoudness),
+                                                      oStreamer);
+  res |= SelectionStatsParamSerializer::writeToStream(iValue.fSelectionStats, oStreamer);
+
+  fWrittenFrame = lcdData;
+  fWrittenFrameId = frameId;
+  if(isFullFrame)
+    fFullFrameTime = now;
+
+  if(fMetrics)
+    fMetrics->recordBroadcastBytes(oStreamer.tell() - startPosition);
+
+  return res;
+}
+
+// the fields of MetricsSnapshot in wire order (followed by the load histogram)
+static constexpr Steinberg::int64 Common::MetricsSnapshot::*METRICS_SNAPSHOT_FIELDS[] = {
+  &Common::MetricsSnapshot::fBlockCount,
+  &Common::MetricsSnapshot::fSampleCount,
+  &Common::MetricsSnapshot::fProcessTimeNs,
+  &Common::MetricsSnapshot::fBudgetNs,
+  &Common::MetricsSnapshot::fMaxProcessTimeNs,
+  &Common::MetricsSnapshot::fMaxLoadPermille,
+  &Common::MetricsSnapshot::fZoomComputeCount,
+  &Common::MetricsSnapshot::fZoomComputeTimeNs,
+  &Common::MetricsSnapshot::fMaxZoomComputeTimeNs,
+  &Common::MetricsSnapshot::fBroadcastCount,
+  &Common::MetricsSnapshot::fBroadcastBytes,
+  &Common::MetricsSnapshot::fSharedPublishCount,
+  &Common::MetricsSnapshot::fSuppressedBroadcastCount,
+  &Common::MetricsSnapshot::fHistoryBytes,
+  &Common::MetricsSnapshot::fSnapshotBytes,
+  &Common::MetricsSnapshot::fDumpCount
+};
+
+//------------------------------------------------------------------------
+// MetricsSnapshotParamSerializer::readFromStream
+//------------------------------------------------------------------------
+tresult MetricsSnapshotParamSerializer::readFromStream(IBStreamer &iStreamer, ParamType &oValue) const
+{
+  for(auto field: METRICS_SNAPSHOT_FIELDS)
+  {
+    if(!iStreamer.readInt64(oValue.*field))
+      return kResultFalse;
+  }
+
+  for(auto &count: oValue.fLoadHistogram)
+  {
+    if(!iStreamer.readInt64(count))
+      return kResultFalse;
+  }
+
+  return kResultOk;
+}
+
+//------------------------------------------------------------------------
+// MetricsSnapshotParamSerializer::writeToStream
+//------------------------------------------------------------------------
+tresult MetricsSnapshotParamSerializer::writeToStream(const ParamType &iValue, IBStreamer &oStreamer) const
+{
+  for(auto field: METRICS_SNAPSHOT_FIELDS)
+    oStreamer.writeInt64(iValue.*field);
+  for(auto count: iValue.fLoadHistogram)
+    oStreamer.writeInt64(count);
+  return kResultOk;
 }
 }
 }
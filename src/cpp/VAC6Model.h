@@ -4,11 +4,13 @@
 #include <pluginterfaces/vst/ivstattributes.h>
 #include <pongasoft/VST/ParamConverters.h>
 #include <pongasoft/VST/ParamSerializers.h>
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 #include <pongasoft/VST/GUI/Params/GUIJmbParameter.h>
 #include "VAC6Constants.h"
 #include "ZoomWindow.h"
+#include "Metrics.h"
 
 namespace pongasoft {
 namespace VST {
@@ -40,6 +42,7 @@ constexpr double MIN_SOFT_CLIPPING_LEVEL_DB = -24;
 constexpr double MIN_VOLUME_DB = -60; // -60dB
 constexpr TSample MIN_AUDIO_SAMPLE = 0.001; // dbToSample<TSample>(-60.0)
 constexpr bool DEFAULT_GAIN_FILTER = true;
+constexpr bool DEFAULT_TRUE_PEAK = false;
 
 using LCDHistoryOffsetParamConverter = PercentParamConverter;
 
@@ -47,14 +50,22 @@ using LCDHistoryOffsetParamConverter = PercentParamConverter;
 // LCDZoomFactorXParamConverter
 ///////////////////////////////////
 
-// zoom varies from 30s to 1.28s (5ms * 256=1.28s) and we want default to be 15s
-constexpr double DEFAULT_ZOOM_FACTOR_X = 0.52228412256267409131;
+// zoom varies from ZOOM_HISTORY_SIZE_IN_SECONDS (1h or 1 day with the disk history) to 1.28s (5ms * 256=1.28s)
+// exponentially (see ZoomWindow::setZoomFactor) and we want default to be 15s
+// => 1 - log(15 / 1.28) / log(ZOOM_HISTORY_SIZE_IN_SECONDS / 1.28)
+constexpr double DEFAULT_ZOOM_FACTOR_X = VAC6_DISK_HISTORY ? 0.778667621734382 : 0.6900978214519219;
 
 class LCDZoomFactorXParamConverter : public PercentParamConverter
 {
 public:
   std::string toString(ParamType const &iValue, int32 iPrecision) const override;
 
+  /**
+   * Version 1 of the processor state: the zoom varied linearly from SAMPLE_BUFFER_SIZE entries (30s) to 1.28s
+   * => the value giving the same zoom with the exponential mapping
+   */
+  static double upgradeFromVersion1(double iValue);
+
   inline void toString(ParamType const &iValue, String128 iString, int32 iPrecision) const override
   {
     auto s = toString(iValue, iPrecision);
@@ -85,6 +96,51 @@ public:
   }
 };
 
+///////////////////////////////////
+// LCDLoudness
+///////////////////////////////////
+
+// which loudness (if any) is displayed on the LCD
+constexpr int LCD_LOUDNESS_OFF = 0;
+constexpr int LCD_LOUDNESS_MOMENTARY = 1;
+constexpr int LCD_LOUDNESS_SHORT_TERM = 2;
+constexpr int DEFAULT_LCD_LOUDNESS = LCD_LOUDNESS_OFF;
+
+class LCDLoudnessParamConverter : public DiscreteValueParamConverter<LCD_LOUDNESS_SHORT_TERM, int>
+{
+public:
+  std::string toString(ParamType const &iValue, int32 iPrecision) const override;
+
+  inline void toString(ParamType const &iValue, String128 iString, int32 iPrecision) const override
+  {
+    auto s = toString(iValue, iPrecision);
+    Steinberg::UString wrapper(iString, str16BufferSize(String128));
+    wrapper.fromAscii(s.c_str());
+  }
+};
+
+///////////////////////////////////
+// LCDChannelView
+///////////////////////////////////
+
+// which channels are displayed on the LCD: the max of the group of all the channels (the left/right toggles applying
+// to the first 2 channels) or a single channel (LCD_CHANNEL_VIEW_ALL + 1 + channel index)
+constexpr int LCD_CHANNEL_VIEW_ALL = 0;
+constexpr int DEFAULT_LCD_CHANNEL_VIEW = LCD_CHANNEL_VIEW_ALL;
+
+class LCDChannelViewParamConverter : public DiscreteValueParamConverter<MAX_NUM_CHANNELS, int>
+{
+public:
+  std::string toString(ParamType const &iValue, int32 iPrecision) const override;
+
+  inline void toString(ParamType const &iValue, String128 iString, int32 iPrecision) const override
+  {
+    auto s = toString(iValue, iPrecision);
+    Steinberg::UString wrapper(iString, str16BufferSize(String128));
+    wrapper.fromAscii(s.c_str());
+  }
+};
+
 ///////////////////////////////////////////
 // toDisplayValue
 ///////////////////////////////////////////
@@ -219,56 +275,6 @@ public:
   }
 };
 
-///////////////////////////////////
-// FilteredGain - Gain which changes slowly to avoid nasty effects
-///////////////////////////////////
-class FilteredGain
-{
-public:
-  explicit FilteredGain(double iValue = Gain::Unity, bool iFilterOn = true) :
-    fValue{iValue},
-    fTargetValue{fValue},
-    fFilterOn{iFilterOn}
-  {}
-
-  // adjust should be called every frame
-  bool adjust()
-  {
-    if(fTargetValue == fValue)
-      return false;
-
-    double previousValue = fValue;
-    if(!fFilterOn)
-    {
-      fValue = fTargetValue;
-    }
-    else
-    {
-      // Filter changes to avoid nasty sounds.
-      if(std::abs(fValue - fTargetValue) < 0.01f)
-      {
-        fValue = fTargetValue;
-      }
-      else
-      {
-        fValue += (fTargetValue - fValue) / 100.0f;
-        //DLOG_F(INFO, "gain adjusted from %f to %f with target %f", previousValue, fValue, fTargetValue);
-      }
-    }
-
-    return previousValue != fValue;
-  }
-
-  inline void setTargetValue(double iTargetValue) { fTargetValue = iTargetValue; }
-  inline double getValue() const { return fValue; }
-  inline void setFilterOn(bool iFilterOn) { fFilterOn = iFilterOn; }
-
-private:
-  double fValue;
-  double fTargetValue;
-  bool fFilterOn;
-};
-
 ///////////////////////////////////
 // MaxLevel
 ///////////////////////////////////
@@ -296,20 +302,63 @@ struct LCDData
   struct Channel
   {
     bool fOn{true};
-    TSample fSamples[MAX_ARRAY_SIZE]{};
+    THistorySample fSamples[MAX_ARRAY_SIZE]{}; // as stored in the history (see fromHistorySample)
     TSample fMaxLevelSinceReset{0};
+    Steinberg::int64 fZoomPointCount{0}; // points pushed in the zoomed buffer so far (not sent, RT side only)
 
     MaxLevel computeInWindowMaxLevel() const;
     MaxLevel computeSinceResetMaxLevel() const;
   };
 
-  Channel fLeftChannel;
-  Channel fRightChannel;
+  // number of channels of the bus (only the first fNumChannels entries of fChannels are meaningful)
+  int fNumChannels{2};
+  Channel fChannels[MAX_NUM_CHANNELS]{};
+  Channel fLoudness{false}; // (momentary or short term) loudness (see VAC6LoudnessProcessor)
+
+  /**
+   * @return the max of the samples at index iIndex of all the channels on (-1 if none)
+   */
+  TSample computeMaxSample(int iIndex) const;
+
+  /**
+   * Computes the max of the samples of all the channels on for every index at once (as stored in the history, 0 if
+   * no channel is on)
+   */
+  void computeMaxSamples(THistorySample *oSamples) const;
+};
+
+///////////////////////////////////
+// SelectionStats
+///////////////////////////////////
+
+/**
+ * Statistics of the entries of the history (at full resolution, each entry being the max over
+ * ACCUMULATOR_BATCH_SIZE_IN_MS) covered by the selected range of the LCD (for all the channels on). The average is
+ * the one of the entries (peaks) whereas the RMS is the one of the samples.
+ */
+struct SelectionStats
+{
+  TSample fMax{-1};
+  TSample fAveragePeak{0};
+  TSample fRMS{0};
+  int fCountAboveSoftClippingLevel{0};
+  int fCount{0};
+
+  bool isUndefined() const
+  {
+    return fCount == 0;
+  }
+
+  MaxLevel getMaxLevel() const
+  {
+    return isUndefined() ? MaxLevel{} : MaxLevel{fMax, -1};
+  }
 };
 
 struct HistoryData
 {
   LCDData fLCDData{};
+  SelectionStats fSelectionStats{};
   MaxLevel fMaxLevelInWindow{};
   MaxLevel fMaxLevelSinceReset{};
 
@@ -322,62 +371,183 @@ class LCDDataChannelParamSerializer
 public:
   using ParamType = LCDData::Channel;
 
+  /**
+   * Reads a channel: only the samples appended since the previous frame are in the stream, the other ones being the
+   * samples already in oValue moved to the left (see HistoryDataParamSerializer)
+   */
   inline static tresult readFromStream(IBStreamer &iStreamer, ParamType &oValue)
   {
     tresult res = IBStreamHelper::readBool(iStreamer, oValue.fOn);
     if(res == kResultOk)
     {
       if(oValue.fOn)
-        res |= !iStreamer.readDoubleArray(oValue.fSamples, MAX_ARRAY_SIZE);
+      {
+        int32 appendedCount;
+        if(!iStreamer.readInt32(appendedCount) || appendedCount < 0 || appendedCount > MAX_ARRAY_SIZE)
+          return kResultFalse;
+        std::copy(oValue.fSamples + appendedCount, oValue.fSamples + MAX_ARRAY_SIZE, oValue.fSamples);
+        res |= !readSamples(iStreamer, oValue.fSamples + MAX_ARRAY_SIZE - appendedCount, appendedCount);
+      }
       res |= IBStreamHelper::readDouble(iStreamer, oValue.fMaxLevelSinceReset);
     }
     return res;
   }
 
-  inline static tresult writeToStream(const ParamType &iValue, IBStreamer &oStreamer)
+  /**
+   * Writes a channel with only its iAppendedCount most recent samples (MAX_ARRAY_SIZE for all of them)
+   */
+  inline static tresult writeToStream(const ParamType &iValue, int iAppendedCount, IBStreamer &oStreamer)
   {
     oStreamer.writeBool(iValue.fOn);
     if(iValue.fOn)
-      oStreamer.writeDoubleArray(iValue.fSamples, MAX_ARRAY_SIZE);
+    {
+      oStreamer.writeInt32(iAppendedCount);
+      writeSamples(iValue.fSamples + MAX_ARRAY_SIZE - iAppendedCount, iAppendedCount, oStreamer);
+    }
     oStreamer.writeDouble(iValue.fMaxLevelSinceReset);
     return kResultOk;
   }
+
+  /**
+   * @return how many samples were appended to iPrevious to get iValue (MAX_ARRAY_SIZE when iValue is not iPrevious
+   *         moved to the left, which is the case after a zoom, a scroll, a pause...)
+   */
+  static int computeAppendedCount(ParamType const &iPrevious, ParamType const &iValue)
+  {
+    if(!iPrevious.fOn || !iValue.fOn)
+      return MAX_ARRAY_SIZE;
+
+    auto count = iValue.fZoomPointCount - iPrevious.fZoomPointCount;
+    if(count < 0 || count > MAX_ARRAY_SIZE)
+      return MAX_ARRAY_SIZE;
+
+    auto appendedCount = static_cast<int>(count);
+    if(!std::equal(iValue.fSamples,
+                   iValue.fSamples + MAX_ARRAY_SIZE - appendedCount,
+                   iPrevious.fSamples + appendedCount))
+      return MAX_ARRAY_SIZE;
+
+    return appendedCount;
+  }
+
+private:
+  // the samples are sent as they are stored in the history: floats or 16 bits dB codes (see HistorySample.h)
+  inline static bool readSamples(IBStreamer &iStreamer, Sample32 *oSamples, int iCount)
+  {
+    return iStreamer.readFloatArray(oSamples, static_cast<uint32>(iCount));
+  }
+
+  inline static bool readSamples(IBStreamer &iStreamer, uint16 *oSamples, int iCount)
+  {
+    return iStreamer.readInt16uArray(oSamples, static_cast<uint32>(iCount));
+  }
+
+  inline static bool writeSamples(Sample32 const *iSamples, int iCount, IBStreamer &oStreamer)
+  {
+    return oStreamer.writeFloatArray(iSamples, static_cast<uint32>(iCount));
+  }
+
+  inline static bool writeSamples(uint16 const *iSamples, int iCount, IBStreamer &oStreamer)
+  {
+    return oStreamer.writeInt16uArray(iSamples, static_cast<uint32>(iCount));
+  }
 };
 
-class LCDDataParamSerializer
+class SelectionStatsParamSerializer
 {
 public:
-  using ParamType = LCDData;
+  using ParamType = SelectionStats;
 
   inline static tresult readFromStream(IBStreamer &iStreamer, ParamType &oValue)
   {
     tresult res = kResultOk;
-    res |= LCDDataChannelParamSerializer::readFromStream(iStreamer, oValue.fLeftChannel);
-    res |= LCDDataChannelParamSerializer::readFromStream(iStreamer, oValue.fRightChannel);
+    res |= IBStreamHelper::readDouble(iStreamer, oValue.fMax);
+    res |= IBStreamHelper::readDouble(iStreamer, oValue.fAveragePeak);
+    res |= IBStreamHelper::readDouble(iStreamer, oValue.fRMS);
+    res |= !iStreamer.readInt32(oValue.fCountAboveSoftClippingLevel);
+    res |= !iStreamer.readInt32(oValue.fCount);
     return res;
   }
 
   inline static tresult writeToStream(const ParamType &iValue, IBStreamer &oStreamer)
   {
-    tresult res = kResultOk;
-    res |= LCDDataChannelParamSerializer::writeToStream(iValue.fLeftChannel, oStreamer);
-    res |= LCDDataChannelParamSerializer::writeToStream(iValue.fRightChannel, oStreamer);
-    return res;
+    oStreamer.writeDouble(iValue.fMax);
+    oStreamer.writeDouble(iValue.fAveragePeak);
+    oStreamer.writeDouble(iValue.fRMS);
+    oStreamer.writeInt32(iValue.fCountAboveSoftClippingLevel);
+    oStreamer.writeInt32(iValue.fCount);
+    return kResultOk;
   }
 };
 
+/**
+ * HistoryData is sent by RT to the GUI when it changes (at most every UI_FRAME_RATE_MS). Since the LCD mostly scrolls, a frame (delta frame)
+ * only contains, for each channel, the samples appended since the previous frame and the GUI rebuilds the full view
+ * from the previous frame it read. The channels which cannot be rebuilt this way (zoom, scroll, pause...) are sent in
+ * full, and so is the whole frame at least every FULL_FRAME_INTERVAL_NS (whatever the rate at which the frames are
+ * sent, see UIUpdateScheduler) so that a GUI which did not get the previous frame (a delta frame for another frame is
+ * ignored) catches up.
+ *
+ * Wire format: version, frame id, previous frame id (0 for a full frame), number of channels, channels, loudness
+ * (see LCDDataChannelParamSerializer) and selection stats.
+ *
+ * The serializer keeps the last frame written (RT side) and the last frame read (GUI side) which is why there must
+ * be one instance per side (one per plugin instance).
+ */
 class HistoryDataParamSerializer : public IParamSerializer<HistoryData>
 {
 public:
   using ParamType = HistoryData;
 
+  // to be changed when the format changes
+  static constexpr int32 WIRE_FORMAT_VERSION = 2;
+
+  // a full frame is sent when the last one was sent at least FULL_FRAME_INTERVAL_NS ago (1s)
+  static constexpr Steinberg::int64 FULL_FRAME_INTERVAL_NS = 1000000000;
+
+  // returns the current time in nanoseconds (monotonic)
+  using Clock = Steinberg::int64 (*)();
+
+  /**
+   * RT side: the size of every frame written is recorded in iMetrics (nullptr for none, ex: GUI side) and iClock
+   * tells when a full frame is due
+   */
+  explicit HistoryDataParamSerializer(Common::ProcessMetrics *iMetrics = nullptr,
+                                      Clock iClock = Common::ProcessMetrics::now) :
+    fMetrics{iMetrics},
+    fClock{iClock}
+  {}
+
   tresult readFromStream(IBStreamer &iStreamer, ParamType &oValue) const override;
 
-  inline tresult writeToStream(const ParamType &iValue, IBStreamer &oStreamer) const override
-  {
-    return LCDDataParamSerializer::writeToStream(iValue.fLCDData, oStreamer);
-  }
+  tresult writeToStream(const ParamType &iValue, IBStreamer &oStreamer) const override;
+
+private:
+  // RT side
+  Common::ProcessMetrics *fMetrics;
+  Clock fClock;
+  mutable LCDData fWrittenFrame{};
+  mutable uint32 fWrittenFrameId{0}; // 0 means no frame written yet
+  mutable Steinberg::int64 fFullFrameTime{0}; // when the last full frame was written
+
+  // GUI side
+  mutable LCDData fReadFrame{};
+  mutable uint32 fReadFrameId{0}; // 0 means no (valid) frame read yet
+};
+
+/**
+ * MetricsSnapshot is sent by RT to the GUI when the metrics are dumped (see EVAC6ParamID::kMetricsDump)
+ */
+class MetricsSnapshotParamSerializer : public IParamSerializer<Common::MetricsSnapshot>
+{
+public:
+  using ParamType = Common::MetricsSnapshot;
+
+  tresult readFromStream(IBStreamer &iStreamer, ParamType &oValue) const override;
+
+  tresult writeToStream(const ParamType &iValue, IBStreamer &oStreamer) const override;
 };
+
+}
 }
 }
-}
\ No newline at end of file
@@ -7,7 +7,7 @@ namespace VAC6 {
 //------------------------------------------------------------------------
 // VAC6Parameters::VAC6Parameters
 //------------------------------------------------------------------------
-VAC6Parameters::VAC6Parameters() : Parameters()
+VAC6Parameters::VAC6Parameters(Common::ProcessMetrics *iHistoryDataMetrics) : Parameters()
 {
   // YP Note: registration order is important as it defines the order in which
   // they will be registered to the vst world hence for example the order in which they will be displayed
@@ -108,6 +108,27 @@ VAC6Parameters::VAC6Parameters() : Parameters()
       .shortTitle(STR16 ("Gn. Ft."))
       .add();
 
+  // which loudness (if any) is displayed in the LCD
+  fLCDLoudnessParam =
+    vst<LCDLoudnessParamConverter>(EVAC6ParamID::kLCDLoudness, STR16 ("Loudness"))
+      .defaultValue(DEFAULT_LCD_LOUDNESS)
+      .shortTitle(STR16 ("Loudness"))
+      .add();
+
+  // which channels (all of them or a single one) are displayed in the LCD
+  fLCDChannelViewParam =
+    vst<LCDChannelViewParamConverter>(EVAC6ParamID::kLCDChannelView, STR16 ("Channel View"))
+      .defaultValue(DEFAULT_LCD_CHANNEL_VIEW)
+      .shortTitle(STR16 ("Chan View"))
+      .add();
+
+  // the toggle for true peak (inter-sample peak) detection
+  fTruePeakParam =
+    vst<BooleanParamConverter>(EVAC6ParamID::kTruePeak, STR16 ("True Peak"))
+      .defaultValue(DEFAULT_TRUE_PEAK)
+      .shortTitle(STR16 ("True Pk"))
+      .add();
+
   // selected position on the screen when paused
   fLCDInputXParam =
     vst<LCDInputXParamConverter>(EVAC6ParamID::kLCDInputX, STR16 ("Graph Select"))
@@ -116,6 +137,15 @@ VAC6Parameters::VAC6Parameters() : Parameters()
       .transient()
       .add();
 
+  // where the selection started on the screen when paused (the selection is the range between this position and
+  // fLCDInputXParam)
+  fLCDSelectionStartXParam =
+    vst<LCDInputXParamConverter>(EVAC6ParamID::kLCDSelectionStartX, STR16 ("Graph Select Start"))
+      .defaultValue(LCD_INPUT_X_NOTHING_SELECTED) // not selected (-1)
+      .flags(0) // state is not saved
+      .transient()
+      .add();
+
   // the scroll position (in percent)
   fLCDHistoryOffsetParam =
     vst<LCDHistoryOffsetParamConverter>(EVAC6ParamID::kLCDHistoryOffset, STR16 ("Graph Scroll"))
@@ -127,12 +157,46 @@ VAC6Parameters::VAC6Parameters() : Parameters()
 
   // history data
   fHistoryDataParam =
-    jmb<HistoryDataParamSerializer>(EVAC6ParamID::kHistoryData, STR16("HistoryData"))
+    jmb<HistoryDataParamSerializer>(EVAC6ParamID::kHistoryData, STR16("HistoryData"), iHistoryDataMetrics)
+      .transient()
+      .rtOwned()
+      .shared()
+      .add();
+
+  // soft clipping level used by the processing to compute the selection stats
+  fSelectionSoftClippingLevelParam =
+    jmb<DoubleParamSerializer>(EVAC6ParamID::kSelectionSoftClippingLevel, STR16("SelectionSoftClippingLevel"))
+      .defaultValue(DEFAULT_SOFT_CLIPPING_LEVEL)
+      .transient()
+      .guiOwned()
+      .shared()
+      .add();
+
+  // the momentary (debug) button which dumps the runtime metrics (not automatable)
+  fMetricsDumpParam =
+    vst<BooleanParamConverter>(EVAC6ParamID::kMetricsDump, STR16 ("Dump Metrics"))
+      .defaultValue(false)
+      .shortTitle(STR16 ("Metrics"))
+      .flags(0) // state is not saved
+      .transient()
+      .add();
+
+  // runtime metrics (sent when dumped)
+  fMetricsDataParam =
+    jmb<MetricsSnapshotParamSerializer>(EVAC6ParamID::kMetricsData, STR16("MetricsData"))
       .transient()
       .rtOwned()
       .shared()
       .add();
 
+  // the (hidden) debug overlay showing the runtime metrics on the LCD (toggled with Alt + click)
+  fMetricsOverlayParam =
+    jmb<BooleanParamSerializer>(EVAC6ParamID::kMetricsOverlay, STR16("MetricsOverlay"))
+      .defaultValue(false)
+      .transient()
+      .guiOwned()
+      .add();
+
   setRTSaveStateOrder(PROCESSOR_STATE_VERSION,
                       fZoomFactorXParam,
                       fLeftChannelOnParam,
@@ -140,7 +204,20 @@ VAC6Parameters::VAC6Parameters() : Parameters()
                       fGain1Param,
                       fGain2Param,
                       fGainFilterParam,
-                      fBypassParam);
+                      fBypassParam,
+                      fTruePeakParam,
+                      fLCDLoudnessParam,
+                      fLCDChannelViewParam);
+
+  // version 1: linear zoom level (see handleRTStateUpgrade)
+  setRTDeprecatedSaveStateOrder(1,
+                                fZoomFactorXParam,
+                                fLeftChannelOnParam,
+                                fRightChannelOnParam,
+                                fGain1Param,
+                                fGain2Param,
+                                fGainFilterParam,
+                                fBypassParam);
 
   setGUISaveStateOrder(CONTROLLER_STATE_VERSION,
                        fSinceResetMarkerParam,
@@ -148,6 +225,34 @@ VAC6Parameters::VAC6Parameters() : Parameters()
                        fSoftClippingLevelParam);
 }
 
+//------------------------------------------------------------------------
+// VAC6Parameters::handleRTStateUpgrade
+//------------------------------------------------------------------------
+tresult VAC6Parameters::handleRTStateUpgrade(NormalizedState const &iDeprecatedState,
+                                             NormalizedState &oNewState) const
+{
+  if(iDeprecatedState.fSaveOrder->fVersion != 1)
+    return kResultFalse;
+
+  auto const &newOrder = oNewState.fSaveOrder->fOrder;
+
+  // the parameters added since version 1 keep their default value
+  for(int i = 0; i < iDeprecatedState.getCount(); i++)
+  {
+    auto paramID = iDeprecatedState.fSaveOrder->fOrder[i];
+    auto value = iDeprecatedState.fValues[i];
+
+    if(paramID == fZoomFactorXParam->fParamID)
+      value = LCDZoomFactorXParamConverter::upgradeFromVersion1(value);
+
+    auto iter = std::find(newOrder.begin(), newOrder.end(), paramID);
+    if(iter != newOrder.end())
+      oNewState.fValues[iter - newOrder.begin()] = value;
+  }
+
+  return kResultOk;
+}
+
 }
 }
 }
\ No newline at end of file
@@ -17,7 +17,12 @@ namespace VAC6 {
 class VAC6Parameters : public Parameters
 {
 public:
-  VAC6Parameters();
+  // iHistoryDataMetrics records the size of the history data messages (processor side only, see
+  // HistoryDataParamSerializer)
+  explicit VAC6Parameters(Common::ProcessMetrics *iHistoryDataMetrics = nullptr);
+
+  // upgrades a processor state saved by a previous version (see PROCESSOR_STATE_VERSION)
+  tresult handleRTStateUpgrade(NormalizedState const &iDeprecatedState, NormalizedState &oNewState) const override;
 
   // saved
   VstParam<Percent> fZoomFactorXParam;
@@ -27,11 +32,15 @@ public:
   VstParam<Gain> fGain2Param;
   VstParam<bool> fGainFilterParam;
   VstParam<bool> fBypassParam;
+  VstParam<bool> fTruePeakParam;
+  VstParam<int> fLCDLoudnessParam;
+  VstParam<int> fLCDChannelViewParam;
 
   // transient
   VstParam<bool> fLCDLiveViewParam;
   VstParam<bool> fMaxLevelResetParam;
   VstParam<int> fLCDInputXParam;
+  VstParam<int> fLCDSelectionStartXParam;
   VstParam<Percent> fLCDHistoryOffsetParam;
 
   // UI Only
@@ -41,6 +50,14 @@ public:
 
   // used to communicate data from the processing to the UI
   JmbParam<HistoryData> fHistoryDataParam;
+
+  // used to communicate the soft clipping level from the UI to the processing
+  JmbParam<double> fSelectionSoftClippingLevelParam;
+
+  // debug: dumps the runtime metrics of the processing (see ProcessMetrics)
+  VstParam<bool> fMetricsDumpParam;
+  JmbParam<Common::MetricsSnapshot> fMetricsDataParam;
+  JmbParam<bool> fMetricsOverlayParam;
 };
 
 using namespace RT;
@@ -57,13 +74,21 @@ public:
     fGain2{add(iParams.fGain2Param)},
     fGainFilter{add(iParams.fGainFilterParam)},
     fBypass{add(iParams.fBypassParam)},
+    fTruePeak{add(iParams.fTruePeakParam)},
+    fLCDLoudness{add(iParams.fLCDLoudnessParam)},
+    fLCDChannelView{add(iParams.fLCDChannelViewParam)},
 
     fLCDLiveView{add(iParams.fLCDLiveViewParam)},
     fMaxLevelReset{add(iParams.fMaxLevelResetParam)},
     fLCDInputX{add(iParams.fLCDInputXParam)},
+    fLCDSelectionStartX{add(iParams.fLCDSelectionStartXParam)},
     fLCDHistoryOffset{add(iParams.fLCDHistoryOffsetParam)},
 
-    fHistoryData{addJmbOut(iParams.fHistoryDataParam)}
+    fHistoryData{addJmbOut(iParams.fHistoryDataParam)},
+    fSelectionSoftClippingLevel{addJmbIn(iParams.fSelectionSoftClippingLevelParam)},
+
+    fMetricsDump{add(iParams.fMetricsDumpParam)},
+    fMetricsData{addJmbOut(iParams.fMetricsDataParam)}
   {
   }
 
@@ -93,15 +118,24 @@ public:
   RTVstParam<Gain> fGain2;
   RTVstParam<bool> fGainFilter;
   RTVstParam<bool> fBypass;
+  RTVstParam<bool> fTruePeak;
+  RTVstParam<int> fLCDLoudness;
+  RTVstParam<int> fLCDChannelView;
 
   // transient state
   RTVstParam<bool> fLCDLiveView;
   RTVstParam<bool> fMaxLevelReset;
   RTVstParam<int> fLCDInputX;
+  RTVstParam<int> fLCDSelectionStartX;
   RTVstParam<Percent> fLCDHistoryOffset;
 
   // messaging
   RTJmbOutParam<HistoryData> fHistoryData;
+  RTJmbInParam<double> fSelectionSoftClippingLevel;
+
+  // debug
+  RTVstParam<bool> fMetricsDump;
+  RTJmbOutParam<Common::MetricsSnapshot> fMetricsData;
 };
 
 using namespace GUI;
@@ -111,7 +145,10 @@ class VAC6GUIState : public GUIPluginState<VAC6Parameters>
 public:
   explicit VAC6GUIState(VAC6Parameters const &iParams) :
     GUIPluginState(iParams),
-    fHistoryData{add(iParams.fHistoryDataParam)}
+    fHistoryData{add(iParams.fHistoryDataParam)},
+    fSelectionSoftClippingLevel{add(iParams.fSelectionSoftClippingLevelParam)},
+    fMetricsData{add(iParams.fMetricsDataParam)},
+    fMetricsOverlay{add(iParams.fMetricsOverlayParam)}
   {};
 
 #ifndef NDEBUG
@@ -146,6 +183,11 @@ protected:
 public:
   // messaging
   GUIJmbParam<HistoryData> fHistoryData;
+  GUIJmbParam<double> fSelectionSoftClippingLevel;
+
+  // debug
+  GUIJmbParam<Common::MetricsSnapshot> fMetricsData;
+  GUIJmbParam<bool> fMetricsOverlay;
 };
 
 }
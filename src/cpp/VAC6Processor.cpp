@@ -18,66 +18,68 @@ using namespace Common;
 using namespace VAC6;
 
 /////////////////////////////////////////
-// VAC6AudioChannelProcessor::genericProcessChannel
+// VAC6LoudnessProcessor::genericProcessLoudness
 /////////////////////////////////////////
 template<typename SampleType>
-bool VAC6AudioChannelProcessor::genericProcessChannel(ZoomWindow const *iZoomWindow,
-                                                      typename AudioBuffers<SampleType>::Channel const &iIn,
-                                                      typename AudioBuffers<SampleType>::Channel &iOut,
-                                                      double const &iGain)
+void VAC6LoudnessProcessor::genericProcessLoudness(ZoomWindow const *iZoomWindow,
+                                                   AudioBuffers<SampleType> &iIn,
+                                                   BlockGain const &iGain,
+                                                   int iFromSample,
+                                                   int iToSample)
 {
-  DCHECK_EQ_F(iIn.getNumSamples(), iOut.getNumSamples());
-
-  if(fNeedToRecomputeZoomMaxBuffer)
+  // once per block
+  if(iFromSample == 0)
   {
-    fZoomMaxAccumulator = iZoomWindow->computeZoomWindow(*fMaxBuffer, *fZoomMaxBuffer);
-    fNeedToRecomputeZoomMaxBuffer = false;
+    fMomentaryHistory->updateZoomMaxBuffer(iZoomWindow);
+    fShortTermHistory->updateZoomMaxBuffer(iZoomWindow);
   }
 
-  bool silent = true;
-
-  auto numSamples = iIn.getNumSamples();
+  // like the peaks, the loudness history does not move while paused
+  if(!fIsLiveView)
+    return;
 
-  auto inPtr = iIn.getBuffer();
-  auto outPtr = iOut.getBuffer();
+  // the channels flagged silent by the host are never read
+  auto leftPtr = iIn.getLeftChannel().isSilent() ? nullptr : iIn.getLeftChannel().getBuffer();
+  auto rightPtr = iIn.getNumChannels() >= 2 && !iIn.getRightChannel().isSilent() ?
+                  iIn.getRightChannel().getBuffer() : nullptr;
 
-  for(int i = 0; i < numSamples; ++i)
+  int i = iFromSample;
+  while(i < iToSample)
   {
-    TSample sample = inPtr ? *inPtr++ : 0;
+    // a run stops at the end of the current batch (history entry) or loudness block (whichever comes first)
+    auto runSize = fMomentaryAccumulator.getRemainingSamplesInBatch(static_cast<uint32>(iToSample - i));
+    runSize = fLoudnessAccumulator.getRemainingSamplesInBlock(runSize);
 
-    if(iGain != Gain::Unity)
-      sample *= iGain;
+    auto left = leftPtr ? leftPtr + i : nullptr;
+    auto right = rightPtr ? rightPtr + i : nullptr;
+    auto numSamples = static_cast<int>(runSize);
 
-    if(fIsLiveView)
+    TSample sumOfSquares;
+
+    if(iGain.isConstant())
     {
-      TSample max;
-      if(fMaxAccumulatorForBuffer.accumulate(sample, max))
-      {
-        fMaxBuffer->push(max);
-
-        // only when we get a sample in the max buffer do we accumulate in the zoomed one
-        TSample zoomedMax;
-        if(fZoomMaxAccumulator.accumulate(max, zoomedMax))
-        {
-          fZoomMaxBuffer->push(zoomedMax);
-          if(zoomedMax > fMaxLevelSinceReset)
-          {
-            fMaxLevelSinceReset = zoomedMax;
-          }
-        }
-      }
+      sumOfSquares = fKWeightingFilter.process(left, right, numSamples, iGain.fValue);
+    }
+    else
+    {
+      // during a gain ramp the filter is fed with the gain adjusted samples
+      DCHECK_F(numSamples <= static_cast<int>(fGainedLeft.size()));
+      auto gains = iGain.fGains + i;
+      PeakKernel::copyAndComputeMax(left, static_cast<SampleType *>(nullptr), numSamples, gains, fGainedLeft.data());
+      PeakKernel::copyAndComputeMax(right, static_cast<SampleType *>(nullptr), numSamples, gains, fGainedRight.data());
+      sumOfSquares = fKWeightingFilter.process<TSample>(fGainedLeft.data(), fGainedRight.data(), numSamples, 1.0);
     }
 
-    if(silent && !pongasoft::VST::isSilent(sample))
-      silent = false;
-
-    if(outPtr)
-      *outPtr++ = sample;
-  }
+    fLoudnessAccumulator.accumulate(sumOfSquares, runSize);
 
-  iOut.setSilenceFlag(silent);
+    TSample loudness;
+    if(fMomentaryAccumulator.accumulateMax(fLoudnessAccumulator.getMomentaryLoudness(), runSize, loudness))
+      fMomentaryHistory->pushHistoryEntry(loudness);
+    if(fShortTermAccumulator.accumulateMax(fLoudnessAccumulator.getShortTermLoudness(), runSize, loudness))
+      fShortTermHistory->pushHistoryEntry(loudness);
 
-  return silent;
+    i += numSamples;
+  }
 }
 
 ///////////////////////////////////////////
@@ -85,15 +87,22 @@ bool VAC6AudioChannelProcessor::genericProcessChannel(ZoomWindow const *iZoomWin
 ///////////////////////////////////////////
 VAC6Processor::VAC6Processor() :
   RTProcessor(VAC6ControllerUID),
-  fParameters{},
+  fSharedHistoryChannel{SharedHistoryChannel::create()},
+  fParameters{&fSharedHistoryChannel->getMetrics()},
   fState{fParameters},
   fGain{fState.fGain1->getValue() * fState.fGain2->getValue(), DEFAULT_GAIN_FILTER},
+  fGain1Value{fState.fGain1->getValue()},
+  fGain2Value{fState.fGain2->getValue()},
   fClock{44100},
   fMaxAccumulatorBatchSize{fClock.getSampleCountFor(ACCUMULATOR_BATCH_SIZE_IN_MS)},
   fZoomWindow{nullptr},
-  fLeftChannelProcessor{nullptr},
-  fRightChannelProcessor{nullptr},
-  fRateLimiter{}
+  fChannelBank{nullptr},
+  fLoudnessProcessor{nullptr},
+  fUIUpdateScheduler{},
+  fUIGeneration{0},
+  fIsSharedHistoryReaderAttached{false},
+  fPausedSnapshotPosition{-1},
+  fNeedToRecomputeZoomMaxBuffers{false}
 {
   DLOG_F(INFO, "[%s] VAC6Processor() - jamba: %s - plugin: v%s (%s)",
          stringPluginName,
@@ -113,8 +122,11 @@ VAC6Processor::~VAC6Processor()
 {
   DLOG_F(INFO, "~VAC6Processor()");
 
-  delete fRightChannelProcessor;
-  delete fLeftChannelProcessor;
+  // the thread uses the disk histories owned by the channels
+  fDiskHistoryThread.stop();
+
+  delete fLoudnessProcessor;
+  delete fChannelBank;
   delete fZoomWindow;
 }
 
@@ -150,7 +162,11 @@ tresult PLUGIN_API VAC6Processor::initialize(FUnknown *context)
 ///////////////////////////////////////////
 tresult PLUGIN_API VAC6Processor::terminate()
 {
-  DLOG_F(INFO, "VAC6Processor::terminate()");
+  DLOG_F(INFO, "VAC6Processor::terminate() - UI updates: %lld sent, %lld suppressed (nothing changed)",
+         static_cast<long long>(fUIUpdateScheduler.getUpdateCount()),
+         static_cast<long long>(fUIUpdateScheduler.getSuppressedCount()));
+
+  fDiskHistoryThread.stop();
 
   return AudioEffect::terminate();
 }
@@ -167,31 +183,328 @@ tresult VAC6Processor::setupProcessing(ProcessSetup &setup)
 
   fClock.setSampleRate(setup.sampleRate);
 
-  fRateLimiter = fClock.getRateLimiter(UI_FRAME_RATE_MS);
+  fGain.setup(setup.sampleRate, setup.maxSamplesPerBlock);
+
+  fUIUpdateScheduler = UIUpdateScheduler{fClock.getSampleCountFor(UI_FRAME_RATE_MS),
+                                         fClock.getSampleCountFor(UI_IDLE_FRAME_RATE_MS)};
 
   // since this method is called multiple times, we make sure that there is no leak...
-  delete fRightChannelProcessor;
-  delete fLeftChannelProcessor;
+  fDiskHistoryThread.stop();
+  delete fLoudnessProcessor;
+  delete fChannelBank;
   delete fZoomWindow;
 
   fMaxAccumulatorBatchSize = fClock.getSampleCountFor(ACCUMULATOR_BATCH_SIZE_IN_MS);
 
-  fZoomWindow = new ZoomWindow(MAX_ARRAY_SIZE, SAMPLE_BUFFER_SIZE);
-  fLeftChannelProcessor = new VAC6AudioChannelProcessor(fClock, fZoomWindow, SAMPLE_BUFFER_SIZE);
-  fRightChannelProcessor = new VAC6AudioChannelProcessor(fClock, fZoomWindow, SAMPLE_BUFFER_SIZE);
+  // the bus arrangement (see setBusArrangements) determines the number of channels
+  auto inputBus = getAudioInput(0);
+  int numChannels = inputBus ? SpeakerArr::getChannelCount(inputBus->getArrangement()) : 2;
+  numChannels = std::max(1, std::min(numChannels, MAX_NUM_CHANNELS));
+
+  constexpr bool withDiskHistory = VAC6_DISK_HISTORY;
+
+  fZoomWindow = new ZoomWindow(MAX_ARRAY_SIZE, ZOOM_HISTORY_BUFFER_SIZE);
+  fChannelBank = new VAC6ChannelBank(fClock,
+                                     fZoomWindow,
+                                     numChannels,
+                                     SAMPLE_BUFFER_SIZE,
+                                     HISTORY_BUFFER_SIZE,
+                                     withDiskHistory);
+  fLoudnessProcessor =
+    new VAC6LoudnessProcessor(fClock, fZoomWindow, SAMPLE_BUFFER_SIZE, HISTORY_BUFFER_SIZE, withDiskHistory);
+
+  if(withDiskHistory)
+  {
+    std::vector<DiskHistory *> diskHistories{};
+    for(int c = 0; c < numChannels; c++)
+      diskHistories.emplace_back(fChannelBank->getChannel(c).getDiskHistory());
+    diskHistories.emplace_back(fLoudnessProcessor->getHistory(LCD_LOUDNESS_MOMENTARY).getDiskHistory());
+    diskHistories.emplace_back(fLoudnessProcessor->getHistory(LCD_LOUDNESS_SHORT_TERM).getDiskHistory());
+    fDiskHistoryThread.start(diskHistories);
+  }
+
+  fChannelBank->setTruePeak(*fState.fTruePeak);
+
+  // all the histories have the same size
+  fSharedHistoryChannel->resizeSnapshot(numChannels,
+                                        PAUSED_SNAPSHOT_ENABLED ?
+                                        fChannelBank->getChannel(0).getHistory().getMaxSnapshotSize() : 0);
+  fPausedSnapshotPosition = -1;
+  fNeedToRecomputeZoomMaxBuffers = false;
+
+  // the metrics restart with every setup (the budget of a block depends on the sample rate)
+  auto &metrics = fSharedHistoryChannel->getMetrics();
+  metrics.reset(setup.sampleRate);
+  metrics.setMemory(fChannelBank->getMemorySize() + fLoudnessProcessor->getMemorySize(),
+                    fSharedHistoryChannel->getSnapshotMemorySize());
+  fChannelBank->setMetrics(&metrics);
+  fLoudnessProcessor->setMetrics(&metrics);
 
   DLOG_F(INFO,
-         "VAC6Processor::setupProcessing(%s, %s, maxSamples=%d, sampleRate=%f, %dms=%d samples)",
+         "VAC6Processor::setupProcessing(%s, %s, maxSamples=%d, sampleRate=%f, channels=%d, %dms=%d samples)",
          setup.processMode == kRealtime ? "Realtime" : (setup.processMode == kPrefetch ? "Prefetch" : "Offline"),
          setup.symbolicSampleSize == kSample32 ? "32bits" : "64bits",
          setup.maxSamplesPerBlock,
          setup.sampleRate,
+         numChannels,
          ACCUMULATOR_BATCH_SIZE_IN_MS,
          fMaxAccumulatorBatchSize);
 
+  // the memory does not depend on the sample rate (nor on the length of the session)
+  DLOG_F(INFO,
+         "VAC6Processor::setupProcessing(history=%ds, disk history=%ds, memory=%zu bytes)",
+         HISTORY_SIZE_IN_SECONDS,
+         withDiskHistory ? DISK_HISTORY_SIZE_IN_SECONDS : 0,
+         fChannelBank->getMemorySize() + fLoudnessProcessor->getMemorySize());
+
   return result;
 }
 
+///////////////////////////////////////////
+// VAC6Processor::setBusArrangements
+///////////////////////////////////////////
+tresult PLUGIN_API VAC6Processor::setBusArrangements(SpeakerArrangement *inputs, int32 numIns,
+                                                     SpeakerArrangement *outputs, int32 numOuts)
+{
+  if(numIns != 1 || numOuts != 1)
+    return kResultFalse;
+
+  auto numInputChannels = SpeakerArr::getChannelCount(inputs[0]);
+  auto numOutputChannels = SpeakerArr::getChannelCount(outputs[0]);
+
+  DLOG_F(INFO, "VAC6Processor::setBusArrangements(in=%d channels, out=%d channels)",
+         numInputChannels, numOutputChannels);
+
+  if(numInputChannels < 1 || numInputChannels > MAX_NUM_CHANNELS ||
+     numOutputChannels < 1 || numOutputChannels > MAX_NUM_CHANNELS)
+    return kResultFalse;
+
+  return RTProcessor::setBusArrangements(inputs, numIns, outputs, numOuts);
+}
+
+///////////////////////////////////////////
+// VAC6Processor::connect
+///////////////////////////////////////////
+tresult PLUGIN_API VAC6Processor::connect(IConnectionPoint *other)
+{
+  tresult result = RTProcessor::connect(other);
+  if(result != kResultOk)
+    return result;
+
+  // the controller only finds the channel if it lives in the same process
+  IPtr<IMessage> message = owned(allocateMessage());
+  if(message)
+  {
+    message->setMessageID(SharedHistoryChannel::MESSAGE_ID);
+    message->getAttributes()->setInt(SharedHistoryChannel::PROCESS_TOKEN_ATTR,
+                                     SharedHistoryChannel::getProcessToken());
+    message->getAttributes()->setInt(SharedHistoryChannel::CHANNEL_ID_ATTR, fSharedHistoryChannel->getId());
+    sendMessage(message);
+  }
+
+  return result;
+}
+
+/////////////////////////////////////////
+// VAC6Processor::isChannelOn
+/////////////////////////////////////////
+bool VAC6Processor::isChannelOn(int iChannel) const
+{
+  if(*fState.fLCDChannelView != LCD_CHANNEL_VIEW_ALL)
+    return iChannel == *fState.fLCDChannelView - 1;
+
+  // the left/right toggles apply to the first 2 channels
+  switch(iChannel)
+  {
+    case 0:
+      return *fState.fLeftChannelOn;
+
+    case 1:
+      return *fState.fRightChannelOn;
+
+    default:
+      return true;
+  }
+}
+
+/////////////////////////////////////////
+// VAC6Processor::continuePausedSnapshot
+/////////////////////////////////////////
+void VAC6Processor::continuePausedSnapshot()
+{
+  auto &snapshot = fSharedHistoryChannel->getSnapshot();
+  int numEntries = snapshot.getNumHistories() * snapshot.fEntriesPerHistory;
+  int numEntriesToCopy = PAUSED_SNAPSHOT_ENTRIES_PER_BLOCK;
+
+  while(numEntriesToCopy > 0 && fPausedSnapshotPosition < numEntries)
+  {
+    // the channels followed by the loudness histories (momentary then short term)
+    int h = fPausedSnapshotPosition / snapshot.fEntriesPerHistory;
+    auto const &history =
+      h < snapshot.fNumChannels ? fChannelBank->getChannel(h).getHistory() :
+      fLoudnessProcessor->getHistory(h == snapshot.fNumChannels ? LCD_LOUDNESS_MOMENTARY : LCD_LOUDNESS_SHORT_TERM).getHistory();
+
+    int from = fPausedSnapshotPosition % snapshot.fEntriesPerHistory;
+    int count = std::min(numEntriesToCopy, snapshot.fEntriesPerHistory - from);
+
+    snapshot.fPushCounts[h] = history.getPushCount();
+    history.copyMaxSnapshot(from, count, snapshot.getEntries(h) + from);
+
+    fPausedSnapshotPosition += count;
+    numEntriesToCopy -= count;
+  }
+
+  if(fPausedSnapshotPosition == numEntries)
+  {
+    fSharedHistoryChannel->publishSnapshot();
+    fPausedSnapshotPosition = -1;
+  }
+}
+
+/////////////////////////////////////////
+// VAC6Processor::computeUIGeneration
+/////////////////////////////////////////
+int64 VAC6Processor::computeUIGeneration() const
+{
+  // every generation only increases => so does the sum (which is why the hidden channels/loudness are included)
+  auto generation = fUIGeneration;
+
+  for(int c = 0; c < fChannelBank->getNumChannels(); c++)
+    generation += fChannelBank->getChannel(c).getDisplayGeneration();
+
+  generation += fLoudnessProcessor->getHistory(LCD_LOUDNESS_MOMENTARY).getDisplayGeneration();
+  generation += fLoudnessProcessor->getHistory(LCD_LOUDNESS_SHORT_TERM).getDisplayGeneration();
+
+  return generation;
+}
+
+/////////////////////////////////////////
+// VAC6Processor::findParamValueQueue
+/////////////////////////////////////////
+IParamValueQueue *VAC6Processor::findParamValueQueue(IParameterChanges *iChanges, ParamID iParamID)
+{
+  if(!iChanges)
+    return nullptr;
+
+  int32 numParamsChanged = iChanges->getParameterCount();
+  for(int32 i = 0; i < numParamsChanged; ++i)
+  {
+    auto paramQueue = iChanges->getParameterData(i);
+    if(paramQueue && paramQueue->getParameterId() == iParamID && paramQueue->getPointCount() > 0)
+      return paramQueue;
+  }
+
+  return nullptr;
+}
+
+/////////////////////////////////////////
+// VAC6Processor::addGainChanges
+/////////////////////////////////////////
+void VAC6Processor::addGainChanges(ProcessData &data)
+{
+  IParamValueQueue *queues[2] = {
+    findParamValueQueue(data.inputParameterChanges, EVAC6ParamID::kGain1),
+    findParamValueQueue(data.inputParameterChanges, EVAC6ParamID::kGain2)
+  };
+
+  // the gains changed without automation (ex: state restored) => the change happens at the start of the block
+  if(!queues[0] && !queues[1])
+  {
+    fGain1Value = fState.fGain1->getValue();
+    fGain2Value = fState.fGain2->getValue();
+    fGain.addTargetValue(0, fGain1Value * fGain2Value);
+    return;
+  }
+
+  double *values[2] = {&fGain1Value, &fGain2Value};
+  int32 numPoints[2] = {queues[0] ? queues[0]->getPointCount() : 0, queues[1] ? queues[1]->getPointCount() : 0};
+  int32 nextPoint[2] = {0, 0};
+
+  GainParamConverter converter{};
+
+  // merges the points of both queues in offset order
+  while(true)
+  {
+    int next = -1;
+    int32 offset = 0;
+    ParamValue value = 0;
+
+    for(int q = 0; q < 2; q++)
+    {
+      int32 pointOffset;
+      ParamValue pointValue;
+      if(nextPoint[q] < numPoints[q] &&
+         queues[q]->getPoint(nextPoint[q], pointOffset, pointValue) == kResultTrue &&
+         (next == -1 || pointOffset < offset))
+      {
+        next = q;
+        offset = pointOffset;
+        value = pointValue;
+      }
+    }
+
+    if(next == -1)
+      break;
+
+    *values[next] = converter.denormalize(value).getValue();
+    nextPoint[next]++;
+
+    fGain.addTargetValue(offset, fGain1Value * fGain2Value);
+  }
+}
+
+/////////////////////////////////////////
+// VAC6Processor::computeSelectionStats
+/////////////////////////////////////////
+void VAC6Processor::computeSelectionStats(SelectionStats &oSelectionStats)
+{
+  oSelectionStats = SelectionStats{};
+
+  // only available when paused
+  if(*fState.fLCDLiveView || *fState.fLCDInputX == LCD_INPUT_X_NOTHING_SELECTED)
+    return;
+
+  int selectionStartX = *fState.fLCDSelectionStartX;
+  if(selectionStartX == LCD_INPUT_X_NOTHING_SELECTED)
+    selectionStartX = *fState.fLCDInputX;
+
+  int fromOffset, toOffset;
+  fZoomWindow->computeBufferRange(std::min(selectionStartX, *fState.fLCDInputX),
+                                  std::max(selectionStartX, *fState.fLCDInputX),
+                                  fromOffset,
+                                  toOffset);
+
+  // the stats (other than the max) are only available for the part of the selection still at full resolution
+  int statsFromOffset = std::max(fromOffset, -SAMPLE_BUFFER_SIZE);
+  int statsToOffset = std::max(toOffset, statsFromOffset);
+
+  TSample sum = 0;
+  TSample sumOfMeanSquares = 0;
+
+  for(int c = 0; c < fChannelBank->getNumChannels(); c++)
+  {
+    if(!isChannelOn(c))
+      continue;
+
+    auto &channelProcessor = fChannelBank->getChannel(c);
+
+    oSelectionStats.fMax = std::max(oSelectionStats.fMax, channelProcessor.computeRangeMax(fromOffset, toOffset));
+
+    auto stats = channelProcessor.computeRangeStats(statsFromOffset, statsToOffset);
+    sum += stats.fSum;
+    sumOfMeanSquares += stats.fSumOfMeanSquares;
+    oSelectionStats.fCountAboveSoftClippingLevel += stats.fCountAboveThreshold;
+    oSelectionStats.fCount += statsToOffset - statsFromOffset;
+  }
+
+  if(oSelectionStats.fCount > 0)
+  {
+    // every entry is the max (and mean square) of the same number of samples
+    oSelectionStats.fAveragePeak = sum / oSelectionStats.fCount;
+    oSelectionStats.fRMS = std::sqrt(sumOfMeanSquares / oSelectionStats.fCount);
+  }
+}
+
 /////////////////////////////////////////
 // VAC6Processor::genericProcessInputs
 /////////////////////////////////////////
@@ -207,45 +520,70 @@ tresult VAC6Processor::genericProcessInputs(ProcessData &data)
   AudioBuffers<SampleType> in(data.inputs[0], data.numSamples);
   AudioBuffers<SampleType> out(data.outputs[0], data.numSamples);
 
-  // Handling mono or stereo only
-  if(in.getNumChannels() < 1 || in.getNumChannels() > 2 || out.getNumChannels() < 1 || out.getNumChannels() > 2)
+  // any arrangement (see setBusArrangements)
+  if(in.getNumChannels() < 1 || out.getNumChannels() < 1)
     return kResultFalse;
 
   bool isNewLiveView = false;
   bool isNewPause = false;
 
+  bool isForcedPause = false;
+
+  // sample offset (in this block) of the live view/pause change
+  int liveViewChangeOffset = 0;
+
   // some DAW like Maschine exposes the controls which then bypasses pause => force into pause
-  if(fState.fLCDInputX.hasChanged() || fState.fLCDHistoryOffset.hasChanged())
+  if(fState.fLCDInputX.hasChanged() || fState.fLCDSelectionStartX.hasChanged() || fState.fLCDHistoryOffset.hasChanged())
   {
     if(*fState.fLCDLiveView)
     {
       fState.fLCDLiveView.update(false, data);
+      isForcedPause = true;
     }
   }
 
-  // live view/pause has changed
-  if(fState.fLCDLiveView.hasChanged())
+  // live view/pause has changed (the change happens at the offset of the last point, see below)
+  bool isLiveViewChange = fState.fLCDLiveView.hasChanged();
+  if(isLiveViewChange)
   {
-    fLeftChannelProcessor->setIsLiveView(*fState.fLCDLiveView);
-    fRightChannelProcessor->setIsLiveView(*fState.fLCDLiveView);
+    // when forced into pause (above) the queue (if any) does not reflect the change
+    auto queue = isForcedPause ? nullptr : findParamValueQueue(data.inputParameterChanges, EVAC6ParamID::kLCDLiveView);
+    if(queue)
+    {
+      int32 offset;
+      ParamValue value;
+      if(queue->getPoint(queue->getPointCount() - 1, offset, value) == kResultTrue)
+        liveViewChangeOffset = std::max(0, std::min(static_cast<int>(offset), data.numSamples));
+    }
 
     isNewLiveView = *fState.fLCDLiveView;
     isNewPause =!isNewLiveView;
   }
 
+  // true peak mode has changed
+  if(fState.fTruePeak.hasChanged())
+  {
+    fChannelBank->setTruePeak(*fState.fTruePeak);
+  }
+
   // Gain filter has changed
   if(fState.fGainFilter.hasChanged())
   {
     fGain.setFilterOn(*fState.fGainFilter);
   }
 
-    // gain has changed
+  // gain has changed
   if(fState.fGain1.hasChanged() || fState.fGain2.hasChanged())
   {
-    // simply combine the 2 gains
-    fGain.setTargetValue(fState.fGain1->getValue() * fState.fGain2->getValue());
+    // simply combine the 2 gains (at the exact sample offset of each change)
+    addGainChanges(data);
   }
 
+  // while paused, the editor may zoom/scroll on its own (see LocalHistoryNavigator) and update LCDInputX and
+  // LCDHistoryOffset accordingly => only the zoom window is updated (it is used for the selection stats) and the
+  // zoomed buffers are recomputed once the editor stops doing so
+  bool isLocalNavigation = !*fState.fLCDLiveView && fSharedHistoryChannel->isLocalNavigation();
+
   // Zoom has changed
   if(fState.fZoomFactorX.hasChanged())
   {
@@ -253,19 +591,34 @@ tresult VAC6Processor::genericProcessInputs(ProcessData &data)
     {
       fZoomWindow->setZoomFactor(*fState.fZoomFactorX);
     }
+    else if(isLocalNavigation)
+    {
+      fZoomWindow->setZoomFactor(*fState.fZoomFactorX);
+      fZoomWindow->setWindowOffset(*fState.fLCDHistoryOffset);
+    }
     else
     {
+      TieredHistory<THistorySample> const *histories[MAX_NUM_CHANNELS];
+      for(int c = 0; c < fChannelBank->getNumChannels(); c++)
+        histories[c] = isChannelOn(c) ? &fChannelBank->getChannel(c).getHistory() : nullptr;
+
       int newLCDInputX =
         fZoomWindow->setZoomFactor(*fState.fZoomFactorX,
                                    fState.fLCDInputX != LCD_INPUT_X_NOTHING_SELECTED ? *fState.fLCDInputX : MAX_ARRAY_SIZE / 2,
-                                   { *fState.fLeftChannelOn ? &fLeftChannelProcessor->getMaxBuffer() : nullptr,
-                                     *fState.fRightChannelOn ? &fRightChannelProcessor->getMaxBuffer() : nullptr });
+                                   histories,
+                                   fChannelBank->getNumChannels());
 
       if(fState.fLCDInputX != LCD_INPUT_X_NOTHING_SELECTED && fState.fLCDInputX != newLCDInputX)
       {
         fState.fLCDInputX.update(newLCDInputX, data);
       }
 
+      // the start of the selection no longer represents the same point in the history => single point selection
+      if(fState.fLCDSelectionStartX != LCD_INPUT_X_NOTHING_SELECTED)
+      {
+        fState.fLCDSelectionStartX.update(LCD_INPUT_X_NOTHING_SELECTED, data);
+      }
+
       double newLCDHistoryOffset = fZoomWindow->getWindowOffset();
 
       if(newLCDHistoryOffset != fState.fLCDHistoryOffset)
@@ -274,16 +627,30 @@ tresult VAC6Processor::genericProcessInputs(ProcessData &data)
       }
     }
 
-    fLeftChannelProcessor->setDirty();
-    fRightChannelProcessor->setDirty();
+    if(isLocalNavigation)
+    {
+      fNeedToRecomputeZoomMaxBuffers = true;
+    }
+    else
+    {
+      fChannelBank->setDirty();
+      fLoudnessProcessor->setDirty();
+    }
   }
 
   // Scrollbar has been moved
   if(fState.fLCDHistoryOffset.hasChanged())
   {
     fZoomWindow->setWindowOffset(*fState.fLCDHistoryOffset);
-    fLeftChannelProcessor->setDirty();
-    fRightChannelProcessor->setDirty();
+    if(isLocalNavigation)
+    {
+      fNeedToRecomputeZoomMaxBuffers = true;
+    }
+    else
+    {
+      fChannelBank->setDirty();
+      fLoudnessProcessor->setDirty();
+    }
   }
 
   // after we cancel pause we need to reset LCDInputX and LCDHistoryOffset
@@ -294,65 +661,166 @@ tresult VAC6Processor::genericProcessInputs(ProcessData &data)
       fState.fLCDInputX.update(LCD_INPUT_X_NOTHING_SELECTED, data);
     }
 
+    if(fState.fLCDSelectionStartX != LCD_INPUT_X_NOTHING_SELECTED)
+    {
+      fState.fLCDSelectionStartX.update(LCD_INPUT_X_NOTHING_SELECTED, data);
+    }
+
     if(fState.fLCDHistoryOffset != MAX_HISTORY_OFFSET)
     {
       fState.fLCDHistoryOffset.update(MAX_HISTORY_OFFSET, data);
       fZoomWindow->setWindowOffset(*fState.fLCDHistoryOffset);
-      fLeftChannelProcessor->setDirty();
-      fRightChannelProcessor->setDirty();
+      fChannelBank->setDirty();
+      fLoudnessProcessor->setDirty();
     }
   }
 
-  // we need to adjust the filtered gain
-  fGain.adjust();
-  auto gain = *fState.fBypass ? Gain::Unity : fGain.getValue();
+  // the editor no longer zooms/scrolls on its own (live view, editor closed...)
+  if(fNeedToRecomputeZoomMaxBuffers && !isLocalNavigation)
+  {
+    fChannelBank->setDirty();
+    fLoudnessProcessor->setDirty();
+    fNeedToRecomputeZoomMaxBuffers = false;
+  }
 
-  // in mono case there could be only one channel
-  auto leftChannel = out.getLeftChannel();
-  fLeftChannelProcessor->genericProcessChannel<SampleType>(fZoomWindow, in.getLeftChannel(), leftChannel, gain);
+  // soft clipping level (owned by the UI) has changed
+  if(fState.fSelectionSoftClippingLevel.hasUpdate())
+  {
+    auto softClippingLevel = *fState.fSelectionSoftClippingLevel.pop();
+    fChannelBank->setSoftClippingLevel(softClippingLevel);
+    fUIGeneration++; // selection stats
+  }
+
+  // the gain of every sample of the block (the ramp moves on even when bypassed)
+  auto gain = fGain.generate(data.numSamples);
+  if(*fState.fBypass)
+    gain = BlockGain{Gain::Unity, nullptr};
+
+  // the samples before the live view/pause change are processed with the previous state
+  if(liveViewChangeOffset > 0)
+  {
+    fChannelBank->genericProcessChannels<SampleType>(fZoomWindow, in, out, gain, 0, liveViewChangeOffset);
+    fLoudnessProcessor->genericProcessLoudness<SampleType>(fZoomWindow, in, gain, 0, liveViewChangeOffset);
+  }
 
-  if(in.getNumChannels() == 2)
+  if(isLiveViewChange)
   {
-    auto rightChannel = out.getNumChannels() == 2 ? out.getRightChannel() : leftChannel;
-    fRightChannelProcessor->genericProcessChannel<SampleType>(fZoomWindow, in.getRightChannel(), rightChannel, gain);
+    fChannelBank->setIsLiveView(*fState.fLCDLiveView);
+    fLoudnessProcessor->setIsLiveView(*fState.fLCDLiveView);
   }
 
+  // all the channels in one pass
+  fChannelBank->genericProcessChannels<SampleType>(fZoomWindow, in, out, gain, liveViewChangeOffset, data.numSamples);
+
+  // the loudness combines the (front) left and right channels
+  fLoudnessProcessor->genericProcessLoudness<SampleType>(fZoomWindow, in, gain, liveViewChangeOffset, data.numSamples);
+
   // if reset of max level is requested (pressing momentary button) then we need to reset the accumulator
   if(*fState.fMaxLevelReset)
   {
-    fLeftChannelProcessor->resetMaxLevelSinceReset();
-    fRightChannelProcessor->resetMaxLevelSinceReset();
+    fChannelBank->resetMaxLevelSinceReset();
   }
 
-  // is it time to update the UI?
-  if(isNewPause || fRateLimiter.shouldUpdate(static_cast<uint32>(data.numSamples)))
+  // the parameters which change what is displayed (without changing the zoomed samples)
+  if(isLiveViewChange ||
+     fState.fLeftChannelOn.hasChanged() ||
+     fState.fRightChannelOn.hasChanged() ||
+     fState.fLCDChannelView.hasChanged() ||
+     fState.fLCDLoudness.hasChanged() ||
+     fState.fLCDInputX.hasChanged() ||
+     fState.fLCDSelectionStartX.hasChanged())
   {
-    fState.fHistoryData.broadcast([this](HistoryData *oHistoryData) {
+    fUIGeneration++;
+  }
 
-      LCDData &lcdData = oHistoryData->fLCDData;
+  // the editor (same process) has just been opened => it needs the data right away
+  bool isSharedHistoryReaderAttached = fSharedHistoryChannel->isReaderAttached();
+  bool isNewReader = isSharedHistoryReaderAttached && !fIsSharedHistoryReaderAttached;
+  fIsSharedHistoryReaderAttached = isSharedHistoryReaderAttached;
 
-      // left
-      if(*fState.fLeftChannelOn)
-      {
-        fLeftChannelProcessor->computeZoomSamples(MAX_ARRAY_SIZE, lcdData.fLeftChannel.fSamples);
-        lcdData.fLeftChannel.fMaxLevelSinceReset = fLeftChannelProcessor->getMaxLevelSinceReset();
-      }
-      lcdData.fLeftChannel.fOn = *fState.fLeftChannelOn;
+  // the (frozen) histories are copied for the editor while paused (see SharedHistoryChannel)
+  if(PAUSED_SNAPSHOT_ENABLED)
+  {
+    if(isNewLiveView)
+    {
+      fSharedHistoryChannel->invalidateSnapshot();
+      fPausedSnapshotPosition = -1;
+    }
 
+    if(!*fState.fLCDLiveView && isSharedHistoryReaderAttached && (isNewPause || isNewReader))
+    {
+      fSharedHistoryChannel->beginSnapshot();
+      fPausedSnapshotPosition = 0;
+    }
 
-      // right
-      if(*fState.fRightChannelOn)
-      {
-        fRightChannelProcessor->computeZoomSamples(MAX_ARRAY_SIZE, lcdData.fRightChannel.fSamples);
-        lcdData.fRightChannel.fMaxLevelSinceReset = fRightChannelProcessor->getMaxLevelSinceReset();
-      }
-      lcdData.fRightChannel.fOn = *fState.fRightChannelOn;
+    if(fPausedSnapshotPosition >= 0)
+      continuePausedSnapshot();
+  }
 
-    });
+  // is it time to update the UI? (only when something visible changed)
+  if(fUIUpdateScheduler.shouldUpdate(static_cast<uint32>(data.numSamples),
+                                     computeUIGeneration(),
+                                     isNewPause || isNewReader))
+  {
+    if(isSharedHistoryReaderAttached)
+    {
+      computeHistoryData(fSharedHistoryChannel->getWriteBuffer());
+      fSharedHistoryChannel->publish();
+      fSharedHistoryChannel->getMetrics().recordSharedPublish();
+    }
+    else
+    {
+      fState.fHistoryData.broadcast([this](HistoryData *oHistoryData) { computeHistoryData(*oHistoryData); });
+      fSharedHistoryChannel->getMetrics().recordBroadcast();
+    }
+  }
+  fSharedHistoryChannel->getMetrics().setSuppressedBroadcastCount(fUIUpdateScheduler.getSuppressedCount());
+
+  // the (debug) dump button was pressed => the metrics are sent to the UI (which logs them)
+  if(fState.fMetricsDump.hasChanged() && *fState.fMetricsDump)
+  {
+    auto &metrics = fSharedHistoryChannel->getMetrics();
+    metrics.recordDump();
+    fState.fMetricsData.broadcast([&metrics](MetricsSnapshot *oSnapshot) { metrics.snapshot(*oSnapshot); });
   }
 
   return kResultOk;
 }
 
+/////////////////////////////////////////
+// VAC6Processor::computeHistoryData
+/////////////////////////////////////////
+void VAC6Processor::computeHistoryData(HistoryData &oHistoryData)
+{
+  LCDData &lcdData = oHistoryData.fLCDData;
+
+  // channels (only the ones displayed are sent)
+  lcdData.fNumChannels = fChannelBank->getNumChannels();
+  for(int c = 0; c < lcdData.fNumChannels; c++)
+  {
+    auto &channel = lcdData.fChannels[c];
+    channel.fOn = isChannelOn(c);
+    if(channel.fOn)
+    {
+      fChannelBank->getChannel(c).computeZoomSamples(MAX_ARRAY_SIZE, channel.fSamples);
+      channel.fZoomPointCount = fChannelBank->getChannel(c).getZoomPointCount();
+      channel.fMaxLevelSinceReset = fChannelBank->getChannel(c).getMaxLevelSinceReset();
+    }
+    else
+      channel.fMaxLevelSinceReset = -1; // a hidden channel does not contribute to the max level since reset
+  }
+
+  // loudness
+  if(*fState.fLCDLoudness != LCD_LOUDNESS_OFF)
+  {
+    auto const &loudnessHistory = fLoudnessProcessor->getHistory(*fState.fLCDLoudness);
+    loudnessHistory.computeZoomSamples(MAX_ARRAY_SIZE, lcdData.fLoudness.fSamples);
+    lcdData.fLoudness.fZoomPointCount = loudnessHistory.getZoomPointCount();
+  }
+  lcdData.fLoudness.fOn = *fState.fLCDLoudness != LCD_LOUDNESS_OFF;
+
+  computeSelectionStats(oHistoryData.fSelectionStats);
+}
+
 }
 }
\ No newline at end of file
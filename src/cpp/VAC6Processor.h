@@ -11,7 +11,14 @@
 #include "VAC6Model.h"
 #include "ZoomWindow.h"
 #include "VAC6AudioChannelProcessor.h"
+#include "VAC6ChannelBank.h"
+#include "VAC6LoudnessProcessor.h"
+#include "GainRamp.h"
+#include "DiskHistory.h"
+#include "SharedHistoryChannel.h"
+#include "UIUpdateScheduler.h"
 #include "VAC6Plugin.h"
+#include "RTSafety.h"
 
 namespace pongasoft {
 namespace VST {
@@ -58,6 +65,28 @@ public:
   // This is where the setup happens which depends on sample rate, etc..
   tresult PLUGIN_API setupProcessing(ProcessSetup &setup) override;
 
+  /**
+   * Accepts any speaker arrangement (from mono to MAX_NUM_CHANNELS channels) for the input and output buses. All
+   * the input channels are metered (see VAC6ChannelBank).
+   */
+  tresult PLUGIN_API setBusArrangements(SpeakerArrangement *inputs, int32 numIns,
+                                        SpeakerArrangement *outputs, int32 numOuts) override;
+
+  /**
+   * Sends the shared history channel to the controller (see SharedHistoryChannel)
+   */
+  tresult PLUGIN_API connect(IConnectionPoint *other) override;
+
+  /**
+   * The whole realtime callback is checked (see RTSafety.h): not only the processing of the inputs but also what
+   * the framework does before (parameter changes) and after (output parameters, RTJmbOutParam updates)
+   */
+  tresult PLUGIN_API process(ProcessData &data) override
+  {
+    VAC6_RT_SAFETY_SCOPE("process");
+    return RTProcessor::process(data);
+  }
+
 protected:
   /**
    * Processes inputs (step 2 always called after processing the parameters)
@@ -65,27 +94,112 @@ protected:
   template<typename SampleType>
   tresult genericProcessInputs(ProcessData &data);
 
+  /**
+   * Calls genericProcessInputs and records the time it took (see ProcessMetrics)
+   */
+  template<typename SampleType>
+  tresult measureProcessInputs(ProcessData &data)
+  {
+    auto startTime = ProcessMetrics::now();
+    auto res = genericProcessInputs<SampleType>(data);
+    fSharedHistoryChannel->getMetrics().recordBlock(data.numSamples, ProcessMetrics::now() - startTime);
+    return res;
+  }
+
   // processInputs32Bits
-  tresult processInputs32Bits(ProcessData &data) override { return genericProcessInputs<Sample32>(data); }
+  tresult processInputs32Bits(ProcessData &data) override
+  {
+    return measureProcessInputs<Sample32>(data);
+  }
 
   // processInputs64Bits
-  tresult processInputs64Bits(ProcessData &data) override { return genericProcessInputs<Sample64>(data); }
+  tresult processInputs64Bits(ProcessData &data) override
+  {
+    return measureProcessInputs<Sample64>(data);
+  }
+
+  /**
+   * Computes the stats (at full resolution) of the selected range (when paused) using the range indices
+   * maintained by each channel (O(log n)). The part of the selection older than the full resolution history only
+   * contributes to the max.
+   */
+  void computeSelectionStats(SelectionStats &oSelectionStats);
+
+  /**
+   * Computes the data sent to the UI (through the shared history channel or the messaging)
+   */
+  void computeHistoryData(HistoryData &oHistoryData);
+
+  /**
+   * Copies (at most PAUSED_SNAPSHOT_ENTRIES_PER_BLOCK entries of) the (frozen) histories in the paused history
+   * snapshot of the shared history channel and publishes it when complete
+   */
+  void continuePausedSnapshot();
+
+  /**
+   * @return the generation of what the UI displays (changes every time something visible changes, see
+   *         UIUpdateScheduler)
+   */
+  int64 computeUIGeneration() const;
+
+  /**
+   * @return true if the channel is displayed (see LCD_CHANNEL_VIEW_ALL)
+   */
+  bool isChannelOn(int iChannel) const;
+
+  /**
+   * Adds the changes of the 2 gains in this block to fGain at their exact sample offset (the points of both queues
+   * are merged in offset order)
+   */
+  void addGainChanges(ProcessData &data);
+
+  /**
+   * @return the queue of the changes of the parameter in this block (nullptr if it did not change)
+   */
+  static IParamValueQueue *findParamValueQueue(IParameterChanges *iChanges, ParamID iParamID);
+
+  /////////////////////////////////////////////////////////////////////
+  // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+  // !! The methods below are public only for the purpose of testing !!
+  // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+  /////////////////////////////////////////////////////////////////////
+public:
+  // the channel the editor uses when it lives in the same process (see connect)
+  inline SharedHistoryChannel &__getSharedHistoryChannel() { return *fSharedHistoryChannel; }
 
 private:
+  // used instead of fState.fHistoryData when the editor is open in the same process (declared first: its metrics are
+  // given to fParameters)
+  std::shared_ptr<SharedHistoryChannel> fSharedHistoryChannel;
+
   VAC6Parameters fParameters;
   VAC6RTState fState;
 
-  FilteredGain fGain;
+  // combined gain (sample accurate) and the last value of each gain
+  GainRamp fGain;
+  double fGain1Value;
+  double fGain2Value;
 
   SampleRateBasedClock fClock;
 
   uint32 fMaxAccumulatorBatchSize;
   ZoomWindow *fZoomWindow;
 
-  VAC6AudioChannelProcessor *fLeftChannelProcessor;
-  VAC6AudioChannelProcessor *fRightChannelProcessor;
+  VAC6ChannelBank *fChannelBank; // as many channels as the input bus
+  VAC6LoudnessProcessor *fLoudnessProcessor;
+
+  // writes/reads the disk histories (if any) of the channels (must be stopped before deleting them)
+  DiskHistoryThread fDiskHistoryThread;
+
+  // the UI is only updated when something visible changed (at most every UI_FRAME_RATE_MS)
+  UIUpdateScheduler fUIUpdateScheduler;
+  int64 fUIGeneration; // changes of the parameters affecting what is displayed
+  bool fIsSharedHistoryReaderAttached; // state of the reader when the UI was last updated
 
-  SampleRateBasedClock::RateLimiter fRateLimiter;
+  // next entry of the paused history snapshot to copy (-1 when not copying, see continuePausedSnapshot)
+  int fPausedSnapshotPosition;
+  // the editor zoomed/scrolled on its own while paused => the zoomed buffers are stale
+  bool fNeedToRecomputeZoomMaxBuffers;
 };
 
 }
@@ -30,7 +30,7 @@ ZoomWindow::ZoomWindow(int iVisibleWindowSize, int iBufferSize) :
 TZoom::MaxAccumulator ZoomWindow::setZoomFactor(double iZoomFactorPercent)
 {
   DCHECK_F(iZoomFactorPercent >= 0 && iZoomFactorPercent <= 1.0);
-  return __setRawZoomFactor(getZoomFactorLerp().computeY(iZoomFactorPercent));
+  return __setRawZoomFactor(computeZoomFactor(iZoomFactorPercent));
 }
 
 ////////////////////////////////////////////////////////////
@@ -64,10 +64,13 @@ TZoom::MaxAccumulator ZoomWindow::__setRawZoomFactor(double iZoomFactor)
 ////////////////////////////////////////////////////////////
 // ZoomWindow::setZoomFactor
 ////////////////////////////////////////////////////////////
-int ZoomWindow::setZoomFactor(double iZoomFactorPercent, int iOffsetFromLeftOfScreen, std::initializer_list<CircularBuffer<TSample> const *>iBuffers)
+int ZoomWindow::setZoomFactor(double iZoomFactorPercent,
+                              int iOffsetFromLeftOfScreen,
+                              TieredHistory<THistorySample> const * const *iHistories,
+                              int iNumHistories)
 {
   DCHECK_F(iZoomFactorPercent >= 0 && iZoomFactorPercent <= 1.0);
-  return __setRawZoomFactor(getZoomFactorLerp().computeY(iZoomFactorPercent), iOffsetFromLeftOfScreen, iBuffers);
+  return __setRawZoomFactor(computeZoomFactor(iZoomFactorPercent), iOffsetFromLeftOfScreen, iHistories, iNumHistories);
 }
 
 ////////////////////////////////////////////////////////////
@@ -75,7 +78,8 @@ int ZoomWindow::setZoomFactor(double iZoomFactorPercent, int iOffsetFromLeftOfSc
 ////////////////////////////////////////////////////////////
 int ZoomWindow::__setRawZoomFactor(double iZoomFactor,
                                    int iOffsetFromLeftOfScreen,
-                                   std::initializer_list<CircularBuffer<TSample> const *>iBuffers)
+                                   TieredHistory<THistorySample> const * const *iHistories,
+                                   int iNumHistories)
 {
   DCHECK_F(iZoomFactor >= 1.0 && iZoomFactor <= fMaxZoomFactor);
   DCHECK_F(iOffsetFromLeftOfScreen >= 0 && iOffsetFromLeftOfScreen < fVisibleWindowSize);
@@ -85,14 +89,15 @@ int ZoomWindow::__setRawZoomFactor(double iZoomFactor,
 
   // we capture the offset prior to zooming
   int maxOffset = 0;
-  TSample max = 0;
+  THistorySample max = 0;
 
-  for(auto buffer : iBuffers)
+  for(int i = 0; i < iNumHistories; i++)
   {
-    if(buffer)
+    auto history = iHistories[i];
+    if(history)
     {
       int newMaxOffset = 0;
-      TSample newMax = __findMaxForIndex(beforeZoomPointIndex, *buffer, newMaxOffset);
+      THistorySample newMax = __findMaxForIndex(beforeZoomPointIndex, *history, newMaxOffset);
       if(newMax > max)
       {
         max = newMax;
@@ -139,26 +144,170 @@ int ZoomWindow::__setRawZoomFactor(double iZoomFactor,
   return iOffsetFromLeftOfScreen;
 }
 
+////////////////////////////////////////////////////////////
+// ZoomWindow::beginZoomWindow
+////////////////////////////////////////////////////////////
+ZoomWindow::PendingPoints ZoomWindow::beginZoomWindow(CircularBuffer<THistorySample> const &iPreviousBuffer,
+                                                      ComputedWindow const &iPreviousWindow,
+                                                      CircularBuffer<THistorySample> &oBuffer) const
+{
+  DCHECK_EQ_F(fVisibleWindowSize, iPreviousBuffer.getSize());
+  DCHECK_EQ_F(fVisibleWindowSize, oBuffer.getSize());
+
+  PendingPoints res{};
+  res.fWindow.fBatchSizeInSamples = fZoom.getBatchSizeInSamples();
+  res.fWindow.fWindowOffset = fWindowOffset;
+  res.fZoom = fZoom;
+
+  // by default, all the points need to be computed
+  res.fIdx = fWindowOffset - fVisibleWindowSize + 1;
+  res.fPosition = 0;
+  res.fNumPoints = fVisibleWindowSize;
+
+  // how many points the window has moved (> 0 means moved right/more recent)
+  int shift = fWindowOffset - iPreviousWindow.fWindowOffset;
+
+  bool canShift = iPreviousWindow.isValid() &&
+                  iPreviousWindow.fBatchSizeInSamples == fZoom.getBatchSizeInSamples() &&
+                  std::abs(shift) < fVisibleWindowSize;
+
+  if(!canShift)
+    return res;
+
+  if(shift > 0)
+  {
+    // the points move to the left (iterating from the start so that it works in place)
+    for(int i = 0; i < fVisibleWindowSize - shift; i++)
+      oBuffer.setAt(i, iPreviousBuffer.getAt(i + shift));
+
+    // and the new ones are on the right
+    res.fIdx = fWindowOffset - shift + 1;
+    res.fPosition = fVisibleWindowSize - shift;
+    res.fNumPoints = shift;
+  }
+  else
+  {
+    // the points move to the right (iterating from the end so that it works in place)
+    for(int i = fVisibleWindowSize - 1; i >= -shift; i--)
+      oBuffer.setAt(i, iPreviousBuffer.getAt(i + shift));
+
+    // and the new ones are on the left
+    res.fNumPoints = -shift;
+  }
+
+  return res;
+}
+
 ////////////////////////////////////////////////////////////
 // ZoomWindow::computeZoomWindow
 ////////////////////////////////////////////////////////////
-TZoom::MaxAccumulator ZoomWindow::computeZoomWindow(CircularBuffer<TSample> const &iBuffer, CircularBuffer<TSample> &oBuffer) const
+void ZoomWindow::computeZoomWindow(TieredHistory<THistorySample> const &iHistory,
+                                   PendingPoints &ioPendingPoints,
+                                   int iMaxNumPoints,
+                                   int iPushCount,
+                                   CircularBuffer<THistorySample> &oBuffer) const
 {
-  DCHECK_EQ_F(fBufferSize, iBuffer.getSize());
+  DCHECK_GE_F(fBufferSize, iHistory.getHistorySize());
   DCHECK_EQ_F(fVisibleWindowSize, oBuffer.getSize());
 
+  int numPoints = std::min(iMaxNumPoints, ioPendingPoints.fNumPoints);
+
+  if(numPoints <= 0)
+    return;
+
+  auto const &zoom = ioPendingPoints.fZoom;
+  int tier = getHistoryTier(zoom, iHistory);
+
+  auto rangeMax = [&iHistory, tier] (int iFromOffset, int iToOffset) {
+    return iHistory.getMax(clampToHistory(iHistory, iFromOffset), clampToHistory(iHistory, iToOffset), tier);
+  };
+
+  computeZoomPoints(zoom, rangeMax, ioPendingPoints.fIdx, numPoints, iPushCount, oBuffer, ioPendingPoints.fPosition);
+
+  ioPendingPoints.fIdx += numPoints;
+  ioPendingPoints.fPosition += numPoints;
+  ioPendingPoints.fNumPoints -= numPoints;
+}
+
+////////////////////////////////////////////////////////////
+// ZoomWindow::endZoomWindow
+////////////////////////////////////////////////////////////
+TZoom::MaxAccumulator ZoomWindow::endZoomWindow(PendingPoints const &iPendingPoints, ComputedWindow &oWindow) const
+{
+  DCHECK_F(iPendingPoints.isDone());
+
+  oWindow = iPendingPoints.fWindow;
+
+  return getMaxAccumulatorAfterRightOfScreen(iPendingPoints.fWindow.fWindowOffset);
+}
+
+////////////////////////////////////////////////////////////
+// ZoomWindow::computeBufferRange
+////////////////////////////////////////////////////////////
+void ZoomWindow::computeBufferRange(int iFromPosition, int iToPosition, int &oFromOffset, int &oToOffset) const
+{
+  DCHECK_F(iFromPosition >= 0 && iFromPosition <= iToPosition && iToPosition < fVisibleWindowSize);
+
+  int leftOfScreenIdx = fWindowOffset - fVisibleWindowSize + 1;
+
+  __getMaxAccumulatorFromIndex(leftOfScreenIdx + iFromPosition, oFromOffset);
+
+  int lastOffset;
+  auto accumulator = __getMaxAccumulatorFromIndex(leftOfScreenIdx + iToPosition, lastOffset);
+  oToOffset = lastOffset + fZoom.fBatchSizes[accumulator.getBatchSizeIdx()];
+}
+
+////////////////////////////////////////////////////////////
+// ZoomWindow::getMaxAccumulatorAfterRightOfScreen
+////////////////////////////////////////////////////////////
+TZoom::MaxAccumulator ZoomWindow::getMaxAccumulatorAfterRightOfScreen(int iWindowOffset) const
+{
+  // the batch size index only depends on the zoom point index (not on the zoom factor)
+  int offset;
+  int batchSizeIdx = fZoom.getAccumulatorFromIndex(iWindowOffset, offset).getBatchSizeIdx() + 1;
+  if(batchSizeIdx == fZoom.getBatchSize())
+    batchSizeIdx = 0;
+
+  return TZoom::MaxAccumulator{&fZoom, batchSizeIdx};
+}
+
+////////////////////////////////////////////////////////////
+// ZoomWindow::computeZoomPoints
+////////////////////////////////////////////////////////////
+template<typename RangeMax>
+void ZoomWindow::computeZoomPoints(TZoom const &iZoom,
+                                   RangeMax const &iRangeMax,
+                                   int iFirstIdx,
+                                   int iNumPoints,
+                                   int iPushCount,
+                                   CircularBuffer<THistorySample> &oBuffer,
+                                   int iFirstPosition) const
+{
   int offset = 0;
-  auto accumulator = __getMaxAccumulatorFromLeftOfScreen(offset);
+  auto accumulator = iZoom.getAccumulatorFromIndex(iFirstIdx, offset);
+  DCHECK_F(offset >= -fBufferSize && offset <= -1);
+
+  // each point represents fBatchSizes[batchSizeIdx] samples in the buffer
+  int batchSizeIdx = accumulator.getBatchSizeIdx();
 
-  TSample max;
-  for(int i = 0; i < fVisibleWindowSize; i++)
+  // entries pushed in the meantime moved everything to the left
+  offset -= iPushCount;
+
+  for(int i = 0; i < iNumPoints; i++)
   {
-    while(!accumulator.accumulate(iBuffer.getAt(offset++), max))
-    {}
-    oBuffer.push(max);
-  }
+    int numSamples = iZoom.fBatchSizes[batchSizeIdx];
 
-  return accumulator;
+    // entries pushed out of the buffer in the meantime are ignored
+    int fromOffset = std::max(offset, -fBufferSize);
+    int toOffset = std::max(offset + numSamples, fromOffset);
+
+    oBuffer.setAt(iFirstPosition + i, iRangeMax(fromOffset, toOffset));
+    offset += numSamples;
+
+    batchSizeIdx++;
+    if(batchSizeIdx == iZoom.getBatchSize())
+      batchSizeIdx = 0;
+  }
 }
 
 ////////////////////////////////////////////////////////////
@@ -182,18 +331,21 @@ TZoom::MaxAccumulator ZoomWindow::__getMaxAccumulatorFromLeftOfScreen(int &oOffs
 }
 
 ////////////////////////////////////////////////////////////
-// ZoomWindow::__getMaxAccumulatorFromIndex
+// ZoomWindow::__findMaxForIndex
 ////////////////////////////////////////////////////////////
-TSample ZoomWindow::__findMaxForIndex(int iIdx, CircularBuffer<TSample> const &iBuffer, int &oMaxOffset) const
+THistorySample ZoomWindow::__findMaxForIndex(int iIdx, TieredHistory<THistorySample> const &iHistory, int &oMaxOffset) const
 {
   DCHECK_F(iIdx >= __getMinWindowIdx() && iIdx <= MAX_WINDOW_OFFSET);
 
   int firstOffsetInBatch;
   auto accumulator = __getMaxAccumulatorFromIndex(iIdx, firstOffsetInBatch);
 
-  int nextOffset = 0;
+  int nextOffset = firstOffsetInBatch + fZoom.fBatchSizes[accumulator.getBatchSizeIdx()];
 
-  return accumulator.accumulate<TSample>(iBuffer, firstOffsetInBatch, oMaxOffset, nextOffset);
+  return iHistory.findMax(clampToHistory(iHistory, firstOffsetInBatch),
+                          clampToHistory(iHistory, nextOffset),
+                          getHistoryTier(iHistory),
+                          oMaxOffset);
 }
 
 ////////////////////////////////////////////////////////////
@@ -5,6 +5,9 @@
 #include <pongasoft/Utils/Collection/CircularBuffer.h>
 #include <pongasoft/Utils/Lerp.h>
 #include <algorithm>
+#include <type_traits>
+#include "TieredHistory.h"
+#include "HistorySample.h"
 #include <cmath>
 
 namespace pongasoft {
@@ -20,12 +23,14 @@ constexpr int MAX_WINDOW_OFFSET = -1;
 /**
  * batchSize is linked to how precise you want to be in regards to the zoom factor
  * For example a batchSize of 10 means that means that we can handle zoom factor like 1.2, 3.4, etc...
- * For example a batchSize of 100 means that means that we can handle zoom factor like 1.24, 3.49, etc... */
-template <int batchSize = 10>
+ * For example a batchSize of 100 means that means that we can handle zoom factor like 1.24, 3.49, etc...
+ *
+ * StorageType is the type of the entries of the buffers being zoomed */
+template <int batchSize = 10, typename StorageType = THistorySample>
 class Zoom
 {
 public:
-  using class_type = Zoom<batchSize>;
+  using class_type = Zoom<batchSize, StorageType>;
 
   /**
    * Class which helps in accumulating samples when zoomed. Zoom::fBatchSizes is used to keep track of how many
@@ -56,10 +61,9 @@ public:
      * Accumulate the given sample. If a batch is complete (as defined by the Zoom) then it returns true and
      * populate oMaxSample with the value. Otherwise it returns false and does not modify oMaxSample
      */
-    template<typename SampleType>
-    bool accumulate(SampleType iSample, SampleType &oMaxSample)
+    bool accumulate(StorageType iSample, StorageType &oMaxSample)
     {
-      if(iSample < 0)
+      if(std::is_signed<StorageType>::value && iSample < 0)
         iSample = -iSample;
 
       fAccumulatedMax = std::max(fAccumulatedMax, iSample);
@@ -86,26 +90,28 @@ public:
      * @param oNextOffset the next offset to continue calling this method
      * @return the max sample
      */
-    template<typename SampleType>
-    SampleType accumulate(CircularBuffer<TSample> const &iBuffer, int iStartOffset, int &oMaxOffset, int &oNextOffset)
+    StorageType accumulate(CircularBuffer<StorageType> const &iBuffer, int iStartOffset, int &oMaxOffset, int &oNextOffset)
     {
-      SampleType firstMax = -1;
+      // the first sample always sets firstMax (StorageType may be unsigned so there is no "lower than any" value)
+      StorageType firstMax = 0;
+      bool hasFirstMax = false;
 
       oNextOffset = iStartOffset;
       oMaxOffset = -1;
-      SampleType max = 0;
+      StorageType max = 0;
 
       while(!accumulate(iBuffer.getAt(oNextOffset), max))
       {
-        if(fAccumulatedMax > firstMax)
+        if(!hasFirstMax || fAccumulatedMax > firstMax)
         {
+          hasFirstMax = true;
           firstMax = fAccumulatedMax;
           oMaxOffset = oNextOffset;
         }
         oNextOffset++;
       }
 
-      if(max > firstMax)
+      if(!hasFirstMax || max > firstMax)
       {
         firstMax = max;
         oMaxOffset = oNextOffset;
@@ -118,7 +124,7 @@ public:
 
 
     // getAccumulatedMax
-    TSample getAccumulatedMax() const
+    StorageType getAccumulatedMax() const
     {
       return fAccumulatedMax;
     }
@@ -138,7 +144,7 @@ public:
   private:
     class_type const *fZoom;
 
-    TSample fAccumulatedMax;
+    StorageType fAccumulatedMax;
     int fAccumulatedSamples;
     int fBatchSizeIdx;
   };
@@ -152,7 +158,10 @@ public:
     setZoomFactor(iZoomFactor);
   }
 
-  Zoom(Zoom const&) = delete;
+  // copyable so that a computation spread over several blocks keeps the zoom it started with (see
+  // ZoomWindow::PendingPoints) => the accumulators keep pointing to the zoom they were created from
+  Zoom(Zoom const&) = default;
+  Zoom &operator=(Zoom const&) = default;
 
   /**
    * @param iZoomFactor zoom factor is 1.0 for min zoom. 2.0 for example means twice as big... etc...
@@ -244,19 +253,74 @@ using TZoom = Zoom<10>;
  */
 class ZoomWindow
 {
+public:
+  /**
+   * Keeps track of the window (zoom and offset) a zoomed buffer was computed for, so that when only the offset
+   * changes, the buffer can be shifted in place and only the newly exposed points need to be computed. There is
+   * one per zoomed buffer (the zoom window itself is shared).
+   */
+  class ComputedWindow
+  {
+  public:
+    // invalidate => next computation will be a full one (must be called when the zoomed buffer or the
+    // underlying buffer is modified outside of computeZoomWindow)
+    inline void invalidate() { fBatchSizeInSamples = -1; }
+
+    // isValid
+    inline bool isValid() const { return fBatchSizeInSamples != -1; }
+
+  private:
+    friend class ZoomWindow;
+
+    int fBatchSizeInSamples{-1};
+    int fWindowOffset{MAX_WINDOW_OFFSET};
+  };
+
+  /**
+   * The points of a zoomed buffer which remain to be computed for a given window. Allows to spread the computation
+   * over several calls (see beginZoomWindow / computeZoomWindow / endZoomWindow). The zoom is captured by
+   * beginZoomWindow so the computation can complete even if the zoom window changes in the meantime.
+   */
+  class PendingPoints
+  {
+  public:
+    // isDone
+    inline bool isDone() const { return fNumPoints == 0; }
+
+    // getNumPoints
+    inline int getNumPoints() const { return fNumPoints; }
+
+  private:
+    friend class ZoomWindow;
+
+    int fIdx{0};       // zoom point index (relative to the right of the screen) of the next point to compute
+    int fPosition{0};  // position of the next point in the zoomed buffer
+    int fNumPoints{0}; // number of points remaining
+    ComputedWindow fWindow{}; // the window being computed
+    TZoom fZoom{};            // the zoom of the window being computed
+  };
+
 public:
   ZoomWindow(int iVisibleWindowSize, int iBufferSize);
 
   /**
-   * @param iZoomFactorPercent zoom factor between 0-1 (where 1 is min zoom, and 0 is max zoom)
+   * @param iZoomFactorPercent zoom factor between 0-1 (where 1 is min zoom, and 0 is max zoom). The mapping is
+   *                           exponential (each step multiplies the zoom factor by the same amount) because the
+   *                           max zoom factor can be very big with a long history.
    */
   TZoom::MaxAccumulator setZoomFactor(double iZoomFactorPercent);
 
   /**
    * Updates the zoom factor by using the iOffsetFromLeftOfScreen as the reference point
    * As a side effect, window offset may be different and can be obtained with getWindowOffset()
+   *
+   * @param iHistories the histories (iNumHistories of them, nullptr entries being ignored) used to find the max
+   *                   at the reference point
    * @return the adjusted offsetFromLeftOfScreen (may be changed) */
-  int setZoomFactor(double iZoomFactorPercent, int iOffsetFromLeftOfScreen, std::initializer_list<CircularBuffer<TSample> const *>iBuffers);
+  int setZoomFactor(double iZoomFactorPercent,
+                    int iOffsetFromLeftOfScreen,
+                    TieredHistory<THistorySample> const * const *iHistories,
+                    int iNumHistories);
 
   /**
    * Changes the window offset. Note that window offset is an "abstract" value given as a percentage so that it does
@@ -288,11 +352,64 @@ public:
   }
 
   /**
-   * Computes the zoom
-   * @param iBuffer
-   * @param oBuffer
+   * Starts computing the current window into oBuffer: when iPreviousWindow shows that iPreviousBuffer was computed
+   * with the same zoom and an offset which overlaps the current one (scrolling), the points that remain visible are
+   * copied (shifted) into oBuffer (which can be iPreviousBuffer itself). The points that still need to be computed
+   * are returned.
    */
-  TZoom::MaxAccumulator computeZoomWindow(const CircularBuffer <TSample> &iBuffer, CircularBuffer <TSample> &oBuffer) const;
+  PendingPoints beginZoomWindow(CircularBuffer<THistorySample> const &iPreviousBuffer,
+                                ComputedWindow const &iPreviousWindow,
+                                CircularBuffer<THistorySample> &oBuffer) const;
+
+  /**
+   * Computes at most iMaxNumPoints of the pending points (from left to right) into oBuffer using the tiered history:
+   * each point is a range max query (O(log n)) on the coarsest tier which still has at least one entry per point
+   * (see getHistoryTier) so that the cost depends neither on the zoom factor nor on the length of the history. Since
+   * a point is not necessarily aligned on the entries of the tier, its max may include (part of) a tier entry of its
+   * neighbours (but it is never less than the actual max). The points (or part of the points) older than what the
+   * history covers are 0.
+   *
+   * @param iPushCount number of entries pushed in iHistory since beginZoomWindow was called (live view) which is
+   *                   used to find where the entries now are in iHistory
+   * @note the points are the ones of the window at the time beginZoomWindow was called (even if the zoom or the
+   *       offset changed since)
+   */
+  void computeZoomWindow(TieredHistory<THistorySample> const &iHistory,
+                         PendingPoints &ioPendingPoints,
+                         int iMaxNumPoints,
+                         int iPushCount,
+                         CircularBuffer<THistorySample> &oBuffer) const;
+
+  /**
+   * Completes the computation (all points must have been computed) and returns the accumulator to use for
+   * accumulating the entries pushed after the computation started. oWindow is set to the window computed. If the
+   * zoom changed since beginZoomWindow, the accumulator does not match the computed window and a new computation
+   * must be started before any entry gets accumulated.
+   */
+  TZoom::MaxAccumulator endZoomWindow(PendingPoints const &iPendingPoints, ComputedWindow &oWindow) const;
+
+  /**
+   * @return the offset clamped to what the history covers (the zoom window can cover more than the history
+   *         when the rest is provided separately, see DiskHistory)
+   */
+  static inline int clampToHistory(TieredHistory<THistorySample> const &iHistory, int iOffset)
+  {
+    return std::max(iOffset, -iHistory.getHistorySize());
+  }
+
+  /**
+   * @return the coarsest tier of the history which has at least one entry per point for the current zoom
+   */
+  inline int getHistoryTier(TieredHistory<THistorySample> const &iHistory) const
+  {
+    return getHistoryTier(fZoom, iHistory);
+  }
+
+  /**
+   * Computes the range of entries [oFromOffset, oToOffset[ (negative offsets in the buffer) represented by the
+   * points [iFromPosition, iToPosition] of the visible window (0 being the left of the screen).
+   */
+  void computeBufferRange(int iFromPosition, int iToPosition, int &oFromOffset, int &oToOffset) const;
 
   /////////////////////////////////////////////////////////////////////
   // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
@@ -307,7 +424,7 @@ public:
    * Given an index (relative to the right of the screen), find the (first) sample which gives the max result
    * and return its offset (as well as the max value)
    */
-  TSample __findMaxForIndex(int iIdx, CircularBuffer<TSample> const &iBuffer, int &oMaxOffset) const;
+  THistorySample __findMaxForIndex(int iIdx, TieredHistory<THistorySample> const &iHistory, int &oMaxOffset) const;
 
   // Convenient method to compute the zoom point at the left of the LCD screen
   TZoom::MaxAccumulator __getMaxAccumulatorFromLeftOfScreen(int &oOffset) const;
@@ -320,7 +437,10 @@ public:
   /**
    * @param iZoomFactor the zoom factor with 1.0 being no zoom, 2.0 being 2x, etc... (used internally)
    */
-  int __setRawZoomFactor(double iZoomFactor, int iOffsetFromLeftOfScreen, std::initializer_list<CircularBuffer<TSample> const *>iBuffers);
+  int __setRawZoomFactor(double iZoomFactor,
+                         int iOffsetFromLeftOfScreen,
+                         TieredHistory<THistorySample> const * const *iHistories,
+                         int iNumHistories);
 
   /**
    * Changes the window offset to the given value (used internally)
@@ -350,6 +470,33 @@ public:
     return fMaxZoomFactor;
   }
 
+private:
+  /**
+   * Computes iNumPoints points starting at the zoom point index iFirstIdx (relative to the right of the screen) and
+   * stores them in oBuffer starting at position iFirstPosition. iRangeMax(fromOffset, toOffset) computes the max of
+   * a range of entries.
+   *
+   * @param iZoom the zoom of the points (see PendingPoints)
+   * @param iPushCount see computeZoomWindow
+   */
+  template<typename RangeMax>
+  void computeZoomPoints(TZoom const &iZoom,
+                         RangeMax const &iRangeMax,
+                         int iFirstIdx,
+                         int iNumPoints,
+                         int iPushCount,
+                         CircularBuffer<THistorySample> &oBuffer,
+                         int iFirstPosition) const;
+
+  // the accumulator to use right after the point at the right of the screen (when it is at iWindowOffset)
+  TZoom::MaxAccumulator getMaxAccumulatorAfterRightOfScreen(int iWindowOffset) const;
+
+  // getHistoryTier (for iZoom)
+  static inline int getHistoryTier(TZoom const &iZoom, TieredHistory<THistorySample> const &iHistory)
+  {
+    return iHistory.findTier(std::max(1, iZoom.getBatchSizeInSamples() / iZoom.getBatchSize()));
+  }
+
 private:
   int const fVisibleWindowSize;
   int const fBufferSize;
@@ -373,17 +520,18 @@ private:
     return {fMinWindowOffset, MAX_WINDOW_OFFSET};
   }
 
-  inline Utils::DPLerp getZoomFactorLerp() const
+  // percent (0 is max zoom factor, 1 is 1.0) => zoom factor (exponential mapping)
+  inline double computeZoomFactor(double iZoomFactorPercent) const
   {
-    return {fMaxZoomFactor, 1.0};
+    return std::min(std::max(std::pow(fMaxZoomFactor, 1.0 - iZoomFactorPercent), 1.0), fMaxZoomFactor);
   }
 };
 
 ////////////////////////////////////////////////////////////
 // Zoom::init
 ////////////////////////////////////////////////////////////
-template<int batchSize>
-void Zoom<batchSize>::init()
+template<int batchSize, typename StorageType>
+void Zoom<batchSize, StorageType>::init()
 {
   int accumulatedZoom = 0;
   int accumulatedSamples = 0;
@@ -418,8 +566,8 @@ void Zoom<batchSize>::init()
 ////////////////////////////////////////////////////////////
 // Zoom::getAccumulatorFromIndex
 ////////////////////////////////////////////////////////////
-template<int batchSize>
-typename Zoom<batchSize>::MaxAccumulator Zoom<batchSize>::getAccumulatorFromIndex(int iZoomPointIndex, int &oOffset) const
+template<int batchSize, typename StorageType>
+typename Zoom<batchSize, StorageType>::MaxAccumulator Zoom<batchSize, StorageType>::getAccumulatorFromIndex(int iZoomPointIndex, int &oOffset) const
 {
   // the first element in the offset is -1 so it should always be a negative number
   DCHECK_F(iZoomPointIndex < 0);
@@ -436,14 +584,14 @@ typename Zoom<batchSize>::MaxAccumulator Zoom<batchSize>::getAccumulatorFromInde
   int offset = ((iZoomPointIndex + 1) / batchSize) * getBatchSizeInSamples(); // multiple of getBatchSizeInSamples
   oOffset = offset + fOffset[batchSizeIndex];
 
-  return Zoom<batchSize>::MaxAccumulator(this, batchSizeIndex);
+  return Zoom<batchSize, StorageType>::MaxAccumulator(this, batchSizeIndex);
 }
 
 ////////////////////////////////////////////////////////////
 // Zoom::getZoomPointIndexFromOffset
 ////////////////////////////////////////////////////////////
-template<int batchSize>
-int Zoom<batchSize>::getZoomPointIndexFromOffset(int iOffset) const
+template<int batchSize, typename StorageType>
+int Zoom<batchSize, StorageType>::getZoomPointIndexFromOffset(int iOffset) const
 {
   // iOffset should be negative
   DCHECK_F(iOffset < 0);
@@ -0,0 +1,124 @@
+#include <vstgui4/vstgui/lib/platform/platformfactory.h>
+#include <vstgui4/vstgui/lib/platform/iplatformbitmap.h>
+#include <pongasoft/logging/loguru.hpp>
+#include <cmath>
+#include "LCDColumnsBitmap.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+///////////////////////////////////////////
+// LCDColumnsBitmap::createBitmap
+///////////////////////////////////////////
+bool LCDColumnsBitmap::createBitmap(double iHeight, int iPixelsPerColumn)
+{
+  fBitmap = nullptr;
+  fIsValid = false;
+  fHeight = iHeight;
+  fPixelsPerColumn = iPixelsPerColumn;
+
+  // 1 column = iPixelsPerColumn pixels (whole pixels so that scrolling is a plain copy)
+  auto platformBitmap = getPlatformFactory().createBitmap(CPoint(MAX_ARRAY_SIZE * iPixelsPerColumn,
+                                                                 std::round(iHeight * iPixelsPerColumn)));
+  if(!platformBitmap)
+    return false;
+
+  platformBitmap->setScaleFactor(iPixelsPerColumn);
+  fBitmap = makeOwned<CBitmap>(platformBitmap);
+  return true;
+}
+
+///////////////////////////////////////////
+// LCDColumnsBitmap::update
+///////////////////////////////////////////
+bool LCDColumnsBitmap::update(CDrawContext *iContext,
+                              double iHeight,
+                              THistorySample const *iSamples,
+                              double iSoftClippingLevel,
+                              CColor const (&iBandColors)[Columns::kNumBands],
+                              Columns const &iColumns)
+{
+  if(!fIsSupported)
+    return false;
+
+  auto pixelsPerColumn = std::max(1, static_cast<int>(std::lround(iContext->getScaleFactor())));
+
+  if(!fBitmap || fHeight != iHeight || fPixelsPerColumn != pixelsPerColumn)
+  {
+    if(!createBitmap(iHeight, pixelsPerColumn))
+    {
+      DLOG_F(WARNING, "LCDColumnsBitmap::update() - offscreen bitmap not supported");
+      fIsSupported = false;
+      return false;
+    }
+  }
+
+  int shift = -1;
+
+  if(fIsValid && fSoftClippingLevel == iSoftClippingLevel &&
+     std::equal(std::begin(fBandColors), std::end(fBandColors), std::begin(iBandColors)))
+  {
+    shift = Columns::computeShift(fSamples, iSamples, MAX_SHIFT);
+
+    // nothing changed
+    if(shift == 0)
+      return true;
+  }
+
+  auto accessor = owned(CBitmapPixelAccess::create(fBitmap));
+  if(!accessor)
+  {
+    DLOG_F(WARNING, "LCDColumnsBitmap::update() - pixel access not supported");
+    fIsSupported = false;
+    return false;
+  }
+
+  PixelBuffer pixels{accessor->getAddress(),
+                     static_cast<int>(accessor->getBytesPerRow()),
+                     static_cast<int>(accessor->getBitmapWidth()),
+                     static_cast<int>(accessor->getBitmapHeight())};
+
+  if(shift < 0)
+  {
+    // the value of the pixels of each band in the (platform dependent) pixel format of the bitmap (the pixel is then
+    // overwritten by the full render)
+    for(int b = 0; b < Columns::kNumBands; b++)
+    {
+      accessor->setPosition(0, 0);
+      accessor->setColor(iBandColors[b]);
+      fBandPixels[b] = pixels.getRow(0)[0];
+    }
+
+    iColumns.rasterize(pixels, 0, fPixelsPerColumn, fBandPixels);
+  }
+  else
+  {
+    // scroll
+    pixels.shiftLeft(shift * fPixelsPerColumn);
+    iColumns.rasterize(pixels, MAX_ARRAY_SIZE - shift, fPixelsPerColumn, fBandPixels);
+  }
+
+  // releasing the accessor applies the changes to the bitmap
+  accessor = nullptr;
+
+  std::copy(iSamples, iSamples + MAX_ARRAY_SIZE, fSamples);
+  fSoftClippingLevel = iSoftClippingLevel;
+  std::copy(std::begin(iBandColors), std::end(iBandColors), std::begin(fBandColors));
+  fIsValid = true;
+
+  return true;
+}
+
+///////////////////////////////////////////
+// LCDColumnsBitmap::draw
+///////////////////////////////////////////
+void LCDColumnsBitmap::draw(CDrawContext *iContext, CRect const &iRect)
+{
+  if(fBitmap)
+    fBitmap->draw(iContext, iRect);
+}
+
+}
+}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vstgui4/vstgui/lib/cbitmap.h>
+#include <vstgui4/vstgui/lib/cdrawcontext.h>
+#include "../LCDColumns.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+using namespace VSTGUI;
+
+/**
+ * Offscreen cache of the columns of the LCD. In live view the graph only scrolls to the left by a few columns between
+ * 2 frames: instead of drawing all the columns every frame, the bitmap is moved to the left and only the new columns
+ * are rasterized (directly in its pixels, see LCDColumns::rasterize).
+ *
+ * Whether the graph scrolled is found by comparing the entries displayed with the ones of the previous frame (see
+ * LCDColumns::computeShift) so that anything else (zoom, scroll, pause, channels...) simply leads to a full render, as
+ * does a change of size, scale factor, colors or soft clipping level.
+ */
+class LCDColumnsBitmap
+{
+public:
+  using Columns = LCDColumns<MAX_ARRAY_SIZE>;
+
+  // past this many new columns, rendering everything is as cheap
+  static constexpr int MAX_SHIFT = MAX_ARRAY_SIZE / 4;
+
+  /**
+   * Brings the bitmap up to date with iColumns (computed from iSamples)
+   *
+   * @param iHeight the height of the LCD
+   * @return false if offscreen bitmaps are not supported (the columns must be drawn directly)
+   */
+  bool update(CDrawContext *iContext,
+              double iHeight,
+              THistorySample const *iSamples,
+              double iSoftClippingLevel,
+              CColor const (&iBandColors)[Columns::kNumBands],
+              Columns const &iColumns);
+
+  // draw (in iRect, the (absolute) rectangle of the columns)
+  void draw(CDrawContext *iContext, CRect const &iRect);
+
+protected:
+  // (re)creates the bitmap for the size and scale factor
+  bool createBitmap(double iHeight, int iPixelsPerColumn);
+
+private:
+  SharedPointer<CBitmap> fBitmap{};
+  double fHeight{0};
+  int fPixelsPerColumn{1};
+  bool fIsSupported{true};
+
+  // what the bitmap contains
+  bool fIsValid{false};
+  THistorySample fSamples[MAX_ARRAY_SIZE]{};
+  double fSoftClippingLevel{-1};
+  CColor fBandColors[Columns::kNumBands]{};
+  PixelBuffer::Pixel fBandPixels[Columns::kNumBands]{};
+};
+
+}
+}
+}
@@ -11,6 +11,9 @@ const CColor MAX_LEVEL_FOR_SELECTION_LINES_COLOR = CColor{255,255,255,200};
 const CColor MAX_LEVEL_SINCE_RESET_COLOR = CColor{255,0,0,220};
 const CColor MAX_LEVEL_IN_WINDOW_COLOR = CColor{0,0,255,220};
 const CColor MAX_LEVEL_FOR_SELECTION_COLOR = CColor{0,0,0,40};
+const CColor SELECTION_RANGE_COLOR = CColor{255,255,255,40};
+const CColor LOUDNESS_COLOR = CColor{0,200,255,220};
+const CColor METRICS_BACKGROUND_COLOR = CColor{0,0,0,180};
 
 ///////////////////////////////////////////
 // LCDDisplayState::LCDMessage::update
@@ -48,15 +51,15 @@ void LCDDisplayState::onTimer(Timer * /* timer */)
     }
   }
 
-  if(fLCDZoomFactorXMessage)
+  if(fLCDTopMessage)
   {
-    if(fLCDZoomFactorXMessage->update(now))
+    if(fLCDTopMessage->update(now))
     {
-      fLCDZoomFactorXMessage = nullptr;
+      fLCDTopMessage = nullptr;
     }
   }
 
-  if(fLCDSoftClippingLevelMessage == nullptr && fLCDZoomFactorXMessage == nullptr)
+  if(fLCDSoftClippingLevelMessage == nullptr && fLCDTopMessage == nullptr)
   {
     fTimer = nullptr;
   }
@@ -91,7 +94,23 @@ void LCDDisplayView::onParameterChange(ParamID iParamID)
   {
     Steinberg::String text = "Zoom: ";
     text += fLCDZoomFactorXParam.toString();
-    fLCDZoomFactorXMessage = std::make_unique<LCDMessage>(UTF8String(text), Clock::getCurrentTimeMillis());
+    fLCDTopMessage = std::make_unique<LCDMessage>(UTF8String(text), Clock::getCurrentTimeMillis());
+    startTimer();
+  }
+
+  if(iParamID == fLCDLoudnessParam.getParamID())
+  {
+    Steinberg::String text = "Loudness: ";
+    text += fLCDLoudnessParam.toString();
+    fLCDTopMessage = std::make_unique<LCDMessage>(UTF8String(text), Clock::getCurrentTimeMillis());
+    startTimer();
+  }
+
+  if(iParamID == fLCDChannelViewParam.getParamID())
+  {
+    Steinberg::String text = "Channels: ";
+    text += fLCDChannelViewParam.toString();
+    fLCDTopMessage = std::make_unique<LCDMessage>(UTF8String(text), Clock::getCurrentTimeMillis());
     startTimer();
   }
 
@@ -100,6 +119,7 @@ void LCDDisplayView::onParameterChange(ParamID iParamID)
     fLCDSoftClippingLevelMessage =
       std::make_unique<LCDMessage>(UTF8String(fSoftClippingLevelParam.toString()), Clock::getCurrentTimeMillis());
     startTimer();
+    sendSoftClippingLevel();
   }
 
   CustomView::onParameterChange(iParamID);
@@ -109,7 +129,8 @@ void LCDDisplayView::onParameterChange(ParamID iParamID)
 // LCDDisplayView::LCDDisplayView
 ///////////////////////////////////////////
 LCDDisplayView::LCDDisplayView(const CRect &size)
-  : HistoryView(size)
+  : HistoryView(size),
+    fLCDColumns{VST::Sample64SilentThreshold, MIN_AUDIO_SAMPLE, HARD_CLIPPING_LEVEL}
 {
 
 }
@@ -145,6 +166,52 @@ void LCDDisplayView::drawMaxLevelNoCheck(GUI::RelativeDrawContext &iContext,
 }
 
 
+///////////////////////////////////////////
+// LCDDisplayView::drawColumns
+///////////////////////////////////////////
+void LCDDisplayView::drawColumns(GUI::RelativeDrawContext &iContext, CDrawContext *iDrawContext)
+{
+  using Band = LCDColumns<MAX_ARRAY_SIZE>::Band;
+
+  auto height = getViewSize().getHeight();
+
+  for(int b = 0; b < Band::kNumBands; b++)
+  {
+    auto band = static_cast<Band>(b);
+    auto numColumns = fLCDColumns.getNumColumns(band);
+    if(numColumns == 0)
+      continue;
+
+    auto const *columns = fLCDColumns.getColumns(band);
+    CColor const &color = band == Band::kHardClipping ? getLevelStateHardClippingColor() :
+                          band == Band::kSoftClipping ? getLevelStateSoftClippingColor() :
+                          getLevelStateOkColor();
+
+    // all the columns of the band are filled at once (1 pixel wide rectangles, same as a 1 pixel line)
+    auto path = VSTGUI::owned(iDrawContext->createGraphicsPath());
+
+    if(!path)
+    {
+      // graphics paths not supported by the platform => one line per column
+      for(int i = 0; i < numColumns; i++)
+      {
+        RelativeCoord x = columns[i];
+        iContext.drawLine(x, fLCDColumns.getTop(columns[i]), x, height, color);
+      }
+      continue;
+    }
+
+    for(int i = 0; i < numColumns; i++)
+    {
+      RelativeCoord x = columns[i];
+      path->addRect(iContext.toAbsoluteRect(RelativeRect{x, fLCDColumns.getTop(columns[i]), x + 1, height}));
+    }
+
+    iDrawContext->setFillColor(color);
+    iDrawContext->drawGraphicsPath(path, CDrawContext::kPathFilled);
+  }
+}
+
 ///////////////////////////////////////////
 // LCDDisplayView::draw
 ///////////////////////////////////////////
@@ -156,18 +223,26 @@ void LCDDisplayView::draw(CDrawContext *iContext)
 
   auto height = getViewSize().getHeight();
   auto width = getViewSize().getWidth();
-  RelativeCoord left = 0;
 
   LCDData const &lcdData = fHistoryDataParam->fLCDData;
 
-  bool leftChannelOn = lcdData.fLeftChannel.fOn;
-  bool rightChannelOn = lcdData.fRightChannel.fOn;
+  bool channelsOn = false;
+  for(int c = 0; c < lcdData.fNumChannels; c++)
+    channelsOn |= lcdData.fChannels[c].fOn;
 
-  if(leftChannelOn || rightChannelOn)
+  if(channelsOn)
   {
+    // the selected range (if more than one point)
+    int selectionStartX = *fLCDSelectionStartXParameter;
+    if(selectionStartX != LCD_INPUT_X_NOTHING_SELECTED && *fLCDInputXParameter != LCD_INPUT_X_NOTHING_SELECTED &&
+       selectionStartX != *fLCDInputXParameter)
+    {
+      RelativeCoord rangeLeft = std::min(selectionStartX, *fLCDInputXParameter);
+      RelativeCoord rangeRight = std::max(selectionStartX, *fLCDInputXParameter) + 1;
+      rdc.fillRect(RelativeRect{rangeLeft, 0, rangeRight, height}, SELECTION_RANGE_COLOR);
+    }
 
-    MaxLevel maxLevelForSelection{-1, *fLCDInputXParameter};
-    RelativePoint maxLevelForSelectionPoint = {static_cast<RelativeCoord>(maxLevelForSelection.fIndex), -1};
+    RelativePoint maxLevelForSelectionPoint = {static_cast<RelativeCoord>(*fLCDInputXParameter), -1};
 
     auto maxLevelSinceReset = getMaxLevelSinceReset();
     RelativePoint maxLevelSinceResetPoint = { static_cast<RelativeCoord>(maxLevelSinceReset.fIndex), -1 };
@@ -175,48 +250,34 @@ void LCDDisplayView::draw(CDrawContext *iContext)
     auto maxLevelInWindow = getMaxLevelInWindow();
     RelativePoint maxLevelInWindowPoint = {static_cast<RelativeCoord>(maxLevelInWindow.fIndex), -1 };
 
+    // max of all the channels displayed
+    THistorySample samples[MAX_ARRAY_SIZE];
+    lcdData.computeMaxSamples(samples);
+    fLCDColumns.compute(samples, height, fSoftClippingLevelParameter->getValueInSample());
+
     // display every sample in the array as a vertical line (from the bottom)
-    for(int i = 0; i < MAX_ARRAY_SIZE; i++)
+    CColor const bandColors[] = {getLevelStateOkColor(),
+                                 getLevelStateSoftClippingColor(),
+                                 getLevelStateHardClippingColor()};
+    if(fLCDColumnsBitmap.update(iContext,
+                                height,
+                                samples,
+                                fSoftClippingLevelParameter->getValueInSample(),
+                                bandColors,
+                                fLCDColumns))
     {
-      double displayValue;
-
-      TSample leftSample = leftChannelOn ? lcdData.fLeftChannel.fSamples[i] : 0;
-      TSample rightSample = rightChannelOn ? lcdData.fRightChannel.fSamples[i] : 0;
-
-      TSample sample = std::max(leftSample, rightSample);
-      RelativeCoord top = height;
-
-      if(sample >= VST::Sample64SilentThreshold)
-      {
-        if(sample < MIN_AUDIO_SAMPLE) // a single pixel for -60dB to silent
-          displayValue = 1;
-        else
-        {
-          displayValue = toDisplayValue(sample, height);
-        }
-
-        top = Utils::clamp<RelativeCoord>(height - displayValue, -0.5, height);
-
-        // color of the sample depends on its level
-        CColor const &color = computeColor(*fSoftClippingLevelParameter, sample);
-
-        rdc.drawLine(left, top, left, height, color);
-
-      }
-
-      if(maxLevelForSelection.fIndex == i)
-      {
-        maxLevelForSelection.fValue = sample;
-        maxLevelForSelectionPoint.y = top;
-      }
-
-      if(maxLevelSinceResetPoint.x == i)
-        maxLevelSinceResetPoint.y = top;
-
-      if(maxLevelInWindowPoint.x == i)
-        maxLevelInWindowPoint.y = top;
+      auto columnsRect = RelativeRect{0, 0, static_cast<RelativeCoord>(MAX_ARRAY_SIZE), height};
+      fLCDColumnsBitmap.draw(iContext, rdc.toAbsoluteRect(columnsRect));
+    }
+    else
+    {
+      drawColumns(rdc, iContext);
+    }
 
-      left++;
+    for(auto point : {&maxLevelForSelectionPoint, &maxLevelSinceResetPoint, &maxLevelInWindowPoint})
+    {
+      if(point->x > -1 && point->x < MAX_ARRAY_SIZE)
+        point->y = fLCDColumns.getTop(static_cast<int>(point->x));
     }
 
     if(*fMaxLevelInWindowMarker)
@@ -243,6 +304,27 @@ void LCDDisplayView::draw(CDrawContext *iContext)
       rdc.drawLine(x, 0, x, height, MAX_LEVEL_FOR_SELECTION_LINES_COLOR);
       rdc.drawLine(0, y, width, y, MAX_LEVEL_FOR_SELECTION_LINES_COLOR);
     }
+
+    drawSelectionStats(rdc, fHistoryDataParam->fSelectionStats);
+  }
+
+  // the loudness is drawn as a line on top of the peaks
+  if(lcdData.fLoudness.fOn)
+  {
+    RelativeCoord previousTop = height;
+    for(int i = 0; i < MAX_ARRAY_SIZE; i++)
+    {
+      TSample loudness = fromHistorySample(lcdData.fLoudness.fSamples[i]);
+
+      RelativeCoord top = height;
+      if(loudness >= MIN_AUDIO_SAMPLE)
+        top = Utils::clamp<RelativeCoord>(height - toDisplayValue(loudness, height), -0.5, height);
+
+      if(i > 0)
+        rdc.drawLine(i - 1, previousTop, i, top, LOUDNESS_COLOR);
+
+      previousTop = top;
+    }
   }
 
   // display the soft clipping level line (which is controlled by a knob)
@@ -270,17 +352,90 @@ void LCDDisplayView::draw(CDrawContext *iContext)
                    RelativeRect{0, textTop, static_cast<RelativeCoord>(MAX_ARRAY_SIZE), textTop + 20}, sdc);
   }
 
-  if(fLCDZoomFactorXMessage)
+  if(fLCDTopMessage)
   {
     StringDrawContext sdc{};
     sdc.fHorizTxtAlign = kCenterText;
     sdc.fTextInset = {2, 2};
-    sdc.fFontColor = fLCDZoomFactorXMessage->fColor;
+    sdc.fFontColor = fLCDTopMessage->fColor;
     sdc.fFont = fFont;
 
-    rdc.drawString(fLCDZoomFactorXMessage->fText,
+    rdc.drawString(fLCDTopMessage->fText,
                    RelativeRect{0, 0, static_cast<RelativeCoord>(MAX_ARRAY_SIZE), 20}, sdc);
   }
+
+  // on top of everything else
+  if(*fMetricsOverlayParam)
+    drawMetrics(rdc, *fMetricsDataParam);
+}
+
+///////////////////////////////////////////
+// LCDDisplayView::drawMetrics
+///////////////////////////////////////////
+void LCDDisplayView::drawMetrics(GUI::RelativeDrawContext &iContext, MetricsSnapshot const &iMetrics)
+{
+  auto width = getViewSize().getWidth();
+  auto height = getViewSize().getHeight();
+
+  iContext.fillRect(RelativeRect{0, 0, width, height}, METRICS_BACKGROUND_COLOR);
+
+  StringDrawContext sdc{};
+  sdc.fHorizTxtAlign = kLeftText;
+  sdc.fTextInset = {4, 2};
+  sdc.fFontColor = kWhiteCColor;
+  sdc.fFont = fFont;
+
+  // nothing measured yet (or the processor lives in another process and the metrics were never dumped)
+  if(iMetrics.fBlockCount == 0)
+  {
+    iContext.drawString(UTF8String("No metrics (dump them with the Dump Metrics parameter)"),
+                        RelativeRect{0, 0, width, 20}, sdc);
+    return;
+  }
+
+  std::istringstream lines{iMetrics.toString()};
+  std::string line;
+  RelativeCoord top = 0;
+  while(std::getline(lines, line) && top + 15 <= height)
+  {
+    iContext.drawString(UTF8String(line), RelativeRect{0, top, width, top + 15}, sdc);
+    top += 15;
+  }
+}
+
+///////////////////////////////////////////
+// LCDDisplayView::drawSelectionStats
+///////////////////////////////////////////
+void LCDDisplayView::drawSelectionStats(GUI::RelativeDrawContext &iContext, SelectionStats const &iSelectionStats)
+{
+  if(iSelectionStats.isUndefined())
+    return;
+
+  std::ostringstream s;
+  s << "avg pk " << toDbString(iSelectionStats.fAveragePeak, 1)
+    << "  rms " << toDbString(iSelectionStats.fRMS, 1)
+    << "  > scl " << iSelectionStats.fCountAboveSoftClippingLevel;
+
+  StringDrawContext sdc{};
+  sdc.addStyle(StringDrawContext::Style::kShadowText);
+  sdc.fHorizTxtAlign = kCenterText;
+  sdc.fTextInset = {2, 2};
+  sdc.fFontColor = kWhiteCColor;
+  sdc.fFont = fFont;
+  sdc.fShadowColor = kBlackCColor;
+
+  auto height = getViewSize().getHeight();
+  iContext.drawString(UTF8String(s.str()),
+                      RelativeRect{0, height - 20, static_cast<RelativeCoord>(MAX_ARRAY_SIZE), height}, sdc);
+}
+
+///////////////////////////////////////////
+// LCDDisplayView::sendSoftClippingLevel
+///////////////////////////////////////////
+void LCDDisplayView::sendSoftClippingLevel()
+{
+  fSelectionSoftClippingLevelParam.setValue(fSoftClippingLevelParam->getValueInSample());
+  fSelectionSoftClippingLevelParam.broadcast();
 }
 
 ///////////////////////////////////////////
@@ -297,12 +452,23 @@ int LCDDisplayView::computeLCDInputX(CPoint &where) const
 ///////////////////////////////////////////
 CMouseEventResult LCDDisplayView::onMouseDown(CPoint &where, const CButtonState &buttons)
 {
+  // hidden gesture: Alt + click toggles the debug overlay (runtime metrics)
+  if(buttons.isLeftButton() && (buttons & kAlt))
+  {
+    fMetricsOverlayParam.setValue(!*fMetricsOverlayParam);
+    return kMouseEventHandled;
+  }
+
   if(*fLCDLiveViewParameter)
   {
     fLCDLiveViewParameter.setValue(false);
   }
 
-  fLCDInputXEditor = fLCDInputXParameter.edit(computeLCDInputX(where));
+  auto lcdInputX = computeLCDInputX(where);
+
+  // the selection is the range between where the mouse went down and where it is now
+  fLCDSelectionStartXParameter.setValue(lcdInputX);
+  fLCDInputXEditor = fLCDInputXParameter.edit(lcdInputX);
 
   return kMouseEventHandled;
 }
@@ -345,6 +511,7 @@ CMouseEventResult LCDDisplayView::onMouseCancel()
   {
     fLCDInputXEditor->rollback();
     fLCDInputXEditor = nullptr;
+    fLCDSelectionStartXParameter.setValue(LCD_INPUT_X_NOTHING_SELECTED);
     return kMouseEventHandled;
   }
 
@@ -361,7 +528,16 @@ void LCDDisplayView::registerParameters()
   fMaxLevelInWindowMarker = registerParam(fParams->fInWindowMarkerParam);
   fLCDLiveViewParameter = registerParam(fParams->fLCDLiveViewParam);
   fLCDZoomFactorXParam = registerParam(fParams->fZoomFactorXParam);
+  fLCDLoudnessParam = registerParam(fParams->fLCDLoudnessParam);
+  fLCDChannelViewParam = registerParam(fParams->fLCDChannelViewParam);
   fSoftClippingLevelParam = registerParam(fParams->fSoftClippingLevelParam);
+  fLCDSelectionStartXParameter = registerParam(fParams->fLCDSelectionStartXParam);
+  fSelectionSoftClippingLevelParam = registerParam(fState->fSelectionSoftClippingLevel, false);
+  fMetricsDataParam = registerParam(fState->fMetricsData);
+  fMetricsOverlayParam = registerParam(fState->fMetricsOverlay);
+
+  // makes sure RT uses the current soft clipping level
+  sendSoftClippingLevel();
 }
 
 #if EDITOR_MODE
@@ -375,26 +551,29 @@ void LCDDisplayView::onEditorModeChanged()
   {
     HistoryData historyData{};
     LCDData &lcdData = historyData.fLCDData;
-    lcdData.fLeftChannel.fOn = true;
-    lcdData.fRightChannel.fOn = true;
+    lcdData.fNumChannels = 2;
+    auto &leftChannel = lcdData.fChannels[0];
+    auto &rightChannel = lcdData.fChannels[1];
+    leftChannel.fOn = true;
+    rightChannel.fOn = true;
 
     auto dbLerp = Utils::mapRangeDPX<int>(0, MAX_ARRAY_SIZE - 1, -65.0, +0.5);
 
     for(int i = 0; i < MAX_ARRAY_SIZE; i++)
     {
-      auto sample = i >= 10 && i < 13 ? 0.0: dbToSample<TSample>(dbLerp.computeY(i));
-      lcdData.fLeftChannel.fSamples[i] = sample;
-      lcdData.fRightChannel.fSamples[MAX_ARRAY_SIZE - i - 1] = sample;
+      auto sample = toHistorySample(i >= 10 && i < 13 ? 0.0: dbToSample<TSample>(dbLerp.computeY(i)));
+      leftChannel.fSamples[i] = sample;
+      rightChannel.fSamples[MAX_ARRAY_SIZE - i - 1] = sample;
     }
 
     for(int i = 100; i < 103; i++)
     {
-      lcdData.fLeftChannel.fSamples[i] = 0.0;
-      lcdData.fRightChannel.fSamples[i] = 0.0;
+      leftChannel.fSamples[i] = 0;
+      rightChannel.fSamples[i] = 0;
     }
 
-    lcdData.fLeftChannel.fMaxLevelSinceReset = lcdData.fLeftChannel.fSamples[10];
-    lcdData.fRightChannel.fMaxLevelSinceReset = lcdData.fRightChannel.fSamples[10];
+    leftChannel.fMaxLevelSinceReset = fromHistorySample(leftChannel.fSamples[10]);
+    rightChannel.fMaxLevelSinceReset = fromHistorySample(rightChannel.fSamples[10]);
 
     historyData.computeMaxLevels();
 
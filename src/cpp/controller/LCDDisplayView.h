@@ -6,7 +6,9 @@
 #include <pongasoft/VST/GUI/DrawContext.h>
 #include <memory>
 #include "../VAC6Model.h"
+#include "../LCDColumns.h"
 #include "HistoryView.h"
+#include "LCDColumnsBitmap.h"
 
 namespace pongasoft {
 namespace VST {
@@ -67,7 +69,8 @@ private:
   friend class LCDDisplayView;
 
   std::unique_ptr<LCDMessage> fLCDSoftClippingLevelMessage;
-  std::unique_ptr<LCDMessage> fLCDZoomFactorXMessage;
+  // zoom, loudness or channels change (the top of the LCD shows the last one)
+  std::unique_ptr<LCDMessage> fLCDTopMessage;
 
   std::unique_ptr<AutoReleaseTimer> fTimer;
 };
@@ -117,6 +120,18 @@ protected:
   // computeLCDInputX
   int computeLCDInputX(CPoint &where) const;
 
+  // sendSoftClippingLevel (to RT for the selection stats)
+  void sendSoftClippingLevel();
+
+  // drawColumns (one path per level band, see LCDColumns) when the columns cannot be cached in a bitmap
+  void drawColumns(GUI::RelativeDrawContext &iContext, CDrawContext *iDrawContext);
+
+  // drawSelectionStats
+  void drawSelectionStats(GUI::RelativeDrawContext &iContext, SelectionStats const &iSelectionStats);
+
+  // drawMetrics (debug overlay, see MetricsMonitor)
+  void drawMetrics(GUI::RelativeDrawContext &iContext, MetricsSnapshot const &iMetrics);
+
   // drawMaxLevel
   void drawMaxLevel(GUI::RelativeDrawContext &iContext, RelativePoint const &iPoint, CCoord iHalfSize, CColor const &iColor);
 
@@ -139,14 +154,26 @@ protected:
   CColor fSoftClippingLevelColor{};
   FontSPtr fFont{nullptr};
 
+  // the columns of the last frame drawn
+  LCDColumns<MAX_ARRAY_SIZE> fLCDColumns;
+  LCDColumnsBitmap fLCDColumnsBitmap{};
+
   GUIVstBooleanParam fMaxLevelSinceResetMarker{nullptr};
   GUIVstBooleanParam fMaxLevelInWindowMarker{nullptr};
   GUIVstBooleanParam fLCDLiveViewParameter{nullptr};
 
   GUIVstParam<SoftClippingLevel> fSoftClippingLevelParam{nullptr};
   GUIVstParam<Percent> fLCDZoomFactorXParam{nullptr};
+  GUIVstParam<int> fLCDLoudnessParam{nullptr};
+  GUIVstParam<int> fLCDChannelViewParam{nullptr};
 
   GUIVstParamEditor<int> fLCDInputXEditor{nullptr};
+  GUIVstParam<int> fLCDSelectionStartXParameter{nullptr};
+
+  GUIJmbParam<double> fSelectionSoftClippingLevelParam{};
+
+  GUIJmbParam<MetricsSnapshot> fMetricsDataParam{};
+  GUIJmbParam<bool> fMetricsOverlayParam{};
 
 public:
   class Creator : public CustomViewCreator<LCDDisplayView, HistoryView>
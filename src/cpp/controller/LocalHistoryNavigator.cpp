@@ -0,0 +1,220 @@
+#include <pongasoft/logging/loguru.hpp>
+#include "LocalHistoryNavigator.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+///////////////////////////////////////////
+// LocalHistoryNavigator::LocalHistoryNavigator
+///////////////////////////////////////////
+LocalHistoryNavigator::LocalHistoryNavigator(VAC6Parameters const &iParams, VAC6GUIState &iState) :
+  fParameters{iParams},
+  fState{iState},
+  fZoomWindow{MAX_ARRAY_SIZE, ZOOM_HISTORY_BUFFER_SIZE}
+{
+}
+
+///////////////////////////////////////////
+// LocalHistoryNavigator::registerNavigationParameters
+///////////////////////////////////////////
+void LocalHistoryNavigator::registerNavigationParameters()
+{
+  fZoomFactorXParam = registerParam(fParameters.fZoomFactorXParam);
+  fLCDHistoryOffsetParam = registerParam(fParameters.fLCDHistoryOffsetParam);
+  fLCDInputXParam = registerParam(fParameters.fLCDInputXParam, false);
+  fLCDSelectionStartXParam = registerParam(fParameters.fLCDSelectionStartXParam, false);
+  fLCDLoudnessParam = registerParam(fParameters.fLCDLoudnessParam, false);
+}
+
+///////////////////////////////////////////
+// LocalHistoryNavigator::update
+///////////////////////////////////////////
+void LocalHistoryNavigator::update(SharedHistoryChannel &iChannel)
+{
+  auto snapshotId = iChannel.getSnapshotId();
+
+  if(snapshotId == fSnapshotId)
+    return;
+
+  if(snapshotId == 0)
+  {
+    // live view (or the snapshot is being rewritten)
+    stop(iChannel);
+    return;
+  }
+
+  bool isRestored = false;
+  bool isValid = iChannel.readSnapshot(snapshotId, [this, &isRestored](SharedHistoryChannel::PausedHistorySnapshot const &iSnapshot) {
+    // all the histories have the same size (which can only change when the processor is setup again)
+    if(fNumChannels != iSnapshot.fNumChannels || fHistories.empty() ||
+       fHistories[0]->getMaxSnapshotSize() != iSnapshot.fEntriesPerHistory)
+    {
+      fNumChannels = iSnapshot.fNumChannels;
+      fHistories.clear();
+      fZoomBuffers.clear();
+      for(int h = 0; h < iSnapshot.getNumHistories(); h++)
+      {
+        fHistories.emplace_back(std::make_unique<TieredHistory<THistorySample>>(SAMPLE_BUFFER_SIZE,
+                                                                                HISTORY_BUFFER_SIZE,
+                                                                                HISTORY_TIER_FACTOR));
+        fZoomBuffers.emplace_back(std::make_unique<CircularBuffer<THistorySample>>(MAX_ARRAY_SIZE));
+      }
+      fZoomBufferWindows.resize(fHistories.size());
+    }
+
+    if(fHistories[0]->getMaxSnapshotSize() != iSnapshot.fEntriesPerHistory)
+      return;
+
+    for(int h = 0; h < iSnapshot.getNumHistories(); h++)
+      fHistories[h]->restoreMaxSnapshot(iSnapshot.fPushCounts[h], iSnapshot.getEntries(h));
+
+    isRestored = true;
+  });
+
+  if(!isValid || !isRestored)
+  {
+    // invalidated in the meantime => waiting for the next one
+    stop(iChannel);
+    return;
+  }
+
+  DLOG_F(INFO, "LocalHistoryNavigator::update() - navigating snapshot %lld locally", static_cast<long long>(snapshotId));
+
+  fSnapshotId = snapshotId;
+
+  // same window as the processor
+  fZoomWindow.setZoomFactor(*fZoomFactorXParam);
+  fZoomWindow.setWindowOffset(*fLCDHistoryOffsetParam);
+  for(auto &window : fZoomBufferWindows)
+    window.invalidate();
+  computeZoomBuffers();
+
+  // from now on the processor no longer recomputes the zoomed buffers while paused
+  iChannel.setLocalNavigationSnapshotId(fSnapshotId);
+
+  updateHistoryData();
+}
+
+///////////////////////////////////////////
+// LocalHistoryNavigator::stop
+///////////////////////////////////////////
+void LocalHistoryNavigator::stop(SharedHistoryChannel &iChannel)
+{
+  fSnapshotId = 0;
+  iChannel.setLocalNavigationSnapshotId(0);
+}
+
+///////////////////////////////////////////
+// LocalHistoryNavigator::onParameterChange
+///////////////////////////////////////////
+void LocalHistoryNavigator::onParameterChange(ParamID iParamID)
+{
+  if(!isActive() || fIsUpdatingParameters)
+    return;
+
+  if(iParamID == fZoomFactorXParam.getParamID())
+  {
+    // same as the processor when not navigating locally (see VAC6Processor::genericProcessInputs)
+    TieredHistory<THistorySample> const *histories[MAX_NUM_CHANNELS];
+    collectDisplayedHistories(histories);
+
+    int lcdInputX = *fLCDInputXParam;
+    int newLCDInputX = fZoomWindow.setZoomFactor(*fZoomFactorXParam,
+                                                 lcdInputX != LCD_INPUT_X_NOTHING_SELECTED ? lcdInputX : MAX_ARRAY_SIZE / 2,
+                                                 histories,
+                                                 fNumChannels);
+
+    fIsUpdatingParameters = true;
+
+    if(lcdInputX != LCD_INPUT_X_NOTHING_SELECTED && lcdInputX != newLCDInputX)
+      fLCDInputXParam.setValue(newLCDInputX);
+
+    // the start of the selection no longer represents the same point in the history => single point selection
+    if(*fLCDSelectionStartXParam != LCD_INPUT_X_NOTHING_SELECTED)
+      fLCDSelectionStartXParam.setValue(LCD_INPUT_X_NOTHING_SELECTED);
+
+    fLCDHistoryOffsetParam.setValue(fZoomWindow.getWindowOffset());
+
+    fIsUpdatingParameters = false;
+
+    // the processor derives its window offset from the (percent) offset => so does the editor
+    fZoomWindow.setWindowOffset(*fLCDHistoryOffsetParam);
+  }
+  else if(iParamID == fLCDHistoryOffsetParam.getParamID())
+  {
+    fZoomWindow.setWindowOffset(*fLCDHistoryOffsetParam);
+  }
+  else
+  {
+    return;
+  }
+
+  computeZoomBuffers();
+  updateHistoryData();
+}
+
+///////////////////////////////////////////
+// LocalHistoryNavigator::collectDisplayedHistories
+///////////////////////////////////////////
+void LocalHistoryNavigator::collectDisplayedHistories(TieredHistory<THistorySample> const **oHistories) const
+{
+  LCDData const &lcdData = fState.fHistoryData->fLCDData;
+  for(int c = 0; c < fNumChannels; c++)
+    oHistories[c] = c < lcdData.fNumChannels && lcdData.fChannels[c].fOn ? fHistories[c].get() : nullptr;
+}
+
+///////////////////////////////////////////
+// LocalHistoryNavigator::computeZoomBuffers
+///////////////////////////////////////////
+void LocalHistoryNavigator::computeZoomBuffers()
+{
+  for(size_t h = 0; h < fHistories.size(); h++)
+  {
+    auto &buffer = *fZoomBuffers[h];
+    auto &window = fZoomBufferWindows[h];
+    auto pendingPoints = fZoomWindow.beginZoomWindow(buffer, window, buffer);
+    fZoomWindow.computeZoomWindow(*fHistories[h], pendingPoints, pendingPoints.getNumPoints(), 0, buffer);
+    fZoomWindow.endZoomWindow(pendingPoints, window);
+  }
+}
+
+///////////////////////////////////////////
+// LocalHistoryNavigator::patch
+///////////////////////////////////////////
+void LocalHistoryNavigator::patch(HistoryData &ioHistoryData) const
+{
+  if(!isActive())
+    return;
+
+  LCDData &lcdData = ioHistoryData.fLCDData;
+
+  for(int c = 0; c < std::min(lcdData.fNumChannels, fNumChannels); c++)
+  {
+    for(int i = 0; i < MAX_ARRAY_SIZE; i++)
+      lcdData.fChannels[c].fSamples[i] = fZoomBuffers[c]->getAt(i);
+  }
+
+  if(lcdData.fLoudness.fOn)
+  {
+    auto const &buffer = *fZoomBuffers[fNumChannels + (*fLCDLoudnessParam == LCD_LOUDNESS_SHORT_TERM ? 1 : 0)];
+    for(int i = 0; i < MAX_ARRAY_SIZE; i++)
+      lcdData.fLoudness.fSamples[i] = buffer.getAt(i);
+  }
+}
+
+///////////////////////////////////////////
+// LocalHistoryNavigator::updateHistoryData
+///////////////////////////////////////////
+void LocalHistoryNavigator::updateHistoryData()
+{
+  fState.fHistoryData.updateIf([this](HistoryData *oHistoryData) {
+    patch(*oHistoryData);
+    oHistoryData->computeMaxLevels();
+    return true;
+  });
+}
+
+}
+}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <pongasoft/VST/GUI/Params/ParamAware.h>
+#include <memory>
+#include <vector>
+#include "../VAC6Plugin.h"
+#include "../ZoomWindow.h"
+#include "../SharedHistoryChannel.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+using namespace GUI::Params;
+
+/**
+ * While paused (and when the processor lives in the same process), the editor zooms and scrolls on its own: the
+ * (frozen) histories are mirrored from the paused history snapshot published by the processor (see
+ * SharedHistoryChannel) and the LCD is computed locally with its own ZoomWindow at display rate. Zooming updates
+ * LCDInputX and LCDHistoryOffset the same way the processor does (keeping the max under LCDInputX in place) and the
+ * processor only updates its zoom window (used for the selection stats) instead of recomputing the zoomed buffers.
+ */
+class LocalHistoryNavigator : public ParamAware
+{
+public:
+  // Constructor
+  LocalHistoryNavigator(VAC6Parameters const &iParams, VAC6GUIState &iState);
+
+  // registerNavigationParameters (to be called once the state has been initialized, see initState)
+  void registerNavigationParameters();
+
+  /**
+   * Mirrors the paused history snapshot of the channel when a new one is available (or stops navigating locally when
+   * it is gone). Called at every frame by the controller.
+   */
+  void update(SharedHistoryChannel &iChannel);
+
+  // stop (navigation is handled by the processor again, for example when the editor is closed)
+  void stop(SharedHistoryChannel &iChannel);
+
+  // isActive
+  inline bool isActive() const { return fSnapshotId != 0; }
+
+  /**
+   * Replaces the zoomed samples sent by the processor (stale when navigating locally) by the local ones. Does nothing
+   * when not active.
+   */
+  void patch(HistoryData &ioHistoryData) const;
+
+  // onParameterChange (zoom and scroll)
+  void onParameterChange(ParamID iParamID) override;
+
+protected:
+  // (re)computes the zoomed buffers for the current window (only the new points when scrolling)
+  void computeZoomBuffers();
+
+  // patches fState.fHistoryData (see patch)
+  void updateHistoryData();
+
+  // the local histories which are displayed (nullptr for the others)
+  void collectDisplayedHistories(TieredHistory<THistorySample> const **oHistories) const;
+
+private:
+  VAC6Parameters const &fParameters;
+  VAC6GUIState &fState;
+
+  ZoomWindow fZoomWindow;
+
+  // the channels followed by the loudness histories (momentary then short term) (see PausedHistorySnapshot)
+  int fNumChannels{0};
+  std::vector<std::unique_ptr<TieredHistory<THistorySample>>> fHistories{};
+  std::vector<std::unique_ptr<CircularBuffer<THistorySample>>> fZoomBuffers{};
+  std::vector<ZoomWindow::ComputedWindow> fZoomBufferWindows{};
+
+  Steinberg::int64 fSnapshotId{0}; // snapshot mirrored in fHistories (0 when not active)
+  bool fIsUpdatingParameters{false}; // to ignore the changes made by this class
+
+  GUIVstParam<Percent> fZoomFactorXParam{nullptr};
+  GUIVstParam<Percent> fLCDHistoryOffsetParam{nullptr};
+  GUIVstParam<int> fLCDInputXParam{nullptr};
+  GUIVstParam<int> fLCDSelectionStartXParam{nullptr};
+  GUIVstParam<int> fLCDLoudnessParam{nullptr};
+};
+
+}
+}
+}
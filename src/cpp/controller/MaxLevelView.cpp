@@ -53,6 +53,9 @@ MaxLevel MaxLevelView::getMaxLevel() const
     case Type::kInWindow:
       return fHistoryDataParam->fMaxLevelInWindow;
 
+    case Type::kForRange:
+      return fHistoryDataParam->fSelectionStats.getMaxLevel();
+
     default:
       DLOG_F(WARNING, "should not be reached");
       return MaxLevel{};
@@ -19,7 +19,8 @@ public:
   {
     kForSelection,
     kSinceReset,
-    kInWindow
+    kInWindow,
+    kForRange
   };
 
   // Constructor
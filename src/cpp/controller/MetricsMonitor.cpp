@@ -0,0 +1,60 @@
+#include <pongasoft/logging/loguru.hpp>
+#include "MetricsMonitor.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+///////////////////////////////////////////
+// MetricsMonitor::MetricsMonitor
+///////////////////////////////////////////
+MetricsMonitor::MetricsMonitor(VAC6GUIState &iState) :
+  fState{iState}
+{
+}
+
+///////////////////////////////////////////
+// MetricsMonitor::registerMetricsParameters
+///////////////////////////////////////////
+void MetricsMonitor::registerMetricsParameters()
+{
+  fMetricsDataParam = registerParam(fState.fMetricsData);
+  fMetricsOverlayParam = registerParam(fState.fMetricsOverlay, false);
+}
+
+///////////////////////////////////////////
+// MetricsMonitor::update
+///////////////////////////////////////////
+void MetricsMonitor::update(SharedHistoryChannel const &iChannel)
+{
+  if(!*fMetricsOverlayParam)
+    return;
+
+  fMetricsDataParam.updateIf([&iChannel](MetricsSnapshot *oSnapshot) {
+    iChannel.getMetrics().snapshot(*oSnapshot);
+    return true;
+  });
+}
+
+///////////////////////////////////////////
+// MetricsMonitor::onParameterChange
+///////////////////////////////////////////
+void MetricsMonitor::onParameterChange(ParamID iParamID)
+{
+  if(iParamID != fMetricsDataParam.getParamID())
+    return;
+
+  // the live updates (see update) carry the dump count as well => a dump is logged once however it is received
+  auto const &metrics = *fMetricsDataParam;
+  if(metrics.fDumpCount != fLastLoggedDumpCount)
+  {
+    fLastLoggedDumpCount = metrics.fDumpCount;
+    LOG_F(INFO, "VAC6 metrics (dump #%lld)\n%s",
+          static_cast<long long>(metrics.fDumpCount),
+          metrics.toString().c_str());
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <pongasoft/VST/GUI/Params/ParamAware.h>
+#include "../VAC6Plugin.h"
+#include "../SharedHistoryChannel.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+using namespace GUI::Params;
+
+/**
+ * Controller side of the runtime metrics of the processor (see ProcessMetrics): logs the metrics every time they are
+ * dumped (see EVAC6ParamID::kMetricsDump) and, while the debug overlay is shown (and the processor lives in the same
+ * process), refreshes fState.fMetricsData at every frame straight from the shared history channel. Otherwise the
+ * overlay shows the last metrics dumped.
+ */
+class MetricsMonitor : public ParamAware
+{
+public:
+  // Constructor
+  explicit MetricsMonitor(VAC6GUIState &iState);
+
+  // registerMetricsParameters (to be called once the state has been initialized, see initState)
+  void registerMetricsParameters();
+
+  // update (called at every frame by the controller)
+  void update(SharedHistoryChannel const &iChannel);
+
+  // onParameterChange (metrics received)
+  void onParameterChange(ParamID iParamID) override;
+
+private:
+  VAC6GUIState &fState;
+
+  Steinberg::int64 fLastLoggedDumpCount{0};
+
+  GUIJmbParam<MetricsSnapshot> fMetricsDataParam{};
+  GUIJmbParam<bool> fMetricsOverlayParam{};
+};
+
+}
+}
+}
@@ -1,4 +1,5 @@
 #include <vstgui4/vstgui/plugin-bindings/vst3editor.h>
+#include <cstring>
 #include <pongasoft/logging/loguru.hpp>
 #include <pongasoft/VST/Debug/ParamDisplay.h>
 #include <pongasoft/VST/Debug/ParamTable.h>
@@ -13,7 +14,9 @@ namespace VAC6 {
 //------------------------------------------------------------------------
 VAC6Controller::VAC6Controller() : GUIController("VAC6.uidesc"),
                                    fParameters{},
-                                   fState{fParameters}
+                                   fState{fParameters},
+                                   fLocalHistoryNavigator{fParameters, fState},
+                                   fMetricsMonitor{fState}
 {
   DLOG_F(INFO, "VAC6Controller::VAC6Controller()");
 }
@@ -24,6 +27,8 @@ VAC6Controller::VAC6Controller() : GUIController("VAC6.uidesc"),
 VAC6Controller::~VAC6Controller()
 {
   DLOG_F(INFO, "VAC6Controller::~VAC6Controller()");
+
+  stopSharedHistoryReader();
 }
 
 //------------------------------------------------------------------------
@@ -33,6 +38,14 @@ tresult VAC6Controller::initialize(FUnknown *context)
 {
   tresult res = GUIController::initialize(context);
 
+  if(res == kResultOk)
+  {
+    fLocalHistoryNavigator.initState(&fState);
+    fLocalHistoryNavigator.registerNavigationParameters();
+    fMetricsMonitor.initState(&fState);
+    fMetricsMonitor.registerMetricsParameters();
+  }
+
   //------------------------------------------------------------------------
   // In debug mode this code displays the order in which the GUI parameters
   // will be saved
@@ -50,6 +63,107 @@ tresult VAC6Controller::initialize(FUnknown *context)
   return res;
 }
 
+//------------------------------------------------------------------------
+// VAC6Controller::notify
+//------------------------------------------------------------------------
+tresult VAC6Controller::notify(IMessage *message)
+{
+  if(message && strcmp(message->getMessageID(), SharedHistoryChannel::MESSAGE_ID) == 0)
+  {
+    int64 processToken = 0;
+    int64 channelId = 0;
+    if(message->getAttributes()->getInt(SharedHistoryChannel::PROCESS_TOKEN_ATTR, processToken) == kResultOk &&
+       message->getAttributes()->getInt(SharedHistoryChannel::CHANNEL_ID_ATTR, channelId) == kResultOk)
+    {
+      stopSharedHistoryReader();
+      fSharedHistoryChannel = SharedHistoryChannel::find(processToken, channelId);
+      DLOG_F(INFO, "VAC6Controller::notify() - shared history channel %s",
+             fSharedHistoryChannel ? "found" : "not found (using messaging)");
+      if(fIsEditorOpen)
+        startSharedHistoryReader();
+    }
+    return kResultOk;
+  }
+
+  return GUIController::notify(message);
+}
+
+//------------------------------------------------------------------------
+// VAC6Controller::didOpen
+//------------------------------------------------------------------------
+void VAC6Controller::didOpen(VSTGUI::VST3Editor *editor)
+{
+  GUIController::didOpen(editor);
+  fIsEditorOpen = true;
+  startSharedHistoryReader();
+}
+
+//------------------------------------------------------------------------
+// VAC6Controller::willClose
+//------------------------------------------------------------------------
+void VAC6Controller::willClose(VSTGUI::VST3Editor *editor)
+{
+  fIsEditorOpen = false;
+  stopSharedHistoryReader();
+  GUIController::willClose(editor);
+}
+
+//------------------------------------------------------------------------
+// VAC6Controller::startSharedHistoryReader
+//------------------------------------------------------------------------
+void VAC6Controller::startSharedHistoryReader()
+{
+  if(!fSharedHistoryChannel || fSharedHistoryTimer)
+    return;
+
+  // from now on the processor publishes in the channel instead of sending messages
+  fSharedHistoryChannel->setReaderAttached(true);
+  fSharedHistoryTimer = VSTGUI::makeOwned<VSTGUI::CVSTGUITimer>([this](VSTGUI::CVSTGUITimer *) {
+                                                                   readSharedHistory();
+                                                                 },
+                                                                 static_cast<uint32_t>(UI_FRAME_RATE_MS));
+}
+
+//------------------------------------------------------------------------
+// VAC6Controller::stopSharedHistoryReader
+//------------------------------------------------------------------------
+void VAC6Controller::stopSharedHistoryReader()
+{
+  if(fSharedHistoryTimer)
+  {
+    fSharedHistoryTimer->stop();
+    fSharedHistoryTimer = nullptr;
+  }
+
+  if(fSharedHistoryChannel)
+  {
+    fLocalHistoryNavigator.stop(*fSharedHistoryChannel);
+    fSharedHistoryChannel->setReaderAttached(false);
+  }
+}
+
+//------------------------------------------------------------------------
+// VAC6Controller::readSharedHistory
+//------------------------------------------------------------------------
+void VAC6Controller::readSharedHistory()
+{
+  // while paused, zoom and scroll are handled here (see LocalHistoryNavigator)
+  fLocalHistoryNavigator.update(*fSharedHistoryChannel);
+
+  // debug overlay (see MetricsMonitor)
+  fMetricsMonitor.update(*fSharedHistoryChannel);
+
+  if(!fSharedHistoryChannel->update())
+    return;
+
+  fState.fHistoryData.updateIf([this](HistoryData *oHistoryData) {
+    *oHistoryData = fSharedHistoryChannel->getReadBuffer();
+    fLocalHistoryNavigator.patch(*oHistoryData);
+    oHistoryData->computeMaxLevels();
+    return true;
+  });
+}
+
 }
 }
 }
\ No newline at end of file
@@ -1,8 +1,13 @@
 #pragma once
 
 #include <pongasoft/VST/GUI/GUIController.h>
+#include <vstgui4/vstgui/lib/cvstguitimer.h>
+#include <memory>
 #include "HistoryView.h"
+#include "LocalHistoryNavigator.h"
+#include "MetricsMonitor.h"
 #include "../VAC6Plugin.h"
+#include "../SharedHistoryChannel.h"
 
 namespace pongasoft {
 namespace VST {
@@ -32,13 +37,40 @@ public:
   // getGUIState
   GUIState *getGUIState() override { return &fState; }
 
+  /**
+   * Handles the shared history channel message sent by the processor (see SharedHistoryChannel)
+   */
+  tresult PLUGIN_API notify(IMessage *message) override;
+
+  // didOpen (the history data is read from the shared history channel while the editor is open)
+  void didOpen(VSTGUI::VST3Editor *editor) override;
+
+  // willClose
+  void willClose(VSTGUI::VST3Editor *editor) override;
 
 protected:
   tresult initialize(FUnknown *context) override;
 
+  // starts/stops reading the shared history channel (if any) at UI_FRAME_RATE_MS
+  void startSharedHistoryReader();
+  void stopSharedHistoryReader();
+
+  // copies the latest data published by the processor in fState.fHistoryData (if any)
+  void readSharedHistory();
+
 private:
   VAC6Parameters fParameters;
   VAC6GUIState fState;
+
+  // zooms and scrolls in the editor while paused (only when reading the shared history channel)
+  LocalHistoryNavigator fLocalHistoryNavigator;
+
+  // logs the runtime metrics of the processor when dumped (and refreshes them for the debug overlay)
+  MetricsMonitor fMetricsMonitor;
+
+  std::shared_ptr<SharedHistoryChannel> fSharedHistoryChannel{}; // nullptr when not in the same process
+  VSTGUI::SharedPointer<VSTGUI::CVSTGUITimer> fSharedHistoryTimer{}; // set while reading the channel
+  bool fIsEditorOpen{false};
 };
 
 }
@@ -0,0 +1,186 @@
+#include <chrono>
+#include <cmath>
+#include "OfflineAnalyzer.h"
+#include "WavFile.h"
+#include "../VAC6ChannelBank.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+namespace {
+
+using VST::Common::WavFile;
+using FileAnalysis = OfflineAnalyzer::FileAnalysis;
+using Options = OfflineAnalyzer::Options;
+
+inline void setChannelBuffers(AudioBusBuffers &oBuffers, Sample32 **iChannels) { oBuffers.channelBuffers32 = iChannels; }
+inline void setChannelBuffers(AudioBusBuffers &oBuffers, Sample64 **iChannels) { oBuffers.channelBuffers64 = iChannels; }
+
+/**
+ * Sets the zoom so that the window shows (at least) iNumEntries entries of the history (or all of it)
+ */
+void zoomToShow(ZoomWindow &ioZoomWindow, int iHistorySize, int iNumEntries)
+{
+  auto numPoints = ioZoomWindow.getVisibleWindowSizeInPoints();
+
+  // the mapping is exponential (see ZoomWindow::setZoomFactor) => first guess, adjusted for rounding
+  double zoomFactorPercent = 1.0;
+  if(iNumEntries > numPoints)
+  {
+    auto maxZoomFactor = static_cast<double>(iHistorySize) / numPoints;
+    auto zoomFactor = static_cast<double>(iNumEntries) / numPoints;
+    zoomFactorPercent = std::max(0.0, 1.0 - std::log(zoomFactor) / std::log(maxZoomFactor));
+  }
+
+  ioZoomWindow.setZoomFactor(zoomFactorPercent);
+  while(zoomFactorPercent > 0 && ioZoomWindow.getVisibleWindowSizeInSamples() < iNumEntries)
+  {
+    zoomFactorPercent = std::max(0.0, zoomFactorPercent - 0.001);
+    ioZoomWindow.setZoomFactor(zoomFactorPercent);
+  }
+}
+
+/**
+ * Feeds the frames of the file to the engine one batch (ACCUMULATOR_BATCH_SIZE_IN_MS) at a time: every block pushes
+ * exactly one entry (the max of the batch) in the histories so the most recent entry tells in which batch the max is.
+ * The max level since reset of the engine (the max of the same entries) gives the level but not when it happened.
+ */
+template<typename SampleType>
+void analyzeFrames(WavFile const &iFile, Options const &iOptions, FileAnalysis &oAnalysis)
+{
+  auto const numChannels = std::min(iFile.getNumChannels(), MAX_NUM_CHANNELS);
+  auto const numFrames = iFile.getNumFrames();
+
+  SampleRateBasedClock clock{iFile.getSampleRate()};
+  auto const batchSize = static_cast<int>(clock.getSampleCountFor(ACCUMULATOR_BATCH_SIZE_IN_MS));
+
+  // the engine as set up by VAC6Processor::setupProcessing (without the disk history, hence the zoom range)
+  ZoomWindow zoomWindow{MAX_ARRAY_SIZE, HISTORY_BUFFER_SIZE};
+  VAC6ChannelBank channelBank{clock, &zoomWindow, numChannels, SAMPLE_BUFFER_SIZE, HISTORY_BUFFER_SIZE, false};
+  channelBank.setIsLiveView(true);
+  channelBank.setTruePeak(iOptions.fTruePeak);
+
+  // the frames are read into a planar block (all the channels of the file) unless the file can be used directly
+  auto const directData = iFile.getChannelData<SampleType>(0);
+  std::vector<SampleType> block(static_cast<size_t>(iFile.getNumChannels()) * batchSize);
+  std::vector<SampleType *> blockChannels(static_cast<size_t>(iFile.getNumChannels()));
+  for(size_t c = 0; c < blockChannels.size(); c++)
+    blockChannels[c] = block.data() + c * batchSize;
+
+  SampleType *inChannels[MAX_NUM_CHANNELS]{};
+  AudioBusBuffers inBus{};
+  inBus.numChannels = numChannels;
+  inBus.silenceFlags = 0;
+  setChannelBuffers(inBus, inChannels);
+
+  // no output: at unity gain the engine only meters the input
+  AudioBusBuffers outBus{};
+  outBus.numChannels = 0;
+
+  AudioBuffers<SampleType> in(inBus, batchSize);
+  AudioBuffers<SampleType> out(outBus, batchSize);
+  BlockGain const unity{Gain::Unity, nullptr};
+
+  oAnalysis.fChannels.assign(static_cast<size_t>(numChannels), OfflineAnalyzer::ChannelAnalysis{});
+
+  int numEntries = 0;
+  for(int64_t frame = 0; frame < numFrames; frame += batchSize, numEntries++)
+  {
+    auto numSamples = static_cast<int>(std::min<int64_t>(batchSize, numFrames - frame));
+
+    if(directData && numSamples == batchSize)
+    {
+      // zero copy (the engine never writes into the input)
+      inChannels[0] = const_cast<SampleType *>(directData + frame);
+    }
+    else
+    {
+      iFile.readFrames(frame, numSamples, blockChannels.data());
+
+      // the last batch is completed with silence (so that it is pushed in the history)
+      if(numSamples < batchSize)
+      {
+        for(auto channel: blockChannels)
+          std::fill(channel + numSamples, channel + batchSize, 0);
+      }
+
+      std::copy(blockChannels.begin(), blockChannels.begin() + numChannels, inChannels);
+    }
+
+    channelBank.genericProcessChannels<SampleType>(&zoomWindow, in, out, unity, 0, batchSize);
+
+    for(int c = 0; c < numChannels; c++)
+    {
+      auto maxLevel = fromHistorySample(channelBank.getChannel(c).getHistory().getBuffer().getAt(-1));
+      auto &channel = oAnalysis.fChannels[c];
+      if(maxLevel > channel.fMaxLevel)
+      {
+        channel.fMaxLevel = maxLevel;
+        channel.fMaxLevelPosition = frame / iFile.getSampleRate();
+      }
+    }
+  }
+
+  for(auto const &channel: oAnalysis.fChannels)
+  {
+    if(channel.fMaxLevel > oAnalysis.fMax.fMaxLevel ||
+       (channel.fMaxLevel == oAnalysis.fMax.fMaxLevel && channel.fMaxLevelPosition < oAnalysis.fMax.fMaxLevelPosition))
+      oAnalysis.fMax = channel;
+  }
+
+  // the peak history: the zoomed window of each channel (see VAC6AudioChannelProcessor::updateZoomMaxBuffer)
+  auto const numPoints = iOptions.fNumPoints;
+  ZoomWindow historyWindow{numPoints, HISTORY_BUFFER_SIZE};
+  zoomToShow(historyWindow, HISTORY_BUFFER_SIZE, numEntries);
+
+  CircularBuffer<THistorySample> points{numPoints};
+  oAnalysis.fPeakHistory.assign(static_cast<size_t>(numPoints), 0);
+  for(int c = 0; c < numChannels; c++)
+  {
+    ZoomWindow::ComputedWindow window{};
+    auto pendingPoints = historyWindow.beginZoomWindow(points, window, points);
+    historyWindow.computeZoomWindow(channelBank.getChannel(c).getHistory(), pendingPoints, numPoints, 0, points);
+    historyWindow.endZoomWindow(pendingPoints, window);
+
+    for(int i = 0; i < numPoints; i++)
+      oAnalysis.fPeakHistory[i] = std::max(oAnalysis.fPeakHistory[i], fromHistorySample(points.getAt(i)));
+  }
+}
+
+}
+
+//------------------------------------------------------------------------
+// OfflineAnalyzer::analyze
+//------------------------------------------------------------------------
+OfflineAnalyzer::FileAnalysis OfflineAnalyzer::analyze(std::string const &iPath) const
+{
+  auto start = std::chrono::steady_clock::now();
+
+  FileAnalysis analysis{};
+  analysis.fPath = iPath;
+
+  WavFile file{iPath};
+  if(file.isOpen())
+  {
+    analysis.fSampleRate = file.getSampleRate();
+    analysis.fNumFrames = file.getNumFrames();
+    analysis.fNumChannels = file.getNumChannels();
+
+    // 64 bits files are processed in 64 bits (like a host processing in double precision), the others in 32 bits
+    if(file.getSampleFormat() == WavFile::SampleFormat::kFloat64)
+      analyzeFrames<Sample64>(file, fOptions, analysis);
+    else
+      analyzeFrames<Sample32>(file, fOptions, analysis);
+  }
+  else
+    analysis.fError = file.getError();
+
+  analysis.fProcessingTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  return analysis;
+}
+
+}
+}
+}
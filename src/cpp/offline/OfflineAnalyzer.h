@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../VAC6Constants.h"
+
+namespace pongasoft {
+namespace VST {
+namespace VAC6 {
+
+/**
+ * Runs the engine of the plugin (VAC6ChannelBank, i.e. the VAC6AudioChannelProcessor of every channel, in live view)
+ * over a WAV file, as if the file was played in a DAW with the plugin at unity gain, and collects what the plugin
+ * would display once the file is over.
+ */
+class OfflineAnalyzer
+{
+public:
+  struct Options
+  {
+    // number of points of the peak history (the width of the LCD by default)
+    int fNumPoints{MAX_ARRAY_SIZE};
+
+    // see the "True Peak" parameter
+    bool fTruePeak{false};
+  };
+
+  struct ChannelAnalysis
+  {
+    // max level over the whole file, i.e. the max of all the entries pushed in the history (-1 when the file is empty)
+    TSample fMaxLevel{-1};
+
+    // position (in seconds) of the start of the batch (ACCUMULATOR_BATCH_SIZE_IN_MS) containing the max level
+    double fMaxLevelPosition{0};
+  };
+
+  struct FileAnalysis
+  {
+    std::string fPath{};
+    std::string fError{}; // empty on success
+
+    double fSampleRate{0};
+    int64_t fNumFrames{0};
+    int fNumChannels{0}; // channels of the file (only the first MAX_NUM_CHANNELS are analyzed)
+
+    std::vector<ChannelAnalysis> fChannels{};
+
+    // max of all the channels
+    ChannelAnalysis fMax{};
+
+    /**
+     * Max of all the channels, Options::fNumPoints points (oldest first) covering the whole file (or its last
+     * HISTORY_SIZE_IN_SECONDS): computed by the ZoomWindow, exactly like the LCD when zoomed out to show the whole
+     * file. A file shorter than the max zoom starts with 0s.
+     */
+    std::vector<TSample> fPeakHistory{};
+
+    // wall clock time spent analyzing the file (in seconds)
+    double fProcessingTime{0};
+
+    // getDuration (in seconds)
+    inline double getDuration() const { return fSampleRate > 0 ? fNumFrames / fSampleRate : 0; }
+  };
+
+  // Constructor
+  explicit OfflineAnalyzer(Options const &iOptions) : fOptions{iOptions} {}
+
+  /**
+   * Analyzes the file (can be called concurrently from several threads, each call using its own engine)
+   */
+  FileAnalysis analyze(std::string const &iPath) const;
+
+private:
+  Options const fOptions;
+};
+
+}
+}
+}
@@ -0,0 +1,275 @@
+#include "WavFile.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+namespace {
+
+constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+inline uint16_t readUInt16(char const *iPtr)
+{
+  auto p = reinterpret_cast<unsigned char const *>(iPtr);
+  return static_cast<uint16_t>(p[0] | p[1] << 8);
+}
+
+inline uint32_t readUInt32(char const *iPtr)
+{
+  auto p = reinterpret_cast<unsigned char const *>(iPtr);
+  return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+         static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+}
+
+////////////////////////////////////////////////////////////
+// WavFile::WavFile
+////////////////////////////////////////////////////////////
+WavFile::WavFile(std::string const &iPath)
+{
+  if(!map(iPath))
+  {
+    if(fError.empty())
+      fError = "cannot open " + iPath;
+    return;
+  }
+
+  if(!parse())
+  {
+    fFrames = nullptr;
+    unmap();
+  }
+}
+
+////////////////////////////////////////////////////////////
+// WavFile::~WavFile
+////////////////////////////////////////////////////////////
+WavFile::~WavFile()
+{
+  unmap();
+}
+
+////////////////////////////////////////////////////////////
+// WavFile::parse
+////////////////////////////////////////////////////////////
+bool WavFile::parse()
+{
+  if(fSize < 12 || std::memcmp(fData, "RIFF", 4) != 0 || std::memcmp(fData + 8, "WAVE", 4) != 0)
+  {
+    fError = "not a WAV file";
+    return false;
+  }
+
+  bool hasFormat = false;
+  uint16_t formatTag = 0;
+  int bitsPerSample = 0;
+
+  size_t offset = 12;
+  while(offset + 8 <= fSize)
+  {
+    auto chunk = fData + offset;
+    size_t chunkSize = readUInt32(chunk + 4);
+    auto body = offset + 8;
+
+    if(std::memcmp(chunk, "fmt ", 4) == 0)
+    {
+      if(chunkSize < 16 || body + chunkSize > fSize)
+      {
+        fError = "invalid fmt chunk";
+        return false;
+      }
+
+      formatTag = readUInt16(fData + body);
+      fNumChannels = readUInt16(fData + body + 2);
+      fSampleRate = readUInt32(fData + body + 4);
+      fBytesPerFrame = readUInt16(fData + body + 12);
+      bitsPerSample = readUInt16(fData + body + 14);
+
+      // the actual format is the first 2 bytes of the sub format GUID
+      if(formatTag == WAVE_FORMAT_EXTENSIBLE && chunkSize >= 40)
+        formatTag = readUInt16(fData + body + 24);
+
+      hasFormat = true;
+    }
+    else if(std::memcmp(chunk, "data", 4) == 0)
+    {
+      if(!hasFormat)
+      {
+        fError = "data chunk before fmt chunk";
+        return false;
+      }
+
+      switch(formatTag)
+      {
+        case WAVE_FORMAT_PCM:
+          if(bitsPerSample == 16)
+            fSampleFormat = SampleFormat::kPCM16;
+          else if(bitsPerSample == 24)
+            fSampleFormat = SampleFormat::kPCM24;
+          else if(bitsPerSample == 32)
+            fSampleFormat = SampleFormat::kPCM32;
+          else
+          {
+            fError = "unsupported PCM bits per sample (" + std::to_string(bitsPerSample) + ")";
+            return false;
+          }
+          break;
+
+        case WAVE_FORMAT_IEEE_FLOAT:
+          if(bitsPerSample == 32)
+            fSampleFormat = SampleFormat::kFloat32;
+          else if(bitsPerSample == 64)
+            fSampleFormat = SampleFormat::kFloat64;
+          else
+          {
+            fError = "unsupported float bits per sample (" + std::to_string(bitsPerSample) + ")";
+            return false;
+          }
+          break;
+
+        default:
+          fError = "unsupported format (" + std::to_string(formatTag) + ")";
+          return false;
+      }
+
+      fBytesPerSample = bitsPerSample / 8;
+      if(fNumChannels <= 0 || fSampleRate <= 0 || fBytesPerFrame != fNumChannels * fBytesPerSample)
+      {
+        fError = "invalid format";
+        return false;
+      }
+
+      // a file which is still being written (or truncated) has fewer bytes than advertised
+      auto dataSize = std::min(chunkSize, fSize - body);
+      fFrames = fData + body;
+      fNumFrames = static_cast<int64_t>(dataSize / fBytesPerFrame);
+      return true;
+    }
+
+    // chunks are padded to an even size
+    offset = body + chunkSize + (chunkSize & 1);
+  }
+
+  fError = hasFormat ? "no data chunk" : "no fmt chunk";
+  return false;
+}
+
+#ifdef _WIN32
+
+////////////////////////////////////////////////////////////
+// WavFile::map (Windows)
+////////////////////////////////////////////////////////////
+bool WavFile::map(std::string const &iPath)
+{
+  auto file = CreateFileA(iPath.c_str(),
+                          GENERIC_READ,
+                          FILE_SHARE_READ,
+                          nullptr,
+                          OPEN_EXISTING,
+                          FILE_FLAG_SEQUENTIAL_SCAN,
+                          nullptr);
+
+  if(file == INVALID_HANDLE_VALUE)
+    return false;
+
+  fFile = file;
+
+  LARGE_INTEGER size;
+  if(!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+  {
+    fError = "empty file";
+    return false;
+  }
+
+  fMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if(fMapping)
+    fData = static_cast<char const *>(MapViewOfFile(fMapping, FILE_MAP_READ, 0, 0, 0));
+
+  if(!fData)
+    return false;
+
+  fSize = static_cast<size_t>(size.QuadPart);
+  return true;
+}
+
+////////////////////////////////////////////////////////////
+// WavFile::unmap (Windows)
+////////////////////////////////////////////////////////////
+void WavFile::unmap()
+{
+  if(fData)
+    UnmapViewOfFile(fData);
+  if(fMapping)
+    CloseHandle(fMapping);
+  if(fFile)
+    CloseHandle(fFile);
+  fData = nullptr;
+  fMapping = nullptr;
+  fFile = nullptr;
+  fSize = 0;
+}
+
+#else
+
+////////////////////////////////////////////////////////////
+// WavFile::map (macOS / Linux)
+////////////////////////////////////////////////////////////
+bool WavFile::map(std::string const &iPath)
+{
+  fFile = ::open(iPath.c_str(), O_RDONLY);
+
+  if(fFile == -1)
+    return false;
+
+  struct stat s{};
+  if(::fstat(fFile, &s) != 0 || s.st_size == 0)
+  {
+    fError = "empty file";
+    return false;
+  }
+
+  auto size = static_cast<size_t>(s.st_size);
+  auto data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fFile, 0);
+  if(data == MAP_FAILED)
+    return false;
+
+  // the frames are read once, front to back
+  ::madvise(data, size, MADV_SEQUENTIAL);
+
+  fData = static_cast<char const *>(data);
+  fSize = size;
+  return true;
+}
+
+////////////////////////////////////////////////////////////
+// WavFile::unmap (macOS / Linux)
+////////////////////////////////////////////////////////////
+void WavFile::unmap()
+{
+  if(fData)
+    ::munmap(const_cast<char *>(fData), fSize);
+  if(fFile != -1)
+    ::close(fFile);
+  fData = nullptr;
+  fFile = -1;
+  fSize = 0;
+}
+
+#endif
+
+}
+}
+}
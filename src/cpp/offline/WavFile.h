@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+/**
+ * A WAV file (PCM 16/24/32 bits or float 32/64 bits, plain or WAVE_FORMAT_EXTENSIBLE) mapped (read only) in memory:
+ * nothing is read upfront, the pages are brought in by the system as the frames are accessed.
+ *
+ * The frames are stored interleaved in the file so they are read (and converted) into planar blocks (readFrames)
+ * except when the channel already is in the requested format (mono file, same sample type) in which case
+ * getChannelData gives direct access to the mapped samples (no copy at all).
+ */
+class WavFile
+{
+public:
+  enum class SampleFormat
+  {
+    kPCM16,
+    kPCM24,
+    kPCM32,
+    kFloat32,
+    kFloat64
+  };
+
+  // Constructor (check isOpen() / getError() for errors)
+  explicit WavFile(std::string const &iPath);
+
+  // Destructor (unmaps and closes the file)
+  ~WavFile();
+
+  WavFile(WavFile const&) = delete;
+  WavFile &operator=(WavFile const&) = delete;
+
+  // isOpen
+  inline bool isOpen() const { return fFrames != nullptr; }
+
+  // getError (empty when the file is open)
+  inline std::string const &getError() const { return fError; }
+
+  inline int getNumChannels() const { return fNumChannels; }
+  inline double getSampleRate() const { return fSampleRate; }
+  inline int64_t getNumFrames() const { return fNumFrames; }
+  inline SampleFormat getSampleFormat() const { return fSampleFormat; }
+
+  // getDuration (in seconds)
+  inline double getDuration() const { return fSampleRate > 0 ? static_cast<double>(fNumFrames) / fSampleRate : 0; }
+
+  /**
+   * @return the samples of the channel as stored in the file when they can be used directly as SampleType
+   *         (mono file in the same format, properly aligned), nullptr otherwise (use readFrames)
+   */
+  template<typename SampleType>
+  SampleType const *getChannelData(int iChannel) const;
+
+  /**
+   * Reads (and converts to [-1.0, 1.0]) the frames [iFromFrame, iFromFrame + iNumFrames[ of the file into planar
+   * buffers (oChannels[c] being the channel c, getNumChannels() of them). The range must be within the file.
+   */
+  template<typename SampleType>
+  void readFrames(int64_t iFromFrame, int iNumFrames, SampleType * const *oChannels) const;
+
+private:
+  // parses the RIFF chunks of the mapped file (sets fError on failure)
+  bool parse();
+
+  // map / unmap (platform dependent)
+  bool map(std::string const &iPath);
+  void unmap();
+
+  template<typename SampleType, typename Decoder>
+  void deinterleave(int64_t iFromFrame, int iNumFrames, SampleType * const *oChannels, Decoder iDecoder) const;
+
+  std::string fError{};
+
+  // the mapping
+  char const *fData{nullptr};
+  size_t fSize{0};
+#ifdef _WIN32
+  void *fFile{nullptr};
+  void *fMapping{nullptr};
+#else
+  int fFile{-1};
+#endif
+
+  // the format
+  int fNumChannels{0};
+  double fSampleRate{0};
+  SampleFormat fSampleFormat{SampleFormat::kPCM16};
+  int fBytesPerSample{0};
+  int fBytesPerFrame{0};
+
+  // the frames (nullptr when the file is not open)
+  char const *fFrames{nullptr};
+  int64_t fNumFrames{0};
+};
+
+//------------------------------------------------------------------------
+// WavFile::getChannelData
+//------------------------------------------------------------------------
+template<typename SampleType>
+SampleType const *WavFile::getChannelData(int iChannel) const
+{
+  constexpr auto format = sizeof(SampleType) == sizeof(float) ? SampleFormat::kFloat32 : SampleFormat::kFloat64;
+
+  if(!fFrames || fNumChannels != 1 || iChannel != 0 || fSampleFormat != format)
+    return nullptr;
+
+  if(reinterpret_cast<uintptr_t>(fFrames) % alignof(SampleType) != 0)
+    return nullptr;
+
+  return reinterpret_cast<SampleType const *>(fFrames);
+}
+
+//------------------------------------------------------------------------
+// WavFile::deinterleave
+//------------------------------------------------------------------------
+template<typename SampleType, typename Decoder>
+void WavFile::deinterleave(int64_t iFromFrame, int iNumFrames, SampleType * const *oChannels, Decoder iDecoder) const
+{
+  auto frame = fFrames + iFromFrame * fBytesPerFrame;
+  for(int i = 0; i < iNumFrames; i++, frame += fBytesPerFrame)
+  {
+    auto sample = frame;
+    for(int c = 0; c < fNumChannels; c++, sample += fBytesPerSample)
+      oChannels[c][i] = static_cast<SampleType>(iDecoder(reinterpret_cast<unsigned char const *>(sample)));
+  }
+}
+
+//------------------------------------------------------------------------
+// WavFile::readFrames
+//------------------------------------------------------------------------
+template<typename SampleType>
+void WavFile::readFrames(int64_t iFromFrame, int iNumFrames, SampleType * const *oChannels) const
+{
+  // the samples are little endian (and so are all the platforms the plugin is built for)
+  switch(fSampleFormat)
+  {
+    case SampleFormat::kPCM16:
+      deinterleave(iFromFrame, iNumFrames, oChannels, [](unsigned char const *s) {
+        return static_cast<int16_t>(s[0] | (s[1] << 8)) / 32768.0;
+      });
+      break;
+
+    case SampleFormat::kPCM24:
+      deinterleave(iFromFrame, iNumFrames, oChannels, [](unsigned char const *s) {
+        // sign extension: the 24 bits go to the top of an int32 which is then shifted back
+        auto u = static_cast<uint32_t>(s[0]) << 8 | static_cast<uint32_t>(s[1]) << 16 | static_cast<uint32_t>(s[2]) << 24;
+        return (static_cast<int32_t>(u) >> 8) / 8388608.0;
+      });
+      break;
+
+    case SampleFormat::kPCM32:
+      deinterleave(iFromFrame, iNumFrames, oChannels, [](unsigned char const *s) {
+        int32_t v;
+        std::memcpy(&v, s, sizeof(v));
+        return v / 2147483648.0;
+      });
+      break;
+
+    case SampleFormat::kFloat32:
+      deinterleave(iFromFrame, iNumFrames, oChannels, [](unsigned char const *s) {
+        float v;
+        std::memcpy(&v, s, sizeof(v));
+        return v;
+      });
+      break;
+
+    case SampleFormat::kFloat64:
+      deinterleave(iFromFrame, iNumFrames, oChannels, [](unsigned char const *s) {
+        double v;
+        std::memcpy(&v, s, sizeof(v));
+        return v;
+      });
+      break;
+  }
+}
+
+}
+}
+}
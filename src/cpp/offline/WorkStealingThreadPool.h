@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Common {
+
+/**
+ * Fixed size pool of threads where each thread (worker) has its own queue of tasks: a worker runs the tasks of its
+ * own queue (most recent first) and, when it is empty, steals the oldest task of another worker. The tasks submitted
+ * from outside the pool are spread over the workers (round robin) and the ones submitted by a task go to the queue of
+ * the worker running it, so that uneven tasks (ex: files of very different lengths) keep all the threads busy.
+ *
+ * Meant for offline processing (the queues are protected by mutexes and the tasks are std::function): never use
+ * from the audio thread.
+ */
+class WorkStealingThreadPool
+{
+public:
+  // a task gets the index of the worker running it (0 to getNumThreads() - 1)
+  using Task = std::function<void(int iWorker)>;
+
+  /**
+   * @param iNumThreads number of threads (0 means one per core)
+   */
+  explicit WorkStealingThreadPool(int iNumThreads = 0)
+  {
+    if(iNumThreads <= 0)
+      iNumThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    for(int i = 0; i < iNumThreads; i++)
+      fWorkers.emplace_back(std::make_unique<Worker>());
+
+    for(int i = 0; i < iNumThreads; i++)
+      fWorkers[i]->fThread = std::thread([this, i] { run(i); });
+  }
+
+  // Destructor (waits for all the tasks to complete)
+  ~WorkStealingThreadPool()
+  {
+    wait();
+
+    {
+      std::lock_guard<std::mutex> lock{fMutex};
+      fStop = true;
+    }
+    fTaskAvailable.notify_all();
+
+    for(auto &worker: fWorkers)
+      worker->fThread.join();
+  }
+
+  WorkStealingThreadPool(WorkStealingThreadPool const&) = delete;
+  WorkStealingThreadPool &operator=(WorkStealingThreadPool const&) = delete;
+
+  // getNumThreads
+  inline int getNumThreads() const { return static_cast<int>(fWorkers.size()); }
+
+  // submit (can be called from any thread, including from a task)
+  void submit(Task iTask)
+  {
+    auto worker = sCurrentPool == this ? sCurrentWorker :
+                  static_cast<int>(fNextWorker.fetch_add(1) % fWorkers.size());
+
+    fPendingCount.fetch_add(1);
+
+    {
+      std::lock_guard<std::mutex> lock{fWorkers[worker]->fMutex};
+      fWorkers[worker]->fTasks.emplace_back(std::move(iTask));
+    }
+
+    {
+      std::lock_guard<std::mutex> lock{fMutex};
+      fQueuedCount++;
+    }
+    fTaskAvailable.notify_one();
+  }
+
+  // wait (blocks until all the tasks submitted so far, and the ones they submit, are completed)
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock{fMutex};
+    fAllDone.wait(lock, [this] { return fPendingCount.load() == 0; });
+  }
+
+private:
+  struct Worker
+  {
+    std::mutex fMutex{};
+    std::deque<Task> fTasks{};
+    std::thread fThread{};
+  };
+
+  // the most recent task of its own queue, or the oldest one of another worker
+  bool popOrSteal(int iWorker, Task &oTask)
+  {
+    {
+      auto &worker = *fWorkers[iWorker];
+      std::lock_guard<std::mutex> lock{worker.fMutex};
+      if(!worker.fTasks.empty())
+      {
+        oTask = std::move(worker.fTasks.back());
+        worker.fTasks.pop_back();
+        return true;
+      }
+    }
+
+    auto numWorkers = static_cast<int>(fWorkers.size());
+    for(int i = 1; i < numWorkers; i++)
+    {
+      auto &victim = *fWorkers[(iWorker + i) % numWorkers];
+      std::lock_guard<std::mutex> lock{victim.fMutex};
+      if(!victim.fTasks.empty())
+      {
+        oTask = std::move(victim.fTasks.front());
+        victim.fTasks.pop_front();
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // the loop of each thread
+  void run(int iWorker)
+  {
+    sCurrentPool = this;
+    sCurrentWorker = iWorker;
+
+    while(true)
+    {
+      Task task{};
+      if(popOrSteal(iWorker, task))
+      {
+        {
+          std::lock_guard<std::mutex> lock{fMutex};
+          fQueuedCount--;
+        }
+
+        task(iWorker);
+
+        if(fPendingCount.fetch_sub(1) == 1)
+        {
+          std::lock_guard<std::mutex> lock{fMutex};
+          fAllDone.notify_all();
+        }
+        continue;
+      }
+
+      // nothing to run: sleep until a task is queued
+      std::unique_lock<std::mutex> lock{fMutex};
+      fTaskAvailable.wait(lock, [this] { return fStop || fQueuedCount > 0; });
+      if(fStop)
+        return;
+    }
+  }
+
+  std::vector<std::unique_ptr<Worker>> fWorkers{};
+  std::atomic<unsigned int> fNextWorker{0};
+
+  std::mutex fMutex{};
+  std::condition_variable fTaskAvailable{};
+  std::condition_variable fAllDone{};
+  int fQueuedCount{0}; // tasks in the queues (protected by fMutex)
+  std::atomic<int> fPendingCount{0}; // tasks submitted and not completed
+  bool fStop{false};
+
+  // the pool (and worker) the current thread belongs to
+  static thread_local WorkStealingThreadPool *sCurrentPool;
+  static thread_local int sCurrentWorker;
+};
+
+inline thread_local WorkStealingThreadPool *WorkStealingThreadPool::sCurrentPool = nullptr;
+inline thread_local int WorkStealingThreadPool::sCurrentWorker = 0;
+
+}
+}
+}
@@ -0,0 +1,181 @@
+#include <pongasoft/logging/loguru.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "OfflineAnalyzer.h"
+#include "WorkStealingThreadPool.h"
+
+using namespace pongasoft::VST;
+using namespace pongasoft::VST::VAC6;
+
+namespace {
+
+void usage(char const *iProgram)
+{
+  std::fprintf(stderr,
+               "usage: %s [--threads N] [--points N] [--true-peak] file.wav...\n"
+               "\n"
+               "Runs the VAC-6V engine over each WAV file (in parallel) and prints (JSON) the max level of each file\n"
+               "(and channel), its position and the peak history of the whole file. The throughput is printed at the\n"
+               "end (on stderr).\n"
+               "\n"
+               "  --threads N   number of threads (default: one per core)\n"
+               "  --points N    number of points of the peak history (default: %d)\n"
+               "  --true-peak   true peak (4x oversampled) max levels\n",
+               iProgram, MAX_ARRAY_SIZE);
+}
+
+// printJSONString
+void printJSONString(std::string const &iString)
+{
+  std::putchar('"');
+  for(unsigned char c: iString)
+  {
+    switch(c)
+    {
+      case '"': std::fputs("\\\"", stdout); break;
+      case '\\': std::fputs("\\\\", stdout); break;
+      case '\n': std::fputs("\\n", stdout); break;
+      case '\r': std::fputs("\\r", stdout); break;
+      case '\t': std::fputs("\\t", stdout); break;
+      default:
+        if(c < 0x20)
+          std::printf("\\u%04x", c);
+        else
+          std::putchar(c);
+    }
+  }
+  std::putchar('"');
+}
+
+// printLevel (JSON has no -inf => null for silence)
+void printLevel(char const *iName, TSample iLevel)
+{
+  std::printf("\"%s\": %.9g, \"%sDb\": ", iName, std::max(iLevel, 0.0), iName);
+  if(iLevel > 0)
+    std::printf("%.3f", std::log10(iLevel) * 20.0);
+  else
+    std::fputs("null", stdout);
+}
+
+// printMax
+void printMax(OfflineAnalyzer::ChannelAnalysis const &iMax)
+{
+  printLevel("maxLevel", iMax.fMaxLevel);
+  std::printf(", \"maxLevelPosition\": %.3f", iMax.fMaxLevelPosition);
+}
+
+// printAnalysis
+void printAnalysis(OfflineAnalyzer::FileAnalysis const &iAnalysis)
+{
+  std::fputs("  {\"file\": ", stdout);
+  printJSONString(iAnalysis.fPath);
+
+  if(!iAnalysis.fError.empty())
+  {
+    std::fputs(", \"error\": ", stdout);
+    printJSONString(iAnalysis.fError);
+    std::fputs("}", stdout);
+    return;
+  }
+
+  std::printf(", \"sampleRate\": %g, \"numChannels\": %d, \"duration\": %.3f, ",
+              iAnalysis.fSampleRate, iAnalysis.fNumChannels, iAnalysis.getDuration());
+  printMax(iAnalysis.fMax);
+
+  std::fputs(",\n   \"channels\": [", stdout);
+  for(size_t c = 0; c < iAnalysis.fChannels.size(); c++)
+  {
+    std::fputs(c > 0 ? ", {" : "{", stdout);
+    printMax(iAnalysis.fChannels[c]);
+    std::fputs("}", stdout);
+  }
+
+  std::fputs("],\n   \"peakHistory\": [", stdout);
+  for(size_t i = 0; i < iAnalysis.fPeakHistory.size(); i++)
+    std::printf(i > 0 ? ", %.6g" : "%.6g", iAnalysis.fPeakHistory[i]);
+  std::fputs("]}", stdout);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  // the engine only logs warnings/errors
+  loguru::g_stderr_verbosity = loguru::Verbosity_WARNING;
+
+  int numThreads = 0;
+  OfflineAnalyzer::Options options{};
+  std::vector<std::string> paths{};
+
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg{argv[i]};
+    if(arg == "--threads" && i + 1 < argc)
+      numThreads = std::atoi(argv[++i]);
+    else if(arg == "--points" && i + 1 < argc)
+      options.fNumPoints = std::atoi(argv[++i]);
+    else if(arg == "--true-peak")
+      options.fTruePeak = true;
+    else if(arg == "-h" || arg == "--help" || arg.rfind("--", 0) == 0)
+    {
+      usage(argv[0]);
+      return arg == "-h" || arg == "--help" ? 0 : 1;
+    }
+    else
+      paths.emplace_back(arg);
+  }
+
+  if(paths.empty() || options.fNumPoints <= 0 || options.fNumPoints > SAMPLE_BUFFER_SIZE)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  OfflineAnalyzer analyzer{options};
+  std::vector<OfflineAnalyzer::FileAnalysis> analyses(paths.size());
+
+  auto start = std::chrono::steady_clock::now();
+  int usedThreads;
+  {
+    Common::WorkStealingThreadPool pool{numThreads};
+    usedThreads = pool.getNumThreads();
+    for(size_t i = 0; i < paths.size(); i++)
+      pool.submit([&analyzer, &analyses, &paths, i](int) { analyses[i] = analyzer.analyze(paths[i]); });
+    pool.wait();
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // the results (in the order of the command line)
+  int numErrors = 0;
+  double audioDuration = 0;
+  double processingTime = 0;
+
+  std::fputs("[\n", stdout);
+  for(size_t i = 0; i < analyses.size(); i++)
+  {
+    auto const &analysis = analyses[i];
+    printAnalysis(analysis);
+    std::fputs(i + 1 < analyses.size() ? ",\n" : "\n", stdout);
+
+    if(!analysis.fError.empty())
+      numErrors++;
+    audioDuration += analysis.getDuration();
+    processingTime += analysis.fProcessingTime;
+  }
+  std::fputs("]\n", stdout);
+
+  // throughput: seconds of audio processed per second (overall and per core, i.e. per second of processing time)
+  std::fprintf(stderr,
+               "%zu files (%d errors), %.1fs of audio in %.2fs on %d threads => %.1fx realtime (%.1fx realtime per core)\n",
+               analyses.size(), numErrors, audioDuration, elapsed, usedThreads,
+               elapsed > 0 ? audioDuration / elapsed : 0,
+               processingTime > 0 ? audioDuration / processingTime : 0);
+
+  return numErrors > 0 ? 2 : 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <src/cpp/ZoomWindow.h>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::Common;
+
+/**
+ * Reference implementation of the zoom used by the tests: computes the whole visible window of iWindow from the full
+ * resolution buffer iBuffer (the buffer the zoom window covers) by accumulating every entry one at a time (which is
+ * what the plugin did before the tiered history).
+ *
+ * @return the accumulator to use right after the point at the right of the screen
+ */
+inline TZoom::MaxAccumulator computeReferenceZoomWindow(ZoomWindow const &iWindow,
+                                                        CircularBuffer<THistorySample> const &iBuffer,
+                                                        CircularBuffer<THistorySample> &oBuffer)
+{
+  int offset = 0;
+  auto accumulator = iWindow.__getMaxAccumulatorFromLeftOfScreen(offset);
+
+  THistorySample max;
+  for(int i = 0; i < iWindow.getVisibleWindowSizeInPoints(); i++)
+  {
+    while(!accumulator.accumulate(iBuffer.getAt(offset++), max))
+    {}
+    oBuffer.push(max);
+  }
+
+  return accumulator;
+}
+
+}
+}
+}
@@ -0,0 +1,392 @@
+// the functions interposed below must not be replaced by their inline (fortified) versions
+#undef _FORTIFY_SOURCE
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include "RTSafetyChecker.h"
+
+// the glibc implementation of the allocation functions (no dlsym which itself allocates)
+extern "C" {
+void *__libc_malloc(size_t iSize);
+void *__libc_calloc(size_t iCount, size_t iSize);
+void *__libc_realloc(void *iPtr, size_t iSize);
+void __libc_free(void *iPtr);
+void *__libc_memalign(size_t iAlignment, size_t iSize);
+}
+
+namespace {
+
+constexpr int MAX_VIOLATIONS = 64;
+constexpr int MAX_FRAMES = 32;
+
+struct Violation
+{
+  char const *fCall;
+  char const *fCallback;
+  int fNumFrames;
+  void *fFrames[MAX_FRAMES];
+};
+
+// the violations are recorded in preallocated memory (they are recorded from within malloc...)
+Violation gViolations[MAX_VIOLATIONS];
+std::atomic<int> gViolationCount{0};
+bool gAbortOnViolation{false};
+
+// initial-exec => accessing them never allocates (unlike the default model for a shared library)
+__thread int tCallbackDepth __attribute__((tls_model("initial-exec"))) = 0;
+__thread char const *tCallback __attribute__((tls_model("initial-exec"))) = nullptr;
+__thread bool tIsRecording __attribute__((tls_model("initial-exec"))) = false;
+
+/**
+ * Records the call iCall (if a realtime callback is on the stack of this thread)
+ */
+void recordViolation(char const *iCall)
+{
+  // the checker itself may call the interposed functions (backtrace, abort...)
+  if(tCallbackDepth == 0 || tIsRecording)
+    return;
+
+  tIsRecording = true;
+
+  auto index = gViolationCount.fetch_add(1);
+  if(index < MAX_VIOLATIONS)
+  {
+    auto &violation = gViolations[index];
+    violation.fCall = iCall;
+    violation.fCallback = tCallback;
+    violation.fNumFrames = backtrace(violation.fFrames, MAX_FRAMES);
+  }
+
+  if(gAbortOnViolation)
+  {
+    std::fprintf(stderr, "RTSafetyChecker: %s called from %s\n", iCall, tCallback);
+    std::abort();
+  }
+
+  tIsRecording = false;
+}
+
+// the next definition of a function (the libc one)
+template<typename F>
+F next(char const *iName)
+{
+  return reinterpret_cast<F>(dlsym(RTLD_NEXT, iName));
+}
+
+// demangles the function name in a line of backtrace_symbols ("module(function+offset) [address]")
+std::string demangle(char const *iSymbol)
+{
+  std::string line{iSymbol};
+  auto from = line.find('(');
+  auto to = line.find('+', from);
+  if(from == std::string::npos || to == std::string::npos || to == from + 1)
+    return line;
+
+  int status = 0;
+  auto name = line.substr(from + 1, to - from - 1);
+  auto demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+  if(status == 0 && demangled)
+    line.replace(from + 1, to - from - 1, demangled);
+  std::free(demangled);
+  return line;
+}
+
+// initialization (when the library is loaded)
+__attribute__((constructor)) void initialize()
+{
+  // the first call to backtrace loads libgcc (which allocates)
+  void *frames[1];
+  backtrace(frames, 1);
+
+  auto abortOnViolation = std::getenv("VAC6_RT_SAFETY_ABORT");
+  gAbortOnViolation = abortOnViolation && std::strcmp(abortOnViolation, "1") == 0;
+}
+
+// when preloaded, nobody else reports the violations
+__attribute__((destructor)) void terminate()
+{
+  if(pongasoft::VST::Test::RTSafetyChecker::getViolationCount() > 0)
+    std::fprintf(stderr, "RTSafetyChecker: %s", pongasoft::VST::Test::RTSafetyChecker::getReport().c_str());
+}
+
+}
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+//------------------------------------------------------------------------
+// RTSafetyChecker::getViolationCount
+//------------------------------------------------------------------------
+int RTSafetyChecker::getViolationCount()
+{
+  return gViolationCount.load();
+}
+
+//------------------------------------------------------------------------
+// RTSafetyChecker::getReport
+//------------------------------------------------------------------------
+std::string RTSafetyChecker::getReport()
+{
+  int count = getViolationCount();
+
+  std::ostringstream report{};
+  report << count << " realtime safety violation(s)\n";
+
+  for(int i = 0; i < std::min(count, MAX_VIOLATIONS); i++)
+  {
+    auto const &violation = gViolations[i];
+    report << "#" << i << ": " << violation.fCall << " called from " << violation.fCallback << "\n";
+
+    auto symbols = backtrace_symbols(violation.fFrames, violation.fNumFrames);
+    if(symbols)
+    {
+      // the first frames are the checker itself
+      for(int f = 2; f < violation.fNumFrames; f++)
+        report << "    " << demangle(symbols[f]) << "\n";
+      std::free(symbols);
+    }
+  }
+
+  if(count > MAX_VIOLATIONS)
+    report << "(" << count - MAX_VIOLATIONS << " more)\n";
+
+  return report.str();
+}
+
+//------------------------------------------------------------------------
+// RTSafetyChecker::reset
+//------------------------------------------------------------------------
+void RTSafetyChecker::reset()
+{
+  gViolationCount = 0;
+}
+
+}
+}
+}
+
+//------------------------------------------------------------------------
+// The realtime callbacks (see VAC6_RT_SAFETY_SCOPE)
+//------------------------------------------------------------------------
+extern "C" void vac6_rt_safety_enter(char const *iCallback)
+{
+  if(tCallbackDepth++ == 0)
+    tCallback = iCallback;
+}
+
+extern "C" void vac6_rt_safety_leave()
+{
+  tCallbackDepth--;
+}
+
+//------------------------------------------------------------------------
+// The interposed functions
+//------------------------------------------------------------------------
+extern "C" {
+
+// allocations
+void *malloc(size_t iSize) noexcept
+{
+  recordViolation("malloc");
+  return __libc_malloc(iSize);
+}
+
+void *calloc(size_t iCount, size_t iSize) noexcept
+{
+  recordViolation("calloc");
+  return __libc_calloc(iCount, iSize);
+}
+
+void *realloc(void *iPtr, size_t iSize) noexcept
+{
+  recordViolation("realloc");
+  return __libc_realloc(iPtr, iSize);
+}
+
+void free(void *iPtr) noexcept
+{
+  if(iPtr)
+    recordViolation("free");
+  __libc_free(iPtr);
+}
+
+void *memalign(size_t iAlignment, size_t iSize) noexcept
+{
+  recordViolation("memalign");
+  return __libc_memalign(iAlignment, iSize);
+}
+
+void *aligned_alloc(size_t iAlignment, size_t iSize) noexcept
+{
+  recordViolation("aligned_alloc");
+  return __libc_memalign(iAlignment, iSize);
+}
+
+int posix_memalign(void **oPtr, size_t iAlignment, size_t iSize) noexcept
+{
+  recordViolation("posix_memalign");
+  static auto const f = next<int (*)(void **, size_t, size_t)>("posix_memalign");
+  return f(oPtr, iAlignment, iSize);
+}
+
+// locks
+int pthread_mutex_lock(pthread_mutex_t *iMutex) noexcept
+{
+  recordViolation("pthread_mutex_lock");
+  static auto const f = next<int (*)(pthread_mutex_t *)>("pthread_mutex_lock");
+  return f(iMutex);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t *iLock) noexcept
+{
+  recordViolation("pthread_rwlock_rdlock");
+  static auto const f = next<int (*)(pthread_rwlock_t *)>("pthread_rwlock_rdlock");
+  return f(iLock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t *iLock) noexcept
+{
+  recordViolation("pthread_rwlock_wrlock");
+  static auto const f = next<int (*)(pthread_rwlock_t *)>("pthread_rwlock_wrlock");
+  return f(iLock);
+}
+
+int pthread_cond_wait(pthread_cond_t *iCond, pthread_mutex_t *iMutex)
+{
+  recordViolation("pthread_cond_wait");
+  static auto const f = next<int (*)(pthread_cond_t *, pthread_mutex_t *)>("pthread_cond_wait");
+  return f(iCond, iMutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t *iCond, pthread_mutex_t *iMutex, struct timespec const *iTime)
+{
+  recordViolation("pthread_cond_timedwait");
+  static auto const f = next<int (*)(pthread_cond_t *, pthread_mutex_t *, struct timespec const *)>("pthread_cond_timedwait");
+  return f(iCond, iMutex, iTime);
+}
+
+int pthread_join(pthread_t iThread, void **oResult)
+{
+  recordViolation("pthread_join");
+  static auto const f = next<int (*)(pthread_t, void **)>("pthread_join");
+  return f(iThread, oResult);
+}
+
+int sem_wait(sem_t *iSemaphore)
+{
+  recordViolation("sem_wait");
+  static auto const f = next<int (*)(sem_t *)>("sem_wait");
+  return f(iSemaphore);
+}
+
+// blocking system calls
+int nanosleep(struct timespec const *iRequest, struct timespec *oRemaining)
+{
+  recordViolation("nanosleep");
+  static auto const f = next<int (*)(struct timespec const *, struct timespec *)>("nanosleep");
+  return f(iRequest, oRemaining);
+}
+
+int clock_nanosleep(clockid_t iClock, int iFlags, struct timespec const *iRequest, struct timespec *oRemaining)
+{
+  recordViolation("clock_nanosleep");
+  static auto const f = next<int (*)(clockid_t, int, struct timespec const *, struct timespec *)>("clock_nanosleep");
+  return f(iClock, iFlags, iRequest, oRemaining);
+}
+
+int usleep(useconds_t iMicroseconds)
+{
+  recordViolation("usleep");
+  static auto const f = next<int (*)(useconds_t)>("usleep");
+  return f(iMicroseconds);
+}
+
+unsigned int sleep(unsigned int iSeconds)
+{
+  recordViolation("sleep");
+  static auto const f = next<unsigned int (*)(unsigned int)>("sleep");
+  return f(iSeconds);
+}
+
+ssize_t read(int iFD, void *oBuffer, size_t iCount)
+{
+  recordViolation("read");
+  static auto const f = next<ssize_t (*)(int, void *, size_t)>("read");
+  return f(iFD, oBuffer, iCount);
+}
+
+ssize_t write(int iFD, void const *iBuffer, size_t iCount)
+{
+  recordViolation("write");
+  static auto const f = next<ssize_t (*)(int, void const *, size_t)>("write");
+  return f(iFD, iBuffer, iCount);
+}
+
+int open(char const *iPath, int iFlags, ...)
+{
+  recordViolation("open");
+
+  mode_t mode = 0;
+  if(iFlags & O_CREAT)
+  {
+    va_list args;
+    va_start(args, iFlags);
+    mode = static_cast<mode_t>(va_arg(args, int));
+    va_end(args);
+  }
+
+  static auto const f = next<int (*)(char const *, int, ...)>("open");
+  return f(iPath, iFlags, mode);
+}
+
+int close(int iFD)
+{
+  recordViolation("close");
+  static auto const f = next<int (*)(int)>("close");
+  return f(iFD);
+}
+
+int fsync(int iFD)
+{
+  recordViolation("fsync");
+  static auto const f = next<int (*)(int)>("fsync");
+  return f(iFD);
+}
+
+int msync(void *iAddress, size_t iLength, int iFlags)
+{
+  recordViolation("msync");
+  static auto const f = next<int (*)(void *, size_t, int)>("msync");
+  return f(iAddress, iLength, iFlags);
+}
+
+void *mmap(void *iAddress, size_t iLength, int iProtection, int iFlags, int iFD, off_t iOffset) noexcept
+{
+  recordViolation("mmap");
+  static auto const f = next<void *(*)(void *, size_t, int, int, int, off_t)>("mmap");
+  return f(iAddress, iLength, iProtection, iFlags, iFD, iOffset);
+}
+
+int munmap(void *iAddress, size_t iLength) noexcept
+{
+  recordViolation("munmap");
+  static auto const f = next<int (*)(void *, size_t)>("munmap");
+  return f(iAddress, iLength);
+}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+/**
+ * Realtime safety checker (Linux only): a shared library (vac6_rtcheck) interposing the allocation functions
+ * (malloc, free...), the locks (pthread_mutex_lock, condition variables, semaphores...) and the blocking system calls
+ * (sleep, read, write, mmap...) of the libc. A call made while a realtime callback (see VAC6_RT_SAFETY_SCOPE in
+ * src/cpp/RTSafety.h) is on the stack of the calling thread is recorded as a violation (with its backtrace).
+ *
+ * The library is either linked (see vac6_rt_safety_test which checks the violations after driving the processor) or
+ * preloaded (LD_PRELOAD=libvac6_rtcheck.so) in which case the violations are printed (on stderr) at exit. With
+ * VAC6_RT_SAFETY_ABORT=1 in the environment, the process aborts on the first violation (to get a core dump or break
+ * in a debugger).
+ *
+ * Only the calls going through the dynamic linker are seen: a libc function calling another one internally (ex:
+ * printf writing to stdout) is not, but the allocations and locks it makes usually are.
+ */
+class RTSafetyChecker
+{
+public:
+  // getViolationCount (since the last reset)
+  static int getViolationCount();
+
+  /**
+   * @return the violations (since the last reset): one line per violation (the call and the realtime callback)
+   *         followed by its backtrace
+   */
+  static std::string getReport();
+
+  // reset (forgets the violations)
+  static void reset();
+};
+
+}
+}
+}
@@ -0,0 +1,461 @@
+#include <src/cpp/VAC6Processor.h>
+#include <src/cpp/VAC6CIDs.h>
+#include <test/cpp/rtcheck/RTSafetyChecker.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cmath>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace pongasoft::VST::VAC6;
+
+// RTSafetyCheckerTest - Scope (only the calls made while a realtime callback is on the stack are violations)
+TEST(RTSafetyCheckerTest, Scope)
+{
+  RTSafetyChecker::reset();
+
+  // volatile => the allocation cannot be optimized away
+  void * volatile ptr = malloc(16);
+  free(ptr);
+  std::mutex mutex{};
+  mutex.lock();
+  mutex.unlock();
+  ASSERT_EQ(0, RTSafetyChecker::getViolationCount());
+
+  {
+    VAC6_RT_SAFETY_SCOPE("Scope");
+    ptr = malloc(16);
+    free(ptr);
+  }
+  ASSERT_EQ(2, RTSafetyChecker::getViolationCount());
+
+  {
+    VAC6_RT_SAFETY_SCOPE("Scope");
+    {
+      VAC6_RT_SAFETY_SCOPE("Nested");
+    }
+    mutex.lock();
+    mutex.unlock();
+  }
+  ASSERT_EQ(3, RTSafetyChecker::getViolationCount());
+  auto report = RTSafetyChecker::getReport();
+  ASSERT_NE(std::string::npos, report.find("malloc called from Scope")) << report;
+  ASSERT_NE(std::string::npos, report.find("pthread_mutex_lock called from Scope")) << report;
+
+  // the scope is per thread
+  RTSafetyChecker::reset();
+  std::atomic<bool> isInScope{false};
+  std::atomic<bool> isDone{false};
+  std::thread thread{[&isInScope, &isDone] {
+    while(!isInScope)
+      std::this_thread::yield();
+    void * volatile p = malloc(16);
+    free(p);
+    isDone = true;
+  }};
+  {
+    VAC6_RT_SAFETY_SCOPE("Scope");
+    isInScope = true;
+    while(!isDone)
+      std::this_thread::yield();
+  }
+  thread.join();
+  ASSERT_EQ(0, RTSafetyChecker::getViolationCount()) << RTSafetyChecker::getReport();
+}
+
+/**
+ * Preallocated queue of points for one parameter (IParamValueQueue)
+ */
+class ParamValueQueue : public IParamValueQueue
+{
+public:
+  static constexpr int32 MAX_POINTS = 4;
+
+  void reset(ParamID iParamID) { fParamID = iParamID; fPointCount = 0; }
+
+  ParamID PLUGIN_API getParameterId() override { return fParamID; }
+  int32 PLUGIN_API getPointCount() override { return fPointCount; }
+
+  tresult PLUGIN_API getPoint(int32 index, int32 &sampleOffset, ParamValue &value) override
+  {
+    if(index < 0 || index >= fPointCount)
+      return kResultFalse;
+    sampleOffset = fOffsets[index];
+    value = fValues[index];
+    return kResultTrue;
+  }
+
+  tresult PLUGIN_API addPoint(int32 sampleOffset, ParamValue value, int32 &index) override
+  {
+    // a new point at the same offset replaces the previous one
+    if(fPointCount > 0 && fOffsets[fPointCount - 1] == sampleOffset)
+      fPointCount--;
+    if(fPointCount == MAX_POINTS)
+      return kResultFalse;
+    fOffsets[fPointCount] = sampleOffset;
+    fValues[fPointCount] = value;
+    index = fPointCount++;
+    return kResultTrue;
+  }
+
+  tresult PLUGIN_API queryInterface(const TUID, void **obj) override { *obj = nullptr; return kNoInterface; }
+  uint32 PLUGIN_API addRef() override { return 1; }
+  uint32 PLUGIN_API release() override { return 1; }
+
+private:
+  ParamID fParamID{};
+  int32 fPointCount{0};
+  int32 fOffsets[MAX_POINTS]{};
+  ParamValue fValues[MAX_POINTS]{};
+};
+
+/**
+ * Preallocated parameter changes (IParameterChanges): unlike the ones of the SDK (hosting) it never allocates, so
+ * that the only violations are the ones of the processor
+ */
+class ParameterChanges : public IParameterChanges
+{
+public:
+  static constexpr int32 MAX_PARAMETERS = 32;
+
+  void clear() { fParameterCount = 0; }
+
+  // add (the change of iParamID at iSampleOffset)
+  void add(ParamID iParamID, ParamValue iValue, int32 iSampleOffset = 0)
+  {
+    int32 index;
+    addParameterData(iParamID, index)->addPoint(iSampleOffset, iValue, index);
+  }
+
+  // getLastValue (-1 if iParamID did not change)
+  ParamValue getLastValue(ParamID iParamID) const
+  {
+    ParamValue value = -1;
+    for(int32 i = 0; i < fParameterCount; i++)
+    {
+      auto &queue = const_cast<ParamValueQueue &>(fQueues[i]);
+      int32 offset;
+      if(queue.getParameterId() == iParamID)
+        queue.getPoint(queue.getPointCount() - 1, offset, value);
+    }
+    return value;
+  }
+
+  int32 PLUGIN_API getParameterCount() override { return fParameterCount; }
+
+  IParamValueQueue *PLUGIN_API getParameterData(int32 index) override
+  {
+    return index >= 0 && index < fParameterCount ? &fQueues[index] : nullptr;
+  }
+
+  IParamValueQueue *PLUGIN_API addParameterData(const ParamID &id, int32 &index) override
+  {
+    for(index = 0; index < fParameterCount; index++)
+    {
+      if(fQueues[index].getParameterId() == id)
+        return &fQueues[index];
+    }
+
+    if(fParameterCount == MAX_PARAMETERS)
+      return nullptr;
+
+    fQueues[fParameterCount].reset(id);
+    index = fParameterCount;
+    return &fQueues[fParameterCount++];
+  }
+
+  tresult PLUGIN_API queryInterface(const TUID, void **obj) override { *obj = nullptr; return kNoInterface; }
+  uint32 PLUGIN_API addRef() override { return 1; }
+  uint32 PLUGIN_API release() override { return 1; }
+
+private:
+  int32 fParameterCount{0};
+  ParamValueQueue fQueues[MAX_PARAMETERS]{};
+};
+
+/**
+ * Drives the processor like a host would (stereo in/out, blocks of various sizes). Everything (buffers, parameter
+ * changes) is allocated before processing.
+ */
+template<typename SampleType>
+class ProcessorDriver
+{
+public:
+  static constexpr int32 MAX_SAMPLES_PER_BLOCK = 4096;
+  static constexpr int NUM_CHANNELS = 2;
+
+  ProcessorDriver() :
+    fProcessor{owned(new VAC6Processor())},
+    fSamples(NUM_CHANNELS, std::vector<SampleType>(MAX_SAMPLES_PER_BLOCK)),
+    fOutSamples(NUM_CHANNELS, std::vector<SampleType>(MAX_SAMPLES_PER_BLOCK))
+  {
+    for(int c = 0; c < NUM_CHANNELS; c++)
+    {
+      fInPtrs[c] = fSamples[c].data();
+      fOutPtrs[c] = fOutSamples[c].data();
+    }
+
+    fIn.numChannels = NUM_CHANNELS;
+    fOut.numChannels = NUM_CHANNELS;
+    setChannelBuffers(fIn, fInPtrs);
+    setChannelBuffers(fOut, fOutPtrs);
+
+    fData.processMode = kRealtime;
+    fData.symbolicSampleSize = getSymbolicSampleSize();
+    fData.numInputs = 1;
+    fData.numOutputs = 1;
+    fData.inputs = &fIn;
+    fData.outputs = &fOut;
+    fData.inputParameterChanges = &fInputChanges;
+    fData.outputParameterChanges = &fOutputChanges;
+  }
+
+  ~ProcessorDriver()
+  {
+    fProcessor->setProcessing(false);
+    fProcessor->setActive(false);
+    fProcessor->terminate();
+  }
+
+  // setup (not realtime)
+  void setup()
+  {
+    ASSERT_EQ(kResultOk, fProcessor->initialize(nullptr));
+
+    ProcessSetup setup{kRealtime, getSymbolicSampleSize(), MAX_SAMPLES_PER_BLOCK, 48000};
+    ASSERT_EQ(kResultOk, fProcessor->setupProcessing(setup));
+    ASSERT_EQ(kResultOk, fProcessor->setActive(true));
+    fProcessor->setProcessing(true);
+  }
+
+  // change (applied at the next block)
+  void change(ParamID iParamID, ParamValue iValue, int32 iSampleOffset = 0)
+  {
+    fInputChanges.add(iParamID, iValue, iSampleOffset);
+  }
+
+  /**
+   * Processes iNumBlocks blocks (a sine wave) cycling through a few block sizes (the changes apply to the first one)
+   */
+  void process(int iNumBlocks)
+  {
+    static constexpr int32 blockSizes[] = {512, 64, 4096, 1, 333, 1024};
+
+    for(int b = 0; b < iNumBlocks; b++)
+    {
+      auto numSamples = blockSizes[fBlockCount++ % std::size(blockSizes)];
+
+      for(int32 i = 0; i < numSamples; i++)
+      {
+        auto sample = static_cast<SampleType>(0.8 * std::sin(fPhase));
+        fSamples[0][i] = sample;
+        fSamples[1][i] = -sample / 2;
+        fPhase += 0.05;
+      }
+
+      fData.numSamples = numSamples;
+      fOutputChanges.clear();
+      ASSERT_EQ(kResultOk, fProcessor->process(fData));
+      fInputChanges.clear();
+    }
+  }
+
+  // getOutputValue (-1 if the processor did not change iParamID in the last block)
+  ParamValue getOutputValue(ParamID iParamID) const { return fOutputChanges.getLastValue(iParamID); }
+
+  // getSharedHistoryChannel
+  SharedHistoryChannel &getSharedHistoryChannel() { return fProcessor->__getSharedHistoryChannel(); }
+
+private:
+  static constexpr SymbolicSampleSizes getSymbolicSampleSize()
+  {
+    return std::is_same<SampleType, Sample32>::value ? kSample32 : kSample64;
+  }
+
+  static void setChannelBuffers(AudioBusBuffers &oBuffers, SampleType **iPtrs)
+  {
+    if constexpr(std::is_same<SampleType, Sample32>::value)
+      oBuffers.channelBuffers32 = iPtrs;
+    else
+      oBuffers.channelBuffers64 = iPtrs;
+  }
+
+private:
+  IPtr<VAC6Processor> fProcessor;
+  std::vector<std::vector<SampleType>> fSamples;
+  std::vector<std::vector<SampleType>> fOutSamples;
+  SampleType *fInPtrs[NUM_CHANNELS]{};
+  SampleType *fOutPtrs[NUM_CHANNELS]{};
+  AudioBusBuffers fIn{};
+  AudioBusBuffers fOut{};
+  ParameterChanges fInputChanges{};
+  ParameterChanges fOutputChanges{};
+  ProcessData fData{};
+  int fBlockCount{0};
+  double fPhase{0};
+};
+
+// fails (with the report) if the processor made a realtime unsafe call since the last check
+#define ASSERT_RT_SAFE(iSequence) \
+  ASSERT_EQ(0, RTSafetyChecker::getViolationCount()) << iSequence << ": " << RTSafetyChecker::getReport(); \
+  RTSafetyChecker::reset()
+
+/**
+ * Drives the processor through the sequences the editor and the host trigger (live, pause, zoom, scroll, reset...)
+ * and checks that none of them makes a realtime unsafe call while processing
+ */
+template<typename SampleType>
+void checkProcessorSequences()
+{
+  ProcessorDriver<SampleType> driver{};
+  ASSERT_NO_FATAL_FAILURE(driver.setup());
+
+  RTSafetyChecker::reset();
+
+  LCDInputXParamConverter inputX{};
+  GainParamConverter gain{};
+
+  // live (no editor in the same process => the UI data goes through the regular messaging: the whole process call,
+  // including the RTJmbOutParam updates done by the framework after processing the inputs, is checked)
+  ASSERT_NO_FATAL_FAILURE(driver.process(200));
+  ASSERT_RT_SAFE("live");
+
+  // gains (sample accurate, both queues merged), gain filter, true peak, loudness, channel view and bypass
+  driver.change(EVAC6ParamID::kGain1, gain.normalize(Gain{0.5}), 10);
+  driver.change(EVAC6ParamID::kGain2, gain.normalize(Gain{2.0}), 5);
+  driver.process(1);
+  driver.change(EVAC6ParamID::kGainFilter, 0);
+  driver.change(EVAC6ParamID::kGain1, gain.normalize(Gain{0.1}), 100);
+  driver.change(EVAC6ParamID::kTruePeak, 1);
+  driver.change(EVAC6ParamID::kLCDLoudness, LCDLoudnessParamConverter{}.normalize(LCD_LOUDNESS_MOMENTARY));
+  driver.process(50);
+  driver.change(EVAC6ParamID::kLCDChannelView, LCDChannelViewParamConverter{}.normalize(1));
+  driver.change(EVAC6ParamID::kLCDLeftChannel, 0);
+  driver.change(EVAC6ParamID::kBypass, 1);
+  driver.process(50);
+  driver.change(EVAC6ParamID::kLCDChannelView, LCDChannelViewParamConverter{}.normalize(LCD_CHANNEL_VIEW_ALL));
+  driver.change(EVAC6ParamID::kLCDLeftChannel, 1);
+  driver.change(EVAC6ParamID::kBypass, 0);
+  driver.change(EVAC6ParamID::kGainFilter, 1);
+  driver.change(EVAC6ParamID::kLCDLoudness, LCDLoudnessParamConverter{}.normalize(LCD_LOUDNESS_SHORT_TERM));
+  driver.process(50);
+  ASSERT_RT_SAFE("parameters");
+
+  // zoom while live
+  driver.change(EVAC6ParamID::kLCDZoomFactorX, 0.2);
+  driver.process(20);
+  driver.change(EVAC6ParamID::kLCDZoomFactorX, 0.9);
+  driver.process(20);
+  ASSERT_RT_SAFE("live zoom");
+
+  // pause (in the middle of a block)
+  driver.change(EVAC6ParamID::kLCDLiveView, 0, 100);
+  driver.process(20);
+  ASSERT_EQ(0, driver.getSharedHistoryChannel().getSnapshotId()); // no reader
+  ASSERT_RT_SAFE("pause");
+
+  // select (point then range)
+  driver.change(EVAC6ParamID::kLCDInputX, inputX.normalize(100));
+  driver.process(5);
+  driver.change(EVAC6ParamID::kLCDSelectionStartX, inputX.normalize(20));
+  driver.process(5);
+  ASSERT_RT_SAFE("selection");
+
+  // zoom while paused (recomputes the zoomed buffers, moves the selection)
+  driver.change(EVAC6ParamID::kLCDZoomFactorX, 0.5);
+  driver.process(1);
+  ASSERT_NE(-1, driver.getOutputValue(EVAC6ParamID::kLCDSelectionStartX));
+  driver.process(5);
+  driver.change(EVAC6ParamID::kLCDZoomFactorX, 0.0);
+  driver.process(5);
+  ASSERT_RT_SAFE("paused zoom");
+
+  // scroll
+  for(int i = 0; i <= 10; i++)
+  {
+    driver.change(EVAC6ParamID::kLCDHistoryOffset, i / 10.0);
+    driver.process(2);
+  }
+  ASSERT_RT_SAFE("scroll");
+
+  // reset (momentary button)
+  driver.change(EVAC6ParamID::kMaxLevelReset, 1);
+  driver.process(3);
+  driver.change(EVAC6ParamID::kMaxLevelReset, 0);
+  driver.process(3);
+  ASSERT_RT_SAFE("reset");
+
+  // back to live
+  driver.change(EVAC6ParamID::kLCDLiveView, 1, 200);
+  driver.process(1);
+  ASSERT_DOUBLE_EQ(inputX.normalize(LCD_INPUT_X_NOTHING_SELECTED), driver.getOutputValue(EVAC6ParamID::kLCDInputX));
+  driver.process(20);
+  ASSERT_RT_SAFE("live");
+
+  // forced into pause (the host changes the selection while live)
+  driver.change(EVAC6ParamID::kLCDInputX, inputX.normalize(50));
+  driver.process(1);
+  ASSERT_DOUBLE_EQ(0, driver.getOutputValue(EVAC6ParamID::kLCDLiveView));
+  driver.change(EVAC6ParamID::kLCDLiveView, 1);
+  driver.process(5);
+  ASSERT_RT_SAFE("forced pause");
+
+  // the editor (same process) opens => the processor writes the UI data to the shared channel
+  auto &channel = driver.getSharedHistoryChannel();
+  channel.setReaderAttached(true);
+  driver.process(50);
+  ASSERT_RT_SAFE("shared channel");
+
+  // pause with a reader => the frozen histories are copied in the snapshot (a few entries per block)
+  driver.change(EVAC6ParamID::kLCDLiveView, 0);
+  int blocks = 0;
+  while(channel.getSnapshotId() == 0 && blocks++ < 100000)
+    driver.process(1);
+  ASSERT_NE(0, channel.getSnapshotId());
+  ASSERT_RT_SAFE("paused snapshot");
+
+  // the editor zooms and scrolls on its own (see LocalHistoryNavigator)
+  channel.setLocalNavigationSnapshotId(channel.getSnapshotId());
+  driver.change(EVAC6ParamID::kLCDZoomFactorX, 0.7);
+  driver.change(EVAC6ParamID::kLCDHistoryOffset, 0.5);
+  driver.change(EVAC6ParamID::kLCDInputX, inputX.normalize(10));
+  driver.process(5);
+  driver.change(EVAC6ParamID::kLCDSelectionStartX, inputX.normalize(200));
+  driver.process(5);
+  channel.setLocalNavigationSnapshotId(0); // recomputes the zoomed buffers
+  driver.process(5);
+  ASSERT_RT_SAFE("local navigation");
+
+  // live again then the editor closes
+  driver.change(EVAC6ParamID::kLCDLiveView, 1);
+  driver.process(10);
+  ASSERT_EQ(0, channel.getSnapshotId());
+  channel.setReaderAttached(false);
+  driver.process(10);
+  ASSERT_RT_SAFE("editor closed");
+}
+
+// RTSafetyTest - Process32 (the 32 bits processing path never allocates, locks or blocks)
+TEST(RTSafetyTest, Process32)
+{
+  checkProcessorSequences<Sample32>();
+}
+
+// RTSafetyTest - Process64 (the 64 bits processing path never allocates, locks or blocks)
+TEST(RTSafetyTest, Process64)
+{
+  checkProcessorSequences<Sample64>();
+}
+
+}
+}
+}
@@ -0,0 +1,156 @@
+#include <src/cpp/DiskHistory.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::VAC6;
+
+using int64 = Steinberg::int64;
+
+constexpr int RECORD_RESOLUTION = 4;
+
+// brute force max of the records overlapping [iFrom, iTo[
+static THistorySample bruteForceMax(std::vector<THistorySample> const &iRecords, int64 iFrom, int64 iTo)
+{
+  THistorySample max = 0;
+  for(int64 r = 0; r < static_cast<int64>(iRecords.size()); r++)
+  {
+    if((r + 1) * RECORD_RESOLUTION > iFrom && r * RECORD_RESOLUTION < iTo)
+      max = std::max(max, iRecords[r]);
+  }
+  return max;
+}
+
+// DiskHistoryTest - Process (records written to the file and requests served from it)
+TEST(DiskHistoryTest, Process)
+{
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  std::uniform_int_distribution<int64> offsetDistribution(-100, 5000);
+
+  DiskHistory history(RECORD_RESOLUTION);
+  std::vector<THistorySample> records{};
+
+  // no record yet => 0
+  DiskHistory::Request request{};
+  DiskHistory::Response response{};
+  request.fGeneration = 3;
+  request.fNumPoints = 1;
+  request.fPositions[0] = 7;
+  request.fFrom[0] = 0;
+  request.fTo[0] = 100;
+  ASSERT_TRUE(history.postRequest(request));
+  ASSERT_FALSE(history.pollResponse(response));
+  history.process();
+  ASSERT_TRUE(history.pollResponse(response));
+  ASSERT_EQ(3, response.fGeneration);
+  ASSERT_EQ(1, response.fNumPoints);
+  ASSERT_EQ(7, response.fPositions[0]);
+  ASSERT_EQ(0, response.fMax[0]);
+
+  // more records than the file grows by at once (and more than the queue can hold between 2 calls to process)
+  for(int64 i = 0; i < 1000; i++)
+  {
+    // a hole (dropped record) is 0
+    auto max = i % 97 == 0 ? 0 : distribution(generator);
+    records.emplace_back(toHistorySample(max));
+    if(max > 0)
+    {
+      ASSERT_TRUE(history.pushRecord(i, {toHistorySample(max), toHistorySample(max / 2), toHistorySample(max / 3)}));
+    }
+
+    if(i % 50 == 0)
+      history.process();
+  }
+  history.process();
+
+  for(int k = 0; k < 20; k++)
+  {
+    request.fGeneration = k;
+    request.fNumPoints = MAX_ARRAY_SIZE;
+    for(int i = 0; i < MAX_ARRAY_SIZE; i++)
+    {
+      request.fPositions[i] = i;
+      request.fFrom[i] = offsetDistribution(generator);
+      request.fTo[i] = request.fFrom[i] + offsetDistribution(generator) / 10;
+    }
+
+    ASSERT_TRUE(history.postRequest(request));
+    history.process();
+    ASSERT_TRUE(history.pollResponse(response));
+    ASSERT_EQ(k, response.fGeneration);
+    ASSERT_EQ(MAX_ARRAY_SIZE, response.fNumPoints);
+
+    for(int i = 0; i < MAX_ARRAY_SIZE; i++)
+    {
+      ASSERT_EQ(i, response.fPositions[i]);
+      ASSERT_EQ(bruteForceMax(records, request.fFrom[i], request.fTo[i]), response.fMax[i])
+                << "[" << request.fFrom[i] << "," << request.fTo[i] << "[";
+    }
+  }
+}
+
+// DiskHistoryTest - Thread (the records and requests are processed by the thread)
+TEST(DiskHistoryTest, Thread)
+{
+  DiskHistory history1(RECORD_RESOLUTION);
+  DiskHistory history2(RECORD_RESOLUTION);
+
+  DiskHistoryThread thread;
+  thread.start({&history1, &history2});
+
+  // the entries are encoded (see toHistorySample) whatever the type of the history
+  auto entry = [](double iMax) -> DiskHistory::TierEntry {
+    return {toHistorySample(iMax), toHistorySample(0.1), toHistorySample(0.2)};
+  };
+
+  ASSERT_TRUE(history1.pushRecord(0, entry(0.5)));
+  ASSERT_TRUE(history2.pushRecord(0, entry(0.7)));
+  ASSERT_TRUE(history2.pushRecord(1, entry(0.9)));
+
+  DiskHistory::Request request{};
+  request.fGeneration = 1;
+  request.fNumPoints = 2;
+  request.fPositions[0] = 0;
+  request.fFrom[0] = 0;
+  request.fTo[0] = RECORD_RESOLUTION;
+  request.fPositions[1] = 1;
+  request.fFrom[1] = 0;
+  request.fTo[1] = 2 * RECORD_RESOLUTION;
+
+  // records and requests are processed in order
+  ASSERT_TRUE(history1.postRequest(request));
+  ASSERT_TRUE(history2.postRequest(request));
+
+  DiskHistory::Response response{};
+
+  auto waitForResponse = [&response] (DiskHistory &iHistory) {
+    for(int i = 0; i < 500; i++)
+    {
+      if(iHistory.pollResponse(response))
+        return true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+  };
+
+  ASSERT_TRUE(waitForResponse(history1));
+  ASSERT_EQ(toHistorySample(0.5), response.fMax[0]);
+  ASSERT_EQ(toHistorySample(0.5), response.fMax[1]);
+
+  ASSERT_TRUE(waitForResponse(history2));
+  ASSERT_EQ(toHistorySample(0.7), response.fMax[0]);
+  ASSERT_EQ(toHistorySample(0.9), response.fMax[1]);
+
+  thread.stop();
+}
+
+}
+}
+}
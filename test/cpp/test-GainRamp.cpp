@@ -0,0 +1,143 @@
+#include <src/cpp/GainRamp.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::VAC6;
+
+constexpr double SAMPLE_RATE = 44100;
+
+// the gain of each of the iNumSamples samples of the block
+static std::vector<TSample> toVector(BlockGain const &iGain, int iNumSamples)
+{
+  if(iGain.isConstant())
+    return std::vector<TSample>(static_cast<size_t>(iNumSamples), iGain.fValue);
+  return std::vector<TSample>(iGain.fGains, iGain.fGains + iNumSamples);
+}
+
+// GainRampTest - Constant (no change => no per sample gain)
+TEST(GainRampTest, Constant)
+{
+  GainRamp gain{0.5};
+  gain.setup(SAMPLE_RATE, 512);
+
+  auto blockGain = gain.generate(512);
+  ASSERT_TRUE(blockGain.isConstant());
+  ASSERT_EQ(0.5, blockGain.fValue);
+
+  // same value
+  gain.setTargetValue(0.5);
+  ASSERT_TRUE(gain.generate(512).isConstant());
+}
+
+// GainRampTest - Ramp (the gain moves toward the target and then snaps to it)
+TEST(GainRampTest, Ramp)
+{
+  GainRamp gain{1.0};
+  gain.setup(SAMPLE_RATE, 512);
+
+  gain.setTargetValue(2.0);
+
+  auto blockGain = gain.generate(512);
+  ASSERT_FALSE(blockGain.isConstant());
+
+  auto gains = toVector(blockGain, 512);
+  for(int i = 1; i < 512; i++)
+    ASSERT_GT(gains[i], gains[i - 1]);
+  ASSERT_GT(gains[0], 1.0);
+  ASSERT_LT(gains[511], 2.0);
+  ASSERT_EQ(gains[511], gain.getValue());
+
+  // one time constant => ~63% of the way
+  int numSamples = static_cast<int>(GAIN_FILTER_TIME_CONSTANT_IN_MS * SAMPLE_RATE / 1000.0);
+  int generated = 512;
+  while(generated + 512 <= numSamples)
+  {
+    gain.generate(512);
+    generated += 512;
+  }
+  gains = toVector(gain.generate(numSamples - generated), numSamples - generated);
+  ASSERT_NEAR(2.0 - std::exp(-1.0), gain.getValue(), 1e-3);
+
+  // eventually reaches the target exactly and is constant again
+  bool isConstant = false;
+  for(int i = 0; i < 1000 && !isConstant; i++)
+    isConstant = gain.generate(512).isConstant();
+  ASSERT_TRUE(isConstant);
+  ASSERT_EQ(2.0, gain.getValue());
+}
+
+// GainRampTest - BlockSizeIndependent (the ramp does not depend on how the samples are split in blocks)
+TEST(GainRampTest, BlockSizeIndependent)
+{
+  GainRamp gain1{1.0};
+  gain1.setup(SAMPLE_RATE, 512);
+  GainRamp gain2{1.0};
+  gain2.setup(SAMPLE_RATE, 512);
+
+  gain1.addTargetValue(100, 0.25);
+  auto gains1 = toVector(gain1.generate(512), 512);
+
+  // same change in the second block of 128 samples
+  std::vector<TSample> gains2{};
+  for(int b = 0; b < 4; b++)
+  {
+    if(b == 0)
+      gain2.addTargetValue(100, 0.25);
+    auto blockGains = toVector(gain2.generate(128), 128);
+    gains2.insert(gains2.end(), blockGains.begin(), blockGains.end());
+  }
+
+  for(int i = 0; i < 100; i++)
+    ASSERT_EQ(1.0, gains1[i]);
+
+  for(int i = 0; i < 512; i++)
+    ASSERT_NEAR(gains1[i], gains2[i], 1e-12) << i;
+}
+
+// GainRampTest - FilterOff (the gain changes at the exact sample offset)
+TEST(GainRampTest, FilterOff)
+{
+  GainRamp gain{1.0, false};
+  gain.setup(SAMPLE_RATE, 512);
+
+  // at the start of the block => constant
+  gain.setTargetValue(0.5);
+  auto blockGain = gain.generate(512);
+  ASSERT_TRUE(blockGain.isConstant());
+  ASSERT_EQ(0.5, blockGain.fValue);
+
+  gain.addTargetValue(10, 2.0);
+  gain.addTargetValue(300, 3.0);
+  gain.addTargetValue(300, 4.0); // same offset => last one wins
+  auto gains = toVector(gain.generate(512), 512);
+  for(int i = 0; i < 512; i++)
+    ASSERT_EQ(i < 10 ? 0.5 : i < 300 ? 2.0 : 4.0, gains[i]) << i;
+  ASSERT_EQ(4.0, gain.getValue());
+
+  ASSERT_TRUE(gain.generate(512).isConstant());
+}
+
+// GainRampTest - Ramp (vectorized) vs scalarRamp
+TEST(GainRampTest, VectorizedRamp)
+{
+  for(int numSamples = 0; numSamples <= 67; numSamples++)
+  {
+    std::vector<TSample> expected(static_cast<size_t>(numSamples), -2);
+    std::vector<TSample> gains(static_cast<size_t>(numSamples), -2);
+
+    GainRamp::scalarRamp(expected.data(), numSamples, 0.7, -0.4, 0.999);
+    GainRamp::ramp(gains.data(), numSamples, 0.7, -0.4, 0.999);
+
+    for(int i = 0; i < numSamples; i++)
+      ASSERT_NEAR(expected[i], gains[i], 1e-14);
+  }
+}
+
+}
+}
+}
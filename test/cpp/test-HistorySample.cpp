@@ -0,0 +1,195 @@
+#include <src/cpp/HistorySample.h>
+#include <src/cpp/ZoomWindow.h>
+#include <src/cpp/RangeStatsIndex.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::Common;
+
+using TSample = Steinberg::Vst::Sample64;
+using TCode = DbCode::type;
+
+struct DbCodeDecoder
+{
+  inline TSample operator()(TCode iCode) const { return DbCode::decode(iCode); }
+};
+
+// DbCodeTest - Encode
+TEST(DbCodeTest, Encode)
+{
+  // silence (and anything below MIN_DB or invalid) is 0
+  ASSERT_EQ(0, DbCode::encode(0));
+  ASSERT_EQ(0, DbCode::encode(-0.5));
+  ASSERT_EQ(0, DbCode::encode(std::nan("")));
+  ASSERT_EQ(0, DbCode::encode(std::pow(10.0, (DbCode::MIN_DB - 1) / 20.0)));
+  ASSERT_EQ(0, DbCode::decode(0));
+
+  // range
+  ASSERT_EQ(1, DbCode::encode(std::pow(10.0, DbCode::MIN_DB / 20.0) * 1.0001));
+  ASSERT_EQ(DbCode::MAX_CODE, DbCode::encode(std::pow(10.0, DbCode::MAX_DB / 20.0)));
+  ASSERT_EQ(DbCode::MAX_CODE, DbCode::encode(1e10));
+  ASSERT_EQ(DbCode::MAX_CODE, DbCode::encode(std::numeric_limits<double>::infinity()));
+
+  // every code decodes to a value which encodes back to the same code
+  for(int code = 1; code <= DbCode::MAX_CODE; code++)
+  {
+    ASSERT_EQ(code, DbCode::encode(DbCode::decode(static_cast<TCode>(code)))) << code;
+  }
+
+  // precision (half a code)
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(-120.0, 24.0);
+  for(int i = 0; i < 10000; i++)
+  {
+    auto db = distribution(generator);
+    auto decoded = 20.0 * std::log10(DbCode::decode(DbCode::encode(std::pow(10.0, db / 20.0))));
+    ASSERT_NEAR(db, decoded, DbCode::DB_PER_CODE / 2 + 1e-9);
+  }
+}
+
+// DbCodeTest - Monotonic (the max of the codes is the code of the max)
+TEST(DbCodeTest, Monotonic)
+{
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(0.0, 2.0);
+
+  for(int i = 0; i < 10000; i++)
+  {
+    auto s1 = distribution(generator);
+    auto s2 = distribution(generator);
+    auto c1 = DbCode::encode(s1);
+    auto c2 = DbCode::encode(s2);
+    if(s1 < s2)
+    {
+      ASSERT_LE(c1, c2);
+    }
+    ASSERT_EQ(DbCode::encode(std::max(s1, s2)), std::max(c1, c2));
+  }
+}
+
+// DbCodeTest - ZoomAndMaxOnCodes
+TEST(DbCodeTest, ZoomAndMaxOnCodes)
+{
+  constexpr int SIZE = 100;
+
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+  CircularBuffer<TSample> samples(SIZE);
+  CircularBuffer<TCode> codes(SIZE);
+  MaxIndex<TCode> maxIndex(SIZE);
+  samples.init(0);
+  codes.init(0);
+  maxIndex.init(0);
+
+  for(int i = 0; i < SIZE; i++)
+  {
+    auto sample = distribution(generator);
+    samples.push(sample);
+    codes.push(DbCode::encode(sample));
+    maxIndex.onPush(codes);
+  }
+
+  // range max
+  for(int from = -SIZE; from < 0; from += 7)
+  {
+    TSample max = 0;
+    for(int i = from; i < 0; i++)
+      max = std::max(max, samples.getAt(i));
+    ASSERT_EQ(DbCode::encode(max), maxIndex.getMax(codes, from, 0));
+  }
+
+  // zoom (including the offset of the max which relies on the first entry of a batch being a candidate)
+  Zoom<10, TSample> zoom(3.4);
+  Zoom<10, TCode> codesZoom(3.4);
+
+  int offset, codesOffset;
+  auto accumulator = zoom.getAccumulatorFromIndex(-20, offset);
+  auto codesAccumulator = codesZoom.getAccumulatorFromIndex(-20, codesOffset);
+  ASSERT_EQ(offset, codesOffset);
+
+  while(offset < 0)
+  {
+    int maxOffset, codesMaxOffset;
+    auto max = accumulator.accumulate(samples, offset, maxOffset, offset);
+    auto codesMax = codesAccumulator.accumulate(codes, codesOffset, codesMaxOffset, codesOffset);
+    ASSERT_EQ(DbCode::encode(max), codesMax);
+    ASSERT_EQ(offset, codesOffset);
+    ASSERT_EQ(DbCode::encode(samples.getAt(maxOffset)), codes.getAt(codesMaxOffset));
+  }
+}
+
+// DbCodeTest - TieredHistory
+TEST(DbCodeTest, TieredHistory)
+{
+  TieredHistory<TCode> history(20, 1000, 4);
+
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+  std::vector<TSample> entries{};
+  for(int i = 0; i < 1000; i++)
+  {
+    entries.emplace_back(distribution(generator));
+    history.push(DbCode::encode(entries.back()));
+  }
+
+  // (exact) max over the full resolution tier, aligned max over the coarsest tier
+  TSample max = 0;
+  for(int i = -20; i < 0; i++)
+    max = std::max(max, entries[entries.size() + i]);
+  ASSERT_EQ(DbCode::encode(max), history.getMax(-20, 0));
+
+  // the oldest complete entry of the coarsest tier (64 entries, 15 complete) represents the first 64 entries
+  max = 0;
+  for(int i = 0; i < 64; i++)
+    max = std::max(max, entries[i]);
+  auto oldest = history.getTierEntry(history.getTierCount() - 1, -15);
+  ASSERT_EQ(DbCode::encode(max), oldest.fMax);
+
+  // the average does not overflow (average of the codes)
+  ASSERT_GT(oldest.fAverage, oldest.fMin);
+  ASSERT_LT(oldest.fAverage, oldest.fMax);
+}
+
+// DbCodeTest - RangeStats (computed on the decoded entries, threshold compared to the codes)
+TEST(DbCodeTest, RangeStats)
+{
+  constexpr int SIZE = 16;
+
+  CircularBuffer<TCode> codes(SIZE);
+  CircularBuffer<TSample> meanSquares(SIZE); // not encoded
+  RangeStatsIndex<TCode, TSample, DbCodeDecoder> index(SIZE, DbCode::encode(0.5));
+  codes.init(0);
+  meanSquares.init(0);
+  index.init(0, 0);
+
+  TSample sum = 0;
+  int countAboveThreshold = 0;
+  for(int i = 0; i < SIZE; i++)
+  {
+    auto code = DbCode::encode((i + 1) / static_cast<TSample>(SIZE));
+    codes.push(code);
+    meanSquares.push(0.25);
+    index.onPush(codes, meanSquares);
+    sum += DbCode::decode(code);
+    if(code > DbCode::encode(0.5))
+      countAboveThreshold++;
+  }
+
+  auto stats = index.getStats(codes, meanSquares, -SIZE, 0);
+  ASSERT_NEAR(sum, stats.fSum, 1e-12);
+  ASSERT_EQ(SIZE * 0.25, stats.fSumOfMeanSquares);
+  ASSERT_NEAR((SIZE + 1) / 2.0, stats.fSum, 0.01);
+  ASSERT_EQ(countAboveThreshold, stats.fCountAboveThreshold);
+  ASSERT_EQ(SIZE / 2, stats.fCountAboveThreshold);
+}
+
+}
+}
+}
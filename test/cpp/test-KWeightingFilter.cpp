@@ -0,0 +1,85 @@
+#include <src/cpp/KWeightingFilter.h>
+#include <src/cpp/LoudnessAccumulator.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::VAC6;
+
+// KWeightingFilterTest - Process
+TEST(KWeightingFilterTest, Process)
+{
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  std::uniform_int_distribution<int> runSizeDistribution(0, 150);
+
+  constexpr int numSamples = 5000;
+
+  std::vector<Sample32> left(numSamples);
+  std::vector<Sample32> right(numSamples);
+  for(int i = 0; i < numSamples; i++)
+  {
+    left[i] = static_cast<Sample32>(distribution(generator));
+    right[i] = static_cast<Sample32>(distribution(generator));
+  }
+
+  // the vectorized implementation processes both channels at once but must match the reference one
+  KWeightingFilter expectedFilter{44100};
+  KWeightingFilter filter{44100};
+
+  int i = 0;
+  while(i < numSamples)
+  {
+    int runSize = std::min(runSizeDistribution(generator), numSamples - i);
+    ASSERT_EQ(expectedFilter.scalarProcess(left.data() + i, right.data() + i, runSize, 0.7),
+              filter.process(left.data() + i, right.data() + i, runSize, 0.7));
+    i += runSize;
+  }
+
+  // mono
+  ASSERT_EQ(expectedFilter.scalarProcess(left.data(), static_cast<Sample32 const *>(nullptr), numSamples, 1.0),
+            filter.process(left.data(), static_cast<Sample32 const *>(nullptr), numSamples, 1.0));
+
+  // silence
+  ASSERT_EQ(expectedFilter.scalarProcess(static_cast<Sample32 const *>(nullptr), static_cast<Sample32 const *>(nullptr), numSamples, 1.0),
+            filter.process(static_cast<Sample32 const *>(nullptr), static_cast<Sample32 const *>(nullptr), numSamples, 1.0));
+}
+
+// KWeightingFilterTest - Loudness
+TEST(KWeightingFilterTest, Loudness)
+{
+  // BS.1770-4: a 0dBFS 997Hz sine on one channel measures -3.01 LUFS (at any sample rate)
+  constexpr double PI = 3.14159265358979323846;
+
+  for(auto sampleRate: {44100, 48000, 96000, 192000})
+  {
+    std::vector<Sample64> in(static_cast<size_t>(sampleRate) * 4);
+    for(size_t i = 0; i < in.size(); i++)
+      in[i] = std::sin(2.0 * PI * 997.0 * i / sampleRate);
+
+    KWeightingFilter filter{static_cast<double>(sampleRate)};
+    LoudnessAccumulator accumulator{static_cast<uint32>(sampleRate * LOUDNESS_BLOCK_SIZE_IN_MS / 1000)};
+
+    int i = 0;
+    int numSamples = static_cast<int>(in.size());
+    while(i < numSamples)
+    {
+      auto runSize = static_cast<int>(accumulator.getRemainingSamplesInBlock(static_cast<uint32>(numSamples - i)));
+      accumulator.accumulate(filter.process(in.data() + i, static_cast<Sample64 const *>(nullptr), runSize, 1.0),
+                             static_cast<uint32>(runSize));
+      i += runSize;
+    }
+
+    ASSERT_NEAR(-3.01, std::log10(accumulator.getMomentaryLoudness()) * 20.0, 0.05) << sampleRate;
+    ASSERT_NEAR(-3.01, std::log10(accumulator.getShortTermLoudness()) * 20.0, 0.05) << sampleRate;
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,179 @@
+#include <src/cpp/LCDColumns.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::VAC6;
+
+constexpr int NUM_COLUMNS = 256;
+constexpr double SILENT_THRESHOLD = 2.0e-8;
+constexpr double MIN_SAMPLE = 0.001; // -60dB
+constexpr double HARD_CLIPPING_LEVEL = 1.0;
+
+using TestLCDColumns = LCDColumns<NUM_COLUMNS>;
+
+// LCDColumnsTest - FastLog2
+TEST(LCDColumnsTest, FastLog2)
+{
+  for(float value = 1e-7f; value < 100.0f; value *= 1.01f)
+  {
+    ASSERT_NEAR(std::log2(value), TestLCDColumns::fastLog2(value), 2e-5) << value;
+  }
+}
+
+// LCDColumnsTest - SameAsOneLinePerColumn
+TEST(LCDColumnsTest, SameAsOneLinePerColumn)
+{
+  constexpr double height = 200;
+  constexpr double softClippingLevel = 0.50118723362; // -6dB
+
+  // what the LCD used to compute for each column (see toDisplayValue)
+  auto expectedTop = [height](double iSample) {
+    if(iSample < SILENT_THRESHOLD)
+      return height;
+    double displayValue = iSample < MIN_SAMPLE ? 1 : -((20.0 * std::log10(iSample) / -60.0) - 1.0) * height;
+    return std::min(std::max(height - displayValue, -0.5), height);
+  };
+
+  auto expectedBand = [](double iSample) {
+    return iSample > HARD_CLIPPING_LEVEL ? TestLCDColumns::kHardClipping :
+           iSample > softClippingLevel ? TestLCDColumns::kSoftClipping :
+           TestLCDColumns::kOk;
+  };
+
+  std::mt19937 generator{42};
+  std::uniform_real_distribution<double> db{-170.0, 12.0};
+
+  THistorySample samples[NUM_COLUMNS];
+  for(int i = 0; i < NUM_COLUMNS; i++)
+    samples[i] = toHistorySample(std::pow(10.0, db(generator) / 20.0));
+
+  // edge cases
+  samples[0] = toHistorySample(0);
+  samples[1] = toHistorySample(1.0);
+  samples[2] = toHistorySample(softClippingLevel);
+  samples[3] = toHistorySample(MIN_SAMPLE / 2);
+  samples[4] = toHistorySample(4.0);
+
+  TestLCDColumns columns{SILENT_THRESHOLD, MIN_SAMPLE, HARD_CLIPPING_LEVEL};
+  columns.compute(samples, height, softClippingLevel);
+
+  int numDrawn = 0;
+  TestLCDColumns::Band bands[NUM_COLUMNS];
+  for(int b = 0; b < TestLCDColumns::kNumBands; b++)
+  {
+    auto band = static_cast<TestLCDColumns::Band>(b);
+    auto indices = columns.getColumns(band);
+    for(int j = 0; j < columns.getNumColumns(band); j++)
+    {
+      if(j > 0)
+      {
+        ASSERT_LT(indices[j - 1], indices[j]);
+      }
+      bands[indices[j]] = band;
+    }
+    numDrawn += columns.getNumColumns(band);
+  }
+
+  int expectedNumDrawn = 0;
+  for(int i = 0; i < NUM_COLUMNS; i++)
+  {
+    auto sample = fromHistorySample(samples[i]);
+
+    // less than 1/100 of a pixel
+    ASSERT_NEAR(expectedTop(sample), columns.getTop(i), 0.01) << i;
+
+    if(sample >= SILENT_THRESHOLD)
+    {
+      expectedNumDrawn++;
+      ASSERT_EQ(expectedBand(sample), bands[i]) << i;
+    }
+  }
+
+  ASSERT_EQ(expectedNumDrawn, numDrawn);
+  ASSERT_EQ(height, columns.getTop(0));
+  ASSERT_EQ(height - 1, columns.getTop(3));
+  ASSERT_EQ(TestLCDColumns::kHardClipping, bands[4]);
+  ASSERT_EQ(-0.5, columns.getTop(4));
+
+  // new soft clipping level => same tops, different bands
+  columns.compute(samples, height, HARD_CLIPPING_LEVEL);
+  ASSERT_EQ(0, columns.getNumColumns(TestLCDColumns::kSoftClipping));
+  ASSERT_EQ(numDrawn, columns.getNumColumns(TestLCDColumns::kOk) + columns.getNumColumns(TestLCDColumns::kHardClipping));
+}
+
+// LCDColumnsTest - ScrollSameAsFullRaster
+TEST(LCDColumnsTest, ScrollSameAsFullRaster)
+{
+  constexpr int pixelsPerColumn = 2;
+  constexpr double height = 100;
+  constexpr int heightInPixels = 200;
+  constexpr int widthInPixels = NUM_COLUMNS * pixelsPerColumn;
+  PixelBuffer::Pixel const bandPixels[TestLCDColumns::kNumBands] = {1, 2, 3};
+
+  std::mt19937 generator{7};
+  std::uniform_real_distribution<double> db{-70.0, 6.0};
+
+  // the history of the live view (one more column per frame)
+  std::vector<THistorySample> history{};
+  for(int i = 0; i < NUM_COLUMNS + 10; i++)
+    history.emplace_back(toHistorySample(std::pow(10.0, db(generator) / 20.0)));
+  history[NUM_COLUMNS + 3] = 0;
+
+  TestLCDColumns columns{SILENT_THRESHOLD, MIN_SAMPLE, HARD_CLIPPING_LEVEL};
+
+  // the cached bitmap (with padding at the end of each row)
+  constexpr int bytesPerRow = (widthInPixels + 3) * sizeof(PixelBuffer::Pixel);
+  std::vector<uint8_t> cachedPixels(bytesPerRow * heightInPixels, 0xff);
+  PixelBuffer cached{cachedPixels.data(), bytesPerRow, widthInPixels, heightInPixels};
+
+  columns.compute(history.data(), height, 0.5);
+  columns.rasterize(cached, 0, pixelsPerColumn, bandPixels);
+
+  ASSERT_EQ(0, TestLCDColumns::computeShift(history.data(), history.data(), 16));
+
+  int frame = 0;
+  for(int shift : {1, 2, 1, 3, 0, 1})
+  {
+    auto previous = history.data() + frame;
+    frame += shift;
+    auto current = history.data() + frame;
+
+    ASSERT_EQ(shift, TestLCDColumns::computeShift(previous, current, 16));
+
+    // scroll + draw the new columns only
+    columns.compute(current, height, 0.5);
+    cached.shiftLeft(shift * pixelsPerColumn);
+    columns.rasterize(cached, NUM_COLUMNS - shift, pixelsPerColumn, bandPixels);
+
+    // same as drawing everything
+    std::vector<uint8_t> fullPixels(bytesPerRow * heightInPixels, 0xff);
+    PixelBuffer full{fullPixels.data(), bytesPerRow, widthInPixels, heightInPixels};
+    columns.rasterize(full, 0, pixelsPerColumn, bandPixels);
+
+    for(int y = 0; y < heightInPixels; y++)
+    {
+      ASSERT_TRUE(std::equal(full.getRow(y), full.getRow(y) + widthInPixels, cached.getRow(y))) << frame << "/" << y;
+    }
+  }
+
+  // not a scroll (ex: zoom)
+  std::vector<THistorySample> zoomed{history.begin() + frame, history.begin() + frame + NUM_COLUMNS};
+  zoomed[10] = toHistorySample(10.0);
+  ASSERT_EQ(-1, TestLCDColumns::computeShift(history.data() + frame, zoomed.data(), 16));
+
+  // silent column => not drawn (history[NUM_COLUMNS + 3] is the column NUM_COLUMNS + 3 - frame)
+  auto silentColumn = NUM_COLUMNS + 3 - frame;
+  ASSERT_EQ(TestLCDColumns::kNotDrawn, columns.getBand(silentColumn));
+  ASSERT_EQ(PixelBuffer::Pixel{0}, cached.getRow(heightInPixels - 1)[silentColumn * pixelsPerColumn]);
+  ASSERT_EQ(bandPixels[columns.getBand(silentColumn - 1)],
+            cached.getRow(heightInPixels - 1)[(silentColumn - 1) * pixelsPerColumn + 1]);
+}
+
+}
+}
+}
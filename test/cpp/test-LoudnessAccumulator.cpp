@@ -0,0 +1,74 @@
+#include <src/cpp/LoudnessAccumulator.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::VAC6;
+
+/**
+ * Brute force computation of the loudness (as a sample value) of the last iBlockCount blocks (missing blocks are
+ * silent)
+ */
+TSample computeLoudness(std::vector<TSample> const &iBlockSums, int iBlockCount, uint32 iBlockSize)
+{
+  TSample sum = 0;
+  for(int i = std::max(0, static_cast<int>(iBlockSums.size()) - iBlockCount); i < static_cast<int>(iBlockSums.size()); i++)
+    sum += iBlockSums[i];
+
+  auto loudness = std::sqrt(sum / (iBlockSize * iBlockCount)) * LoudnessAccumulator::LOUDNESS_OFFSET;
+  return loudness < LoudnessAccumulator::ABSOLUTE_GATE ? 0 : loudness;
+}
+
+// LoudnessAccumulatorTest - Accumulate
+TEST(LoudnessAccumulatorTest, Accumulate)
+{
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(0, 1.0);
+  std::uniform_int_distribution<uint32> runSizeDistribution(1, 2000);
+
+  constexpr uint32 blockSize = 4410;
+
+  LoudnessAccumulator accumulator{blockSize};
+
+  ASSERT_EQ(0, accumulator.getMomentaryLoudness());
+  ASSERT_EQ(0, accumulator.getShortTermLoudness());
+
+  std::vector<TSample> blockSums{};
+  TSample blockSum = 0;
+
+  for(int i = 0; i < 20000; i++)
+  {
+    auto runSize = accumulator.getRemainingSamplesInBlock(runSizeDistribution(generator));
+
+    // some silent periods to check the gate
+    auto meanSquare = (i / 1000) % 3 == 0 ? 0 : distribution(generator) * distribution(generator);
+    auto sumOfSquares = meanSquare * runSize;
+    blockSum += sumOfSquares;
+
+    if(accumulator.accumulate(sumOfSquares, runSize))
+    {
+      blockSums.emplace_back(blockSum);
+      blockSum = 0;
+
+      ASSERT_NEAR(computeLoudness(blockSums, LoudnessAccumulator::MOMENTARY_BLOCK_COUNT, blockSize),
+                  accumulator.getMomentaryLoudness(), 1e-9);
+      ASSERT_NEAR(computeLoudness(blockSums, LoudnessAccumulator::SHORT_TERM_BLOCK_COUNT, blockSize),
+                  accumulator.getShortTermLoudness(), 1e-9);
+    }
+  }
+
+  ASSERT_GT(blockSums.size(), 100);
+
+  accumulator.reset();
+  ASSERT_EQ(0, accumulator.getMomentaryLoudness());
+  ASSERT_EQ(0, accumulator.getShortTermLoudness());
+}
+
+}
+}
+}
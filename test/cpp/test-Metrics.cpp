@@ -0,0 +1,133 @@
+#include <src/cpp/Metrics.h>
+#include <gtest/gtest.h>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::Common;
+
+// MetricsTest - RecordBlock (budget, load histogram, max)
+TEST(MetricsTest, RecordBlock)
+{
+  ProcessMetrics metrics{};
+  metrics.reset(100000); // 10us per sample => 1ms budget for 100 samples
+
+  metrics.recordBlock(100, 5000);    // 0.5%
+  metrics.recordBlock(100, 15000);   // 1.5%
+  metrics.recordBlock(100, 300000);  // 30%
+  metrics.recordBlock(100, 2000000); // 200% (overrun)
+  metrics.recordBlock(50, 500000);   // 100% (overrun: the budget is 500us)
+
+  MetricsSnapshot snapshot{};
+  metrics.snapshot(snapshot);
+
+  ASSERT_EQ(5, snapshot.fBlockCount);
+  ASSERT_EQ(450, snapshot.fSampleCount);
+  ASSERT_EQ(2820000, snapshot.fProcessTimeNs);
+  ASSERT_EQ(4500000, snapshot.fBudgetNs);
+  ASSERT_EQ(2000000, snapshot.fMaxProcessTimeNs);
+  ASSERT_EQ(2000, snapshot.fMaxLoadPermille);
+  ASSERT_NEAR(62.67, snapshot.getAverageLoad(), 0.01);
+
+  Steinberg::int64 expectedHistogram[MetricsSnapshot::NUM_LOAD_BUCKETS] = {1, 1, 0, 0, 0, 1, 0, 2};
+  for(int b = 0; b < MetricsSnapshot::NUM_LOAD_BUCKETS; b++)
+  {
+    ASSERT_EQ(expectedHistogram[b], snapshot.fLoadHistogram[b]) << b;
+  }
+  ASSERT_EQ(2, snapshot.getOverrunCount());
+}
+
+// MetricsTest - Counters (zoom, ui, memory)
+TEST(MetricsTest, Counters)
+{
+  ProcessMetrics metrics{};
+  metrics.reset(44100);
+
+  metrics.recordZoomCompute(1000);
+  metrics.recordZoomCompute(3000);
+  metrics.recordBroadcast();
+  metrics.recordBroadcastBytes(1500);
+  metrics.recordBroadcast();
+  metrics.recordBroadcastBytes(500);
+  metrics.recordSharedPublish();
+  metrics.setSuppressedBroadcastCount(7);
+  metrics.setMemory(1 << 20, 4096);
+
+  MetricsSnapshot snapshot{};
+  metrics.snapshot(snapshot);
+
+  ASSERT_EQ(2, snapshot.fZoomComputeCount);
+  ASSERT_EQ(4000, snapshot.fZoomComputeTimeNs);
+  ASSERT_EQ(3000, snapshot.fMaxZoomComputeTimeNs);
+  ASSERT_EQ(2, snapshot.fBroadcastCount);
+  ASSERT_EQ(2000, snapshot.fBroadcastBytes);
+  ASSERT_EQ(1, snapshot.fSharedPublishCount);
+  ASSERT_EQ(7, snapshot.fSuppressedBroadcastCount);
+  ASSERT_EQ(1 << 20, snapshot.fHistoryBytes);
+  ASSERT_EQ(4096, snapshot.fSnapshotBytes);
+  ASSERT_EQ(0, snapshot.fBlockCount);
+  ASSERT_EQ(0, snapshot.getAverageLoad());
+}
+
+// MetricsTest - Reset (the memory and the dump count are kept)
+TEST(MetricsTest, Reset)
+{
+  ProcessMetrics metrics{};
+  metrics.reset(44100);
+
+  metrics.recordBlock(64, 1000);
+  metrics.recordZoomCompute(1000);
+  metrics.recordBroadcast();
+  metrics.setSuppressedBroadcastCount(3);
+  metrics.setMemory(100, 10);
+  metrics.recordDump();
+  metrics.recordDump();
+
+  metrics.reset(48000);
+
+  MetricsSnapshot snapshot{};
+  metrics.snapshot(snapshot);
+
+  ASSERT_EQ(0, snapshot.fBlockCount);
+  ASSERT_EQ(0, snapshot.fMaxProcessTimeNs);
+  ASSERT_EQ(0, snapshot.fLoadHistogram[0]);
+  ASSERT_EQ(0, snapshot.fZoomComputeCount);
+  ASSERT_EQ(0, snapshot.fBroadcastCount);
+  ASSERT_EQ(0, snapshot.fSuppressedBroadcastCount);
+  ASSERT_EQ(100, snapshot.fHistoryBytes);
+  ASSERT_EQ(10, snapshot.fSnapshotBytes);
+  ASSERT_EQ(2, snapshot.fDumpCount);
+
+  // the budget uses the new sample rate
+  metrics.recordBlock(48, 1000000);
+  metrics.snapshot(snapshot);
+  ASSERT_EQ(1000000, snapshot.fBudgetNs);
+  ASSERT_EQ(1000, snapshot.fMaxLoadPermille);
+}
+
+// MetricsTest - ToString
+TEST(MetricsTest, ToString)
+{
+  ProcessMetrics metrics{};
+  metrics.reset(100000);
+  metrics.recordBlock(100, 250000);
+  metrics.recordZoomCompute(1500);
+  metrics.recordBroadcast();
+  metrics.recordBroadcastBytes(2048);
+  metrics.setMemory(3 * 1024 * 1024, 512);
+
+  MetricsSnapshot snapshot{};
+  metrics.snapshot(snapshot);
+
+  ASSERT_EQ("process: 1 blocks, load avg 25.0% max 25.0% (250.0us), 0 overruns\n"
+            "load: <1% 0.0% <2% 0.0% <5% 0.0% <10% 0.0% <25% 0.0% <50% 100.0% <100% 0.0% >=100% 0.0%\n"
+            "zoom: 1 computes, avg 1.5us max 1.5us\n"
+            "ui: 1 messages (2.0KB), 0 shared updates, 0 suppressed\n"
+            "memory: history 3.0MB, snapshot 512B",
+            snapshot.toString());
+}
+
+}
+}
+}
@@ -0,0 +1,133 @@
+#include <src/cpp/offline/OfflineAnalyzer.h>
+#include <src/cpp/MemoryMappedFile.h>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::VAC6;
+using namespace pongasoft::VST::Common;
+
+namespace {
+
+constexpr int SAMPLE_RATE = 48000;
+constexpr int BATCH_SIZE = SAMPLE_RATE * ACCUMULATOR_BATCH_SIZE_IN_MS / 1000; // 240 frames
+
+// a WAV file (float 32 bits) of the frames (interleaved) deleted at the end of the test
+class WavFixture
+{
+public:
+  WavFixture(int iNumChannels, std::vector<float> const &iFrames) :
+    fPath{MemoryMappedFile::createTemporaryPath("test-OfflineAnalyzer", ".wav")}
+  {
+    auto dataSize = static_cast<uint32_t>(iFrames.size() * sizeof(float));
+    auto numChannels = static_cast<uint16_t>(iNumChannels);
+
+    std::ofstream out{fPath, std::ios::binary};
+    out.write("RIFF", 4);
+    write32(out, 36 + dataSize);
+    out.write("WAVEfmt ", 8);
+    write32(out, 16);
+    write16(out, 3); // WAVE_FORMAT_IEEE_FLOAT
+    write16(out, numChannels);
+    write32(out, SAMPLE_RATE);
+    write32(out, SAMPLE_RATE * numChannels * 4);
+    write16(out, static_cast<uint16_t>(numChannels * 4));
+    write16(out, 32);
+    out.write("data", 4);
+    write32(out, dataSize);
+    out.write(reinterpret_cast<char const *>(iFrames.data()), dataSize);
+  }
+
+  ~WavFixture() { std::remove(fPath.c_str()); }
+
+  std::string const &getPath() const { return fPath; }
+
+private:
+  static void write16(std::ofstream &oOut, uint16_t iValue)
+  {
+    char bytes[] = {static_cast<char>(iValue & 0xFF), static_cast<char>(iValue >> 8)};
+    oOut.write(bytes, 2);
+  }
+
+  static void write32(std::ofstream &oOut, uint32_t iValue)
+  {
+    write16(oOut, static_cast<uint16_t>(iValue & 0xFFFF));
+    write16(oOut, static_cast<uint16_t>(iValue >> 16));
+  }
+
+  std::string fPath;
+};
+
+// the level as stored in the history
+inline TSample stored(TSample iLevel) { return fromHistorySample(toHistorySample(iLevel)); }
+
+}
+
+// OfflineAnalyzerTest - MaxLevel (level and position of the peak of each channel, including in the last, incomplete,
+// point of the zoomed history)
+TEST(OfflineAnalyzerTest, MaxLevel)
+{
+  // 1s + 100 frames (the last batch is incomplete and so is the last point of the zoomed history)
+  constexpr int NUM_FRAMES = SAMPLE_RATE + 100;
+  constexpr int LEFT_PEAK_FRAME = 10000; // batch 41
+  constexpr int RIGHT_PEAK_FRAME = SAMPLE_RATE + 50; // last batch (200)
+
+  std::vector<float> frames(2 * NUM_FRAMES, 0.0f);
+  for(int i = 0; i < NUM_FRAMES; i++)
+  {
+    frames[2 * i] = 0.125f;
+    frames[2 * i + 1] = -0.25f;
+  }
+  frames[2 * LEFT_PEAK_FRAME] = -0.5f;
+  frames[2 * RIGHT_PEAK_FRAME + 1] = 0.75f;
+
+  WavFixture file{2, frames};
+
+  OfflineAnalyzer analyzer{OfflineAnalyzer::Options{}};
+  auto analysis = analyzer.analyze(file.getPath());
+  ASSERT_EQ("", analysis.fError);
+  ASSERT_EQ(NUM_FRAMES, analysis.fNumFrames);
+  ASSERT_EQ(2, analysis.fChannels.size());
+
+  auto const &left = analysis.fChannels[0];
+  ASSERT_EQ(stored(0.5), left.fMaxLevel);
+  ASSERT_DOUBLE_EQ((LEFT_PEAK_FRAME / BATCH_SIZE) * BATCH_SIZE / static_cast<double>(SAMPLE_RATE),
+                   left.fMaxLevelPosition);
+
+  auto const &right = analysis.fChannels[1];
+  ASSERT_EQ(stored(0.75), right.fMaxLevel);
+  ASSERT_DOUBLE_EQ((RIGHT_PEAK_FRAME / BATCH_SIZE) * BATCH_SIZE / static_cast<double>(SAMPLE_RATE),
+                   right.fMaxLevelPosition);
+  ASSERT_DOUBLE_EQ(1.0, right.fMaxLevelPosition);
+
+  ASSERT_EQ(right.fMaxLevel, analysis.fMax.fMaxLevel);
+  ASSERT_EQ(right.fMaxLevelPosition, analysis.fMax.fMaxLevelPosition);
+}
+
+// OfflineAnalyzerTest - FirstMax (the position is the one of the first batch reaching the max)
+TEST(OfflineAnalyzerTest, FirstMax)
+{
+  constexpr int NUM_FRAMES = 20 * BATCH_SIZE;
+
+  std::vector<float> frames(NUM_FRAMES, 0.0f);
+  frames[3 * BATCH_SIZE + 7] = 0.5f;
+  frames[5 * BATCH_SIZE] = -0.5f;
+  frames[15 * BATCH_SIZE] = 0.25f;
+
+  WavFixture file{1, frames};
+
+  auto analysis = OfflineAnalyzer{OfflineAnalyzer::Options{}}.analyze(file.getPath());
+  ASSERT_EQ("", analysis.fError);
+  ASSERT_EQ(1, analysis.fChannels.size());
+  ASSERT_EQ(stored(0.5), analysis.fMax.fMaxLevel);
+  ASSERT_DOUBLE_EQ(3 * BATCH_SIZE / static_cast<double>(SAMPLE_RATE), analysis.fMax.fMaxLevelPosition);
+}
+
+}
+}
+}
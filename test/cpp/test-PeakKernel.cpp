@@ -0,0 +1,269 @@
+#include <src/cpp/PeakKernel.h>
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::VAC6;
+
+/**
+ * Compares the (vectorized) kernel with the reference implementation for every size in [0, iMaxNumSamples]
+ */
+template<typename SampleType>
+void testCopyAndComputeMax(double iGain, int iMaxNumSamples)
+{
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+  for(int numSamples = 0; numSamples <= iMaxNumSamples; numSamples++)
+  {
+    std::vector<SampleType> in(static_cast<size_t>(numSamples));
+    for(auto &s: in)
+      s = static_cast<SampleType>(distribution(generator));
+
+    std::vector<SampleType> expectedOut(in.size(), -2);
+    std::vector<SampleType> out(in.size(), -2);
+
+    auto expectedMax = PeakKernel::scalarCopyAndComputeMax<SampleType>(in.data(), expectedOut.data(), numSamples, iGain);
+
+    // regular
+    ASSERT_EQ(expectedMax, PeakKernel::copyAndComputeMax(in.data(), out.data(), numSamples, iGain));
+    ASSERT_EQ(expectedOut, out);
+
+    // no output
+    ASSERT_EQ(expectedMax, PeakKernel::copyAndComputeMax(in.data(), static_cast<SampleType *>(nullptr), numSamples, iGain));
+
+    // in place
+    auto inPlace = in;
+    ASSERT_EQ(expectedMax, PeakKernel::copyAndComputeMax(inPlace.data(), inPlace.data(), numSamples, iGain));
+    ASSERT_EQ(expectedOut, inPlace);
+
+    // no input => silence
+    ASSERT_EQ(0, PeakKernel::copyAndComputeMax(static_cast<SampleType const *>(nullptr), out.data(), numSamples, iGain));
+    for(auto s: out)
+      ASSERT_EQ(0, s);
+  }
+}
+
+// PeakKernelTest - CopyAndComputeMax64
+TEST(PeakKernelTest, CopyAndComputeMax64)
+{
+  testCopyAndComputeMax<Sample64>(1.0, 67);
+  testCopyAndComputeMax<Sample64>(0.3, 67);
+  testCopyAndComputeMax<Sample64>(2.7, 67);
+}
+
+// PeakKernelTest - CopyAndComputeMax32
+TEST(PeakKernelTest, CopyAndComputeMax32)
+{
+  testCopyAndComputeMax<Sample32>(1.0, 67);
+  testCopyAndComputeMax<Sample32>(0.3, 67);
+  testCopyAndComputeMax<Sample32>(2.7, 67);
+}
+
+/**
+ * Same as testCopyAndComputeMax with a per sample gain (which also outputs the gain adjusted samples)
+ */
+template<typename SampleType>
+void testCopyAndComputeMaxWithGains(int iMaxNumSamples)
+{
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+  for(int numSamples = 0; numSamples <= iMaxNumSamples; numSamples++)
+  {
+    std::vector<SampleType> in(static_cast<size_t>(numSamples));
+    for(auto &s: in)
+      s = static_cast<SampleType>(distribution(generator));
+
+    std::vector<TSample> gains(in.size());
+    for(auto &g: gains)
+      g = 1.5 + distribution(generator);
+
+    std::vector<SampleType> expectedOut(in.size(), -2);
+    std::vector<SampleType> out(in.size(), -2);
+    std::vector<TSample> expectedGained(in.size(), -2);
+    std::vector<TSample> gained(in.size(), -2);
+
+    auto expectedMax = PeakKernel::scalarCopyAndComputeMax<SampleType>(in.data(),
+                                                                       expectedOut.data(),
+                                                                       numSamples,
+                                                                       gains.data(),
+                                                                       expectedGained.data());
+
+    // regular
+    ASSERT_EQ(expectedMax, PeakKernel::copyAndComputeMax(in.data(), out.data(), numSamples, gains.data(), gained.data()));
+    ASSERT_EQ(expectedOut, out);
+    ASSERT_EQ(expectedGained, gained);
+
+    // no output
+    ASSERT_EQ(expectedMax, PeakKernel::copyAndComputeMax(in.data(),
+                                                         static_cast<SampleType *>(nullptr),
+                                                         numSamples,
+                                                         gains.data(),
+                                                         nullptr));
+
+    // in place
+    auto inPlace = in;
+    ASSERT_EQ(expectedMax, PeakKernel::copyAndComputeMax(inPlace.data(), inPlace.data(), numSamples, gains.data(), nullptr));
+    ASSERT_EQ(expectedOut, inPlace);
+
+    // no input => silence
+    ASSERT_EQ(0, PeakKernel::copyAndComputeMax(static_cast<SampleType const *>(nullptr),
+                                               out.data(),
+                                               numSamples,
+                                               gains.data(),
+                                               gained.data()));
+    for(auto s: out)
+      ASSERT_EQ(0, s);
+    for(auto s: gained)
+      ASSERT_EQ(0, s);
+  }
+}
+
+// PeakKernelTest - CopyAndComputeMaxWithGains64
+TEST(PeakKernelTest, CopyAndComputeMaxWithGains64)
+{
+  testCopyAndComputeMaxWithGains<Sample64>(67);
+}
+
+// PeakKernelTest - CopyAndComputeMaxWithGains32
+TEST(PeakKernelTest, CopyAndComputeMaxWithGains32)
+{
+  testCopyAndComputeMaxWithGains<Sample32>(67);
+}
+
+/**
+ * Compares the (vectorized) read only pass with copyAndComputeMax at unity gain
+ */
+template<typename SampleType>
+void testComputeMax(int iMaxNumSamples)
+{
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+  for(int numSamples = 0; numSamples <= iMaxNumSamples; numSamples++)
+  {
+    std::vector<SampleType> in(static_cast<size_t>(numSamples));
+    for(auto &s: in)
+      s = static_cast<SampleType>(distribution(generator));
+
+    // NaN is ignored
+    if(numSamples > 5)
+      in[5] = std::numeric_limits<SampleType>::quiet_NaN();
+
+    auto expectedMax = PeakKernel::scalarCopyAndComputeMax<SampleType>(in.data(), nullptr, numSamples, 1.0);
+
+    ASSERT_EQ(expectedMax, PeakKernel::scalarComputeMax(in.data(), numSamples));
+    ASSERT_EQ(expectedMax, PeakKernel::computeMax(in.data(), numSamples));
+
+    // no input => silence
+    ASSERT_EQ(0, PeakKernel::computeMax(static_cast<SampleType const *>(nullptr), numSamples));
+  }
+}
+
+// PeakKernelTest - ComputeMax64
+TEST(PeakKernelTest, ComputeMax64)
+{
+  testComputeMax<Sample64>(67);
+}
+
+// PeakKernelTest - ComputeMax32
+TEST(PeakKernelTest, ComputeMax32)
+{
+  testComputeMax<Sample32>(67);
+}
+
+// PeakKernelTest - MaxIsOrderIndependent (the max of a batch does not depend on how it is split in runs)
+TEST(PeakKernelTest, MaxIsOrderIndependent)
+{
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+  std::vector<Sample32> in(221);
+  for(auto &s: in)
+    s = static_cast<Sample32>(distribution(generator));
+
+  auto expectedMax = PeakKernel::copyAndComputeMax(in.data(), static_cast<Sample32 *>(nullptr), 221, 0.8);
+
+  for(int split = 0; split <= 221; split++)
+  {
+    auto max1 = PeakKernel::copyAndComputeMax(in.data(), static_cast<Sample32 *>(nullptr), split, 0.8);
+    auto max2 = PeakKernel::copyAndComputeMax(in.data() + split, static_cast<Sample32 *>(nullptr), 221 - split, 0.8);
+    ASSERT_EQ(expectedMax, std::max(max1, max2));
+  }
+}
+
+/**
+ * Compares the (vectorized) sum of squares with the reference implementation for every size in [0, iMaxNumSamples].
+ * The vectorized version keeps several partial sums so the result is only equal within a (relative) tolerance.
+ */
+template<typename SampleType>
+void testComputeSumOfSquares(int iMaxNumSamples)
+{
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  std::uniform_real_distribution<double> gainDistribution(0, 2.0);
+
+  for(int numSamples = 0; numSamples <= iMaxNumSamples; numSamples++)
+  {
+    std::vector<SampleType> in(static_cast<size_t>(numSamples));
+    for(auto &s: in)
+      s = static_cast<SampleType>(distribution(generator));
+
+    std::vector<TSample> gains(in.size());
+    for(auto &g: gains)
+      g = gainDistribution(generator);
+
+    // constant gain
+    for(auto gain: {1.0, 0.3, 2.7})
+    {
+      auto expectedSum = PeakKernel::scalarComputeSumOfSquares<SampleType>(in.data(), numSamples, gain);
+      ASSERT_NEAR(expectedSum, PeakKernel::computeSumOfSquares(in.data(), numSamples, gain), expectedSum * 1e-12);
+    }
+
+    // per sample gain
+    auto expectedSum = PeakKernel::scalarComputeSumOfSquares<SampleType>(in.data(), numSamples, gains.data());
+    ASSERT_NEAR(expectedSum, PeakKernel::computeSumOfSquares(in.data(), numSamples, gains.data()), expectedSum * 1e-12);
+  }
+}
+
+// PeakKernelTest - ComputeSumOfSquares64
+TEST(PeakKernelTest, ComputeSumOfSquares64)
+{
+  testComputeSumOfSquares<Sample64>(67);
+}
+
+// PeakKernelTest - ComputeSumOfSquares32
+TEST(PeakKernelTest, ComputeSumOfSquares32)
+{
+  testComputeSumOfSquares<Sample32>(67);
+}
+
+// PeakKernelTest - ComputeSumOfSquares (constant and per sample gain)
+TEST(PeakKernelTest, ComputeSumOfSquares)
+{
+  // the values are multiples of 1/4 so that the sums are exact
+  Sample32 in32[] = {0.5f, -0.25f, 1.0f, -0.75f};
+  Sample64 in64[] = {0.5, -0.25, 1.0, -0.75};
+  TSample gains[] = {1.0, 2.0, 0.5, 0};
+
+  ASSERT_EQ(1.875, PeakKernel::computeSumOfSquares(in32, 4, 1.0));
+  ASSERT_EQ(1.875, PeakKernel::computeSumOfSquares(in64, 4, 1.0));
+  ASSERT_EQ(7.5, PeakKernel::computeSumOfSquares(in32, 4, 2.0));
+  ASSERT_EQ(0.3125, PeakKernel::computeSumOfSquares(in64, 2, 1.0));
+  ASSERT_EQ(0.75, PeakKernel::computeSumOfSquares(in32, 4, gains));
+  ASSERT_EQ(0.75, PeakKernel::computeSumOfSquares(in64, 4, gains));
+
+  // no input => silence
+  ASSERT_EQ(0, PeakKernel::computeSumOfSquares(static_cast<Sample32 const *>(nullptr), 4, 2.0));
+  ASSERT_EQ(0, PeakKernel::computeSumOfSquares(static_cast<Sample64 const *>(nullptr), 4, gains));
+}
+
+}
+}
+}
@@ -0,0 +1,167 @@
+#include <src/cpp/RangeStatsIndex.h>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::Common;
+
+using TSample = Steinberg::Vst::Sample64;
+
+/**
+ * Compares the index with brute force for all ranges
+ */
+void checkAllRanges(CircularBuffer<TSample> const &iBuffer,
+                    CircularBuffer<TSample> const &iMeanSquares,
+                    RangeStatsIndex<TSample> const &iIndex,
+                    int iIteration)
+{
+  int bufferSize = iBuffer.getSize();
+
+  for(int from = -bufferSize; from <= 0; from++)
+  {
+    RangeStats<TSample> expected{};
+    for(int to = from; to <= 0; to++)
+    {
+      auto stats = iIndex.getStats(iBuffer, iMeanSquares, from, to);
+
+      // the values are multiples of 1/16 (1/4096 for the mean squares) so that the sums are exact no matter the order
+      ASSERT_EQ(expected.fSum, stats.fSum) << "[" << from << "," << to << "[ after " << iIteration;
+      ASSERT_EQ(expected.fSumOfMeanSquares, stats.fSumOfMeanSquares) << "[" << from << "," << to << "[ after " << iIteration;
+      ASSERT_EQ(expected.fCountAboveThreshold, stats.fCountAboveThreshold) << "[" << from << "," << to << "[ after " << iIteration;
+
+      if(to < 0)
+      {
+        auto entry = iBuffer.getAt(to);
+        expected.fSum += entry;
+        expected.fSumOfMeanSquares += iMeanSquares.getAt(to);
+        if(entry > iIndex.getThreshold())
+          expected.fCountAboveThreshold++;
+      }
+    }
+  }
+}
+
+// RangeStatsIndexTest - GetStats (while the buffer keeps wrapping around and the threshold changes)
+TEST(RangeStatsIndexTest, GetStats)
+{
+  constexpr int BUFFER_SIZE = 37;
+
+  std::default_random_engine generator;
+  std::uniform_int_distribution<int> distribution(0, 16);
+
+  CircularBuffer<TSample> buffer{BUFFER_SIZE};
+  buffer.init(0);
+  CircularBuffer<TSample> meanSquares{BUFFER_SIZE};
+  meanSquares.init(0);
+  RangeStatsIndex<TSample> index{BUFFER_SIZE, 0.5};
+  index.init(0, 0);
+
+  // the mean square of an entry is at most its square
+  auto push = [&] {
+    auto entry = distribution(generator) / 16.0;
+    buffer.push(entry);
+    meanSquares.push(entry * entry * distribution(generator) / 16.0);
+    index.onPush(buffer, meanSquares);
+  };
+
+  for(int k = 0; k < 5 * BUFFER_SIZE; k++)
+  {
+    checkAllRanges(buffer, meanSquares, index, k);
+
+    if(k % 7 == 0)
+    {
+      index.setThreshold(buffer, distribution(generator) / 16.0);
+      checkAllRanges(buffer, meanSquares, index, k);
+    }
+
+    push();
+  }
+}
+
+// RangeStatsIndexTest - SetThresholdIncrementally (a few blocks at a time while entries are pushed)
+TEST(RangeStatsIndexTest, SetThresholdIncrementally)
+{
+  constexpr int BUFFER_SIZE = 37;
+
+  std::default_random_engine generator;
+  std::uniform_int_distribution<int> distribution(0, 16);
+
+  CircularBuffer<TSample> buffer{BUFFER_SIZE};
+  buffer.init(0);
+  CircularBuffer<TSample> meanSquares{BUFFER_SIZE};
+  meanSquares.init(0);
+  RangeStatsIndex<TSample> index{BUFFER_SIZE, 0.5};
+  index.init(0, 0);
+
+  // the mean square of an entry is at most its square
+  auto push = [&] {
+    auto entry = distribution(generator) / 16.0;
+    buffer.push(entry);
+    meanSquares.push(entry * entry * distribution(generator) / 16.0);
+    index.onPush(buffer, meanSquares);
+  };
+
+  for(int k = 0; k < 2 * BUFFER_SIZE; k++)
+    push();
+
+  // the threshold changes every 20 iterations (and is set back to the current one once before the change is complete
+  // which suspends the change)
+  TSample thresholds[] = {0.25, 0.75, 0.25, 0.125, 0.5};
+  int changeCount = 0;
+  for(int k = 0; k < 100; k++)
+  {
+    auto threshold = thresholds[k / 20];
+    if(k == 30)
+      threshold = index.getThreshold(); // 0.25 (the change to 0.75 is not complete)
+
+    auto previousThreshold = index.getThreshold();
+    if(index.setThreshold(buffer, threshold, 3))
+    {
+      ASSERT_EQ(threshold, index.getThreshold()) << k;
+      if(previousThreshold != threshold)
+        changeCount++;
+    }
+    else
+    {
+      // the previous threshold is used until the change is complete
+      ASSERT_EQ(previousThreshold, index.getThreshold()) << k;
+    }
+
+    checkAllRanges(buffer, meanSquares, index, k);
+
+    if(k % 3 == 0)
+    {
+      push();
+    }
+  }
+
+  ASSERT_EQ(0.5, index.getThreshold());
+  ASSERT_EQ(5, changeCount);
+}
+
+// RangeStatsIndexTest - Init (the index must be consistent with a buffer initialized with a non 0 value)
+TEST(RangeStatsIndexTest, Init)
+{
+  constexpr int BUFFER_SIZE = 20;
+
+  CircularBuffer<TSample> buffer{BUFFER_SIZE};
+  buffer.init(0.25);
+  CircularBuffer<TSample> meanSquares{BUFFER_SIZE};
+  meanSquares.init(0.0625);
+  RangeStatsIndex<TSample> index{BUFFER_SIZE, 0.125};
+  index.init(0.25, 0.0625);
+
+  checkAllRanges(buffer, meanSquares, index, 0);
+
+  auto stats = index.getStats(buffer, meanSquares, -BUFFER_SIZE, 0);
+  ASSERT_EQ(5.0, stats.fSum);
+  ASSERT_EQ(1.25, stats.fSumOfMeanSquares);
+  ASSERT_EQ(BUFFER_SIZE, stats.fCountAboveThreshold);
+}
+
+}
+}
+}
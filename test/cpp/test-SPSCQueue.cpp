@@ -0,0 +1,75 @@
+#include <src/cpp/SPSCQueue.h>
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::Common;
+
+// SPSCQueueTest - PushPop
+TEST(SPSCQueueTest, PushPop)
+{
+  SPSCQueue<int> queue(3);
+  ASSERT_EQ(3, queue.getCapacity());
+
+  int element = -1;
+  ASSERT_FALSE(queue.pop(element));
+  ASSERT_EQ(-1, element);
+
+  // wraps around several times
+  for(int i = 0; i < 10; i++)
+  {
+    ASSERT_TRUE(queue.push(i));
+    ASSERT_TRUE(queue.push(i + 100));
+    ASSERT_TRUE(queue.push(i + 200));
+    ASSERT_FALSE(queue.push(i + 300)); // full
+
+    ASSERT_TRUE(queue.pop(element));
+    ASSERT_EQ(i, element);
+    ASSERT_TRUE(queue.pop(element));
+    ASSERT_EQ(i + 100, element);
+    ASSERT_TRUE(queue.pop(element));
+    ASSERT_EQ(i + 200, element);
+    ASSERT_FALSE(queue.pop(element));
+  }
+}
+
+// SPSCQueueTest - Threads (every element pushed by the producer is popped in order by the consumer)
+TEST(SPSCQueueTest, Threads)
+{
+  constexpr int NUM_ELEMENTS = 100000;
+
+  SPSCQueue<int> queue(16);
+
+  std::thread producer([&queue] {
+    for(int i = 0; i < NUM_ELEMENTS; i++)
+    {
+      while(!queue.push(i))
+        std::this_thread::yield();
+    }
+  });
+
+  int expected = 0;
+  while(expected < NUM_ELEMENTS)
+  {
+    int element;
+    if(queue.pop(element))
+    {
+      ASSERT_EQ(expected, element);
+      expected++;
+    }
+    else
+      std::this_thread::yield();
+  }
+
+  producer.join();
+
+  int element;
+  ASSERT_FALSE(queue.pop(element));
+}
+
+}
+}
+}
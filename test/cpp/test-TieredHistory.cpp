@@ -0,0 +1,220 @@
+#include <src/cpp/TieredHistory.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::Common;
+
+using TSample = Steinberg::Vst::Sample64;
+
+constexpr int FULL_RESOLUTION_SIZE = 20;
+constexpr int HISTORY_SIZE = 1000;
+constexpr int TIER_FACTOR = 4;
+
+// brute force max of [iFromOffset, iToOffset[ (entries never pushed are 0)
+static TSample bruteForceMax(std::vector<TSample> const &iEntries, int iFromOffset, int iToOffset)
+{
+  TSample max = 0;
+  for(int i = iFromOffset; i < iToOffset; i++)
+  {
+    int idx = static_cast<int>(iEntries.size()) + i;
+    if(idx >= 0)
+      max = std::max(max, iEntries[idx]);
+  }
+  return max;
+}
+
+// TieredHistoryTest - Tiers
+TEST(TieredHistoryTest, Tiers)
+{
+  TieredHistory<TSample> history(FULL_RESOLUTION_SIZE, HISTORY_SIZE, TIER_FACTOR);
+
+  // 1 (20 entries), 4 (20 entries), 16 (20 entries) and 64 (16 entries) => 1024 >= 1000
+  ASSERT_EQ(4, history.getTierCount());
+  ASSERT_EQ(1, history.getTierResolution(0));
+  ASSERT_EQ(64, history.getTierResolution(3));
+  ASSERT_EQ(FULL_RESOLUTION_SIZE, history.getTierSize(2));
+  ASSERT_EQ(16, history.getTierSize(3));
+
+  ASSERT_EQ(0, history.findTier(1));
+  ASSERT_EQ(0, history.findTier(3));
+  ASSERT_EQ(1, history.findTier(4));
+  ASSERT_EQ(2, history.findTier(63));
+  ASSERT_EQ(3, history.findTier(1000));
+
+  // bounded by the number of tiers (and not by the length of the history)
+  ASSERT_LT(history.getMemorySize(), HISTORY_SIZE * sizeof(TSample));
+}
+
+// TieredHistoryTest - TierEntries (max/min/average of each group)
+TEST(TieredHistoryTest, TierEntries)
+{
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+  TieredHistory<TSample> history(FULL_RESOLUTION_SIZE, HISTORY_SIZE, TIER_FACTOR);
+  std::vector<TSample> entries{};
+
+  for(int n = 0; n < 2000; n++)
+  {
+    auto entry = distribution(generator);
+    history.push(entry);
+    entries.emplace_back(entry);
+
+    for(int tier = 1; tier < history.getTierCount(); tier++)
+    {
+      int resolution = history.getTierResolution(tier);
+      int completeEntries = static_cast<int>(entries.size()) / resolution;
+      int end = completeEntries * resolution;
+
+      for(int i = 1; i <= std::min(completeEntries, history.getTierSize(tier)); i++)
+      {
+        TSample max = 0, min = 1.0, sum = 0;
+        for(int j = end - i * resolution; j < end - (i - 1) * resolution; j++)
+        {
+          max = std::max(max, entries[j]);
+          min = std::min(min, entries[j]);
+          sum += entries[j];
+        }
+
+        auto tierEntry = history.getTierEntry(tier, -i);
+        ASSERT_EQ(max, tierEntry.fMax);
+        ASSERT_EQ(min, tierEntry.fMin);
+        ASSERT_NEAR(sum / resolution, tierEntry.fAverage, 1e-12);
+      }
+    }
+  }
+}
+
+// TieredHistoryTest - GetMax (compares with brute force while the tiers keep wrapping around)
+TEST(TieredHistoryTest, GetMax)
+{
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  std::uniform_int_distribution<int> offsetDistribution(-HISTORY_SIZE, 0);
+
+  TieredHistory<TSample> history(FULL_RESOLUTION_SIZE, HISTORY_SIZE, TIER_FACTOR);
+  std::vector<TSample> entries{};
+
+  int coarsestResolution = history.getTierResolution(history.getTierCount() - 1);
+
+  for(int n = 0; n < 3000; n++)
+  {
+    auto entry = distribution(generator);
+    history.push(entry);
+    entries.emplace_back(entry);
+
+    // full resolution => exact
+    for(int from = -FULL_RESOLUTION_SIZE; from <= 0; from++)
+    {
+      for(int to = from; to <= 0; to++)
+      {
+        ASSERT_EQ(bruteForceMax(entries, from, to), history.getMax(from, to)) << "[" << from << "," << to << "[";
+      }
+    }
+
+    for(int tier = 0; tier < history.getTierCount(); tier++)
+    {
+      // aligned on the entries of the tier (and inside the tier) => exact
+      int resolution = history.getTierResolution(tier);
+      int newestOffset = -(static_cast<int>(entries.size()) % resolution);
+      for(int i = 0; i < history.getTierSize(tier); i++)
+      {
+        int from = newestOffset - (i + 1) * resolution;
+        int to = newestOffset - i * resolution;
+        if(from < -HISTORY_SIZE)
+          break;
+        ASSERT_EQ(bruteForceMax(entries, from, to), history.getMax(from, to, tier));
+      }
+
+      // any range => never less than the actual max and never more than the max of the overlapping entries
+      for(int i = 0; i < 10; i++)
+      {
+        int from = offsetDistribution(generator);
+        int to = offsetDistribution(generator);
+        if(from > to)
+          std::swap(from, to);
+
+        auto max = history.getMax(from, to, tier);
+        ASSERT_LE(bruteForceMax(entries, from, to), max);
+        if(from < to)
+        {
+          ASSERT_GE(bruteForceMax(entries, from - coarsestResolution, std::min(to + coarsestResolution, 0)), max);
+        }
+        else
+        {
+          ASSERT_EQ(0, max);
+        }
+
+        // findMax returns the same max and an offset in the range (except when the max is 0)
+        int maxOffset = 1;
+        ASSERT_EQ(max, history.findMax(from, to, tier, maxOffset));
+        if(max > 0)
+        {
+          ASSERT_TRUE(maxOffset >= from && maxOffset < to);
+          if(tier == 0 && from >= -FULL_RESOLUTION_SIZE)
+          {
+            ASSERT_EQ(max, bruteForceMax(entries, maxOffset, maxOffset + 1));
+            ASSERT_GT(max, bruteForceMax(entries, from, maxOffset));
+          }
+        }
+        else
+        {
+          ASSERT_EQ(1, maxOffset);
+        }
+      }
+    }
+  }
+}
+
+// TieredHistoryTest - MaxSnapshot (a history restored from a max snapshot gives the same max as the original)
+TEST(TieredHistoryTest, MaxSnapshot)
+{
+  TieredHistory<TSample> history(FULL_RESOLUTION_SIZE, HISTORY_SIZE, TIER_FACTOR);
+
+  std::default_random_engine generator;
+  std::uniform_real_distribution<TSample> distribution(0.0, 1.0);
+
+  // not a multiple of any tier resolution (the tiers are not aligned)
+  for(int i = 0; i < 1234; i++)
+    history.push(distribution(generator));
+
+  // 20 + 20 + 20 + 16
+  ASSERT_EQ(76, history.getMaxSnapshotSize());
+
+  // copied in several steps
+  std::vector<TSample> snapshot(history.getMaxSnapshotSize());
+  for(int from = 0; from < history.getMaxSnapshotSize(); from += 7)
+  {
+    history.copyMaxSnapshot(from, std::min(7, history.getMaxSnapshotSize() - from), snapshot.data() + from);
+  }
+
+  TieredHistory<TSample> restored(FULL_RESOLUTION_SIZE, HISTORY_SIZE, TIER_FACTOR);
+  restored.push(0.5);
+  restored.restoreMaxSnapshot(history.getPushCount(), snapshot.data());
+  ASSERT_EQ(history.getPushCount(), restored.getPushCount());
+
+  for(int tier = 0; tier < history.getTierCount(); tier++)
+  {
+    for(int from = -HISTORY_SIZE; from < 0; from += 13)
+    {
+      for(int to = from; to <= 0; to += 17)
+      {
+        ASSERT_EQ(history.getMax(from, to, tier), restored.getMax(from, to, tier)) << tier << " " << from << " " << to;
+
+        int maxOffset = 1;
+        int restoredMaxOffset = 1;
+        ASSERT_EQ(history.findMax(from, to, tier, maxOffset), restored.findMax(from, to, tier, restoredMaxOffset));
+        ASSERT_EQ(maxOffset, restoredMaxOffset);
+      }
+    }
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,92 @@
+#include <src/cpp/TripleBuffer.h>
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::Common;
+
+// TripleBufferTest - Latest
+TEST(TripleBufferTest, Latest)
+{
+  TripleBuffer<int> buffer;
+
+  // nothing published yet
+  ASSERT_FALSE(buffer.update());
+  ASSERT_EQ(0, buffer.getReadBuffer());
+
+  buffer.getWriteBuffer() = 1;
+  buffer.publish();
+  ASSERT_TRUE(buffer.update());
+  ASSERT_EQ(1, buffer.getReadBuffer());
+  ASSERT_FALSE(buffer.update());
+  ASSERT_EQ(1, buffer.getReadBuffer());
+
+  // only the latest value is read
+  for(int i = 2; i < 10; i++)
+  {
+    buffer.getWriteBuffer() = i;
+    buffer.publish();
+  }
+  ASSERT_TRUE(buffer.update());
+  ASSERT_EQ(9, buffer.getReadBuffer());
+  ASSERT_FALSE(buffer.update());
+
+  // the write buffer is never the read buffer
+  for(int i = 10; i < 20; i++)
+  {
+    buffer.getWriteBuffer() = i;
+    ASSERT_EQ(i - 1, buffer.getReadBuffer());
+    buffer.publish();
+    ASSERT_TRUE(buffer.update());
+    ASSERT_EQ(i, buffer.getReadBuffer());
+  }
+}
+
+// TripleBufferTest - Threads (the reader always gets a complete value, never older than the previous one)
+TEST(TripleBufferTest, Threads)
+{
+  struct Value
+  {
+    int fCount;
+    int fValues[64];
+  };
+
+  constexpr int NUM_VALUES = 100000;
+
+  TripleBuffer<Value> buffer;
+
+  std::thread writer([&buffer] {
+    for(int i = 1; i <= NUM_VALUES; i++)
+    {
+      auto &value = buffer.getWriteBuffer();
+      value.fCount = i;
+      for(auto &v : value.fValues)
+        v = i;
+      buffer.publish();
+    }
+  });
+
+  int lastCount = 0;
+  while(lastCount < NUM_VALUES)
+  {
+    if(buffer.update())
+    {
+      auto const &value = buffer.getReadBuffer();
+      ASSERT_GT(value.fCount, lastCount);
+      for(auto v : value.fValues)
+        ASSERT_EQ(value.fCount, v);
+      lastCount = value.fCount;
+    }
+  }
+
+  writer.join();
+
+  ASSERT_EQ(NUM_VALUES, buffer.getReadBuffer().fCount);
+}
+
+}
+}
+}
@@ -0,0 +1,104 @@
+#include <src/cpp/TruePeakFilter.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::VAC6;
+
+// TruePeakFilterTest - ComputeMax
+TEST(TruePeakFilterTest, ComputeMax)
+{
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+  for(int numSamples = 0; numSamples <= 100; numSamples++)
+  {
+    std::vector<TSample> buffer(static_cast<size_t>(TruePeakFilter::HISTORY_SIZE + numSamples));
+    for(auto &s: buffer)
+      s = distribution(generator);
+
+    ASSERT_DOUBLE_EQ(TruePeakFilter::scalarComputeMax(buffer.data(), numSamples),
+                     TruePeakFilter::computeMax(buffer.data(), numSamples));
+
+    // 32 bits samples are filtered in 32 bits precision
+    std::vector<Sample32> buffer32(buffer.begin(), buffer.end());
+
+    ASSERT_EQ(TruePeakFilter::scalarComputeMax(buffer32.data(), numSamples),
+              TruePeakFilter::computeMax(buffer32.data(), numSamples));
+  }
+}
+
+// processes the samples in runs of random sizes and compares with the reference implementation
+template<typename SampleType>
+void testProcess()
+{
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  std::uniform_int_distribution<int> runSizeDistribution(0, 150);
+
+  constexpr int numSamples = 2000;
+  constexpr double gain = 0.5;
+
+  std::vector<SampleType> in(numSamples);
+  for(auto &s: in)
+    s = static_cast<SampleType>(distribution(generator));
+
+  // reference: the whole signal at once (the filter starts with silence)
+  std::vector<SampleType> buffer(TruePeakFilter::HISTORY_SIZE, 0);
+  for(auto s: in)
+    buffer.emplace_back(s * static_cast<SampleType>(gain));
+
+  // the max of a run only depends on the samples of the run and the ones right before it
+  TruePeakFilter filter;
+  int i = 0;
+  while(i < numSamples)
+  {
+    int runSize = std::min(runSizeDistribution(generator), numSamples - i);
+    ASSERT_DOUBLE_EQ(TruePeakFilter::scalarComputeMax(buffer.data() + i, runSize),
+                     filter.process(in.data() + i, runSize, gain));
+    i += runSize;
+  }
+
+  // silence flushes the filter
+  ASSERT_GT(filter.process(static_cast<SampleType const *>(nullptr), TruePeakFilter::HISTORY_SIZE, gain), 0);
+  ASSERT_EQ(0, filter.process(static_cast<SampleType const *>(nullptr), 10, gain));
+
+  // reset forgets the previous samples
+  filter.process(in.data(), numSamples, gain);
+  filter.reset();
+  ASSERT_EQ(0, filter.process(static_cast<SampleType const *>(nullptr), 10, gain));
+}
+
+// TruePeakFilterTest - Process
+TEST(TruePeakFilterTest, Process)
+{
+  testProcess<Sample32>();
+  testProcess<Sample64>();
+}
+
+// TruePeakFilterTest - InterSamplePeak
+TEST(TruePeakFilterTest, InterSamplePeak)
+{
+  // sine at fs/4 shifted by 45 degrees => all samples are +/- 0.707 (-3dB) but the true peak is 1.0 (0dB)
+  constexpr double PI = 3.14159265358979323846;
+  std::vector<Sample64> in(1000);
+  for(size_t i = 0; i < in.size(); i++)
+    in[i] = std::sin(PI / 2.0 * i + PI / 4.0);
+
+  TruePeakFilter filter;
+
+  // let the filter settle
+  filter.process(in.data(), 100, 1.0);
+
+  auto truePeak = filter.process(in.data() + 100, static_cast<int>(in.size()) - 100, 1.0);
+  ASSERT_NEAR(1.0, truePeak, 0.02);
+}
+
+}
+}
+}
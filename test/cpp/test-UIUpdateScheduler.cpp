@@ -0,0 +1,73 @@
+#include <src/cpp/UIUpdateScheduler.h>
+#include <gtest/gtest.h>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::Common;
+
+// UIUpdateSchedulerTest - ChangeDriven
+TEST(UIUpdateSchedulerTest, ChangeDriven)
+{
+  // 1 update every 100 samples at most, every 1000 samples at least
+  UIUpdateScheduler scheduler{100, 1000};
+
+  // initial update (as soon as the min interval elapsed)
+  ASSERT_FALSE(scheduler.shouldUpdate(64, 0));
+  ASSERT_TRUE(scheduler.shouldUpdate(64, 0));
+  ASSERT_EQ(1, scheduler.getUpdateCount());
+
+  // nothing changes => no update until the max interval
+  for(int i = 0; i < 7; i++)
+  {
+    ASSERT_FALSE(scheduler.shouldUpdate(128, 0));
+  }
+  ASSERT_EQ(7, scheduler.getSuppressedCount()); // 896 samples => 8 fixed rate updates (the next one stands for 1)
+  ASSERT_TRUE(scheduler.shouldUpdate(128, 0)); // 1024 samples
+  ASSERT_EQ(2, scheduler.getUpdateCount());
+  ASSERT_EQ(9, scheduler.getSuppressedCount());
+
+  // a change is sent right away...
+  ASSERT_FALSE(scheduler.shouldUpdate(128, 0));
+  ASSERT_TRUE(scheduler.shouldUpdate(128, 1));
+  ASSERT_EQ(10, scheduler.getSuppressedCount());
+
+  // ... but no more than once per min interval
+  ASSERT_FALSE(scheduler.shouldUpdate(64, 2));
+  ASSERT_TRUE(scheduler.shouldUpdate(64, 3));
+  ASSERT_EQ(10, scheduler.getSuppressedCount());
+
+  // unless forced
+  ASSERT_TRUE(scheduler.shouldUpdate(16, 3, true));
+  ASSERT_TRUE(scheduler.shouldUpdate(16, 3, true));
+  ASSERT_EQ(6, scheduler.getUpdateCount());
+
+  // changing at every block => same as a fixed rate
+  for(int i = 0; i < 100; i++)
+  {
+    ASSERT_EQ(i % 2 == 1, scheduler.shouldUpdate(64, 4 + i)) << i;
+  }
+  ASSERT_EQ(56, scheduler.getUpdateCount());
+  ASSERT_EQ(10, scheduler.getSuppressedCount());
+}
+
+// UIUpdateSchedulerTest - NoMaxInterval
+TEST(UIUpdateSchedulerTest, NoMaxInterval)
+{
+  UIUpdateScheduler scheduler{100};
+
+  ASSERT_TRUE(scheduler.shouldUpdate(100, 0));
+  for(int i = 0; i < 1000; i++)
+  {
+    ASSERT_FALSE(scheduler.shouldUpdate(100, 0));
+  }
+  ASSERT_EQ(999, scheduler.getSuppressedCount());
+  ASSERT_TRUE(scheduler.shouldUpdate(100, 1));
+  ASSERT_EQ(1000, scheduler.getSuppressedCount());
+  ASSERT_EQ(2, scheduler.getUpdateCount());
+}
+
+}
+}
+}
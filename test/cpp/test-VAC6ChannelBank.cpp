@@ -0,0 +1,371 @@
+#include <src/cpp/VAC6ChannelBank.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::VAC6;
+
+constexpr double SAMPLE_RATE = 44100;
+constexpr int NUM_SAMPLES = 512; // more than one batch (ACCUMULATOR_BATCH_SIZE_IN_MS)
+
+// a bus of iNumChannels channels of NUM_SAMPLES samples (channel c, sample i = (c + 1) * (i + 1) / 1024)
+class Bus
+{
+public:
+  explicit Bus(int iNumChannels) : fSamples(static_cast<size_t>(iNumChannels)), fChannels(fSamples.size())
+  {
+    for(int c = 0; c < iNumChannels; c++)
+    {
+      fSamples[c].resize(NUM_SAMPLES);
+      for(int i = 0; i < NUM_SAMPLES; i++)
+        fSamples[c][i] = expectedSample(c, i);
+      fChannels[c] = fSamples[c].data();
+    }
+
+    fBusBuffers.numChannels = iNumChannels;
+    fBusBuffers.silenceFlags = 0;
+    fBusBuffers.channelBuffers32 = fChannels.data();
+  }
+
+  // same channel buffers as iBus (what a host processing in place does)
+  void alias(Bus &iBus)
+  {
+    for(size_t c = 0; c < fChannels.size(); c++)
+      fChannels[c] = iBus.fChannels[c];
+  }
+
+  static Sample32 expectedSample(int iChannel, int iIndex) { return (iChannel + 1) * (iIndex + 1) / 1024.0f; }
+
+  std::vector<Sample32> &getSamples(int iChannel) { return fSamples[iChannel]; }
+  Sample32 *getChannelBuffer(int iChannel) { return fChannels[iChannel]; }
+  AudioBusBuffers &getBusBuffers() { return fBusBuffers; }
+
+private:
+  std::vector<std::vector<Sample32>> fSamples;
+  std::vector<Sample32 *> fChannels;
+  AudioBusBuffers fBusBuffers{};
+};
+
+// processes a whole block (NUM_SAMPLES samples) at the gain iGain
+static void processBlock(VAC6ChannelBank &iChannelBank,
+                         ZoomWindow const &iZoomWindow,
+                         Bus &iInput,
+                         Bus &iOutput,
+                         double iGain)
+{
+  AudioBuffers<Sample32> in(iInput.getBusBuffers(), NUM_SAMPLES);
+  AudioBuffers<Sample32> out(iOutput.getBusBuffers(), NUM_SAMPLES);
+  iChannelBank.genericProcessChannels<Sample32>(&iZoomWindow, in, out, BlockGain{iGain, nullptr}, 0, NUM_SAMPLES);
+}
+
+// VAC6ChannelBankTest - InPlace (the host uses the same buffers for the input and the output)
+TEST(VAC6ChannelBankTest, InPlace)
+{
+  SampleRateBasedClock clock{SAMPLE_RATE};
+  ZoomWindow zoomWindow{MAX_ARRAY_SIZE, 1000};
+  VAC6ChannelBank channelBank{clock, &zoomWindow, 2, NUM_SAMPLES, 1000};
+
+  Bus input{2};
+  Bus output{2};
+  output.alias(input);
+  output.getBusBuffers().silenceFlags = 0b11;
+
+  // unity gain => nothing is written
+  processBlock(channelBank, zoomWindow, input, output, 1.0);
+  for(int c = 0; c < 2; c++)
+  {
+    ASSERT_EQ(input.getChannelBuffer(c), output.getChannelBuffer(c));
+    for(int i = 0; i < NUM_SAMPLES; i++)
+      ASSERT_EQ(Bus::expectedSample(c, i), output.getChannelBuffer(c)[i]) << c << ":" << i;
+  }
+  ASSERT_EQ(0, output.getBusBuffers().silenceFlags);
+
+  // the gain is applied in place
+  processBlock(channelBank, zoomWindow, input, output, 0.5);
+  for(int c = 0; c < 2; c++)
+  {
+    for(int i = 0; i < NUM_SAMPLES; i++)
+      ASSERT_FLOAT_EQ(Bus::expectedSample(c, i) * 0.5f, output.getChannelBuffer(c)[i]) << c << ":" << i;
+  }
+  ASSERT_EQ(0, output.getBusBuffers().silenceFlags);
+
+  // the input (same buffers) is metered: the max of the last batch (which ends in the second block) is pushed in the
+  // history
+  auto batchSize = static_cast<int>(clock.getSampleCountFor(ACCUMULATOR_BATCH_SIZE_IN_MS));
+  auto lastBatchEnd = (2 * NUM_SAMPLES / batchSize) * batchSize - NUM_SAMPLES;
+  ASSERT_EQ(toHistorySample(Bus::expectedSample(1, lastBatchEnd - 1) * 0.5f),
+            channelBank.getChannel(1).getHistory().getBuffer().getAt(-1));
+}
+
+// VAC6ChannelBankTest - Copy (the input and the output are different buffers)
+TEST(VAC6ChannelBankTest, Copy)
+{
+  SampleRateBasedClock clock{SAMPLE_RATE};
+  ZoomWindow zoomWindow{MAX_ARRAY_SIZE, 1000};
+  VAC6ChannelBank channelBank{clock, &zoomWindow, 2, NUM_SAMPLES, 1000};
+
+  Bus input{2};
+  Bus output{2};
+
+  // unity gain => the input is copied (memcpy)
+  for(int c = 0; c < 2; c++)
+    std::fill(output.getSamples(c).begin(), output.getSamples(c).end(), 3.0f);
+  processBlock(channelBank, zoomWindow, input, output, 1.0);
+  for(int c = 0; c < 2; c++)
+    ASSERT_EQ(input.getSamples(c), output.getSamples(c)) << c;
+
+  // the gain is applied while copying
+  processBlock(channelBank, zoomWindow, input, output, 0.25);
+  for(int c = 0; c < 2; c++)
+  {
+    for(int i = 0; i < NUM_SAMPLES; i++)
+    {
+      ASSERT_EQ(Bus::expectedSample(c, i), input.getSamples(c)[i]);
+      ASSERT_FLOAT_EQ(Bus::expectedSample(c, i) * 0.25f, output.getSamples(c)[i]) << c << ":" << i;
+    }
+  }
+  ASSERT_EQ(0, output.getBusBuffers().silenceFlags);
+}
+
+// VAC6ChannelBankTest - SilentInput (the samples of a channel flagged silent by the host are never read)
+TEST(VAC6ChannelBankTest, SilentInput)
+{
+  SampleRateBasedClock clock{SAMPLE_RATE};
+  ZoomWindow zoomWindow{MAX_ARRAY_SIZE, 1000};
+  VAC6ChannelBank channelBank{clock, &zoomWindow, 2, NUM_SAMPLES, 1000};
+
+  for(auto gain : {1.0, 0.5})
+  {
+    Bus input{2};
+    Bus output{2};
+
+    // the samples of the right channel are garbage (not silent) but the channel is flagged silent
+    input.getBusBuffers().silenceFlags = 0b10;
+
+    processBlock(channelBank, zoomWindow, input, output, gain);
+
+    for(int i = 0; i < NUM_SAMPLES; i++)
+    {
+      ASSERT_FLOAT_EQ(Bus::expectedSample(0, i) * static_cast<float>(gain), output.getSamples(0)[i]) << i;
+      ASSERT_EQ(0, output.getSamples(1)[i]) << i;
+    }
+    ASSERT_EQ(0b10, output.getBusBuffers().silenceFlags) << gain;
+
+    // metered as silence
+    ASSERT_EQ(0, fromHistorySample(channelBank.getChannel(1).getHistory().getBuffer().getAt(-1)));
+  }
+}
+
+// VAC6ChannelBankTest - SilenceFlags (an output channel is flagged silent if and only if all its samples are)
+TEST(VAC6ChannelBankTest, SilenceFlags)
+{
+  SampleRateBasedClock clock{SAMPLE_RATE};
+  ZoomWindow zoomWindow{MAX_ARRAY_SIZE, 1000};
+  VAC6ChannelBank channelBank{clock, &zoomWindow, 2, NUM_SAMPLES, 1000};
+
+  Bus input{2};
+  Bus output{2};
+
+  // the left channel is all 0 (not flagged silent) and the right channel is 0 except for its last sample
+  std::fill(input.getSamples(0).begin(), input.getSamples(0).end(), 0.0f);
+  std::fill(input.getSamples(1).begin(), input.getSamples(1).end() - 1, 0.0f);
+
+  output.getBusBuffers().silenceFlags = 0b10;
+  processBlock(channelBank, zoomWindow, input, output, 1.0);
+  ASSERT_EQ(0b01, output.getBusBuffers().silenceFlags);
+
+  // a gain of 0 silences every channel
+  processBlock(channelBank, zoomWindow, input, output, 0);
+  ASSERT_EQ(0b11, output.getBusBuffers().silenceFlags);
+  ASSERT_EQ(0, output.getSamples(1)[NUM_SAMPLES - 1]);
+
+  // a block processed in several calls: the flags cover the whole block
+  AudioBuffers<Sample32> in(input.getBusBuffers(), NUM_SAMPLES);
+  AudioBuffers<Sample32> out(output.getBusBuffers(), NUM_SAMPLES);
+  channelBank.genericProcessChannels<Sample32>(&zoomWindow, in, out, BlockGain{1.0, nullptr}, 0, NUM_SAMPLES - 1);
+  channelBank.genericProcessChannels<Sample32>(&zoomWindow, in, out, BlockGain{1.0, nullptr}, NUM_SAMPLES - 1,
+                                               NUM_SAMPLES);
+  ASSERT_EQ(0b01, output.getBusBuffers().silenceFlags);
+  ASSERT_EQ(input.getSamples(1), output.getSamples(1));
+}
+
+// VAC6ChannelBankTest - ExtraOutputChannels (more output channels than input channels => silent)
+TEST(VAC6ChannelBankTest, ExtraOutputChannels)
+{
+  SampleRateBasedClock clock{SAMPLE_RATE};
+  ZoomWindow zoomWindow{MAX_ARRAY_SIZE, 1000};
+  VAC6ChannelBank channelBank{clock, &zoomWindow, 2, NUM_SAMPLES, 1000};
+
+  Bus input{2};
+  Bus output{4}; // garbage in all the channels
+
+  processBlock(channelBank, zoomWindow, input, output, 1.0);
+
+  for(int c = 0; c < 2; c++)
+    ASSERT_EQ(input.getSamples(c), output.getSamples(c)) << c;
+  for(int c = 2; c < 4; c++)
+  {
+    for(int i = 0; i < NUM_SAMPLES; i++)
+      ASSERT_EQ(0, output.getSamples(c)[i]) << c << ":" << i;
+  }
+  ASSERT_EQ(0b1100, output.getBusBuffers().silenceFlags);
+}
+
+// VAC6ChannelBankTest - MissingInputChannel (fewer input channels than the bank => metered as silence)
+TEST(VAC6ChannelBankTest, MissingInputChannel)
+{
+  SampleRateBasedClock clock{SAMPLE_RATE};
+  ZoomWindow zoomWindow{MAX_ARRAY_SIZE, 1000};
+  VAC6ChannelBank channelBank{clock, &zoomWindow, 2, NUM_SAMPLES, 1000};
+
+  Bus input{2};
+  Bus output{2};
+
+  processBlock(channelBank, zoomWindow, input, output, 1.0);
+  ASSERT_LT(0, fromHistorySample(channelBank.getChannel(1).getHistory().getBuffer().getAt(-1)));
+
+  // the host now provides a single input channel
+  Bus monoInput{1};
+  processBlock(channelBank, zoomWindow, monoInput, output, 1.0);
+
+  ASSERT_EQ(input.getSamples(0), output.getSamples(0));
+  for(int i = 0; i < NUM_SAMPLES; i++)
+    ASSERT_EQ(0, output.getSamples(1)[i]) << i;
+  ASSERT_EQ(0b10, output.getBusBuffers().silenceFlags);
+
+  // the history of the right channel still receives entries (silence)
+  ASSERT_EQ(0, fromHistorySample(channelBank.getChannel(1).getHistory().getBuffer().getAt(-1)));
+}
+
+// VAC6ChannelBankTest - ContinuousZoomChanges (the zoomed buffer computation, spread over several blocks, is not
+// restarted when the channels are marked dirty every block => the displayed buffer keeps being updated)
+TEST(VAC6ChannelBankTest, ContinuousZoomChanges)
+{
+  SampleRateBasedClock clock{SAMPLE_RATE};
+  ZoomWindow zoomWindow{MAX_ARRAY_SIZE, 1000};
+  VAC6ChannelBank channelBank{clock, &zoomWindow, 2, NUM_SAMPLES, 1000};
+
+  // same input (and final zoom) but marked dirty only once
+  ZoomWindow referenceZoomWindow{MAX_ARRAY_SIZE, 1000};
+  VAC6ChannelBank referenceChannelBank{clock, &referenceZoomWindow, 2, NUM_SAMPLES, 1000};
+
+  Bus input{2};
+  Bus output{2};
+
+  for(int b = 0; b < 4; b++)
+  {
+    processBlock(channelBank, zoomWindow, input, output, 1.0);
+    processBlock(referenceChannelBank, referenceZoomWindow, input, output, 1.0);
+  }
+
+  // paused => only a recomputation changes what is displayed
+  channelBank.setIsLiveView(false);
+  referenceChannelBank.setIsLiveView(false);
+
+  constexpr int numBlocksPerComputation = MAX_ARRAY_SIZE / ZOOM_POINTS_COMPUTED_PER_BLOCK;
+
+  auto generation = channelBank.getChannel(0).getDisplayGeneration();
+  int numSwaps = 0;
+  for(int b = 0; b < 4 * numBlocksPerComputation; b++)
+  {
+    zoomWindow.setZoomFactor(b % 2 == 0 ? 0.5 : 1.0);
+    channelBank.setDirty();
+    processBlock(channelBank, zoomWindow, input, output, 1.0);
+
+    auto newGeneration = channelBank.getChannel(0).getDisplayGeneration();
+    if(newGeneration != generation)
+      numSwaps++;
+    generation = newGeneration;
+  }
+  ASSERT_LE(3, numSwaps);
+
+  // once the changes stop, the last one gets displayed
+  referenceZoomWindow.setZoomFactor(1.0);
+  referenceChannelBank.setDirty();
+  for(int b = 0; b < 2 * numBlocksPerComputation + 2; b++)
+  {
+    processBlock(channelBank, zoomWindow, input, output, 1.0);
+    processBlock(referenceChannelBank, referenceZoomWindow, input, output, 1.0);
+  }
+
+  for(int c = 0; c < 2; c++)
+  {
+    THistorySample samples[MAX_ARRAY_SIZE];
+    THistorySample expectedSamples[MAX_ARRAY_SIZE];
+    channelBank.getChannel(c).computeZoomSamples(MAX_ARRAY_SIZE, samples);
+    referenceChannelBank.getChannel(c).computeZoomSamples(MAX_ARRAY_SIZE, expectedSamples);
+    for(int i = 0; i < MAX_ARRAY_SIZE; i++)
+      ASSERT_EQ(expectedSamples[i], samples[i]) << c << ":" << i;
+  }
+}
+
+// VAC6ChannelBankTest - MaxLevelSinceReset (the max of the entries pushed, even when the point of the zoomed buffer
+// they belong to is not complete)
+TEST(VAC6ChannelBankTest, MaxLevelSinceReset)
+{
+  SampleRateBasedClock clock{SAMPLE_RATE};
+  ZoomWindow zoomWindow{MAX_ARRAY_SIZE, 1000};
+  zoomWindow.setZoomFactor(0); // every point of the zoomed buffer is made of several entries
+  VAC6ChannelBank channelBank{clock, &zoomWindow, 2, NUM_SAMPLES, 1000};
+
+  Bus input{2};
+  Bus output{2};
+
+  channelBank.resetMaxLevelSinceReset();
+  ASSERT_EQ(-1, channelBank.getChannel(0).getMaxLevelSinceReset());
+
+  processBlock(channelBank, zoomWindow, input, output, 1.0);
+
+  // the entries pushed (each one the max of a batch) are increasing
+  auto batchSize = static_cast<int>(clock.getSampleCountFor(ACCUMULATOR_BATCH_SIZE_IN_MS));
+  auto lastBatchEnd = (NUM_SAMPLES / batchSize) * batchSize;
+  for(int c = 0; c < 2; c++)
+  {
+    ASSERT_EQ(fromHistorySample(toHistorySample(Bus::expectedSample(c, lastBatchEnd - 1))),
+              channelBank.getChannel(c).getMaxLevelSinceReset()) << c;
+  }
+}
+
+// VAC6ChannelBankTest - RangeStats (the mean square pushed with each entry is the one of the (gain adjusted) samples
+// of the batch, not the square of its max)
+TEST(VAC6ChannelBankTest, RangeStats)
+{
+  SampleRateBasedClock clock{SAMPLE_RATE};
+  ZoomWindow zoomWindow{MAX_ARRAY_SIZE, 1000};
+  VAC6ChannelBank channelBank{clock, &zoomWindow, 2, NUM_SAMPLES, 1000};
+
+  Bus input{2};
+  Bus output{2};
+
+  processBlock(channelBank, zoomWindow, input, output, 0.5);
+
+  auto batchSize = static_cast<int>(clock.getSampleCountFor(ACCUMULATOR_BATCH_SIZE_IN_MS));
+  auto numBatches = NUM_SAMPLES / batchSize;
+  for(int c = 0; c < 2; c++)
+  {
+    TSample expectedSum = 0;
+    TSample expectedSumOfMeanSquares = 0;
+    for(int b = 0; b < numBatches; b++)
+    {
+      TSample sumOfSquares = 0;
+      for(int i = b * batchSize; i < (b + 1) * batchSize; i++)
+      {
+        TSample sample = Bus::expectedSample(c, i) * 0.5;
+        sumOfSquares += sample * sample;
+      }
+      expectedSum += fromHistorySample(toHistorySample(Bus::expectedSample(c, (b + 1) * batchSize - 1) * 0.5f));
+      expectedSumOfMeanSquares += sumOfSquares / batchSize;
+    }
+
+    auto stats = channelBank.getChannel(c).computeRangeStats(-numBatches, 0);
+    ASSERT_DOUBLE_EQ(expectedSum, stats.fSum) << c;
+    ASSERT_NEAR(expectedSumOfMeanSquares, stats.fSumOfMeanSquares, 1e-12) << c;
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,352 @@
+#include <src/cpp/VAC6Model.h>
+#include <public.sdk/source/common/memorystream.h>
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::VAC6;
+
+// a frame of iNumChannels channels (+ loudness) where every sample is different
+static std::unique_ptr<HistoryData> createHistoryData(int iNumChannels)
+{
+  auto data = std::make_unique<HistoryData>();
+  auto &lcdData = data->fLCDData;
+  lcdData.fNumChannels = iNumChannels;
+  for(int c = 0; c < iNumChannels; c++)
+  {
+    auto &channel = lcdData.fChannels[c];
+    for(int i = 0; i < MAX_ARRAY_SIZE; i++)
+      channel.fSamples[i] = toHistorySample((c * MAX_ARRAY_SIZE + i + 1) / 8192.0);
+    channel.fMaxLevelSinceReset = 0.5 + c / 100.0;
+  }
+  lcdData.fChannels[1].fOn = false;
+  lcdData.fLoudness.fOn = true;
+  for(int i = 0; i < MAX_ARRAY_SIZE; i++)
+    lcdData.fLoudness.fSamples[i] = toHistorySample((i + 1) / 512.0);
+  data->fSelectionStats = SelectionStats{0.75, 0.25, 0.5, 3, 12};
+  return data;
+}
+
+// moves all the channels of the frame by iCount points (what happens between 2 frames in live view)
+static void scroll(LCDData &ioLCDData, int iCount)
+{
+  auto scrollChannel = [iCount](LCDData::Channel &ioChannel) {
+    std::copy(ioChannel.fSamples + iCount, ioChannel.fSamples + MAX_ARRAY_SIZE, ioChannel.fSamples);
+    for(int i = MAX_ARRAY_SIZE - iCount; i < MAX_ARRAY_SIZE; i++)
+      ioChannel.fSamples[i] = toHistorySample((ioChannel.fZoomPointCount + i + 1) / 16384.0);
+    ioChannel.fZoomPointCount += iCount;
+  };
+
+  for(int c = 0; c < ioLCDData.fNumChannels; c++)
+    scrollChannel(ioLCDData.fChannels[c]);
+  scrollChannel(ioLCDData.fLoudness);
+}
+
+// what the GUI must get for the frame (all but the RT side only fields)
+static void assertSameFrame(HistoryData const &iExpected, HistoryData const &iActual)
+{
+  auto assertSameChannel = [](LCDData::Channel const &iExpected, LCDData::Channel const &iActual) {
+    ASSERT_EQ(iExpected.fOn, iActual.fOn);
+    if(iExpected.fOn)
+    {
+      for(int i = 0; i < MAX_ARRAY_SIZE; i++)
+        ASSERT_EQ(iExpected.fSamples[i], iActual.fSamples[i]) << i;
+    }
+    ASSERT_EQ(iExpected.fMaxLevelSinceReset, iActual.fMaxLevelSinceReset);
+  };
+
+  ASSERT_EQ(iExpected.fLCDData.fNumChannels, iActual.fLCDData.fNumChannels);
+  for(int c = 0; c < iExpected.fLCDData.fNumChannels; c++)
+    assertSameChannel(iExpected.fLCDData.fChannels[c], iActual.fLCDData.fChannels[c]);
+  assertSameChannel(iExpected.fLCDData.fLoudness, iActual.fLCDData.fLoudness);
+
+  ASSERT_EQ(iExpected.fSelectionStats.fMax, iActual.fSelectionStats.fMax);
+  ASSERT_EQ(iExpected.fSelectionStats.fAveragePeak, iActual.fSelectionStats.fAveragePeak);
+  ASSERT_EQ(iExpected.fSelectionStats.fRMS, iActual.fSelectionStats.fRMS);
+  ASSERT_EQ(iExpected.fSelectionStats.fCountAboveSoftClippingLevel,
+            iActual.fSelectionStats.fCountAboveSoftClippingLevel);
+  ASSERT_EQ(iExpected.fSelectionStats.fCount, iActual.fSelectionStats.fCount);
+}
+
+// a message between RT (write) and the GUI (read)
+class Message
+{
+public:
+  // write (RT side)
+  void write(HistoryDataParamSerializer const &iSerializer, HistoryData const &iValue)
+  {
+    fStream.setSize(0);
+    fStream.seek(0, IBStream::kIBSeekSet, nullptr);
+    ASSERT_EQ(kResultOk, iSerializer.writeToStream(iValue, fStreamer));
+    fSize = fStreamer.tell();
+  }
+
+  // read (GUI side)
+  tresult read(HistoryDataParamSerializer const &iSerializer, HistoryData &oValue)
+  {
+    fStream.seek(0, IBStream::kIBSeekSet, nullptr);
+    return iSerializer.readFromStream(fStreamer, oValue);
+  }
+
+  // header: version, frame id, previous frame id (0 for a full frame)...
+  uint32 getPreviousFrameId()
+  {
+    int32 version;
+    uint32 frameId, previousFrameId;
+    fStream.seek(0, IBStream::kIBSeekSet, nullptr);
+    fStreamer.readInt32(version);
+    fStreamer.readInt32u(frameId);
+    fStreamer.readInt32u(previousFrameId);
+    return previousFrameId;
+  }
+
+  bool isFullFrame() { return getPreviousFrameId() == 0; }
+
+  // overwrites the version at the beginning of the message
+  void setVersion(int32 iVersion)
+  {
+    fStream.seek(0, IBStream::kIBSeekSet, nullptr);
+    fStreamer.writeInt32(iVersion);
+  }
+
+  int64 getSize() const { return fSize; }
+
+private:
+  MemoryStream fStream{};
+  IBStreamer fStreamer{&fStream, kLittleEndian};
+  int64 fSize{0};
+};
+
+// the time of the RT side of the serializers (see HistoryDataParamSerializer::Clock) so that the tests decide when a
+// full frame is due
+Steinberg::int64 gNow = 0;
+Steinberg::int64 testClock() { return gNow; }
+
+// HistoryDataParamSerializerTest - FullFrame (the first frame written is a full frame)
+TEST(HistoryDataParamSerializerTest, FullFrame)
+{
+  HistoryDataParamSerializer writer{};
+  HistoryDataParamSerializer reader{};
+
+  auto value = createHistoryData(2);
+  auto readValue = std::make_unique<HistoryData>();
+
+  Message message{};
+  message.write(writer, *value);
+  ASSERT_TRUE(message.isFullFrame());
+
+  ASSERT_EQ(kResultOk, message.read(reader, *readValue));
+  assertSameFrame(*value, *readValue);
+
+  // the max levels are computed from the frame read
+  value->computeMaxLevels();
+  ASSERT_EQ(value->fMaxLevelInWindow.fValue, readValue->fMaxLevelInWindow.fValue);
+  ASSERT_EQ(value->fMaxLevelInWindow.fIndex, readValue->fMaxLevelInWindow.fIndex);
+  ASSERT_EQ(value->fMaxLevelSinceReset.fValue, readValue->fMaxLevelSinceReset.fValue);
+}
+
+// HistoryDataParamSerializerTest - DeltaFrame (only the appended samples are sent and the GUI rebuilds the frame)
+TEST(HistoryDataParamSerializerTest, DeltaFrame)
+{
+  HistoryDataParamSerializer writer{nullptr, testClock};
+  HistoryDataParamSerializer reader{};
+
+  auto value = createHistoryData(2);
+  auto readValue = std::make_unique<HistoryData>();
+
+  Message message{};
+  message.write(writer, *value);
+  auto fullFrameSize = message.getSize();
+  ASSERT_EQ(kResultOk, message.read(reader, *readValue));
+
+  for(int i = 1; i <= 3; i++)
+  {
+    scroll(value->fLCDData, i);
+    value->fSelectionStats.fCount = i;
+    message.write(writer, *value);
+    ASSERT_FALSE(message.isFullFrame());
+    ASSERT_LT(message.getSize(), fullFrameSize / 4);
+
+    ASSERT_EQ(kResultOk, message.read(reader, *readValue));
+    assertSameFrame(*value, *readValue);
+  }
+
+  // the samples do not match the previous frame moved to the left (ex: zoom) => the channel is sent in full
+  value->fLCDData.fChannels[0].fSamples[MAX_ARRAY_SIZE / 2] = toHistorySample(0.125);
+  scroll(value->fLCDData, 1);
+  message.write(writer, *value);
+  ASSERT_FALSE(message.isFullFrame());
+  ASSERT_GT(message.getSize(), fullFrameSize / 4);
+  ASSERT_EQ(kResultOk, message.read(reader, *readValue));
+  assertSameFrame(*value, *readValue);
+}
+
+// HistoryDataParamSerializerTest - MissedFrame (a delta frame for a frame which was not read is ignored until the
+// next full frame which is sent 1s after the previous one)
+TEST(HistoryDataParamSerializerTest, MissedFrame)
+{
+  constexpr Steinberg::int64 frameInterval = UI_FRAME_RATE_MS * 1000000;
+
+  HistoryDataParamSerializer writer{nullptr, testClock};
+  HistoryDataParamSerializer reader{};
+
+  auto value = createHistoryData(2);
+  auto readValue = std::make_unique<HistoryData>();
+
+  Message message{};
+  message.write(writer, *value);
+  ASSERT_EQ(kResultOk, message.read(reader, *readValue));
+  auto lastReadValue = std::make_unique<HistoryData>(*readValue);
+
+  // this frame is never read
+  gNow += frameInterval;
+  scroll(value->fLCDData, 1);
+  message.write(writer, *value);
+
+  // every delta frame is ignored (which is not an error) and the value left untouched
+  Steinberg::int64 sinceFullFrame = frameInterval;
+  for(;;)
+  {
+    gNow += frameInterval;
+    sinceFullFrame += frameInterval;
+    scroll(value->fLCDData, 1);
+    message.write(writer, *value);
+
+    if(message.isFullFrame())
+      break;
+
+    ASSERT_EQ(kResultOk, message.read(reader, *readValue));
+    assertSameFrame(*lastReadValue, *readValue);
+  }
+
+  // resync on the first frame written 1s (or more) after the previous full frame
+  ASSERT_GE(sinceFullFrame, HistoryDataParamSerializer::FULL_FRAME_INTERVAL_NS);
+  ASSERT_LT(sinceFullFrame - frameInterval, HistoryDataParamSerializer::FULL_FRAME_INTERVAL_NS);
+  ASSERT_EQ(kResultOk, message.read(reader, *readValue));
+  assertSameFrame(*value, *readValue);
+
+  // and the next delta frames are accepted again
+  gNow += frameInterval;
+  scroll(value->fLCDData, 2);
+  message.write(writer, *value);
+  ASSERT_FALSE(message.isFullFrame());
+  ASSERT_EQ(kResultOk, message.read(reader, *readValue));
+  assertSameFrame(*value, *readValue);
+}
+
+// HistoryDataParamSerializerTest - IdleFrameRate (when the frames are sent at the idle rate, every frame is a full
+// frame so a missed frame does not leave the GUI behind)
+TEST(HistoryDataParamSerializerTest, IdleFrameRate)
+{
+  constexpr Steinberg::int64 frameInterval = UI_IDLE_FRAME_RATE_MS * 1000000;
+
+  HistoryDataParamSerializer writer{nullptr, testClock};
+
+  auto value = createHistoryData(2);
+
+  Message message{};
+  message.write(writer, *value);
+
+  for(int i = 0; i < 3; i++)
+  {
+    gNow += frameInterval;
+    scroll(value->fLCDData, 1);
+    message.write(writer, *value);
+    ASSERT_TRUE(message.isFullFrame());
+  }
+}
+
+// HistoryDataParamSerializerTest - VersionMismatch (a frame written with another format is rejected)
+TEST(HistoryDataParamSerializerTest, VersionMismatch)
+{
+  HistoryDataParamSerializer writer{nullptr, testClock};
+  HistoryDataParamSerializer reader{};
+
+  auto value = createHistoryData(2);
+  auto readValue = std::make_unique<HistoryData>();
+  auto emptyValue = std::make_unique<HistoryData>();
+
+  Message message{};
+  message.write(writer, *value);
+  message.setVersion(HistoryDataParamSerializer::WIRE_FORMAT_VERSION + 1);
+  ASSERT_EQ(kResultFalse, message.read(reader, *readValue));
+  assertSameFrame(*emptyValue, *readValue);
+
+  // nothing was read => the next delta frame is ignored as well
+  scroll(value->fLCDData, 1);
+  message.write(writer, *value);
+  ASSERT_FALSE(message.isFullFrame());
+  ASSERT_EQ(kResultOk, message.read(reader, *readValue));
+  assertSameFrame(*emptyValue, *readValue);
+}
+
+// HistoryDataParamSerializerTest - NumChannelsChange (a different number of channels forces a full frame)
+TEST(HistoryDataParamSerializerTest, NumChannelsChange)
+{
+  HistoryDataParamSerializer writer{nullptr, testClock};
+  HistoryDataParamSerializer reader{};
+
+  auto readValue = std::make_unique<HistoryData>();
+
+  Message message{};
+  message.write(writer, *createHistoryData(2));
+  ASSERT_EQ(kResultOk, message.read(reader, *readValue));
+
+  for(auto numChannels : {6, 1, 4})
+  {
+    auto value = createHistoryData(numChannels);
+    message.write(writer, *value);
+    ASSERT_TRUE(message.isFullFrame()) << numChannels;
+    ASSERT_EQ(kResultOk, message.read(reader, *readValue));
+    assertSameFrame(*value, *readValue);
+
+    // same number of channels => delta frame
+    scroll(value->fLCDData, 1);
+    message.write(writer, *value);
+    ASSERT_FALSE(message.isFullFrame()) << numChannels;
+    ASSERT_EQ(kResultOk, message.read(reader, *readValue));
+    assertSameFrame(*value, *readValue);
+  }
+}
+
+// HistoryDataParamSerializerTest - Metrics (the size of every frame written is recorded in the metrics given to the
+// serializer)
+TEST(HistoryDataParamSerializerTest, Metrics)
+{
+  Common::ProcessMetrics metrics{};
+  metrics.reset(44100);
+  HistoryDataParamSerializer writer{&metrics};
+
+  auto value = createHistoryData(2);
+
+  Message message{};
+  message.write(writer, *value);
+  auto size = message.getSize();
+  scroll(value->fLCDData, 1);
+  message.write(writer, *value);
+  size += message.getSize();
+
+  Common::MetricsSnapshot snapshot{};
+  metrics.snapshot(snapshot);
+  ASSERT_EQ(size, snapshot.fBroadcastBytes);
+}
+
+// LCDZoomFactorXParamConverterTest - UpgradeFromVersion1 (a zoom level saved with the linear mapping gives the same
+// zoom with the exponential mapping)
+TEST(LCDZoomFactorXParamConverterTest, UpgradeFromVersion1)
+{
+  LCDZoomFactorXParamConverter converter{};
+
+  // 30s (the whole history of version 1), 15s (the default of both versions) and 1.28s
+  ASSERT_EQ("30.00s", converter.toString(LCDZoomFactorXParamConverter::upgradeFromVersion1(0), 2));
+  ASSERT_EQ("15.00s", converter.toString(LCDZoomFactorXParamConverter::upgradeFromVersion1(0.52228412256267409131), 2));
+  ASSERT_NEAR(DEFAULT_ZOOM_FACTOR_X, LCDZoomFactorXParamConverter::upgradeFromVersion1(0.52228412256267409131), 1e-9);
+  ASSERT_DOUBLE_EQ(1.0, LCDZoomFactorXParamConverter::upgradeFromVersion1(1.0));
+}
+
+}
+}
+}
@@ -0,0 +1,249 @@
+#include <src/cpp/offline/WavFile.h>
+#include <src/cpp/MemoryMappedFile.h>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::Common;
+
+namespace {
+
+using Bytes = std::vector<unsigned char>;
+
+void append16(Bytes &ioBytes, uint32_t iValue)
+{
+  ioBytes.push_back(iValue & 0xFF);
+  ioBytes.push_back((iValue >> 8) & 0xFF);
+}
+
+void append32(Bytes &ioBytes, uint32_t iValue)
+{
+  append16(ioBytes, iValue & 0xFFFF);
+  append16(ioBytes, iValue >> 16);
+}
+
+template<typename T>
+void appendValue(Bytes &ioBytes, T iValue)
+{
+  auto p = reinterpret_cast<unsigned char const *>(&iValue);
+  ioBytes.insert(ioBytes.end(), p, p + sizeof(T));
+}
+
+// a WAV file (with an extra chunk before the data chunk, as written by most DAWs)
+Bytes wav(uint16_t iFormatTag, int iNumChannels, int iBitsPerSample, Bytes const &iData, bool iExtensible = false)
+{
+  Bytes fmt{};
+  append16(fmt, iExtensible ? 0xFFFE : iFormatTag);
+  append16(fmt, iNumChannels);
+  append32(fmt, 48000);
+  append32(fmt, 48000 * iNumChannels * iBitsPerSample / 8);
+  append16(fmt, iNumChannels * iBitsPerSample / 8);
+  append16(fmt, iBitsPerSample);
+  if(iExtensible)
+  {
+    append16(fmt, 22);
+    append16(fmt, iBitsPerSample);
+    append32(fmt, 0); // channel mask
+    append16(fmt, iFormatTag); // sub format GUID
+    fmt.insert(fmt.end(), 14, 0);
+  }
+
+  Bytes bytes{'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E'};
+
+  bytes.insert(bytes.end(), {'f', 'm', 't', ' '});
+  append32(bytes, static_cast<uint32_t>(fmt.size()));
+  bytes.insert(bytes.end(), fmt.begin(), fmt.end());
+
+  // odd size => padded
+  bytes.insert(bytes.end(), {'L', 'I', 'S', 'T'});
+  append32(bytes, 3);
+  bytes.insert(bytes.end(), {'a', 'b', 'c', 0});
+
+  bytes.insert(bytes.end(), {'d', 'a', 't', 'a'});
+  append32(bytes, static_cast<uint32_t>(iData.size()));
+  bytes.insert(bytes.end(), iData.begin(), iData.end());
+
+  auto riffSize = static_cast<uint32_t>(bytes.size() - 8);
+  for(int i = 0; i < 4; i++)
+    bytes[4 + i] = (riffSize >> (8 * i)) & 0xFF;
+
+  return bytes;
+}
+
+// a temporary file deleted at the end of the test
+class TemporaryFile
+{
+public:
+  explicit TemporaryFile(Bytes const &iBytes) : fPath{MemoryMappedFile::createTemporaryPath("test-WavFile", ".wav")}
+  {
+    std::ofstream out{fPath, std::ios::binary};
+    out.write(reinterpret_cast<char const *>(iBytes.data()), static_cast<std::streamsize>(iBytes.size()));
+  }
+
+  ~TemporaryFile() { std::remove(fPath.c_str()); }
+
+  std::string const &getPath() const { return fPath; }
+
+private:
+  std::string fPath;
+};
+
+}
+
+// WavFileTest - PCM16 (stereo, deinterleaved and converted)
+TEST(WavFileTest, PCM16)
+{
+  Bytes data{};
+  for(int16_t v: {0, 16384, -32768, 32767, -16384, 1})
+    append16(data, static_cast<uint16_t>(v));
+
+  TemporaryFile file{wav(1, 2, 16, data)};
+  WavFile wavFile{file.getPath()};
+  ASSERT_TRUE(wavFile.isOpen()) << wavFile.getError();
+  ASSERT_EQ(2, wavFile.getNumChannels());
+  ASSERT_EQ(48000, wavFile.getSampleRate());
+  ASSERT_EQ(3, wavFile.getNumFrames());
+  ASSERT_EQ(WavFile::SampleFormat::kPCM16, wavFile.getSampleFormat());
+
+  // interleaved => no direct access
+  ASSERT_EQ(nullptr, wavFile.getChannelData<float>(0));
+
+  float left[2], right[2];
+  float *channels[] = {left, right};
+  wavFile.readFrames(1, 2, channels);
+  ASSERT_FLOAT_EQ(-1.0f, left[0]);
+  ASSERT_FLOAT_EQ(32767 / 32768.0f, right[0]);
+  ASSERT_FLOAT_EQ(-0.5f, left[1]);
+  ASSERT_FLOAT_EQ(1 / 32768.0f, right[1]);
+}
+
+// WavFileTest - PCM24 (sign extension)
+TEST(WavFileTest, PCM24)
+{
+  Bytes data{0x00, 0x00, 0x40, // 0.5
+             0x00, 0x00, 0x80, // -1.0
+             0xFF, 0xFF, 0xFF}; // -1 / 2^23
+
+  TemporaryFile file{wav(1, 1, 24, data)};
+  WavFile wavFile{file.getPath()};
+  ASSERT_TRUE(wavFile.isOpen()) << wavFile.getError();
+  ASSERT_EQ(3, wavFile.getNumFrames());
+
+  double samples[3];
+  double *channels[] = {samples};
+  wavFile.readFrames(0, 3, channels);
+  ASSERT_DOUBLE_EQ(0.5, samples[0]);
+  ASSERT_DOUBLE_EQ(-1.0, samples[1]);
+  ASSERT_DOUBLE_EQ(-1.0 / 8388608.0, samples[2]);
+}
+
+// WavFileTest - Float32 (mono => direct access to the mapped samples)
+TEST(WavFileTest, Float32)
+{
+  Bytes data{};
+  for(float v: {0.25f, -0.75f, 1.5f})
+    appendValue(data, v);
+
+  TemporaryFile file{wav(3, 1, 32, data)};
+  WavFile wavFile{file.getPath()};
+  ASSERT_TRUE(wavFile.isOpen()) << wavFile.getError();
+  ASSERT_EQ(WavFile::SampleFormat::kFloat32, wavFile.getSampleFormat());
+
+  auto samples = wavFile.getChannelData<float>(0);
+  ASSERT_NE(nullptr, samples);
+  ASSERT_EQ(0.25f, samples[0]);
+  ASSERT_EQ(-0.75f, samples[1]);
+  ASSERT_EQ(1.5f, samples[2]); // not clipped
+
+  // not the same type => converted
+  ASSERT_EQ(nullptr, wavFile.getChannelData<double>(0));
+  double converted[3];
+  double *channels[] = {converted};
+  wavFile.readFrames(0, 3, channels);
+  ASSERT_EQ(-0.75, converted[1]);
+}
+
+// WavFileTest - Extensible (WAVE_FORMAT_EXTENSIBLE float 64)
+TEST(WavFileTest, Extensible)
+{
+  Bytes data{};
+  for(double v: {0.1, -0.2, 0.3, -0.4})
+    appendValue(data, v);
+
+  TemporaryFile file{wav(3, 2, 64, data, true)};
+  WavFile wavFile{file.getPath()};
+  ASSERT_TRUE(wavFile.isOpen()) << wavFile.getError();
+  ASSERT_EQ(WavFile::SampleFormat::kFloat64, wavFile.getSampleFormat());
+  ASSERT_EQ(2, wavFile.getNumFrames());
+
+  double left[2], right[2];
+  double *channels[] = {left, right};
+  wavFile.readFrames(0, 2, channels);
+  ASSERT_EQ(0.1, left[0]);
+  ASSERT_EQ(-0.2, right[0]);
+  ASSERT_EQ(0.3, left[1]);
+  ASSERT_EQ(-0.4, right[1]);
+}
+
+// WavFileTest - Truncated (data chunk bigger than the file => only the complete frames)
+TEST(WavFileTest, Truncated)
+{
+  Bytes data{};
+  for(int16_t v: {1, 2, 3, 4, 5})
+    append16(data, static_cast<uint16_t>(v));
+
+  auto bytes = wav(1, 2, 16, data);
+  bytes.resize(bytes.size() - 2);
+
+  TemporaryFile file{bytes};
+  WavFile wavFile{file.getPath()};
+  ASSERT_TRUE(wavFile.isOpen()) << wavFile.getError();
+  ASSERT_EQ(2, wavFile.getNumFrames());
+}
+
+// WavFileTest - Errors
+TEST(WavFileTest, Errors)
+{
+  // no such file
+  {
+    WavFile wavFile{MemoryMappedFile::createTemporaryPath("test-WavFile", ".wav")};
+    ASSERT_FALSE(wavFile.isOpen());
+    ASSERT_FALSE(wavFile.getError().empty());
+  }
+
+  // not a WAV file
+  {
+    TemporaryFile file{Bytes{'R', 'I', 'F', 'F', 0, 0, 0, 0, 'A', 'V', 'I', ' '}};
+    WavFile wavFile{file.getPath()};
+    ASSERT_FALSE(wavFile.isOpen());
+    ASSERT_EQ("not a WAV file", wavFile.getError());
+  }
+
+  // 8 bits PCM is not supported
+  {
+    TemporaryFile file{wav(1, 1, 8, Bytes{0x80, 0x80})};
+    WavFile wavFile{file.getPath()};
+    ASSERT_FALSE(wavFile.isOpen());
+    ASSERT_EQ("unsupported PCM bits per sample (8)", wavFile.getError());
+    ASSERT_EQ(0, wavFile.getNumFrames());
+  }
+
+  // no data chunk
+  {
+    auto bytes = wav(1, 1, 16, Bytes{});
+    bytes.resize(bytes.size() - 8);
+    TemporaryFile file{bytes};
+    WavFile wavFile{file.getPath()};
+    ASSERT_FALSE(wavFile.isOpen());
+    ASSERT_EQ("no data chunk", wavFile.getError());
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,92 @@
+#include <src/cpp/offline/WorkStealingThreadPool.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::Common;
+
+// WorkStealingThreadPoolTest - Submit (every task runs exactly once)
+TEST(WorkStealingThreadPoolTest, Submit)
+{
+  constexpr int numTasks = 1000;
+
+  std::atomic<int> runs[numTasks]{};
+
+  WorkStealingThreadPool pool{4};
+  ASSERT_EQ(4, pool.getNumThreads());
+
+  for(int i = 0; i < numTasks; i++)
+    pool.submit([&runs, i](int iWorker) {
+      EXPECT_TRUE(iWorker >= 0 && iWorker < 4);
+      runs[i]++;
+    });
+
+  pool.wait();
+
+  for(auto &run: runs)
+    ASSERT_EQ(1, run.load());
+
+  // can be reused
+  std::atomic<int> count{0};
+  pool.submit([&count](int) { count++; });
+  pool.wait();
+  ASSERT_EQ(1, count.load());
+}
+
+// WorkStealingThreadPoolTest - Steal (the tasks submitted by a task all go to its worker and are stolen by the others)
+TEST(WorkStealingThreadPoolTest, Steal)
+{
+  constexpr int numTasks = 40;
+
+  std::mutex mutex{};
+  std::set<int> workers{};
+  std::atomic<int> count{0};
+
+  WorkStealingThreadPool pool{4};
+
+  pool.submit([&](int) {
+    for(int i = 0; i < numTasks; i++)
+      pool.submit([&](int iWorker) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        {
+          std::lock_guard<std::mutex> lock{mutex};
+          workers.insert(iWorker);
+        }
+        count++;
+      });
+  });
+
+  // waits for the subtasks as well
+  pool.wait();
+
+  ASSERT_EQ(numTasks, count.load());
+  ASSERT_GT(workers.size(), 1);
+}
+
+// WorkStealingThreadPoolTest - Destructor (waits for the pending tasks)
+TEST(WorkStealingThreadPoolTest, Destructor)
+{
+  std::atomic<int> count{0};
+
+  {
+    WorkStealingThreadPool pool{2};
+    for(int i = 0; i < 10; i++)
+      pool.submit([&count](int) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        count++;
+      });
+  }
+
+  ASSERT_EQ(10, count.load());
+}
+
+}
+}
+}
@@ -1,9 +1,11 @@
 #include <src/cpp/ZoomWindow.h>
+#include "ZoomWindowReference.h"
 #include <gtest/gtest.h>
 #include <random>
 #include <vector>
 #include <chrono>
 #include <pongasoft/Utils/Lerp.h>
+#include <pongasoft/Utils/Misc.h>
 
 namespace pongasoft {
 namespace VST {
@@ -15,10 +17,12 @@ using namespace pongasoft::VST::Common;
 // Zoom tests
 ///////////////////////////////////////////
 
+// the zoom is tested with floats (independently of VAC6_COMPACT_HISTORY): it only compares the entries
+
 // ZoomTest - NoZoom
 TEST(ZoomTest, NoZoom)
 {
-  Zoom<10> zoom;
+  Zoom<10, float> zoom;
 
   ASSERT_TRUE(zoom.isNoZoom());
 
@@ -32,13 +36,13 @@ TEST(ZoomTest, NoZoom)
   ASSERT_EQ(-1, offset);
   ASSERT_EQ(-1, zoom.getZoomPointIndexFromOffset(-1));
 
-  TSample s = -1.0;
+  float s = -1.0;
 
   for(int i = 0; i < 15; i++)
   {
     // when no zoom, there is no accumulation
-    ASSERT_TRUE(accumulator.accumulate(static_cast<TSample>(i), s));
-    ASSERT_EQ(static_cast<TSample>(i), s);
+    ASSERT_TRUE(accumulator.accumulate(static_cast<float>(i), s));
+    ASSERT_EQ(static_cast<float>(i), s);
   }
 
   zoom.getAccumulatorFromIndex(-73, offset);
@@ -50,9 +54,9 @@ template <int batchSize, int batchSizeInSamples>
 void testZoom(double zoomFactor, int const *iExpectedBatchSizes, int const *iExpectedOffSets)
 {
   std::default_random_engine generator;
-  std::uniform_real_distribution<double> distribution(0.0,1.0);
+  std::uniform_real_distribution<float> distribution(0.0,1.0);
 
-  Zoom<batchSize> zoom;
+  Zoom<batchSize, float> zoom;
 
   zoom.setZoomFactor(zoomFactor);
 
@@ -102,7 +106,7 @@ void testZoom(double zoomFactor, int const *iExpectedBatchSizes, int const *iExp
       auto accumulator = zoom.getAccumulatorFromIndex(index--, computedOffset);
 
       // creating a random array of elements
-      double elements[batchSizeInSamples];
+      float elements[batchSizeInSamples];
       for(int k = 0; k < batchSizeInSamples; k++)
         elements[k] = distribution(generator);
 
@@ -111,12 +115,12 @@ void testZoom(double zoomFactor, int const *iExpectedBatchSizes, int const *iExp
 
       // size represents ZoomAccumulator::fBatchSizes[ZoomAccumulator::fBatchSizeIdx]
       int size = iExpectedBatchSizes[batchIndex];
-      double max = 0;
+      float max = 0;
 
       // accumulating all the elements in the array
       for(int j = 0; j < batchSizeInSamples; j++)
       {
-        TSample s = -1.0;
+        float s = -1.0;
         bool complete = accumulator.accumulate(elements[j], s);
         max = std::max(max, elements[j]);
         size--;
@@ -146,9 +150,9 @@ void testZoom(double zoomFactor, int const *iExpectedBatchSizes, int const *iExp
 TEST(ZoomTest, Zoom2x)
 {
   std::default_random_engine generator;
-  std::uniform_real_distribution<double> distribution(0.0,1.0);
+  std::uniform_real_distribution<float> distribution(0.0,1.0);
 
-  Zoom<10> zoom;
+  Zoom<10, float> zoom;
 
   zoom.setZoomFactor(2.0);
 
@@ -163,12 +167,12 @@ TEST(ZoomTest, Zoom2x)
 
   for(int i = 0; i < 25; i++)
   {
-    TSample s = -1.0;
-    double s1 = distribution(generator);
+    float s = -1.0;
+    float s1 = distribution(generator);
     ASSERT_FALSE(accumulator.accumulate(s1, s));
     ASSERT_EQ(-1.0, s); // unchanged
 
-    double s2 = distribution(generator);
+    float s2 = distribution(generator);
     ASSERT_TRUE(accumulator.accumulate(s2, s));
 
     ASSERT_EQ(std::max(s1,s2), s);
@@ -213,6 +217,7 @@ public:
   {
     fWindow = new ZoomWindow(VISIBLE_WINDOW_SIZE, BUFFER_SIZE);
     fBuffer.init(0);
+    fHistory.init(0);
     fZoomBuffer.init(0);
 
     auto seed = std::chrono::system_clock::now().time_since_epoch().count();
@@ -221,13 +226,14 @@ public:
 
     for(int i = 0; i < BUFFER_SIZE; i++)
     {
-      auto sample = distribution(generator);
+      auto sample = toHistorySample(distribution(generator));
       fBuffer.push(sample);
+      fHistory.push(sample);
       fReferenceBuffer[i] = sample;
     }
   }
 
-  CircularBuffer<TSample> computeReferenceBuffer(double iZoomFactor)
+  CircularBuffer<THistorySample> computeReferenceBuffer(double iZoomFactor)
   {
     ZoomWindow z(VISIBLE_WINDOW_SIZE, BUFFER_SIZE);
     z.__setRawZoomFactor(iZoomFactor);
@@ -239,18 +245,18 @@ public:
     int offset;
     auto accumulator = zoom.getAccumulatorFromIndex(idx, offset);
 
-    std::vector<TSample> buffer{};
+    std::vector<THistorySample> buffer{};
 
     while(offset < 0)
     {
-      TSample value;
+      THistorySample value;
       if(accumulator.accumulate(fBuffer.getAt(offset), value))
         buffer.push_back(value);
       offset++;
     }
 
-    CircularBuffer<TSample> res(static_cast<int>(buffer.size()));
-    for(double i : buffer)
+    CircularBuffer<THistorySample> res(static_cast<int>(buffer.size()));
+    for(auto i : buffer)
     {
       res.push(i);
     }
@@ -258,6 +264,14 @@ public:
   }
 
 
+  // computeZoomWindow (with fHistory) in one step
+  TZoom::MaxAccumulator computeZoomWindow(ZoomWindow::ComputedWindow &ioComputedWindow)
+  {
+    auto pendingPoints = fWindow->beginZoomWindow(fZoomBuffer, ioComputedWindow, fZoomBuffer);
+    fWindow->computeZoomWindow(fHistory, pendingPoints, pendingPoints.getNumPoints(), 0, fZoomBuffer);
+    return fWindow->endZoomWindow(pendingPoints, ioComputedWindow);
+  }
+
   void checkBuffer()
   {
     for(int i = 0; i < BUFFER_SIZE; i++)
@@ -266,7 +280,7 @@ public:
     }
   }
 
-  void checkZoomBuffer(TSample iExpectedZoomBuffer[VISIBLE_WINDOW_SIZE])
+  void checkZoomBuffer(THistorySample iExpectedZoomBuffer[VISIBLE_WINDOW_SIZE])
   {
     for(int i = 0; i < VISIBLE_WINDOW_SIZE; i++)
     {
@@ -290,9 +304,11 @@ public:
   }
 
   ZoomWindow *fWindow{nullptr};
-  CircularBuffer<TSample> fBuffer{BUFFER_SIZE};
-  CircularBuffer<TSample> fZoomBuffer{VISIBLE_WINDOW_SIZE};
-  TSample fReferenceBuffer[BUFFER_SIZE]{};
+  CircularBuffer<THistorySample> fBuffer{BUFFER_SIZE};
+  // same entries as fBuffer (the full resolution covers the whole buffer so the zoom is exact)
+  TieredHistory<THistorySample> fHistory{BUFFER_SIZE, BUFFER_SIZE, 4};
+  CircularBuffer<THistorySample> fZoomBuffer{VISIBLE_WINDOW_SIZE};
+  THistorySample fReferenceBuffer[BUFFER_SIZE]{};
 };
 
 // ZoomWindowTest - SetWindowOffsetNoZoom)
@@ -305,8 +321,8 @@ TEST_F(ZoomWindowTest, SetWindowOffsetNoZoom)
   ASSERT_EQ(fWindow->__getMinWindowOffset(), -BUFFER_SIZE + VISIBLE_WINDOW_SIZE - 1);
   ASSERT_EQ(fWindow->__getWindowOffset(), -1);
 
-  TSample expectedZoomBuffer[VISIBLE_WINDOW_SIZE];
-  fWindow->computeZoomWindow(fBuffer, fZoomBuffer);
+  THistorySample expectedZoomBuffer[VISIBLE_WINDOW_SIZE];
+  computeReferenceZoomWindow(*fWindow, fBuffer, fZoomBuffer);
 
   // calling computeZoomWindow should not affect buffer
   checkBuffer();
@@ -324,7 +340,7 @@ TEST_F(ZoomWindowTest, SetWindowOffsetNoZoom)
     ASSERT_EQ(fWindow->__getWindowOffset(), windowOffset);
 
     // we compute the new zoom window
-    fWindow->computeZoomWindow(fBuffer, fZoomBuffer);
+    computeReferenceZoomWindow(*fWindow, fBuffer, fZoomBuffer);
 
     // we make sure it is the right one
     fBuffer.copyToBuffer(bufferIndex, expectedZoomBuffer, VISIBLE_WINDOW_SIZE);
@@ -335,11 +351,11 @@ TEST_F(ZoomWindowTest, SetWindowOffsetNoZoom)
 // ZoomWindowTest - SetWindowOffset2xZoom) Live View test
 TEST_F(ZoomWindowTest, SetWindowOffset2xZoom)
 {
-  TSample expectedZoomBuffer[VISIBLE_WINDOW_SIZE];
+  THistorySample expectedZoomBuffer[VISIBLE_WINDOW_SIZE];
 
   fWindow->__setRawZoomFactor(2.0);
 
-  CircularBuffer<TSample> referenceBuffer = computeReferenceBuffer(2.0);
+  CircularBuffer<THistorySample> referenceBuffer = computeReferenceBuffer(2.0);
 
   auto zoomedBufferSize = referenceBuffer.getSize();
 
@@ -354,7 +370,7 @@ TEST_F(ZoomWindowTest, SetWindowOffset2xZoom)
   ASSERT_EQ(fWindow->__getWindowOffset(), -1);
 
   // we compute the new zoom window
-  fWindow->computeZoomWindow(fBuffer, fZoomBuffer);
+  computeReferenceZoomWindow(*fWindow, fBuffer, fZoomBuffer);
   referenceBuffer.copyToBuffer(-VISIBLE_WINDOW_SIZE, expectedZoomBuffer, VISIBLE_WINDOW_SIZE);
   checkZoomBuffer(expectedZoomBuffer);
 
@@ -367,7 +383,7 @@ TEST_F(ZoomWindowTest, SetWindowOffset2xZoom)
     ASSERT_EQ(fWindow->__getWindowOffset(), windowOffset);
 
     // we compute the new zoom window
-    fWindow->computeZoomWindow(fBuffer, fZoomBuffer);
+    computeReferenceZoomWindow(*fWindow, fBuffer, fZoomBuffer);
 
     // we make sure it is the right one
     referenceBuffer.copyToBuffer(bufferIndex, expectedZoomBuffer, VISIBLE_WINDOW_SIZE);
@@ -384,11 +400,11 @@ void testSetWindowOffsetWithZoom(double iZoomFactor, ZoomWindowTest *iTest)
 {
   ASSERT_EQ(-1, iTest->fWindow->__getWindowOffset());
 
-  TSample expectedZoomBuffer[ZoomWindowTest::VISIBLE_WINDOW_SIZE];
+  THistorySample expectedZoomBuffer[ZoomWindowTest::VISIBLE_WINDOW_SIZE];
 
   iTest->fWindow->__setRawZoomFactor(iZoomFactor);
 
-  CircularBuffer<TSample> referenceBuffer = iTest->computeReferenceBuffer(iZoomFactor);
+  CircularBuffer<THistorySample> referenceBuffer = iTest->computeReferenceBuffer(iZoomFactor);
 
   auto zoomedBufferSize = referenceBuffer.getSize();
 
@@ -399,7 +415,7 @@ void testSetWindowOffsetWithZoom(double iZoomFactor, ZoomWindowTest *iTest)
   ASSERT_EQ(iTest->fWindow->__getWindowOffset(), -1);
 
   // we compute the new zoom window
-  iTest->fWindow->computeZoomWindow(iTest->fBuffer, iTest->fZoomBuffer);
+  computeReferenceZoomWindow(*iTest->fWindow, iTest->fBuffer, iTest->fZoomBuffer);
   referenceBuffer.copyToBuffer(-ZoomWindowTest::VISIBLE_WINDOW_SIZE, expectedZoomBuffer, ZoomWindowTest::VISIBLE_WINDOW_SIZE);
   iTest->checkZoomBuffer(expectedZoomBuffer);
 
@@ -412,7 +428,7 @@ void testSetWindowOffsetWithZoom(double iZoomFactor, ZoomWindowTest *iTest)
     ASSERT_EQ(iTest->fWindow->__getWindowOffset(), windowOffset);
 
     // we compute the new zoom window
-    iTest->fWindow->computeZoomWindow(iTest->fBuffer, iTest->fZoomBuffer);
+    computeReferenceZoomWindow(*iTest->fWindow, iTest->fBuffer, iTest->fZoomBuffer);
 
     // we make sure it is the right one
     referenceBuffer.copyToBuffer(bufferIndex, expectedZoomBuffer, ZoomWindowTest::VISIBLE_WINDOW_SIZE);
@@ -434,6 +450,296 @@ TEST_F(ZoomWindowTest, SetWindowOffsetWithZoom)
   testSetWindowOffsetWithZoom(fWindow->__getMaxZoomFactor(), this);
 }
 
+/**
+ * This test checks that computing the zoom window with the (tiered) history produces the exact same result as
+ * accumulating every sample, for every possible offset
+ */
+void testComputeZoomWindowWithHistory(double iZoomFactor, ZoomWindowTest *iTest)
+{
+  iTest->fWindow->__setRawZoomFactor(iZoomFactor);
+
+  CircularBuffer<THistorySample> expectedZoomBuffer(ZoomWindowTest::VISIBLE_WINDOW_SIZE);
+  expectedZoomBuffer.init(0);
+
+  for(int windowOffset = iTest->fWindow->__getMinWindowOffset(); windowOffset <= -1; windowOffset++)
+  {
+    iTest->fWindow->__setRawWindowOffset(windowOffset);
+
+    auto expectedAccumulator = computeReferenceZoomWindow(*iTest->fWindow, iTest->fBuffer, expectedZoomBuffer);
+    ZoomWindow::ComputedWindow computedWindow{};
+    auto accumulator = iTest->computeZoomWindow(computedWindow);
+
+    ASSERT_EQ(expectedAccumulator.getBatchSizeIdx(), accumulator.getBatchSizeIdx());
+    ASSERT_EQ(expectedAccumulator.getAccumulatedSamples(), accumulator.getAccumulatedSamples());
+
+    for(int i = 0; i < ZoomWindowTest::VISIBLE_WINDOW_SIZE; i++)
+    {
+      ASSERT_EQ(expectedZoomBuffer.getAt(i), iTest->fZoomBuffer.getAt(i)) << " at index " << i << " for zoom " << iZoomFactor;
+    }
+  }
+}
+
+// ZoomWindowTest - ComputeZoomWindowWithHistory
+TEST_F(ZoomWindowTest, ComputeZoomWindowWithHistory)
+{
+  testComputeZoomWindowWithHistory(1.0, this);
+  testComputeZoomWindowWithHistory(1.3, this);
+  testComputeZoomWindowWithHistory(2.0, this);
+  testComputeZoomWindowWithHistory(2.3, this);
+  testComputeZoomWindowWithHistory(3.4, this);
+  testComputeZoomWindowWithHistory(3.9, this);
+  testComputeZoomWindowWithHistory(fWindow->__getMaxZoomFactor(), this);
+}
+
+// ZoomWindowTest - IncrementalScroll (random scroll sequences must give the same result as a full computation)
+TEST_F(ZoomWindowTest, IncrementalScroll)
+{
+  std::default_random_engine generator;
+
+  CircularBuffer<THistorySample> expectedZoomBuffer(VISIBLE_WINDOW_SIZE);
+  expectedZoomBuffer.init(0);
+
+  ZoomWindow::ComputedWindow computedWindow{};
+  ASSERT_FALSE(computedWindow.isValid());
+
+  for(double zoomFactor : {1.0, 1.3, 2.0, 2.5, 3.4, fWindow->__getMaxZoomFactor(), 1.0})
+  {
+    // changing the zoom resets the offset to -1 and must trigger a full computation
+    fWindow->__setRawZoomFactor(zoomFactor);
+
+    std::uniform_int_distribution<int> smallShift(-5, 5);
+    std::uniform_int_distribution<int> anyOffset(fWindow->__getMinWindowOffset(), MAX_WINDOW_OFFSET);
+
+    for(int k = 0; k < 500; k++)
+    {
+      int windowOffset = k % 10 == 0 ? anyOffset(generator) : fWindow->__getWindowOffset() + smallShift(generator);
+      windowOffset = Utils::clamp(windowOffset, fWindow->__getMinWindowOffset(), MAX_WINDOW_OFFSET);
+      fWindow->__setRawWindowOffset(windowOffset);
+
+      auto expectedAccumulator = computeReferenceZoomWindow(*fWindow, fBuffer, expectedZoomBuffer);
+      auto accumulator = computeZoomWindow(computedWindow);
+
+      ASSERT_TRUE(computedWindow.isValid());
+      ASSERT_EQ(expectedAccumulator.getBatchSizeIdx(), accumulator.getBatchSizeIdx());
+
+      for(int i = 0; i < VISIBLE_WINDOW_SIZE; i++)
+      {
+        ASSERT_EQ(expectedZoomBuffer.getAt(i), fZoomBuffer.getAt(i))
+                  << " at index " << i << " for zoom " << zoomFactor << " and offset " << windowOffset;
+      }
+    }
+  }
+
+  // modifying the zoomed buffer outside of computeZoomWindow requires invalidation
+  fZoomBuffer.push(toHistorySample(2.0)); // never pushed in the history
+  computedWindow.invalidate();
+  ASSERT_FALSE(computedWindow.isValid());
+  computeReferenceZoomWindow(*fWindow, fBuffer, expectedZoomBuffer);
+  computeZoomWindow(computedWindow);
+  for(int i = 0; i < VISIBLE_WINDOW_SIZE; i++)
+  {
+    ASSERT_EQ(expectedZoomBuffer.getAt(i), fZoomBuffer.getAt(i)) << " at index " << i;
+  }
+}
+
+// ZoomWindowTest - ComputeInSteps (computation spread over several steps while entries keep being pushed must
+// give the same result as a full computation at the start followed by accumulating the pushed entries)
+TEST_F(ZoomWindowTest, ComputeInSteps)
+{
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(0.0,1.0);
+
+  CircularBuffer<THistorySample> expectedZoomBuffer(VISIBLE_WINDOW_SIZE);
+  CircularBuffer<THistorySample> pendingZoomBuffer(VISIBLE_WINDOW_SIZE);
+  pendingZoomBuffer.init(0);
+
+  for(double zoomFactor : {1.0, 1.3, 2.0, 2.5})
+  {
+    fWindow->__setRawZoomFactor(zoomFactor);
+
+    for(int maxNumPoints : {1, 4, 7, VISIBLE_WINDOW_SIZE})
+    {
+      expectedZoomBuffer.init(0);
+      auto expectedAccumulator = computeReferenceZoomWindow(*fWindow, fBuffer, expectedZoomBuffer);
+
+      ZoomWindow::ComputedWindow computedWindow{};
+      auto pendingPoints = fWindow->beginZoomWindow(fZoomBuffer, computedWindow, pendingZoomBuffer);
+      ASSERT_EQ(VISIBLE_WINDOW_SIZE, pendingPoints.getNumPoints());
+
+      // one entry is pushed in between each step
+      int pushCount = 0;
+      while(!pendingPoints.isDone())
+      {
+        fWindow->computeZoomWindow(fHistory, pendingPoints, maxNumPoints, pushCount, pendingZoomBuffer);
+
+        auto sample = toHistorySample(distribution(generator));
+        fBuffer.push(sample);
+        fHistory.push(sample);
+        pushCount++;
+
+        THistorySample zoomedMax;
+        if(expectedAccumulator.accumulate(sample, zoomedMax))
+          expectedZoomBuffer.push(zoomedMax);
+      }
+
+      auto accumulator = fWindow->endZoomWindow(pendingPoints, computedWindow);
+      ASSERT_TRUE(computedWindow.isValid());
+
+      for(int i = -pushCount; i < 0; i++)
+      {
+        THistorySample zoomedMax;
+        if(accumulator.accumulate(fBuffer.getAt(i), zoomedMax))
+          pendingZoomBuffer.push(zoomedMax);
+      }
+
+      ASSERT_EQ(expectedAccumulator.getBatchSizeIdx(), accumulator.getBatchSizeIdx());
+
+      for(int i = 0; i < VISIBLE_WINDOW_SIZE; i++)
+      {
+        ASSERT_EQ(expectedZoomBuffer.getAt(i), pendingZoomBuffer.getAt(i))
+                  << " at index " << i << " for zoom " << zoomFactor << " and step " << maxNumPoints;
+      }
+    }
+  }
+}
+
+// ZoomWindowTest - ComputeBufferRange (every point covers exactly the entries used to compute it)
+TEST_F(ZoomWindowTest, ComputeBufferRange)
+{
+  for(double zoomFactor : {1.0, 1.3, 2.0, 3.4, fWindow->__getMaxZoomFactor()})
+  {
+    fWindow->__setRawZoomFactor(zoomFactor);
+
+    for(int windowOffset : {MAX_WINDOW_OFFSET, std::max(-7, fWindow->__getMinWindowOffset()), fWindow->__getMinWindowOffset()})
+    {
+      fWindow->__setRawWindowOffset(windowOffset);
+      computeReferenceZoomWindow(*fWindow, fBuffer, fZoomBuffer);
+
+      int previousToOffset = 0;
+      for(int i = 0; i < VISIBLE_WINDOW_SIZE; i++)
+      {
+        int fromOffset, toOffset;
+        fWindow->computeBufferRange(i, i, fromOffset, toOffset);
+
+        ASSERT_TRUE(fromOffset >= -BUFFER_SIZE && fromOffset < toOffset && toOffset <= 0);
+        if(i > 0)
+        {
+          ASSERT_EQ(previousToOffset, fromOffset);
+        }
+        ASSERT_EQ(fZoomBuffer.getAt(i), fHistory.getMax(fromOffset, toOffset)) << " at index " << i;
+
+        previousToOffset = toOffset;
+      }
+
+      // full window
+      int fromOffset, toOffset;
+      fWindow->computeBufferRange(0, VISIBLE_WINDOW_SIZE - 1, fromOffset, toOffset);
+      ASSERT_EQ(previousToOffset, toOffset);
+      if(windowOffset == MAX_WINDOW_OFFSET)
+      {
+        ASSERT_EQ(0, toOffset);
+      }
+    }
+  }
+}
+
+// ZoomWindowTest - ComputeZoomWindowWithTieredHistory (every point is at least the max of the entries it covers and
+// at most the max including the tier entries overlapping it)
+TEST_F(ZoomWindowTest, ComputeZoomWindowWithTieredHistory)
+{
+  constexpr int FULL_RESOLUTION_SIZE = 20;
+  constexpr int HISTORY_SIZE = 1000;
+
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(0.0,1.0);
+
+  TieredHistory<THistorySample> history(FULL_RESOLUTION_SIZE, HISTORY_SIZE, 4);
+  std::vector<THistorySample> entries{};
+  for(int i = 0; i < 1500; i++)
+  {
+    entries.emplace_back(toHistorySample(distribution(generator)));
+    history.push(entries.back());
+  }
+
+  auto bruteForceMax = [&entries] (int iFromOffset, int iToOffset) {
+    THistorySample max = 0;
+    for(int i = std::max(iFromOffset, -HISTORY_SIZE); i < std::min(iToOffset, 0); i++)
+      max = std::max(max, entries[entries.size() + i]);
+    return max;
+  };
+
+  ZoomWindow window(VISIBLE_WINDOW_SIZE, HISTORY_SIZE);
+
+  for(double zoomFactor : {1.0, 2.5, 7.0, 20.0, window.__getMaxZoomFactor()})
+  {
+    window.__setRawZoomFactor(zoomFactor);
+
+    int tier = window.getHistoryTier(history);
+    int resolution = history.getTierResolution(history.getTierCount() - 1);
+
+    for(int windowOffset : {MAX_WINDOW_OFFSET, window.__getMinWindowOffset()})
+    {
+      window.__setRawWindowOffset(windowOffset);
+
+      ZoomWindow::ComputedWindow computedWindow{};
+      auto pendingPoints = window.beginZoomWindow(fZoomBuffer, computedWindow, fZoomBuffer);
+      window.computeZoomWindow(history, pendingPoints, VISIBLE_WINDOW_SIZE, 0, fZoomBuffer);
+      window.endZoomWindow(pendingPoints, computedWindow);
+
+      for(int i = 0; i < VISIBLE_WINDOW_SIZE; i++)
+      {
+        int fromOffset, toOffset;
+        window.computeBufferRange(i, i, fromOffset, toOffset);
+
+        if(tier == 0 && fromOffset >= -FULL_RESOLUTION_SIZE)
+        {
+          ASSERT_EQ(bruteForceMax(fromOffset, toOffset), fZoomBuffer.getAt(i)) << " at index " << i;
+        }
+        else
+        {
+          ASSERT_LE(bruteForceMax(fromOffset, toOffset), fZoomBuffer.getAt(i)) << " at index " << i;
+          ASSERT_GE(bruteForceMax(fromOffset - resolution, toOffset + resolution), fZoomBuffer.getAt(i)) << " at index " << i;
+        }
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////
+// MaxIndex tests
+///////////////////////////////////////////
+
+// MaxIndexTest - GetMax (compares with brute force for all ranges while the buffer keeps wrapping around)
+TEST(MaxIndexTest, GetMax)
+{
+  constexpr int BUFFER_SIZE = 37;
+
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> distribution(0.0,1.0);
+
+  CircularBuffer<THistorySample> buffer{BUFFER_SIZE};
+  buffer.init(0);
+  MaxIndex<THistorySample> maxIndex{BUFFER_SIZE};
+  maxIndex.init(0);
+
+  for(int k = 0; k < 5 * BUFFER_SIZE; k++)
+  {
+    for(int from = -BUFFER_SIZE; from <= 0; from++)
+    {
+      THistorySample expectedMax = 0;
+      for(int to = from; to <= 0; to++)
+      {
+        ASSERT_EQ(expectedMax, maxIndex.getMax(buffer, from, to)) << "[" << from << "," << to << "[ after " << k;
+        if(to < 0)
+          expectedMax = std::max(expectedMax, buffer.getAt(to));
+      }
+    }
+
+    buffer.push(toHistorySample(distribution(generator)));
+    maxIndex.onPush(buffer);
+  }
+}
+
 // ZoomWindowTest - SetZoomFactor)
 TEST_F(ZoomWindowTest, SetZoomFactor)
 {
@@ -442,7 +748,7 @@ TEST_F(ZoomWindowTest, SetZoomFactor)
 //
 //  constexpr int MAX_ZOOM_FACTOR = BUFFER_SIZE / VISIBLE_WINDOW_SIZE;
 //
-//  auto copyBuffer = [] (CircularBuffer<TSample> const &iBuffer, TSample oBuffer[VISIBLE_WINDOW_SIZE]) -> void {
+//  auto copyBuffer = [] (CircularBuffer<THistorySample> const &iBuffer, THistorySample oBuffer[VISIBLE_WINDOW_SIZE]) -> void {
 //    for(int i = 0; i < VISIBLE_WINDOW_SIZE; i++)
 //    {
 //      oBuffer[VISIBLE_WINDOW_SIZE - 1 - i] = iBuffer.getAt(-1 - i);
@@ -460,14 +766,14 @@ TEST_F(ZoomWindowTest, SetZoomFactor)
 //  std::default_random_engine generator;
 //  std::uniform_real_distribution<double> distribution(0.0,1.0);
 //
-//  TSample referenceBuffer[BUFFER_SIZE];
-//  TSample resultBuffer[VISIBLE_WINDOW_SIZE];
+//  THistorySample referenceBuffer[BUFFER_SIZE];
+//  THistorySample resultBuffer[VISIBLE_WINDOW_SIZE];
 //
 //
-//  CircularBuffer<TSample> buffer(BUFFER_SIZE);
+//  CircularBuffer<THistorySample> buffer(BUFFER_SIZE);
 //  for(int i = 0; i < BUFFER_SIZE; i++)
 //  {
-//    auto sample = distribution(generator);
+//    auto sample = toHistorySample(distribution(generator));
 //    sample = i;
 //    buffer.push(sample);
 //    referenceBuffer[i] = sample;
@@ -475,16 +781,16 @@ TEST_F(ZoomWindowTest, SetZoomFactor)
 //
 //  Zoom<10> zoom;
 //  auto accumulator = zoom.setZoomFactor(2.0);
-//  std::vector<TSample> referenceBuffer2x{};
+//  std::vector<THistorySample> referenceBuffer2x{};
 //
-//  TSample max;
+//  THistorySample max;
 //  for(int i = 0; i < BUFFER_SIZE; i++)
 //  {
 //    if(accumulator.accumulate(referenceBuffer[i], max))
 //      referenceBuffer2x.push_back(max);
 //  }
 //
-//  CircularBuffer<TSample> zoomBuffer(VISIBLE_WINDOW_SIZE);
+//  CircularBuffer<THistorySample> zoomBuffer(VISIBLE_WINDOW_SIZE);
 //
 //  // we are all the way to the right => should be the end of the buffer
 //  window.computeZoomWindow(buffer, zoomBuffer);
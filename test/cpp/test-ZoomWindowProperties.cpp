@@ -0,0 +1,867 @@
+#include <src/cpp/ZoomWindow.h>
+#include "ZoomWindowReference.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pongasoft {
+namespace VST {
+namespace Test {
+
+using namespace pongasoft::VST::Common;
+
+///////////////////////////////////////////
+// ZoomWindow property based tests
+//
+// Random cases (zoom window and history sizes, history, sequence of operations on the window) are run and after
+// each operation everything the window computes is compared to a naive reference: the definition of the zoom
+// (which entries each point represents) and brute force max. The cases run in parallel and a failing case is shrunk
+// to a minimal reproducer which is printed (with the seed to run it again).
+//
+// The number of cases and the seed can be changed to run a lot more cases (after changing ZoomWindow for example):
+//   VAC6_PROPERTY_CASES=5000000 VAC6_PROPERTY_SEED=$RANDOM vac6_test --gtest_filter='ZoomWindowPropertiesTest.*'
+///////////////////////////////////////////
+
+namespace {
+
+constexpr int BATCH_SIZE = 10; // TZoom
+
+//------------------------------------------------------------------------
+// The naive reference
+//------------------------------------------------------------------------
+
+/**
+ * The zoom point iIdx (negative, -1 being the most recent point) represents the entries [oFrom, oTo[ (negative
+ * offsets): every BATCH_SIZE points represent iZoom (= zoom factor * BATCH_SIZE) entries and the point b (0 being the
+ * oldest) of a batch represents the entries [b * iZoom / BATCH_SIZE, (b + 1) * iZoom / BATCH_SIZE[ of the batch.
+ */
+void naivePointRange(int iZoom, int iIdx, int &oFrom, int &oTo)
+{
+  int n = -iIdx - 1;
+  int batchStart = -(n / BATCH_SIZE + 1) * iZoom;
+  int b = BATCH_SIZE - 1 - n % BATCH_SIZE;
+  oFrom = batchStart + b * iZoom / BATCH_SIZE;
+  oTo = batchStart + (b + 1) * iZoom / BATCH_SIZE;
+}
+
+// the zoom point representing the entry at iOffset (negative)
+int naivePointIndex(int iZoom, int iOffset)
+{
+  for(int idx = -1; ; idx--)
+  {
+    int from, to;
+    naivePointRange(iZoom, idx, from, to);
+    if(iOffset >= from)
+      return idx;
+  }
+}
+
+// max of the entries [iFrom, iTo[ (negative offsets from the most recent entry, older entries being 0)
+THistorySample naiveMax(std::vector<THistorySample> const &iEntries, int iFrom, int iTo)
+{
+  auto size = static_cast<int>(iEntries.size());
+  THistorySample max = 0;
+  for(int i = std::max(iFrom, -size); i < std::min(iTo, 0); i++)
+    max = std::max(max, iEntries[size + i]);
+  return max;
+}
+
+//------------------------------------------------------------------------
+// A case: sizes, history and operations (see generateCase)
+//------------------------------------------------------------------------
+struct Op
+{
+  enum class Type
+  {
+    kZoom,          // setZoomFactor(fValue, fCount (offset from left of screen), histories)
+    kRawZoom,       // __setRawZoomFactor(1 + fValue * (max zoom factor - 1))
+    kScroll,        // __setRawWindowOffset(-1 - fCount) (clamped)
+    kScrollPercent, // setWindowOffset(fValue)
+    kPush,          // pushes fEntries
+    kSteps          // computes the window fCount points at a time, pushing fStep entries (from fEntries) in between
+  };
+
+  Type fType;
+  double fValue{0};
+  int fCount{0};
+  int fStep{0};
+  std::vector<double> fEntries{};
+};
+
+struct Case
+{
+  uint64_t fSeed{0};
+  int fVisibleWindowSize{1};
+  int fBufferSize{1};
+  int fHistorySize{1};
+  int fFullResolutionSize{2};
+  int fTierFactor{2};
+  std::vector<double> fEntries{}; // pushed before the operations (oldest first)
+  std::vector<Op> fOps{};
+};
+
+std::ostream &operator<<(std::ostream &oStream, std::vector<double> const &iEntries)
+{
+  oStream << "{";
+  for(size_t i = 0; i < iEntries.size(); i++)
+    oStream << (i > 0 ? ", " : "") << iEntries[i];
+  return oStream << "}";
+}
+
+std::ostream &operator<<(std::ostream &oStream, Op const &iOp)
+{
+  switch(iOp.fType)
+  {
+    case Op::Type::kZoom:
+      return oStream << "Zoom(" << iOp.fValue << ", offsetFromLeftOfScreen=" << iOp.fCount << ")";
+    case Op::Type::kRawZoom:
+      return oStream << "RawZoom(" << iOp.fValue << " of the range)";
+    case Op::Type::kScroll:
+      return oStream << "Scroll(" << iOp.fCount << " points from the right)";
+    case Op::Type::kScrollPercent:
+      return oStream << "ScrollPercent(" << iOp.fValue << ")";
+    case Op::Type::kPush:
+      return oStream << "Push(" << iOp.fEntries << ")";
+    case Op::Type::kSteps:
+      return oStream << "Steps(" << iOp.fCount << " points per step, " << iOp.fStep << " pushes per step from "
+                     << iOp.fEntries << ")";
+  }
+  return oStream;
+}
+
+std::ostream &operator<<(std::ostream &oStream, Case const &iCase)
+{
+  oStream << "seed=" << iCase.fSeed
+          << " visibleWindowSize=" << iCase.fVisibleWindowSize
+          << " bufferSize=" << iCase.fBufferSize
+          << " historySize=" << iCase.fHistorySize
+          << " fullResolutionSize=" << iCase.fFullResolutionSize
+          << " tierFactor=" << iCase.fTierFactor
+          << "\n  entries=" << iCase.fEntries;
+  for(size_t i = 0; i < iCase.fOps.size(); i++)
+    oStream << "\n  op #" << i << ": " << iCase.fOps[i];
+  return oStream;
+}
+
+// random entries (few distinct levels => lots of ties, 0 included)
+std::vector<double> generateEntries(std::mt19937_64 &ioRandom, int iCount)
+{
+  static constexpr int kLevels[] = {1, 2, 4, 1000};
+  int levels = kLevels[ioRandom() % 4];
+
+  std::vector<double> entries(static_cast<size_t>(iCount));
+  for(auto &entry: entries)
+    entry = static_cast<double>(ioRandom() % (levels + 1)) / levels;
+  return entries;
+}
+
+// generateCase (fully determined by iSeed)
+Case generateCase(uint64_t iSeed)
+{
+  std::mt19937_64 random{iSeed};
+  auto uniform = [&random](int iMin, int iMax) { return iMin + static_cast<int>(random() % (iMax - iMin + 1)); };
+  auto percent = [&random, &uniform]() {
+    // the bounds are special cases
+    switch(uniform(0, 7))
+    {
+      case 0: return 0.0;
+      case 1: return 1.0;
+      default: return std::uniform_real_distribution<double>{0, 1}(random);
+    }
+  };
+
+  Case c{};
+  c.fSeed = iSeed;
+  c.fVisibleWindowSize = uniform(0, 3) == 0 ? uniform(1, 4) : uniform(1, 24);
+  c.fBufferSize = std::min(300, c.fVisibleWindowSize * uniform(1, 40) + uniform(0, c.fVisibleWindowSize));
+  c.fHistorySize = uniform(0, 1) == 0 ? c.fBufferSize : uniform(1, c.fBufferSize);
+  c.fFullResolutionSize = uniform(2, std::max(2, c.fHistorySize));
+  c.fTierFactor = uniform(2, std::min(c.fFullResolutionSize, 6));
+  c.fEntries = generateEntries(random, uniform(0, 2 * c.fBufferSize));
+
+  int numOps = uniform(1, 8);
+  for(int i = 0; i < numOps; i++)
+  {
+    Op op{static_cast<Op::Type>(uniform(0, 5))};
+    switch(op.fType)
+    {
+      case Op::Type::kZoom:
+        op.fValue = percent();
+        op.fCount = uniform(0, c.fVisibleWindowSize - 1);
+        break;
+      case Op::Type::kRawZoom:
+        op.fValue = percent();
+        break;
+      case Op::Type::kScroll:
+        op.fCount = uniform(0, 3) == 0 ? c.fBufferSize : uniform(0, c.fBufferSize / 4);
+        break;
+      case Op::Type::kScrollPercent:
+        op.fValue = percent();
+        break;
+      case Op::Type::kPush:
+        op.fEntries = generateEntries(random, uniform(1, c.fBufferSize));
+        break;
+      case Op::Type::kSteps:
+        op.fCount = uniform(1, c.fVisibleWindowSize);
+        op.fStep = uniform(0, 3);
+        op.fEntries = generateEntries(random, uniform(1, 8));
+        break;
+    }
+    c.fOps.emplace_back(std::move(op));
+  }
+
+  return c;
+}
+
+//------------------------------------------------------------------------
+// Engine: the zoom window and the histories of a case
+//------------------------------------------------------------------------
+struct Engine
+{
+  // the sizes are made consistent so that any case (including a shrunk one) is valid
+  explicit Engine(Case const &iCase) :
+    fVisibleWindowSize{std::max(iCase.fVisibleWindowSize, 1)},
+    fBufferSize{std::max(iCase.fBufferSize, fVisibleWindowSize)},
+    fHistorySize{std::min(std::max(iCase.fHistorySize, 1), fBufferSize)},
+    fFullResolutionSize{std::max(iCase.fFullResolutionSize, 2)},
+    fWindow{fVisibleWindowSize, fBufferSize},
+    fBuffer{fBufferSize},
+    fFullHistory{std::max(fBufferSize, 2), fBufferSize, 2},
+    fHistory{fFullResolutionSize, fHistorySize, std::min(std::max(iCase.fTierFactor, 2), fFullResolutionSize)},
+    fZoomBuffer{fVisibleWindowSize},
+    fIncrementalZoomBuffer{fVisibleWindowSize}
+  {
+    fBuffer.init(0);
+    fZoomBuffer.init(0);
+    fIncrementalZoomBuffer.init(0);
+    fResolution = fHistory.getTierResolution(fHistory.getTierCount() - 1);
+
+    for(auto entry: iCase.fEntries)
+      push(entry);
+  }
+
+  void push(double iEntry)
+  {
+    auto entry = toHistorySample(iEntry);
+    fEntries.emplace_back(entry);
+    fBuffer.push(entry);
+    fFullHistory.push(entry);
+    fHistory.push(entry);
+    fComputedWindow.invalidate();
+  }
+
+  // the zoom (zoom factor * BATCH_SIZE) for a zoom factor
+  static int toZoom(double iZoomFactor) { return static_cast<int>(iZoomFactor * BATCH_SIZE); }
+
+  // zoom point index of the point at iPosition (0 being the left of the screen)
+  int getIdx(int iPosition) const { return fWindow.__getWindowOffset() - fVisibleWindowSize + 1 + iPosition; }
+
+  /**
+   * The tiered history: at least the max of the entries (clamped to the history), at most the max including the
+   * tier entries overlapping the range, exact with tier 0 at full resolution.
+   *
+   * @return true when exact (oMin == oMax being the max)
+   */
+  bool tieredBounds(int iFrom, int iTo, int iTier, THistorySample &oMin, THistorySample &oMax) const
+  {
+    int from = std::max(iFrom, -fHistorySize);
+    int to = std::max(iTo, from);
+    oMin = naiveMax(fEntries, from, to);
+    oMax = oMin;
+    if(from == to || (iTier == 0 && from >= -fFullResolutionSize))
+      return true;
+    oMax = naiveMax(fEntries, from - fResolution, to + fResolution);
+    return false;
+  }
+
+  int const fVisibleWindowSize;
+  int const fBufferSize;
+  int const fHistorySize;
+  int const fFullResolutionSize;
+
+  int fZoom{BATCH_SIZE};
+  int fResolution{1};
+  std::vector<THistorySample> fEntries{};
+
+  ZoomWindow fWindow;
+  CircularBuffer<THistorySample> fBuffer;
+  TieredHistory<THistorySample> fFullHistory; // full resolution only (exact zoom)
+  TieredHistory<THistorySample> fHistory;
+  CircularBuffer<THistorySample> fZoomBuffer;
+  CircularBuffer<THistorySample> fIncrementalZoomBuffer;
+  ZoomWindow::ComputedWindow fComputedWindow{};
+};
+
+// Property: checks the engine after each operation (returns the error, empty when the property holds)
+using Property = std::function<std::string(Engine &)>;
+
+#define PROPERTY_CHECK(condition, message) \
+  if(!(condition)) { std::ostringstream s{}; s << message; return s.str(); }
+
+/**
+ * Everything the window computes for the current zoom and offset: the range of each point, the zoomed buffer (with
+ * the buffer, the full resolution history, incrementally and with the tiered history) and __findMaxForIndex.
+ */
+std::string checkWindow(Engine &e)
+{
+  auto &window = e.fWindow;
+  int const V = e.fVisibleWindowSize;
+  int const zoom = e.fZoom;
+
+  int windowOffset = window.__getWindowOffset();
+  PROPERTY_CHECK(windowOffset >= window.__getMinWindowOffset() && windowOffset <= MAX_WINDOW_OFFSET,
+                 "window offset " << windowOffset << " out of [" << window.__getMinWindowOffset() << ", -1]");
+
+  // the oldest point the window can show must fit in the buffer
+  int from, to;
+  naivePointRange(zoom, window.__getMinWindowIdx(), from, to);
+  PROPERTY_CHECK(from >= -e.fBufferSize, "min window offset " << window.__getMinWindowOffset()
+                                                              << " shows the entries [" << from << ", " << to << "[");
+
+  std::vector<THistorySample> expected(static_cast<size_t>(V));
+  for(int i = 0; i < V; i++)
+  {
+    naivePointRange(zoom, e.getIdx(i), from, to);
+    int rangeFrom, rangeTo;
+    window.computeBufferRange(i, i, rangeFrom, rangeTo);
+    PROPERTY_CHECK(rangeFrom == from && rangeTo == to, "computeBufferRange(" << i << ") = [" << rangeFrom << ", "
+                                                       << rangeTo << "[, expected [" << from << ", " << to << "[");
+    expected[i] = naiveMax(e.fEntries, from, to);
+  }
+
+  // with the buffer
+  e.fZoomBuffer.init(0);
+  auto accumulator = computeReferenceZoomWindow(window, e.fBuffer, e.fZoomBuffer);
+  for(int i = 0; i < V; i++)
+    PROPERTY_CHECK(e.fZoomBuffer.getAt(i) == expected[i],
+                   "computeReferenceZoomWindow(buffer)[" << i << "] = " << e.fZoomBuffer.getAt(i) << ", expected " << expected[i]);
+
+  // with the full resolution history
+  e.fZoomBuffer.init(0);
+  ZoomWindow::ComputedWindow fullComputedWindow{};
+  auto fullPendingPoints = window.beginZoomWindow(e.fZoomBuffer, fullComputedWindow, e.fZoomBuffer);
+  window.computeZoomWindow(e.fFullHistory, fullPendingPoints, V, 0, e.fZoomBuffer);
+  auto fullAccumulator = window.endZoomWindow(fullPendingPoints, fullComputedWindow);
+  PROPERTY_CHECK(fullAccumulator.getBatchSizeIdx() == accumulator.getBatchSizeIdx(),
+                 "computeZoomWindow(full history) accumulator " << fullAccumulator.getBatchSizeIdx()
+                 << ", expected " << accumulator.getBatchSizeIdx());
+  for(int i = 0; i < V; i++)
+    PROPERTY_CHECK(e.fZoomBuffer.getAt(i) == expected[i],
+                   "computeZoomWindow(full history)[" << i << "] = " << e.fZoomBuffer.getAt(i) << ", expected " << expected[i]);
+
+  // incrementally (from the previous check, if still valid)
+  auto incrementalPendingPoints = window.beginZoomWindow(e.fIncrementalZoomBuffer, e.fComputedWindow, e.fIncrementalZoomBuffer);
+  window.computeZoomWindow(e.fFullHistory, incrementalPendingPoints, V, 0, e.fIncrementalZoomBuffer);
+  auto incrementalAccumulator = window.endZoomWindow(incrementalPendingPoints, e.fComputedWindow);
+  PROPERTY_CHECK(incrementalAccumulator.getBatchSizeIdx() == accumulator.getBatchSizeIdx(),
+                 "computeZoomWindow(incremental) accumulator " << incrementalAccumulator.getBatchSizeIdx()
+                 << ", expected " << accumulator.getBatchSizeIdx());
+  for(int i = 0; i < V; i++)
+    PROPERTY_CHECK(e.fIncrementalZoomBuffer.getAt(i) == expected[i],
+                   "computeZoomWindow(incremental)[" << i << "] = " << e.fIncrementalZoomBuffer.getAt(i)
+                   << ", expected " << expected[i]);
+
+  // with the tiered history
+  int tier = window.getHistoryTier(e.fHistory);
+  ZoomWindow::ComputedWindow computedWindow{};
+  auto pendingPoints = window.beginZoomWindow(e.fZoomBuffer, computedWindow, e.fZoomBuffer);
+  window.computeZoomWindow(e.fHistory, pendingPoints, V, 0, e.fZoomBuffer);
+  window.endZoomWindow(pendingPoints, computedWindow);
+  for(int i = 0; i < V; i++)
+  {
+    naivePointRange(zoom, e.getIdx(i), from, to);
+    THistorySample min, max;
+    e.tieredBounds(from, to, tier, min, max);
+    PROPERTY_CHECK(e.fZoomBuffer.getAt(i) >= min && e.fZoomBuffer.getAt(i) <= max,
+                   "computeZoomWindow(tiered history, tier " << tier << ")[" << i << "] = " << e.fZoomBuffer.getAt(i)
+                   << ", expected in [" << min << ", " << max << "]");
+  }
+
+  // __findMaxForIndex: the (first) entry giving the max of the point
+  for(int i = 0; i < V; i++)
+  {
+    int idx = e.getIdx(i);
+    naivePointRange(zoom, idx, from, to);
+    THistorySample min, max;
+    bool exact = e.tieredBounds(from, to, tier, min, max);
+
+    int maxOffset = 1;
+    auto found = window.__findMaxForIndex(idx, e.fHistory, maxOffset);
+    PROPERTY_CHECK(found >= min && found <= max, "__findMaxForIndex(" << idx << ") = " << found << ", expected in ["
+                                                 << min << ", " << max << "] (tier " << tier << ")");
+
+    if(found == 0)
+    {
+      PROPERTY_CHECK(maxOffset == 1, "__findMaxForIndex(" << idx << ") changed the offset (" << maxOffset
+                                     << ") without max");
+      continue;
+    }
+
+    from = std::max(from, -e.fHistorySize);
+    to = std::max(to, from);
+    PROPERTY_CHECK(maxOffset >= from && maxOffset < to, "__findMaxForIndex(" << idx << ") offset " << maxOffset
+                                                        << " out of [" << from << ", " << to << "[");
+
+    if(exact)
+    {
+      // first entry giving the max
+      int firstOffset = std::max(from, -static_cast<int>(e.fEntries.size()));
+      while(e.fEntries[e.fEntries.size() + firstOffset] != found)
+        firstOffset++;
+      PROPERTY_CHECK(maxOffset == firstOffset, "__findMaxForIndex(" << idx << ") offset " << maxOffset
+                                               << ", expected " << firstOffset);
+    }
+    else
+    {
+      // the tier entry giving the max contains both the offset and the entry
+      PROPERTY_CHECK(naiveMax(e.fEntries, maxOffset - e.fResolution + 1, maxOffset + e.fResolution) >= found,
+                     "__findMaxForIndex(" << idx << ") offset " << maxOffset << " is not within "
+                     << e.fResolution << " entries of the max (" << found << ")");
+    }
+  }
+
+  return {};
+}
+
+/**
+ * Computes the window a few points at a time with entries pushed in between (live view): every point is computed
+ * from the entries it represented when the computation started (the ones pushed out of the buffer being ignored).
+ */
+std::string checkSteps(Engine &e, Op const &iOp)
+{
+  auto &window = e.fWindow;
+  int const V = e.fVisibleWindowSize;
+  int const maxNumPoints = std::max(iOp.fCount, 1);
+  int tier = window.getHistoryTier(e.fHistory);
+
+  CircularBuffer<THistorySample> zoomBuffer{V};
+  CircularBuffer<THistorySample> historyZoomBuffer{V};
+  ZoomWindow::ComputedWindow computedWindow{}, historyComputedWindow{};
+  auto pendingPoints = window.beginZoomWindow(zoomBuffer, computedWindow, zoomBuffer);
+  auto historyPendingPoints = window.beginZoomWindow(historyZoomBuffer, historyComputedWindow, historyZoomBuffer);
+  PROPERTY_CHECK(pendingPoints.getNumPoints() == V, "beginZoomWindow => " << pendingPoints.getNumPoints() << " points");
+
+  int pushCount = 0;
+  size_t nextEntry = 0;
+  while(!pendingPoints.isDone())
+  {
+    int position = V - pendingPoints.getNumPoints();
+    window.computeZoomWindow(e.fFullHistory, pendingPoints, maxNumPoints, pushCount, zoomBuffer);
+    window.computeZoomWindow(e.fHistory, historyPendingPoints, maxNumPoints, pushCount, historyZoomBuffer);
+
+    for(int i = position; i < std::min(position + maxNumPoints, V); i++)
+    {
+      int from, to;
+      naivePointRange(e.fZoom, e.getIdx(i), from, to);
+      from = std::max(from - pushCount, -e.fBufferSize);
+      to = std::max(to - pushCount, from);
+
+      auto expected = naiveMax(e.fEntries, from, to);
+      PROPERTY_CHECK(zoomBuffer.getAt(i) == expected, "step computeZoomWindow(full history, push count " << pushCount
+                     << ")[" << i << "] = " << zoomBuffer.getAt(i) << ", expected " << expected);
+
+      THistorySample min, max;
+      e.tieredBounds(from, to, tier, min, max);
+      PROPERTY_CHECK(historyZoomBuffer.getAt(i) >= min && historyZoomBuffer.getAt(i) <= max,
+                     "step computeZoomWindow(tiered history, push count " << pushCount << ")[" << i << "] = "
+                     << historyZoomBuffer.getAt(i) << ", expected in [" << min << ", " << max << "]");
+    }
+
+    for(int i = 0; i < iOp.fStep && !iOp.fEntries.empty(); i++, pushCount++)
+      e.push(iOp.fEntries[nextEntry++ % iOp.fEntries.size()]);
+  }
+
+  PROPERTY_CHECK(historyPendingPoints.isDone(), "tiered history pending points not done");
+  window.endZoomWindow(pendingPoints, computedWindow);
+  window.endZoomWindow(historyPendingPoints, historyComputedWindow);
+  PROPERTY_CHECK(computedWindow.isValid(), "endZoomWindow => invalid window");
+
+  return {};
+}
+
+/**
+ * Zooming from a point of the screen (setZoomFactor(..., iOffsetFromLeftOfScreen, ...)) keeps the entry giving the
+ * max of the point (or its first entry when there is no max) under the same point of the screen when possible (the
+ * window offset being clamped otherwise).
+ */
+std::string checkZoom(Engine &e, Op const &iOp)
+{
+  auto &window = e.fWindow;
+  int const V = e.fVisibleWindowSize;
+  int const offsetFromLeftOfScreen = std::min(std::max(iOp.fCount, 0), V - 1);
+  double const zoomFactorPercent = std::min(std::max(iOp.fValue, 0.0), 1.0);
+
+  int idx = e.getIdx(offsetFromLeftOfScreen);
+  int anchor = 0;
+  if(window.__findMaxForIndex(idx, e.fHistory, anchor) == 0)
+  {
+    int to;
+    naivePointRange(e.fZoom, idx, anchor, to);
+  }
+
+  TieredHistory<THistorySample> const *histories[] = {&e.fHistory, nullptr};
+  int res = window.setZoomFactor(zoomFactorPercent, offsetFromLeftOfScreen, histories, 2);
+
+  // the zoom factor percent is exponential: 0 is the max zoom factor, 1 is no zoom
+  double maxZoomFactor = static_cast<double>(e.fBufferSize) / V;
+  e.fZoom = Engine::toZoom(std::min(std::max(std::pow(maxZoomFactor, 1.0 - zoomFactorPercent), 1.0), maxZoomFactor));
+
+  int anchorIdx = naivePointIndex(e.fZoom, anchor);
+  int expectedWindowOffset = std::min(std::max(anchorIdx + V - 1 - offsetFromLeftOfScreen,
+                                               window.__getMinWindowOffset()),
+                                      MAX_WINDOW_OFFSET);
+  PROPERTY_CHECK(window.__getWindowOffset() == expectedWindowOffset,
+                 "setZoomFactor window offset " << window.__getWindowOffset() << ", expected "
+                 << expectedWindowOffset << " (entry " << anchor << " at point " << anchorIdx << ")");
+
+  int expected = std::min(std::max(anchorIdx - e.getIdx(0), 0), V - 1);
+  PROPERTY_CHECK(res == expected, "setZoomFactor returned " << res << ", expected " << expected);
+
+  return {};
+}
+
+// applyOp
+std::string applyOp(Engine &e, Op const &iOp)
+{
+  auto &window = e.fWindow;
+
+  switch(iOp.fType)
+  {
+    case Op::Type::kZoom:
+      return checkZoom(e, iOp);
+
+    case Op::Type::kRawZoom:
+    {
+      double maxZoomFactor = window.__getMaxZoomFactor();
+      double zoomFactor = std::min(1.0 + std::min(std::max(iOp.fValue, 0.0), 1.0) * (maxZoomFactor - 1.0), maxZoomFactor);
+      window.__setRawZoomFactor(zoomFactor);
+      e.fZoom = Engine::toZoom(zoomFactor);
+      PROPERTY_CHECK(window.__getWindowOffset() == MAX_WINDOW_OFFSET, "zooming does not reset the window offset");
+      return {};
+    }
+
+    case Op::Type::kScroll:
+      window.__setRawWindowOffset(std::max(MAX_WINDOW_OFFSET - std::max(iOp.fCount, 0), window.__getMinWindowOffset()));
+      return {};
+
+    case Op::Type::kScrollPercent:
+    {
+      double windowOffsetPercent = std::min(std::max(iOp.fValue, 0.0), 1.0);
+      window.setWindowOffset(windowOffsetPercent);
+      if(windowOffsetPercent == 1.0)
+      {
+        PROPERTY_CHECK(window.__getWindowOffset() == MAX_WINDOW_OFFSET, "setWindowOffset(1.0) is not the right");
+      }
+      if(windowOffsetPercent == 0.0)
+      {
+        PROPERTY_CHECK(window.__getWindowOffset() == window.__getMinWindowOffset(), "setWindowOffset(0.0) is not the left");
+      }
+      return {};
+    }
+
+    case Op::Type::kPush:
+      for(auto entry: iOp.fEntries)
+        e.push(entry);
+      return {};
+
+    case Op::Type::kSteps:
+      return checkSteps(e, iOp);
+  }
+
+  return {};
+}
+
+// runCase (returns the error, empty when the case passes)
+std::string runCase(Case const &iCase, Property const &iProperty)
+{
+  Engine e{iCase};
+
+  auto error = iProperty(e);
+  if(!error.empty())
+    return "initially: " + error;
+
+  for(size_t i = 0; i < iCase.fOps.size(); i++)
+  {
+    error = applyOp(e, iCase.fOps[i]);
+    if(error.empty())
+      error = iProperty(e);
+    if(!error.empty())
+    {
+      std::ostringstream s{};
+      s << "after op #" << i << " (" << iCase.fOps[i] << "): " << error;
+      return s.str();
+    }
+  }
+
+  return {};
+}
+
+//------------------------------------------------------------------------
+// Shrinking
+//------------------------------------------------------------------------
+
+// vectors simpler than iVector: empty, halves and one entry less
+template<typename T>
+std::vector<std::vector<T>> shrinkVector(std::vector<T> const &iVector)
+{
+  std::vector<std::vector<T>> res{};
+  if(iVector.empty())
+    return res;
+
+  res.emplace_back();
+  auto half = iVector.size() / 2;
+  if(half > 0)
+  {
+    res.emplace_back(iVector.begin(), iVector.begin() + half);
+    res.emplace_back(iVector.begin() + half, iVector.end());
+  }
+  if(iVector.size() <= 64)
+  {
+    for(size_t i = 0; i < iVector.size(); i++)
+    {
+      auto v = iVector;
+      v.erase(v.begin() + i);
+      res.emplace_back(std::move(v));
+    }
+  }
+  return res;
+}
+
+// integers simpler than iValue (towards iMin)
+std::vector<int> shrinkInt(int iValue, int iMin)
+{
+  std::vector<int> res{};
+  for(int v: {iMin, iMin + (iValue - iMin) / 2, iValue - 1})
+  {
+    if(v >= iMin && v < iValue && std::find(res.begin(), res.end(), v) == res.end())
+      res.emplace_back(v);
+  }
+  return res;
+}
+
+// percents simpler than iValue (bounds, 0.5 and rounded)
+std::vector<double> shrinkPercent(double iValue)
+{
+  std::vector<double> res{};
+  for(double v: {0.0, 1.0, 0.5, std::round(iValue * 10) / 10, std::round(iValue * 100) / 100})
+  {
+    if(v != iValue && std::find(res.begin(), res.end(), v) == res.end())
+      res.emplace_back(v);
+  }
+  return res;
+}
+
+// entries simpler than iEntries: fewer of them and then simpler values (0 or 1)
+std::vector<std::vector<double>> shrinkEntries(std::vector<double> const &iEntries)
+{
+  auto res = shrinkVector(iEntries);
+  if(iEntries.size() <= 64)
+  {
+    for(size_t i = 0; i < iEntries.size(); i++)
+    {
+      for(double v: {0.0, 1.0})
+      {
+        if(iEntries[i] != v && (v == 0 || iEntries[i] != 0))
+        {
+          auto entries = iEntries;
+          entries[i] = v;
+          res.emplace_back(std::move(entries));
+        }
+      }
+    }
+  }
+  return res;
+}
+
+// the cases "simpler" than iCase (which should make progress towards a minimal case)
+std::vector<Case> shrinkCase(Case const &iCase)
+{
+  std::vector<Case> res{};
+  auto add = [&res, &iCase](std::function<void(Case &)> const &iChange) {
+    Case c = iCase;
+    iChange(c);
+    res.emplace_back(std::move(c));
+  };
+
+  for(auto &ops: shrinkVector(iCase.fOps))
+    add([&ops](Case &c) { c.fOps = ops; });
+
+  for(auto &entries: shrinkEntries(iCase.fEntries))
+    add([&entries](Case &c) { c.fEntries = entries; });
+
+  for(int v: shrinkInt(iCase.fVisibleWindowSize, 1))
+    add([v](Case &c) { c.fVisibleWindowSize = v; });
+
+  for(int v: shrinkInt(iCase.fBufferSize, std::max(iCase.fVisibleWindowSize, 1)))
+    add([v](Case &c) { c.fBufferSize = v; });
+
+  for(int v: shrinkInt(iCase.fHistorySize, 1))
+    add([v](Case &c) { c.fHistorySize = v; });
+
+  for(int v: shrinkInt(iCase.fFullResolutionSize, 2))
+    add([v](Case &c) { c.fFullResolutionSize = v; });
+
+  for(int v: shrinkInt(iCase.fTierFactor, 2))
+    add([v](Case &c) { c.fTierFactor = v; });
+
+  for(size_t i = 0; i < iCase.fOps.size(); i++)
+  {
+    auto const &op = iCase.fOps[i];
+
+    for(auto v: shrinkPercent(op.fValue))
+      add([i, v](Case &c) { c.fOps[i].fValue = v; });
+
+    for(int v: shrinkInt(op.fCount, op.fType == Op::Type::kSteps ? 1 : 0))
+      add([i, v](Case &c) { c.fOps[i].fCount = v; });
+
+    for(int v: shrinkInt(op.fStep, 0))
+      add([i, v](Case &c) { c.fOps[i].fStep = v; });
+
+    for(auto &entries: shrinkEntries(op.fEntries))
+      add([i, &entries](Case &c) { c.fOps[i].fEntries = entries; });
+  }
+
+  return res;
+}
+
+/**
+ * Shrinks the failing case ioCase (greedily: the first simpler case which still fails is kept, until none does)
+ */
+void shrink(Case &ioCase, std::string &ioError, Property const &iProperty)
+{
+  constexpr int MAX_RUNS = 20000;
+
+  int runs = 0;
+  bool progress = true;
+  while(progress && runs < MAX_RUNS)
+  {
+    progress = false;
+    for(auto &c: shrinkCase(ioCase))
+    {
+      if(++runs > MAX_RUNS)
+        break;
+      auto error = runCase(c, iProperty);
+      if(!error.empty())
+      {
+        ioCase = std::move(c);
+        ioError = std::move(error);
+        progress = true;
+        break;
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+// Running the cases (in parallel)
+//------------------------------------------------------------------------
+uint64_t getEnv(char const *iName, uint64_t iDefaultValue)
+{
+  auto value = std::getenv(iName);
+  return value ? std::strtoull(value, nullptr, 10) : iDefaultValue;
+}
+
+/**
+ * Runs the cases [iSeed, iSeed + iNumCases[ on all the cores and returns the failing case with the lowest seed
+ * (shrunk) if any: false when all the cases pass.
+ */
+bool findFailure(uint64_t iSeed, uint64_t iNumCases, Property const &iProperty, Case &oCase, std::string &oError)
+{
+  constexpr uint64_t CHUNK_SIZE = 64;
+
+  std::atomic<uint64_t> nextCase{0};
+  std::atomic<uint64_t> firstFailure{iNumCases};
+  std::mutex mutex{};
+
+  auto worker = [&]() {
+    while(true)
+    {
+      auto chunk = nextCase.fetch_add(CHUNK_SIZE);
+      if(chunk >= firstFailure.load())
+        return;
+
+      for(auto i = chunk; i < std::min(chunk + CHUNK_SIZE, iNumCases); i++)
+      {
+        auto c = generateCase(iSeed + i);
+        auto error = runCase(c, iProperty);
+        if(!error.empty())
+        {
+          std::lock_guard<std::mutex> lock{mutex};
+          if(i < firstFailure.load())
+          {
+            firstFailure = i;
+            oCase = std::move(c);
+            oError = std::move(error);
+          }
+          return;
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads{};
+  for(unsigned int t = 0; t < std::max(std::thread::hardware_concurrency(), 1u); t++)
+    threads.emplace_back(worker);
+  for(auto &thread: threads)
+    thread.join();
+
+  if(firstFailure.load() == iNumCases)
+    return false;
+
+  shrink(oCase, oError, iProperty);
+  return true;
+}
+
+}
+
+// ZoomWindowPropertiesTest - Reference (everything the window computes matches the naive reference)
+TEST(ZoomWindowPropertiesTest, Reference)
+{
+  auto seed = getEnv("VAC6_PROPERTY_SEED", 0);
+  auto numCases = getEnv("VAC6_PROPERTY_CASES", 20000);
+
+  Case failure{};
+  std::string error{};
+  ASSERT_FALSE(findFailure(seed, numCases, checkWindow, failure, error)) << numCases << " cases (seed " << seed << ")"
+                                                                         << "\nminimal failing case: " << failure
+                                                                         << "\n" << error;
+}
+
+// ZoomWindowPropertiesTest - Shrink (a failing property is reported with a minimal case)
+TEST(ZoomWindowPropertiesTest, Shrink)
+{
+  // "no point of a zoomed window is a full scale entry" obviously fails (when there is one)...
+  auto property = [](Engine &e) -> std::string {
+    if(e.fZoom == BATCH_SIZE)
+      return {};
+    computeReferenceZoomWindow(e.fWindow, e.fBuffer, e.fZoomBuffer);
+    for(int i = 0; i < e.fVisibleWindowSize; i++)
+      PROPERTY_CHECK(e.fZoomBuffer.getAt(i) != toHistorySample(1.0), "full scale at " << i);
+    return {};
+  };
+
+  Case failure{};
+  std::string error{};
+  ASSERT_TRUE(findFailure(0, 1000, property, failure, error));
+
+  // ... and the minimal case is a zoom of a window of 1 point (over 2 entries) showing a single full scale entry
+  ASSERT_EQ(1, failure.fVisibleWindowSize) << failure;
+  ASSERT_EQ(2, failure.fBufferSize) << failure;
+  ASSERT_EQ(1, failure.fEntries.size()) << failure;
+  ASSERT_EQ(1.0, failure.fEntries[0]) << failure;
+  ASSERT_EQ(1, failure.fOps.size()) << failure;
+  ASSERT_TRUE(error.find("full scale at 0") != std::string::npos) << error;
+}
+
+}
+}
+}